@@ -5,13 +5,17 @@
 #include <string.h>
 #include <strings.h>
 
+#include <bit>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "config.hpp"
 #include "iassert.hpp"
+#include "snapshot.hpp"
 #include "snippets.hpp"
 #include "stats.hpp"
+#include "tag_match.hpp"
 
 //-------------------------------------------------------------
 inline constexpr int RRIP_M = 4;  // max value = 2^M   | 4 | 8   | 16   |
@@ -72,6 +76,12 @@ public:
     bool    recent;  // used by skew cache
     uint8_t rrip;    // used by hawkeye and PAR
     CacheLine(int32_t lineSize) : State(lineSize) {}
+
+    void io(Snapshot_io& ar) {
+      State::io(ar);
+      ar.io(recent);
+      ar.io(rrip);
+    }
     // Pure virtual class defines interface
     //
     // Tag included in state. Accessed through:
@@ -110,11 +120,15 @@ protected:
 
   void createStats(const std::string& section, const std::string& name);
 
+  // Called after snapshot() saved/restored the lines, for layouts with state outside the lines
+  virtual void after_snapshot() {}
+
 public:
   // Do not use this interface, use other create
   static CacheGeneric<State, Addr_t>* create(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit,
                                              const std::string& pStr, bool skew, bool xr,
-                                             uint32_t shct_size = 13);  // 13 is the optimal size specified in the paper
+                                             uint32_t shct_size = 13,  // 13 is the optimal size specified in the paper
+                                             bool     soa       = false);
   static CacheGeneric<State, Addr_t>* create(const std::string& section, const std::string& append, const std::string& format);
   void                                destroy() { delete this; }
 
@@ -278,6 +292,20 @@ public:
   }
 
   Addr_t calcAddr4Tag(Addr_t tag) const { return (tag << log2AddrLs); }
+
+  // Saves/restores every line (tag, state, replacement bits). Lines are
+  // visited in getPLine order, so a restore into the same geometry also
+  // rebuilds the per set recency order.
+  void snapshot(Snapshot_io& ar, const std::string& name) {
+    uint64_t key = (static_cast<uint64_t>(numLines) << 32) ^ (static_cast<uint64_t>(assoc) << 16) ^ lineSize;
+    if (!ar.section(name, key)) {
+      return;
+    }
+    for (uint32_t i = 0; i < numLines; ++i) {
+      getPLine(i)->io(ar);
+    }
+    after_snapshot();
+  }
 };
 
 template <class State, class Addr_t>
@@ -451,6 +479,94 @@ public:
   Line* findLine2Replace(Addr_t addr, Addr_t tag_addr, Addr_t pc, bool prefetch);
 };
 
+// Same LRU, LRUp, and RANDOM behavior as CacheAssoc with a structure of
+// arrays set layout. Each set keeps its tags in a contiguous array (compared
+// with AVX2/SSE2/NEON) and one age byte per way (0 is MRU) instead
+// of a recency ordered array of pointers, so a hit updates assoc bytes and
+// lines never move. getPLine(set + rank) returns the way with age rank, the
+// same visit order as CacheAssoc.
+//
+// The tag array is a hint: lines invalidated through the line itself keep a
+// stale tag there, and every candidate way is checked against the line.
+template <class State, class Addr_t>
+class CacheAssocSoA : public CacheGeneric<State, Addr_t> {
+  using CacheGeneric<State, Addr_t>::numLines;
+  using CacheGeneric<State, Addr_t>::assoc;
+  using CacheGeneric<State, Addr_t>::maskAssoc;
+
+public:
+  using Line = typename CacheGeneric<State, Addr_t>::CacheLine;
+
+  // Layouts handled, other policies (and sizes) use CacheAssoc
+  static bool supports(std::string_view pStr_lc, int32_t associativity);
+
+protected:
+  std::vector<Line>    mem;
+  std::vector<Addr_t>  tags;  // numLines, by way
+  std::vector<uint8_t> age;   // numLines (+8), a permutation of 0..assoc-1 per set
+  uint16_t             irand;
+  ReplacementPolicy    policy;
+
+  friend class CacheGeneric<State, Addr_t>;
+  CacheAssocSoA(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const std::string& pStr, bool xr);
+
+  // Ages are handled 8 ways per 64 bit word (SWAR), the array has 8 bytes of
+  // padding so that sets smaller than 8 ways can load a full word
+  static constexpr uint64_t age_lo = 0x0101010101010101ULL;
+  static constexpr uint64_t age_hi = 0x8080808080808080ULL;
+
+  uint64_t age_mask(uint32_t i) const { return assoc - i >= 8 ? ~0ULL : (1ULL << ((assoc - i) * 8)) - 1; }
+
+  uint32_t find_age(const uint8_t* set_age, uint32_t rank) const {
+    const uint64_t r = rank * age_lo;
+    for (uint32_t i = 0;; i += 8) {
+      uint64_t x;
+      memcpy(&x, set_age + i, 8);
+      x ^= r;
+      uint64_t z = (x - age_lo) & ~x & age_hi & age_mask(i);  // lowest set byte is the first zero
+      if (z) {
+        return i + std::countr_zero(z) / 8;
+      }
+      I(i + 8 < assoc);
+    }
+  }
+  void touch(uint8_t* set_age, uint32_t way) {
+    const uint64_t a = set_age[way] * age_lo;
+    if (a == 0) {
+      return;  // already MRU
+    }
+    for (uint32_t i = 0; i < assoc; i += 8) {
+      uint64_t x;
+      memcpy(&x, set_age + i, 8);
+      uint64_t lt = (~((x | age_hi) - a) & age_hi) >> 7;  // 1 in the bytes with age < a
+      x += lt & age_mask(i);
+      memcpy(set_age + i, &x, 8);
+    }
+    set_age[way] = 0;
+  }
+  Line* find_way(Addr_t index, Addr_t tag, uint32_t& way);
+
+  Line* findLineNoEffectPrivate(Addr_t addr, Addr_t tag_addr);
+  Line* findLinePrivate(Addr_t addr, Addr_t tag_addr, Addr_t pc);
+
+  void after_snapshot() override {
+    for (uint32_t i = 0; i < numLines; ++i) {
+      tags[i] = mem[i].getTag();
+    }
+  }
+
+public:
+  virtual ~CacheAssocSoA() {}
+
+  Line* getPLine(uint32_t l) {
+    I(l < numLines);
+    uint32_t index = l & ~static_cast<uint32_t>(maskAssoc);
+    return &mem[index + find_age(&age[index], l & maskAssoc)];
+  }
+
+  Line* findLine2Replace(Addr_t addr, Addr_t tag_addr, Addr_t pc, bool prefetch);
+};
+
 template <class State, class Addr_t>
 class CacheDM : public CacheGeneric<State, Addr_t> {
   using CacheGeneric<State, Addr_t>::numLines;
@@ -623,6 +739,13 @@ public:
   virtual void invalidate() { clearTag(); }
 
   virtual void dump([[maybe_unused]] const std::string& str) {}
+
+  void io(Snapshot_io& ar) {
+    ar.io(tag);
+    ar.io(rrpv);
+    ar.io(signature);
+    ar.io(outcome);
+  }
 };
 
 template <class Addr_t>
@@ -697,6 +820,15 @@ public:
   void setRRPV([[maybe_unused]] uint8_t a) { I(0); }
 
   void incRRPV() { I(0); }
+
+  void io(Snapshot_io& ar) {
+    ar.io(tag);
+    ar.io(prefetch);
+    ar.io(pc);
+    ar.io(sign);
+    ar.io(degree);
+    ar.io(nDemand);
+  }
 };
 
 inline constexpr std::string_view k_RANDOM  = "random";
@@ -712,7 +844,8 @@ inline constexpr std::string_view k_UAR     = "uar";
 // Class CacheGeneric, the combinational logic of Cache
 template <class State, class Addr_t>
 CacheGeneric<State, Addr_t>* CacheGeneric<State, Addr_t>::create(int32_t size, int32_t assoc, int32_t bsize, int32_t addrUnit,
-                                                                 const std::string& pStr, bool skew, bool xr, uint32_t shct_size) {
+                                                                 const std::string& pStr, bool skew, bool xr, uint32_t shct_size,
+                                                                 bool soa) {
   if (size / bsize < assoc) {
     Config::add_error(fmt::format("Invalid cache configuration size {}, line {}, assoc {} (increase size, or decrease line)",
                                   size,
@@ -742,6 +875,8 @@ CacheGeneric<State, Addr_t>* CacheGeneric<State, Addr_t>::create(int32_t size, i
       cache = new CacheSHIP<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, shct_size);
     } else if (pStr_lc == k_HAWKEYE) {
       cache = new HawkCache<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
+    } else if (soa && CacheAssocSoA<State, Addr_t>::supports(pStr_lc, assoc)) {
+      cache = new CacheAssocSoA<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
     } else {
       cache = new CacheAssoc<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
     }
@@ -750,6 +885,8 @@ CacheGeneric<State, Addr_t>* CacheGeneric<State, Addr_t>::create(int32_t size, i
       cache = new CacheSHIP<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, shct_size);
     } else if (pStr_lc == k_HAWKEYE) {
       cache = new HawkCache<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
+    } else if (soa && CacheAssocSoA<State, Addr_t>::supports(pStr_lc, assoc)) {
+      cache = new CacheAssocSoA<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
     } else {
       cache = new CacheAssoc<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
     }
@@ -799,6 +936,7 @@ CacheGeneric<State, Addr_t>* CacheGeneric<State, Addr_t>::create(const std::stri
   auto skew_sec        = fmt::format("{}skew", fmt_append);
   auto xor_sec         = fmt::format("{}xor", fmt_append);
   auto ship_sec        = fmt::format("{}ship_sign_bits", fmt_append);
+  auto soa_sec         = fmt::format("{}soa", fmt_append);
 
   int32_t s  = Config::get_power2(section, size_sec);
   int32_t a  = Config::get_integer(section, assoc_sec);
@@ -812,6 +950,10 @@ CacheGeneric<State, Addr_t>* CacheGeneric<State, Addr_t>::create(const std::stri
   if (Config::has_entry(section, skew_sec)) {
     sk = Config::get_bool(section, skew_sec);
   }
+  bool soa = false;
+  if (Config::has_entry(section, soa_sec)) {
+    soa = Config::get_bool(section, soa_sec);
+  }
   int32_t u = 1;
   if (Config::has_entry(section, addrUnit_sec)) {
     u = Config::get_power2(section, addrUnit_sec, 0, b);
@@ -836,7 +978,7 @@ CacheGeneric<State, Addr_t>* CacheGeneric<State, Addr_t>::create(const std::stri
   if (Config::has_errors()) {
     cache = new CacheAssoc<State, Addr_t>(2, 1, 1, 1, pStr_lc, xr);
   } else {
-    cache = create(s, a, b, u, pStr_lc, sk, xr, shct_size);
+    cache = create(s, a, b, u, pStr_lc, sk, xr, shct_size, soa);
   }
 
   I(cache);
@@ -1179,6 +1321,123 @@ typename CacheAssoc<State, Addr_t>::Line* CacheAssoc<State, Addr_t>::findLine2Re
 
   return tmp;
 }
+/*********************************************************
+ *  CacheAssocSoA
+ *********************************************************/
+
+template <class State, class Addr_t>
+bool CacheAssocSoA<State, Addr_t>::supports(std::string_view pStr_lc, int32_t associativity) {
+  if (pStr_lc != k_LRU && pStr_lc != k_LRUp && pStr_lc != k_RANDOM) {
+    return false;
+  }
+  // 64 ways for the match mask, power of 2 so that getPLine ranks stay within a set
+  return associativity >= 2 && associativity <= 64 && std::has_single_bit(static_cast<uint32_t>(associativity));
+}
+
+template <class State, class Addr_t>
+CacheAssocSoA<State, Addr_t>::CacheAssocSoA(int32_t _size, int32_t associativity, int32_t blksize, int32_t _addrUnit,
+                                            const std::string& pStr, bool xr)
+    : CacheGeneric<State, Addr_t>(_size, associativity, blksize, _addrUnit, xr) {
+  I(numLines > 0);
+
+  if (pStr == k_RANDOM) {
+    policy = RANDOM;
+  } else if (pStr == k_LRU) {
+    policy = LRU;
+  } else {
+    I(pStr == k_LRUp);
+    policy = LRUp;
+  }
+
+  Line zero_line(blksize);
+  zero_line.initialize(this);
+  zero_line.invalidate();
+  zero_line.rrip = 0;
+
+  mem.resize(numLines, zero_line);
+  tags.resize(numLines, 0);
+  age.resize(numLines + 8);
+  for (uint32_t i = 0; i < numLines; i++) {
+    age[i] = i & maskAssoc;  // same initial order as CacheAssoc
+  }
+
+  irand = 0;
+}
+
+template <class State, class Addr_t>
+typename CacheAssocSoA<State, Addr_t>::Line* CacheAssocSoA<State, Addr_t>::find_way(Addr_t index, Addr_t tag, uint32_t& way) {
+  uint64_t m = tag_match_mask(&tags[index], assoc, tag);
+  while (m) {
+    uint32_t w = std::countr_zero(m);
+    if (mem[index + w].getTag() == tag) {
+      way = w;
+      return &mem[index + w];
+    }
+    tags[index + w] = mem[index + w].getTag();  // invalidated outside the cache
+    m &= m - 1;
+  }
+
+  return nullptr;
+}
+
+template <class State, class Addr_t>
+typename CacheAssocSoA<State, Addr_t>::Line* CacheAssocSoA<State, Addr_t>::findLineNoEffectPrivate(Addr_t addr, Addr_t tag_addr) {
+  uint32_t way;
+  return find_way(this->calcIndex4Tag(this->calcTag(addr)), this->calcTag(tag_addr), way);
+}
+
+template <class State, class Addr_t>
+typename CacheAssocSoA<State, Addr_t>::Line* CacheAssocSoA<State, Addr_t>::findLinePrivate(Addr_t addr, Addr_t tag_addr,
+                                                                                           [[maybe_unused]] Addr_t pc) {
+  Addr_t   index = this->calcIndex4Tag(this->calcTag(addr));
+  uint32_t way;
+  Line*    l = find_way(index, this->calcTag(tag_addr), way);
+  if (l) {
+    touch(&age[index], way);
+  }
+
+  return l;
+}
+
+template <class State, class Addr_t>
+typename CacheAssocSoA<State, Addr_t>::Line* CacheAssocSoA<State, Addr_t>::findLine2Replace(Addr_t addr, Addr_t tag_addr, Addr_t pc,
+                                                                                            bool prefetch) {
+  Addr_t tag = this->calcTag(tag_addr);
+  I(tag);
+  Addr_t   index   = this->calcIndex4Tag(this->calcTag(addr));
+  uint8_t* set_age = &age[index];
+
+  uint32_t way;
+  Line*    l = find_way(index, tag, way);
+  if (l == nullptr) {
+    uint32_t rank = assoc - 1;
+    if (policy == RANDOM) {
+      rank  = irand;
+      irand = (irand + 1) & maskAssoc;
+      if (irand == 0) {
+        irand = (irand + 1) & maskAssoc;  // Not MRU
+      }
+    }
+    way               = find_age(set_age, rank);
+    l                 = &mem[index + way];
+    tags[index + way] = tag;  // the caller sets the line tag
+  }
+
+  if (set_age[way] == 0) {
+    return l;  // Hit in the first possition
+  }
+
+  l->setPC(pc);
+
+  if (prefetch || policy == LRUp) {
+    return l;
+  }
+
+  touch(set_age, way);
+
+  return l;
+}
+
 /*********************************************************
  *  HawkCache
  *********************************************************/
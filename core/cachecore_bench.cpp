@@ -1,3 +1,5 @@
+#include <fstream>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "cachecore.hpp"
@@ -175,6 +177,37 @@ BENCHMARK(BM_cachecore)->Arg(2);
 BENCHMARK(BM_cachecore)->Arg(4);
 #endif
 
+// Accesses per second of a LRU cache, args: ways, KB, soa (0 CacheAssoc, 1 CacheAssocSoA)
+static void BM_cache_layout(benchmark::State& state) {
+  long size = state.range(1) * 1024;
+  auto c    = MyCacheType::create(size, state.range(0), 64, 1, "lru", false, false, 13, state.range(2) != 0);
+
+  // 80% in a working set 1.5x the cache, the rest spread over 64MB
+  std::vector<long> addrs(1 << 18);
+  uint64_t          x = 0x9E3779B97F4A7C15ULL;
+  for (auto& a : addrs) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    a = 0x10000 + static_cast<long>((x % 5) ? (x >> 8) % (size + size / 2) : (x >> 8) % (64 << 20));
+  }
+
+  int64_t n = 0;
+  for (auto _ : state) {
+    for (auto a : addrs) {
+      if (c->readLine(a, a, 0xbaadbaad) == nullptr) {
+        c->fillLine(a, a, 0xbaadbaad);
+      }
+    }
+    n += addrs.size();
+  }
+
+  state.counters["accesses"] = benchmark::Counter(n, benchmark::Counter::kIsRate);
+  c->destroy();
+}
+
+BENCHMARK(BM_cache_layout)->ArgsProduct({{4, 8, 16}, {32, 2048}, {0, 1}});
+
 int main(int argc, char* argv[]) {
   setup_config();
   benchmark::Initialize(&argc, argv);
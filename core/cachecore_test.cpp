@@ -0,0 +1,106 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "cachecore.hpp"
+
+#include <unistd.h>
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+class Cachecore_test : public ::testing::TestWithParam<std::tuple<const char*, int>> {
+protected:
+  class Tag_state : public StateGeneric<uint64_t> {
+  public:
+    explicit Tag_state(int32_t lineSize) { (void)lineSize; }
+  };
+  using Cache = CacheGeneric<Tag_state, uint64_t>;
+
+  // Reads, demand and prefetch fills, and invalidations through the line,
+  // the same stream for both caches
+  static void run(Cache* aos, Cache* soa, uint64_t seed, int n) {
+    std::mt19937_64 rng(seed);
+    for (int i = 0; i < n; ++i) {
+      uint64_t addr = 0x10000 + ((rng() & 3) ? (rng() % 24576) : (rng() % (1 << 20)));
+
+      auto* la = aos->readLine(addr, addr, 0);
+      auto* ls = soa->readLine(addr, addr, 0);
+      ASSERT_EQ(la == nullptr, ls == nullptr) << "access " << i;
+
+      if (la == nullptr) {
+        bool     pref = (rng() & 7) == 0;
+        uint64_t ra   = 0;
+        uint64_t rs   = 0;
+        la            = aos->fillLine_replace(addr, addr, ra, 0, pref);
+        ls            = soa->fillLine_replace(addr, addr, rs, 0, pref);
+        ASSERT_EQ(ra, rs) << "access " << i;
+      } else if ((rng() & 31) == 0) {
+        la->invalidate();
+        ls->invalidate();
+      }
+    }
+
+    for (uint32_t i = 0; i < aos->getNumLines(); ++i) {
+      ASSERT_EQ(aos->getPLine(i)->getTag(), soa->getPLine(i)->getTag()) << "line " << i;
+    }
+  }
+};
+
+TEST_P(Cachecore_test, soa_matches_assoc) {
+  auto [policy, assoc] = GetParam();
+
+  auto* aos = Cache::create(8192, assoc, 64, 1, policy, false, false);
+  auto* soa = Cache::create(8192, assoc, 64, 1, policy, false, false, 13, true);
+
+  run(aos, soa, 7, 50000);
+
+  aos->destroy();
+  soa->destroy();
+}
+
+TEST_P(Cachecore_test, soa_snapshot_from_assoc) {
+  auto [policy, assoc] = GetParam();
+
+  auto file_name = fmt::format("cachecore_test_{}.snap", getpid());
+  {
+    auto* aos = Cache::create(8192, assoc, 64, 1, policy, false, false);
+    auto* tmp = Cache::create(8192, assoc, 64, 1, policy, false, false, 13, true);
+    run(aos, tmp, 11, 5000);
+
+    auto ar = Snapshot_io::create(file_name);
+    aos->snapshot(*ar, "L1");
+    ASSERT_TRUE(ar->close());
+    aos->destroy();
+    tmp->destroy();
+  }
+
+  // Both layouts restore the same lines and recency order (the SoA also
+  // rebuilds its tag array), so they keep matching afterwards
+  auto* aos = Cache::create(8192, assoc, 64, 1, policy, false, false);
+  auto* soa = Cache::create(8192, assoc, 64, 1, policy, false, false, 13, true);
+  for (auto* c : {aos, soa}) {
+    auto ar = Snapshot_io::open(file_name);
+    ASSERT_NE(ar, nullptr);
+    c->snapshot(*ar, "L1");
+  }
+  unlink(file_name.c_str());
+
+  EXPECT_NE(soa->findLineNoEffect(aos->getPLine(0)->getTag() << 6, aos->getPLine(0)->getTag() << 6, 0), nullptr);
+
+  run(aos, soa, 13, 20000);
+
+  aos->destroy();
+  soa->destroy();
+}
+
+INSTANTIATE_TEST_SUITE_P(Layouts, Cachecore_test,
+                         ::testing::Combine(::testing::Values("lru", "lrup", "random"), ::testing::Values(4, 8, 16)));
+
+TEST(Cachecore_layout, soa_fallback) {
+  using Soa = CacheAssocSoA<StateGeneric<uint64_t>, uint64_t>;
+
+  EXPECT_TRUE(Soa::supports("lru", 8));
+  EXPECT_FALSE(Soa::supports("par", 8));  // RRIP stays in CacheAssoc
+  EXPECT_FALSE(Soa::supports("lru", 6));
+  EXPECT_FALSE(Soa::supports("lru", 128));
+}
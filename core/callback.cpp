@@ -4,15 +4,23 @@
 
 #include "port.hpp"
 
-EventScheduler::TimedCallbacksQueue EventScheduler::cbQ(256);
+#ifdef EVENT_TWHEEL
+thread_local EventScheduler::TimedCallbacksQueue EventScheduler::cbQ(256, 256);
+#else
+thread_local EventScheduler::TimedCallbacksQueue EventScheduler::cbQ(256);
+#endif
 
-Time_t globalClock = 0;
-Time_t deadClock   = 0;
+thread_local Time_t globalClock = 0;
+thread_local Time_t deadClock   = 0;
 
 void EventScheduler::dump() const { I(0); }
 
 void EventScheduler::register_drain_port(PortGeneric* port) { get_drain_ports().push_back(port); }
 
+void EventScheduler::use_drain_ports(std::vector<PortGeneric*>* ports) {
+  get_drain_ports_ptr() = ports ? ports : &get_global_drain_ports();
+}
+
 void EventScheduler::drain_port_queues() {
   for (auto* port : get_drain_ports()) {
     port->drain_pending();
@@ -5,6 +5,10 @@
 #define STRICT_PRIORITY      1
 #define PORT_STRICT_PRIORITY 1
 
+// Event queue backend. TWheel (two level timing wheel, O(1) inserts up to
+// 64K cycles ahead) by default; undefine to use the single level TQueue.
+#define EVENT_TWHEEL 1
+
 #include <cstdlib>
 #include <vector>  // std::vector<>
 
@@ -13,6 +17,7 @@
 #include "pool.hpp"
 #include "snippets.hpp"
 #include "tqueue.hpp"
+#include "twheel.hpp"
 
 // Forward declaration for port registration
 class PortGeneric;
@@ -34,9 +39,16 @@ class PortGeneric;
 
 class EventScheduler : public TQueue<EventScheduler*, Time_t>::User {
 private:
+#ifdef EVENT_TWHEEL
+  using TimedCallbacksQueue = TWheel<EventScheduler*, Time_t>;
+#else
   using TimedCallbacksQueue = TQueue<EventScheduler*, Time_t>;
+#endif
 
-  static TimedCallbacksQueue cbQ;
+  // One queue per host thread: the parallel engine runs each Clock_domain in
+  // its own thread. Callback pools are per thread too (pool_home), and a
+  // callback posted to another domain goes back to the pool that created it.
+  static thread_local TimedCallbacksQueue cbQ;
 
 #ifndef NDEBUG
   bool priority_set = false;
@@ -81,6 +93,10 @@ public:
   static void register_drain_port(PortGeneric* port);
   static void drain_port_queues();
 
+  // Redirect registration/draining of this thread to another port list
+  // (nullptr restores the global one). Used by Clock_domain.
+  static void use_drain_ports(std::vector<PortGeneric*>* ports);
+
   static void schedule(Time_t tim, EventScheduler* cb) {
     (void)tim;
     (void)cb;
@@ -148,6 +164,23 @@ public:
     }
   }
 
+  // Earliest cycle with a callback or a port drain pending, MaxTime if none
+  static Time_t nextEventTime() {
+    if (any_drain_port_has_pending()) {
+      return globalClock + 1;
+    }
+    return cbQ.nextTime();
+  }
+
+  // Idle-cycle skip: the cycles before tim have nothing scheduled, so they are
+  // counted as dead and the next advanceClock runs tim
+  static void skipClock(Time_t tim) {
+    I(tim > globalClock);
+    I(cbQ.nextTime() >= tim);
+    deadClock += tim - 1 - globalClock;
+    globalClock = tim - 1;
+  }
+
   static bool empty() { return cbQ.empty(); }
 
   static size_t size() { return cbQ.size(); }
@@ -162,10 +195,15 @@ public:
 private:
   // Static storage for registered priority-managed ports (accessor pattern for
   // static initialization order).
-  static std::vector<PortGeneric*>& get_drain_ports() {
+  static std::vector<PortGeneric*>& get_global_drain_ports() {
     static std::vector<PortGeneric*> drain_ports;
     return drain_ports;
   }
+  static std::vector<PortGeneric*>*& get_drain_ports_ptr() {
+    static thread_local std::vector<PortGeneric*>* selected = &get_global_drain_ports();
+    return selected;
+  }
+  static std::vector<PortGeneric*>& get_drain_ports() { return *get_drain_ports_ptr(); }
 
   static bool any_drain_port_has_pending();
 };
@@ -207,10 +245,13 @@ class StaticCallbackBase : public CallbackBase {
 template <class Parameter1, class Parameter2, class Parameter3, void (*funcPtr)(Parameter1, Parameter2, Parameter3)>
 class CallbackFunction3 : public CallbackBase {
 private:
-  using poolType = pool<CallbackFunction3>;
+  using poolType = pool_home<CallbackFunction3>;
 
-  static poolType cbPool;
-  friend class pool<CallbackFunction3>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBF3");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackFunction3>;
 
   Parameter1 p1;
   Parameter2 p2;
@@ -222,7 +263,7 @@ protected:
 
 public:
   static CallbackFunction3* create(Parameter1 a1, Parameter2 a2, Parameter3 a3, Time_t priority = 0) {
-    CallbackFunction3* cb = cbPool.out();
+    CallbackFunction3* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->p1 = a1;
@@ -256,22 +297,21 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class Parameter1, class Parameter2, class Parameter3, void (*funcPtr)(Parameter1, Parameter2, Parameter3)>
-typename CallbackFunction3<Parameter1, Parameter2, Parameter3, funcPtr>::poolType
-    CallbackFunction3<Parameter1, Parameter2, Parameter3, funcPtr>::cbPool(32, "CBF3");
-
 template <class Parameter1, class Parameter2, void (*funcPtr)(Parameter1, Parameter2)>
 class CallbackFunction2 : public CallbackBase {
 private:
-  using poolType = pool<CallbackFunction2>;
+  using poolType = pool_home<CallbackFunction2>;
 
-  static poolType cbPool;
-  friend class pool<CallbackFunction2>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBF2");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackFunction2>;
 
   Parameter1 p1;
   Parameter2 p2;
@@ -282,7 +322,7 @@ protected:
 
 public:
   static CallbackFunction2* create(Parameter1 a1, Parameter2 a2, Time_t priority = 0) {
-    CallbackFunction2* cb = cbPool.out();
+    CallbackFunction2* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->p1 = a1;
@@ -314,22 +354,21 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class Parameter1, class Parameter2, void (*funcPtr)(Parameter1, Parameter2)>
-typename CallbackFunction2<Parameter1, Parameter2, funcPtr>::poolType CallbackFunction2<Parameter1, Parameter2, funcPtr>::cbPool(
-    32, "CBF2");
-
 template <class Parameter1, void (*funcPtr)(Parameter1)>
 class CallbackFunction1 : public CallbackBase {
 private:
-  using poolType = pool<CallbackFunction1>;
+  using poolType = pool_home<CallbackFunction1>;
 
-  static poolType cbPool;
-  friend class pool<CallbackFunction1>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBF1");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackFunction1>;
 
   Parameter1 p1;
 
@@ -339,7 +378,7 @@ protected:
 
 public:
   static CallbackFunction1* create(Parameter1 a1, Time_t priority = 0) {
-    CallbackFunction1* cb = cbPool.out();
+    CallbackFunction1* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->p1 = a1;
@@ -369,21 +408,21 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class Parameter1, void (*funcPtr)(Parameter1)>
-typename CallbackFunction1<Parameter1, funcPtr>::poolType CallbackFunction1<Parameter1, funcPtr>::cbPool(32, "CBF1");
-
 template <void (*funcPtr)()>
 class CallbackFunction0 : public CallbackBase {
 private:
-  using poolType = pool<CallbackFunction0>;
+  using poolType = pool_home<CallbackFunction0>;
 
-  static poolType cbPool;
-  friend class pool<CallbackFunction0>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBF1");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackFunction0>;
 
 protected:
   CallbackFunction0() {}
@@ -391,7 +430,7 @@ protected:
 
 public:
   static CallbackFunction0* create(Time_t priority = 0) {
-    CallbackFunction0* cb = cbPool.out();
+    CallbackFunction0* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     return cb;
@@ -420,12 +459,9 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 };
 
-template <void (*funcPtr)()>
-typename CallbackFunction0<funcPtr>::poolType CallbackFunction0<funcPtr>::cbPool(32, "CBF1");
-
 template <class Parameter1, class Parameter2, void (*funcPtr)(Parameter1, Parameter2)>
 class StaticCallbackFunction2 : public StaticCallbackBase {
 private:
@@ -531,10 +567,13 @@ template <class ClassType, class Parameter1, class Parameter2, class Parameter3,
           class Parameter6, void (ClassType::*memberPtr)(Parameter1, Parameter2, Parameter3, Parameter4, Parameter5, Parameter6)>
 class CallbackMember6 : public CallbackBase {
 private:
-  using poolType = pool<CallbackMember6>;
+  using poolType = pool_home<CallbackMember6>;
 
-  static poolType cbPool;
-  friend class pool<CallbackMember6>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBM6");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackMember6>;
 
   Parameter1 p1;
   Parameter2 p2;
@@ -553,7 +592,7 @@ protected:
 public:
   static CallbackMember6* create(ClassType* i, Parameter1 a1, Parameter2 a2, Parameter3 a3, Parameter4 a4, Parameter5 a5,
                                  Parameter6 a6, Time_t priority = 0) {
-    CallbackMember6* cb = cbPool.out();
+    CallbackMember6* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->instance = i;
@@ -592,17 +631,11 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class ClassType, class Parameter1, class Parameter2, class Parameter3, class Parameter4, class Parameter5,
-          class Parameter6, void (ClassType::*memberPtr)(Parameter1, Parameter2, Parameter3, Parameter4, Parameter5, Parameter6)>
-typename CallbackMember6<ClassType, Parameter1, Parameter2, Parameter3, Parameter4, Parameter5, Parameter6, memberPtr>::poolType
-    CallbackMember6<ClassType, Parameter1, Parameter2, Parameter3, Parameter4, Parameter5, Parameter6, memberPtr>::cbPool(32,
-                                                                                                                          "CBM6");
-
 /************************************************************************************/
 
 /************************************************************************************/
@@ -610,10 +643,13 @@ template <class ClassType, class Parameter1, class Parameter2, class Parameter3,
           void (ClassType::*memberPtr)(Parameter1, Parameter2, Parameter3, Parameter4, Parameter5)>
 class CallbackMember5 : public CallbackBase {
 private:
-  using poolType = pool<CallbackMember5>;
+  using poolType = pool_home<CallbackMember5>;
 
-  static poolType cbPool;
-  friend class pool<CallbackMember5>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBM5");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackMember5>;
 
   Parameter1 p1;
   Parameter2 p2;
@@ -631,7 +667,7 @@ protected:
 public:
   static CallbackMember5* create(ClassType* i, Parameter1 a1, Parameter2 a2, Parameter3 a3, Parameter4 a4, Parameter5 a5,
                                  Time_t priority = 0) {
-    CallbackMember5* cb = cbPool.out();
+    CallbackMember5* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->instance = i;
@@ -669,26 +705,24 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class ClassType, class Parameter1, class Parameter2, class Parameter3, class Parameter4, class Parameter5,
-          void (ClassType::*memberPtr)(Parameter1, Parameter2, Parameter3, Parameter4, Parameter5)>
-typename CallbackMember5<ClassType, Parameter1, Parameter2, Parameter3, Parameter4, Parameter5, memberPtr>::poolType
-    CallbackMember5<ClassType, Parameter1, Parameter2, Parameter3, Parameter4, Parameter5, memberPtr>::cbPool(32, "CBM5");
-
 /************************************************************************************/
 
 template <class ClassType, class Parameter1, class Parameter2, class Parameter3, class Parameter4,
           void (ClassType::*memberPtr)(Parameter1, Parameter2, Parameter3, Parameter4)>
 class CallbackMember4 : public CallbackBase {
 private:
-  using poolType = pool<CallbackMember4>;
+  using poolType = pool_home<CallbackMember4>;
 
-  static poolType cbPool;
-  friend class pool<CallbackMember4>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBM4");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackMember4>;
 
   Parameter1 p1;
   Parameter2 p2;
@@ -703,7 +737,7 @@ protected:
 
 public:
   static CallbackMember4* create(ClassType* i, Parameter1 a1, Parameter2 a2, Parameter3 a3, Parameter4 a4, Time_t priority = 0) {
-    CallbackMember4* cb = cbPool.out();
+    CallbackMember4* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->instance = i;
@@ -740,24 +774,22 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class ClassType, class Parameter1, class Parameter2, class Parameter3, class Parameter4,
-          void (ClassType::*memberPtr)(Parameter1, Parameter2, Parameter3, Parameter4)>
-typename CallbackMember4<ClassType, Parameter1, Parameter2, Parameter3, Parameter4, memberPtr>::poolType
-    CallbackMember4<ClassType, Parameter1, Parameter2, Parameter3, Parameter4, memberPtr>::cbPool(32, "CBM4");
-
 template <class ClassType, class Parameter1, class Parameter2, class Parameter3,
           void (ClassType::*memberPtr)(Parameter1, Parameter2, Parameter3)>
 class CallbackMember3 : public CallbackBase {
 private:
-  using poolType = pool<CallbackMember3>;
+  using poolType = pool_home<CallbackMember3>;
 
-  static poolType cbPool;
-  friend class pool<CallbackMember3>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBM3");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackMember3>;
 
   Parameter1 p1;
   Parameter2 p2;
@@ -771,7 +803,7 @@ protected:
 
 public:
   static CallbackMember3* create(ClassType* i, Parameter1 a1, Parameter2 a2, Parameter3 a3, Time_t priority = 0) {
-    CallbackMember3* cb = cbPool.out();
+    CallbackMember3* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->instance = i;
@@ -805,23 +837,21 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class ClassType, class Parameter1, class Parameter2, class Parameter3,
-          void (ClassType::*memberPtr)(Parameter1, Parameter2, Parameter3)>
-typename CallbackMember3<ClassType, Parameter1, Parameter2, Parameter3, memberPtr>::poolType
-    CallbackMember3<ClassType, Parameter1, Parameter2, Parameter3, memberPtr>::cbPool(32, "CBM3");
-
 template <class ClassType, class Parameter1, class Parameter2, void (ClassType::*memberPtr)(Parameter1, Parameter2)>
 class CallbackMember2 : public CallbackBase {
 private:
-  using poolType = pool<CallbackMember2>;
+  using poolType = pool_home<CallbackMember2>;
 
-  static poolType cbPool;
-  friend class pool<CallbackMember2>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBM2");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackMember2>;
 
   Parameter1 p1;
   Parameter2 p2;
@@ -834,7 +864,7 @@ protected:
 
 public:
   static CallbackMember2* create(ClassType* i, Parameter1 a1, Parameter2 a2, Time_t priority = 0) {
-    CallbackMember2* cb = cbPool.out();
+    CallbackMember2* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->instance = i;
@@ -867,22 +897,21 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class ClassType, class Parameter1, class Parameter2, void (ClassType::*memberPtr)(Parameter1, Parameter2)>
-typename CallbackMember2<ClassType, Parameter1, Parameter2, memberPtr>::poolType
-    CallbackMember2<ClassType, Parameter1, Parameter2, memberPtr>::cbPool(32, "CBM2");
-
 template <class ClassType, class Parameter1, void (ClassType::*memberPtr)(Parameter1)>
 class CallbackMember1 : public CallbackBase {
 private:
-  using poolType = pool<CallbackMember1>;
+  using poolType = pool_home<CallbackMember1>;
 
-  static poolType cbPool;
-  friend class pool<CallbackMember1>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBM1");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackMember1>;
 
   Parameter1 p1;
 
@@ -894,7 +923,7 @@ protected:
 
 public:
   static CallbackMember1* create(ClassType* i, Parameter1 a1, Time_t priority = 0) {
-    CallbackMember1* cb = cbPool.out();
+    CallbackMember1* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->instance = i;
@@ -926,22 +955,21 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 
   void setParam1(Parameter1 a1) { p1 = a1; }
 };
 
-template <class ClassType, class Parameter1, void (ClassType::*memberPtr)(Parameter1)>
-typename CallbackMember1<ClassType, Parameter1, memberPtr>::poolType CallbackMember1<ClassType, Parameter1, memberPtr>::cbPool(
-    32, "CBM1");
-
 template <class ClassType, void (ClassType::*memberPtr)()>
 class CallbackMember0 : public CallbackBase {
 private:
-  using poolType = pool<CallbackMember0>;
+  using poolType = pool_home<CallbackMember0>;
 
-  static poolType cbPool;
-  friend class pool<CallbackMember0>;
+  static poolType& ref_pool() {
+    static thread_local auto* p = new poolType(32, "CBM0");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<CallbackMember0>;
 
   ClassType* instance;
 
@@ -951,7 +979,7 @@ protected:
 
 public:
   static CallbackMember0* create(ClassType* i, Time_t priority = 0) {
-    CallbackMember0* cb = cbPool.out();
+    CallbackMember0* cb = ref_pool().out();
     cb->resetPriority();
     cb->initPriority(priority);
     cb->instance = i;
@@ -982,12 +1010,9 @@ public:
     destroy();
   }
 
-  void destroy() { cbPool.in(this); }
+  void destroy() { ref_pool().in(this); }
 };
 
-template <class ClassType, void (ClassType::*memberPtr)()>
-typename CallbackMember0<ClassType, memberPtr>::poolType CallbackMember0<ClassType, memberPtr>::cbPool(32, "CBM0");
-
 // STATIC SECTION
 
 template <class ClassType, class Parameter1, class Parameter2, void (ClassType::*memberPtr)(Parameter1, Parameter2)>
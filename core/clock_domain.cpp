@@ -0,0 +1,105 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "clock_domain.hpp"
+
+#include "config.hpp"
+#include "fmt/format.h"
+
+thread_local Clock_domain* Clock_domain::current = nullptr;
+
+Clock_domain::Clock_domain(uint16_t _id, const std::string& _name)
+    : id(_id)
+    , name(_name)
+    , n_msgs(fmt::format("clock_domain({}):msgs", _name))
+    , n_late(fmt::format("clock_domain({}):late", _name))
+    , avg_skew(fmt::format("clock_domain({}):skew", _name)) {}
+
+bool Clock_domain::setup() {
+  I(domains.empty());
+
+  if (!Config::has_entry("soc", "parallel") || !Config::get_bool("soc", "parallel")) {
+    return false;
+  }
+
+  auto sync_str = Config::get_string("soc", "sync", {"conservative", "bounded"});
+  sync          = sync_str == "conservative" ? Sync::conservative : Sync::bounded;
+  quantum       = Config::get_integer("soc", "quantum", 1, 1 << 20);
+
+  if (sync == Sync::conservative) {
+    // lookahead is the minimum core to uncore latency. A quantum longer than
+    // that could deliver a message in the receiver past.
+    lookahead = Config::get_integer("soc", "lookahead", 1, 1 << 20);
+    if (quantum > lookahead) {
+      quantum = lookahead;
+    }
+  }
+
+  if (Config::has_entry("trace", "range")) {
+    auto t_start = Config::get_array_integer("trace", "range", 0);
+    auto t_end   = Config::get_array_integer("trace", "range", 1);
+    if (t_start < t_end) {
+      Config::add_error("[soc] parallel does not support [trace] range (the kanata trace is not thread safe)");
+      return false;
+    }
+  }
+
+  if (quantum <= 1) {
+    return false;  // Lockstep every cycle is the sequential engine, keep it bit-exact
+  }
+
+  parallel = true;
+  create("uncore");  // domain 0
+
+  return true;
+}
+
+void Clock_domain::unsetup() {
+  set_current(nullptr);
+  parallel = false;
+  domains.clear();
+}
+
+Clock_domain* Clock_domain::create(const std::string& dname) {
+  I(domains.size() < 65535);
+
+  domains.emplace_back(new Clock_domain(static_cast<uint16_t>(domains.size()), dname));
+
+  return domains.back().get();
+}
+
+void Clock_domain::set_current(Clock_domain* d) {
+  current = d;
+  EventScheduler::use_drain_ports(d ? &d->drain_ports : nullptr);
+}
+
+void Clock_domain::post(Time_t when, EventScheduler* cb) {
+  I(parallel);
+  I(this != current);
+
+  std::lock_guard<std::mutex> lock(mailbox_mutex);
+  mailbox.push_back({when, cb});
+}
+
+void Clock_domain::deliver() {
+  I(current == this);
+
+  {
+    std::lock_guard<std::mutex> lock(mailbox_mutex);
+    delivering.swap(mailbox);
+  }
+
+  for (const auto& m : delivering) {
+    n_msgs.inc();
+
+    auto when = m.when;
+    if (when <= globalClock) {
+      I(sync == Sync::bounded);  // conservative lookahead never lands in the past
+      n_late.inc();
+      avg_skew.sample(globalClock + 1 - when, true);
+      when = globalClock + 1;
+    }
+    EventScheduler::scheduleAbs(when, m.cb);
+  }
+
+  delivering.clear();
+}
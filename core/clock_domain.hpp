@@ -0,0 +1,130 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "callback.hpp"
+#include "iassert.hpp"
+#include "snippets.hpp"
+#include "stats.hpp"
+
+class PortGeneric;
+
+// A Clock_domain is the set of objects advanced by one host thread in the
+// parallel engine: one domain per core (core + private caches) and a single
+// uncore domain (shared caches, xbars, memory controllers).
+//
+// Each thread owns its cbQ, callback pools, and globalClock (thread_local), so
+// events only cross threads through post(). Posted events are parked in the
+// target mailbox and inserted in its cbQ at the next quantum boundary.
+//
+// Sync modes:
+//  conservative: quantum <= lookahead and every cross-domain hop costs at least
+//                lookahead cycles, so no message ever arrives in the past.
+//  bounded:      hops keep their latency and may arrive up to one quantum late;
+//                late messages run on the next cycle and are counted as skew.
+//
+// With parallel disabled (default) no domain exists and nothing changes.
+class Clock_domain {
+public:
+  enum class Sync { conservative, bounded };
+
+private:
+  struct Message {
+    Time_t          when;
+    EventScheduler* cb;
+  };
+
+  const uint16_t    id;
+  const std::string name;
+
+  std::mutex           mailbox_mutex;
+  std::vector<Message> mailbox;
+  std::vector<Message> delivering;  // Swap buffer, only touched by the owner thread
+
+  std::vector<PortGeneric*> drain_ports;
+
+  // Held by the uncore thread while it runs a cycle. Synchronous cross-domain
+  // calls (ffread, isBusy) take it so they never race with the owner.
+  std::recursive_mutex sync_mutex;
+
+  Stats_cntr n_msgs;
+  Stats_cntr n_late;
+  Stats_avg  avg_skew;
+
+  static inline bool   parallel  = false;
+  static inline Sync   sync      = Sync::bounded;
+  static inline Time_t quantum   = 1;
+  static inline Time_t lookahead = 1;
+
+  static inline std::vector<std::unique_ptr<Clock_domain>> domains;
+
+  static thread_local Clock_domain* current;
+
+  Clock_domain(uint16_t _id, const std::string& _name);
+
+public:
+  // Reads [soc] parallel/quantum/sync/lookahead. Returns true when the
+  // parallel engine should be used (quantum 1 falls back to the sequential one).
+  static bool setup();
+  static void unsetup();
+
+  static Clock_domain* create(const std::string& name);
+
+  static bool   is_parallel() { return parallel; }
+  static Time_t get_quantum() { return quantum; }
+  static size_t size() { return domains.size(); }
+
+  static Clock_domain* get_uncore() { return domains.empty() ? nullptr : domains[0].get(); }
+  static Clock_domain* get_current() { return current; }
+  static Clock_domain* ref(size_t i) {
+    I(i < domains.size());
+    return domains[i].get();
+  }
+
+  // Binds the calling thread (event queue, drain ports) to domain d
+  static void set_current(Clock_domain* d);
+
+  // Latency charged to a hop that leaves the current domain
+  static Time_t hop_latency(Time_t lat) { return (sync == Sync::conservative && lat < lookahead) ? lookahead : lat; }
+
+  [[nodiscard]] uint16_t           get_id() const { return id; }
+  [[nodiscard]] const std::string& get_name() const { return name; }
+
+  // Any thread: queue cb to run at cycle when in this domain
+  void post(Time_t when, EventScheduler* cb);
+
+  // Owner thread, at quantum boundary: move the mailbox into the local cbQ
+  void deliver();
+
+  [[nodiscard]] bool has_drain_ports() const { return !drain_ports.empty(); }
+
+  std::recursive_mutex& ref_sync_mutex() { return sync_mutex; }
+
+  // Serializes a synchronous call into domain d when it belongs to another thread
+  class Sync_guard {
+  private:
+    std::recursive_mutex* mtx;
+
+  public:
+    explicit Sync_guard(Clock_domain* d) : mtx(nullptr) {
+      if (likely(!parallel) || d == nullptr || d == current) {
+        return;
+      }
+      mtx = &d->sync_mutex;
+      mtx->lock();
+    }
+    ~Sync_guard() {
+      if (mtx) {
+        mtx->unlock();
+      }
+    }
+    Sync_guard(const Sync_guard&)            = delete;
+    Sync_guard& operator=(const Sync_guard&) = delete;
+  };
+};
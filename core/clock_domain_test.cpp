@@ -0,0 +1,150 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "clock_domain.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+
+static std::vector<Time_t> fired;
+
+static void record_fire(int tag) {
+  (void)tag;
+  fired.push_back(globalClock);
+}
+using record_fireCB = CallbackFunction1<int, &record_fire>;
+
+class Clock_domain_test : public ::testing::Test {
+protected:
+  void write_conf(const std::string& soc_body) {
+    std::ofstream file;
+    file.open("clock_domain_test.toml");
+    file << "[soc]\n";
+    file << soc_body;
+    file.close();
+
+    Config::init("clock_domain_test.toml");
+  }
+
+  void SetUp() override {
+    fired.clear();
+    globalClock = 0;
+    EventScheduler::reset();
+  }
+
+  void TearDown() override {
+    Clock_domain::unsetup();
+    while (!EventScheduler::empty()) {
+      EventScheduler::advanceClock();
+    }
+    EventScheduler::reset();
+  }
+};
+
+TEST_F(Clock_domain_test, disabled_by_default) {
+  write_conf("core = [\"c0\"]\n");
+
+  EXPECT_FALSE(Clock_domain::setup());
+  EXPECT_FALSE(Clock_domain::is_parallel());
+  EXPECT_EQ(Clock_domain::get_uncore(), nullptr);
+}
+
+TEST_F(Clock_domain_test, quantum1_is_sequential) {
+  write_conf("parallel = true\nsync = \"bounded\"\nquantum = 1\n");
+
+  EXPECT_FALSE(Clock_domain::setup());
+  EXPECT_FALSE(Clock_domain::is_parallel());
+}
+
+TEST_F(Clock_domain_test, conservative_caps_quantum) {
+  write_conf("parallel = true\nsync = \"conservative\"\nquantum = 64\nlookahead = 8\n");
+
+  EXPECT_TRUE(Clock_domain::setup());
+  EXPECT_EQ(Clock_domain::get_quantum(), 8);
+  EXPECT_EQ(Clock_domain::hop_latency(0), 8);
+  EXPECT_EQ(Clock_domain::hop_latency(20), 20);
+}
+
+TEST_F(Clock_domain_test, mailbox_delivery) {
+  write_conf("parallel = true\nsync = \"bounded\"\nquantum = 16\n");
+
+  ASSERT_TRUE(Clock_domain::setup());
+  auto* uncore = Clock_domain::get_uncore();
+  auto* core   = Clock_domain::create("core0");
+
+  std::thread worker([core, uncore]() {
+    Clock_domain::set_current(core);
+    for (int i = 0; i < 4; ++i) {
+      EventScheduler::advanceClock();
+    }
+    uncore->post(2, record_fireCB::create(0));   // already in the uncore past
+    uncore->post(40, record_fireCB::create(1));  // future
+    Clock_domain::set_current(nullptr);
+  });
+  worker.join();
+
+  Clock_domain::set_current(uncore);
+  for (int i = 0; i < 16; ++i) {
+    EventScheduler::advanceClock();
+  }
+  uncore->deliver();
+  for (int i = 0; i < 32; ++i) {
+    EventScheduler::advanceClock();
+  }
+
+  ASSERT_EQ(fired.size(), 2);
+  EXPECT_EQ(fired[0], 17);  // late message runs the cycle after delivery
+  EXPECT_EQ(fired[1], 40);
+}
+
+TEST_F(Clock_domain_test, posted_callback_returns_home) {
+  write_conf("parallel = true\nsync = \"bounded\"\nquantum = 16\n");
+
+  ASSERT_TRUE(Clock_domain::setup());
+  auto* uncore = Clock_domain::get_uncore();
+  auto* core   = Clock_domain::create("core0");
+
+  // The worker creates a full chunk of callbacks, the uncore runs (and frees)
+  // them. The next ones the worker creates must be the same objects.
+  constexpr int               n = 32;
+  std::vector<record_fireCB*> sent;
+  std::vector<record_fireCB*> again;
+  std::barrier                sync(2);
+  std::thread                 worker([&]() {
+    Clock_domain::set_current(core);
+    for (int i = 0; i < n; ++i) {
+      sent.push_back(record_fireCB::create(i));
+      uncore->post(10, sent.back());
+    }
+    sync.arrive_and_wait();  // posted
+    sync.arrive_and_wait();  // called by the uncore
+    for (int i = 0; i < n; ++i) {
+      again.push_back(record_fireCB::create(i));
+    }
+    Clock_domain::set_current(nullptr);
+  });
+
+  sync.arrive_and_wait();
+  Clock_domain::set_current(uncore);
+  uncore->deliver();
+  for (int i = 0; i < 16; ++i) {
+    EventScheduler::advanceClock();
+  }
+  EXPECT_EQ(fired.size(), n);
+  sync.arrive_and_wait();
+  worker.join();
+
+  std::sort(sent.begin(), sent.end());
+  std::sort(again.begin(), again.end());
+  EXPECT_EQ(sent, again);
+
+  for (auto* cb : again) {
+    cb->destroy();  // back home from this thread too
+  }
+}
@@ -0,0 +1,254 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "debug_log.hpp"
+
+#include <cstring>
+#include <mutex>
+
+#include "config.hpp"
+#include "fmt/args.h"
+#include "fmt/format.h"
+#include "iassert.hpp"
+
+static std::mutex debug_log_mutex;  // sites and the file, shared by the Clock_domain threads
+
+bool Debug_log::enable(std::string_view list) {
+  while (!list.empty()) {
+    auto pos  = list.find(',');
+    auto name = list.substr(0, pos);
+    list      = pos == std::string_view::npos ? std::string_view{} : list.substr(pos + 1);
+
+    if (name == "all") {
+      requested_mask = (1u << channel_names.size()) - 1;
+      continue;
+    }
+
+    size_t i = 0;
+    while (i < channel_names.size() && channel_names[i] != name) {
+      ++i;
+    }
+    if (i == channel_names.size()) {
+      return false;
+    }
+    requested_mask |= 1u << i;
+  }
+
+  return true;
+}
+
+bool Debug_log::open(const std::string& fname) {
+  close();
+
+  fp = fopen(fname.c_str(), "wb");
+  if (fp == nullptr) {
+    Config::add_error(fmt::format("unable to open debug log file {}", fname));
+    return false;
+  }
+  fwrite(&magic, sizeof(magic), 1, fp);
+
+  sites.clear();
+  buffer.data.clear();
+  buffer.last_clock = 0;
+  mask              = requested_mask;
+
+  return true;
+}
+
+uint32_t Debug_log::add_site(Channel c, std::string_view format, const std::string& types) {
+  std::lock_guard<std::mutex> lock(debug_log_mutex);
+
+  sites.emplace_back(Site{c, types, std::string(format)});
+  return sites.size() - 1;
+}
+
+// A chunk is the u32 byte size and the records of one thread buffer
+void Debug_log::flush(Buffer& b) {
+  if (b.data.empty()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(debug_log_mutex);
+    if (fp) {
+      uint32_t sz = b.data.size();
+      fwrite(&sz, sizeof(sz), 1, fp);
+      fwrite(b.data.data(), 1, sz, fp);
+    }
+  }
+
+  b.data.clear();
+  b.last_clock = 0;
+}
+
+void Debug_log::close() {
+  if (fp == nullptr) {
+    return;
+  }
+
+  // Other Clock_domain threads flushed when they exited
+  flush(buffer);
+  mask = 0;
+
+  std::lock_guard<std::mutex> lock(debug_log_mutex);
+
+  // Trailer: the sites, then the trailer offset
+  uint64_t offset = ftello(fp);
+
+  auto put_str = [](const std::string& str) {
+    uint16_t len = str.size();
+    fwrite(&len, sizeof(len), 1, fp);
+    fwrite(str.data(), 1, len, fp);
+  };
+
+  uint32_t n_sites = sites.size();
+  fwrite(&n_sites, sizeof(n_sites), 1, fp);
+  for (const auto& s : sites) {
+    fputc(static_cast<uint8_t>(s.chan), fp);
+    put_str(s.types);
+    put_str(s.format);
+  }
+
+  fwrite(&offset, sizeof(offset), 1, fp);
+  fclose(fp);
+  fp = nullptr;
+}
+
+bool Debug_log::convert(const std::string& bin_file, std::ostream& out) {
+  FILE* in = fopen(bin_file.c_str(), "rb");
+  if (in == nullptr) {
+    return false;
+  }
+  std::vector<uint8_t> buf;
+  uint8_t              chunk[65536];
+  size_t               n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+    buf.insert(buf.end(), chunk, chunk + n);
+  }
+  fclose(in);
+
+  auto get = [&buf](size_t pos, auto& v) {
+    if (pos + sizeof(v) > buf.size()) {
+      return false;
+    }
+    memcpy(&v, &buf[pos], sizeof(v));
+    return true;
+  };
+
+  uint64_t m      = 0;
+  uint64_t offset = 0;
+  if (!get(0, m) || m != magic || !get(buf.size() - sizeof(offset), offset)) {
+    return false;
+  }
+  if (offset < sizeof(magic) || offset > buf.size() - sizeof(offset)) {
+    return false;
+  }
+
+  size_t pos     = offset;
+  auto   get_str = [&](std::string& str) {
+    uint16_t len = 0;
+    if (!get(pos, len) || pos + sizeof(len) + len > buf.size()) {
+      return false;
+    }
+    str.assign(reinterpret_cast<const char*>(&buf[pos + sizeof(len)]), len);
+    pos += sizeof(len) + len;
+    return true;
+  };
+
+  uint32_t n_sites = 0;
+  if (!get(pos, n_sites)) {
+    return false;
+  }
+  pos += sizeof(n_sites);
+  std::vector<Site> file_sites(n_sites);
+  for (auto& s : file_sites) {
+    uint8_t c = 0;
+    if (!get(pos, c) || c >= channel_names.size()) {
+      return false;
+    }
+    pos += sizeof(c);
+    s.chan = static_cast<Channel>(c);
+    if (!get_str(s.types) || !get_str(s.format)) {
+      return false;
+    }
+  }
+
+  // Chunks, records as in write()
+  size_t end      = offset;
+  bool   bad      = false;
+  auto   get_byte = [&]() -> uint8_t {
+    if (pos >= end) {
+      bad = true;
+      return 0;
+    }
+    return buf[pos++];
+  };
+  auto get_varint = [&]() {
+    uint64_t v     = 0;
+    int      shift = 0;
+    uint8_t  b;
+    do {
+      b = get_byte();
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      shift += 7;
+    } while ((b & 0x80) && !bad && shift < 64);
+    return v;
+  };
+  auto unzigzag = [](uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); };
+
+  pos = sizeof(magic);
+  while (pos < offset) {
+    uint32_t sz = 0;
+    if (!get(pos, sz) || pos + sizeof(sz) + sz > offset) {
+      return false;
+    }
+    pos += sizeof(sz);
+    end = pos + sz;
+
+    Time_t clock = 0;
+    while (pos < end) {
+      auto site = get_varint();
+      clock += unzigzag(get_varint());
+      if (bad || site >= file_sites.size()) {
+        return false;
+      }
+      const auto& s = file_sites[site];
+
+      fmt::dynamic_format_arg_store<fmt::format_context> args;
+      for (auto code : s.types) {
+        if (code == 'u') {
+          args.push_back(get_varint());
+        } else if (code == 'i') {
+          args.push_back(unzigzag(get_varint()));
+        } else if (code == 'd') {
+          uint64_t bits = 0;
+          for (int i = 0; i < 8; ++i) {
+            bits |= static_cast<uint64_t>(get_byte()) << (8 * i);
+          }
+          args.push_back(std::bit_cast<double>(bits));
+        } else if (code == 's') {
+          auto len = get_varint();
+          if (bad || len > end - pos) {
+            return false;
+          }
+          args.push_back(std::string(reinterpret_cast<const char*>(&buf[pos]), len));
+          pos += len;
+        } else {
+          args.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(get_varint())));
+        }
+      }
+      if (bad) {
+        return false;
+      }
+
+      std::string txt;
+      try {
+        txt = fmt::vformat(s.format, args);
+      } catch (const fmt::format_error&) {
+        txt = s.format;  // bad format in the site, keep the text
+      }
+      out << clock << " " << channel_names[static_cast<uint8_t>(s.chan)] << ": " << txt << "\n";
+    }
+  }
+
+  return true;
+}
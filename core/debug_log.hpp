@@ -0,0 +1,161 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "snippets.hpp"
+
+// Named debug channels instead of commented printf:
+//
+//   DLOG(rob, "retire id={} rob={}", dinst->getID(), ROB.size());
+//
+// Channels are selected with "desesc -d rob,scb" or [debug] channels. A site
+// costs a load and a branch while its channel is off. With NDEBUG (bazel -c
+// opt) sites compile to nothing unless built with --config=dlog.
+//
+// Each record is the site, the cycle, and the raw arguments, appended to a per
+// thread buffer that is flushed as one chunk to debug_log.<ext>.bin. Format
+// strings are written as a trailer on close. convert() (and the
+// debug_log_conv tool) produces the text, in order within each thread.
+class Debug_log {
+public:
+  enum class Channel : uint8_t { fetch, rename, rob, scb, mshr, transient };
+  static constexpr std::array<std::string_view, 6> channel_names{"fetch", "rename", "rob", "scb", "mshr", "transient"};
+
+#if !defined(NDEBUG) || defined(DESESC_DEBUG_LOG)
+  static constexpr bool compiled = true;
+#else
+  static constexpr bool compiled = false;
+#endif
+
+  // Comma separated channel names, or "all". False if a name is unknown
+  static bool enable(std::string_view list);
+  static bool requested() { return requested_mask != 0; }
+
+  static bool open(const std::string& fname);
+  static void close();
+
+  static bool on(Channel c) { return compiled && ((mask >> static_cast<uint8_t>(c)) & 1); }
+
+  // One per DLOG site, the argument types are kept for the decoder
+  template <typename... Args>
+  struct Types {
+    static std::string get() { return std::string{type_code<Args>()...}; }
+  };
+  template <typename... Args>
+  static Types<Args...> types_of(const Args&...);
+
+  static uint32_t add_site(Channel c, std::string_view format, const std::string& types);
+
+  template <typename... Args>
+  static void write(uint32_t site, const Args&... args) {
+    auto& b = buffer;
+    put_varint(b.data, site);
+    put_varint(b.data, zigzag(globalClock - b.last_clock));
+    b.last_clock = globalClock;
+    (put_arg(b.data, args), ...);
+
+    if (b.data.size() >= flush_size) {
+      flush(b);
+    }
+  }
+
+  // Binary log to text, false if bin_file is not a debug log
+  static bool convert(const std::string& bin_file, std::ostream& out);
+
+private:
+  struct Site {
+    Channel     chan;
+    std::string types;
+    std::string format;
+  };
+
+  struct Buffer {
+    std::vector<uint8_t> data;
+    Time_t               last_clock;  // clocks are deltas within a chunk (zero initialized)
+    ~Buffer() { flush(*this); }
+  };
+
+  static constexpr uint64_t magic      = 0x314e4942474f4c44ULL;  // "DLOGBIN1"
+  static constexpr size_t   flush_size = 1 << 16;
+
+  template <typename T>
+  static constexpr char type_code() {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) {
+      return 'u';
+    } else if constexpr (std::is_enum_v<U>) {
+      return std::is_signed_v<std::underlying_type_t<U>> ? 'i' : 'u';
+    } else if constexpr (std::is_integral_v<U>) {
+      return std::is_signed_v<U> ? 'i' : 'u';
+    } else if constexpr (std::is_floating_point_v<U>) {
+      return 'd';
+    } else if constexpr (std::is_convertible_v<const U&, std::string_view>) {
+      return 's';
+    } else {
+      static_assert(std::is_pointer_v<U>, "DLOG arguments are numbers, strings, or pointers");
+      return 'p';
+    }
+  }
+
+  static uint64_t zigzag(uint64_t v) {
+    auto d = static_cast<int64_t>(v);
+    return (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+  }
+
+  static void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+      out.push_back(static_cast<uint8_t>(v) | 0x80);
+      v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+  }
+
+  template <typename T>
+  static void put_arg(std::vector<uint8_t>& out, const T& v) {
+    constexpr char code = type_code<T>();
+    if constexpr (code == 'u') {
+      put_varint(out, static_cast<uint64_t>(v));
+    } else if constexpr (code == 'i') {
+      put_varint(out, zigzag(static_cast<int64_t>(v)));
+    } else if constexpr (code == 'd') {
+      auto bits = std::bit_cast<uint64_t>(static_cast<double>(v));
+      for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+      }
+    } else if constexpr (code == 's') {
+      std::string_view str(v);
+      put_varint(out, str.size());
+      out.insert(out.end(), str.begin(), str.end());
+    } else {
+      put_varint(out, reinterpret_cast<uintptr_t>(v));
+    }
+  }
+
+  static void flush(Buffer& b);
+
+  static inline uint32_t requested_mask = 0;
+  static inline uint32_t mask           = 0;  // requested_mask while the file is open
+
+  static inline FILE*               fp = nullptr;
+  static inline std::vector<Site>   sites;
+  static inline thread_local Buffer buffer;
+};
+
+#define DLOG(chan, format, ...)                                                                                               \
+  do {                                                                                                                        \
+    if (Debug_log::on(Debug_log::Channel::chan)) {                                                                            \
+      static const uint32_t dlog_site                                                                                         \
+          = Debug_log::add_site(Debug_log::Channel::chan, format, decltype(Debug_log::types_of(__VA_ARGS__))::get());        \
+      Debug_log::write(dlog_site __VA_OPT__(, ) __VA_ARGS__);                                                                 \
+    }                                                                                                                         \
+  } while (0)
@@ -0,0 +1,29 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include <fstream>
+#include <iostream>
+
+#include "debug_log.hpp"
+#include "fmt/format.h"
+
+// Debug channel log to text: debug_log_conv debug_log.<ext>.bin [out.txt]
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    fmt::print(stderr, "usage: {} <debug_log.bin> [out.txt]\n", argv[0]);
+    return 1;
+  }
+
+  bool ok;
+  if (argc == 3) {
+    std::ofstream out(argv[2]);
+    ok = out && Debug_log::convert(argv[1], out);
+  } else {
+    ok = Debug_log::convert(argv[1], std::cout);
+  }
+
+  if (!ok) {
+    fmt::print(stderr, "{}: {} is not a valid debug log\n", argv[0], argv[1]);
+    return 1;
+  }
+  return 0;
+}
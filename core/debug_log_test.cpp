@@ -0,0 +1,98 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "debug_log.hpp"
+
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+class Debug_log_test : public ::testing::Test {
+protected:
+  std::string file_name;
+
+  void SetUp() override { file_name = fmt::format("debug_log_test_{}.bin", getpid()); }
+  void TearDown() override {
+    Debug_log::close();
+    unlink(file_name.c_str());
+  }
+};
+
+TEST_F(Debug_log_test, channels_and_arguments) {
+  EXPECT_FALSE(Debug_log::enable("rob,nope"));
+  ASSERT_TRUE(Debug_log::enable("rob,transient"));
+
+  DLOG(rob, "before open {}", 1);  // not recorded
+
+  ASSERT_TRUE(Debug_log::open(file_name));
+
+  globalClock = 100;
+  DLOG(rob, "retire id={} rob={}", uint64_t{42}, 7);
+  DLOG(fetch, "not enabled {}", 3);
+  globalClock = 90;  // clocks need not be monotonic
+  std::string why("mispredict");
+  DLOG(transient, "flush {} from {} ratio={:.2f} neg={}", why, "rob", 0.25, -5);
+  globalClock = 120;
+  DLOG(transient, "no arguments");
+  DLOG(rob, "bad {format", 1);
+
+  Debug_log::close();
+
+  std::ostringstream out;
+  ASSERT_TRUE(Debug_log::convert(file_name, out));
+  EXPECT_EQ(out.str(),
+            "100 rob: retire id=42 rob=7\n"
+            "90 transient: flush mispredict from rob ratio=0.25 neg=-5\n"
+            "120 transient: no arguments\n"
+            "120 rob: bad {format\n");
+}
+
+TEST_F(Debug_log_test, thread_chunks) {
+  ASSERT_TRUE(Debug_log::enable("mshr"));
+  ASSERT_TRUE(Debug_log::open(file_name));
+
+  // Several buffer flushes per thread, each thread keeps its own clock
+  auto work = [](Time_t base) {
+    for (int i = 0; i < 20000; ++i) {
+      globalClock = base + i;
+      DLOG(mshr, "miss {} line={}", i, base);
+    }
+  };
+  std::thread t0(work, 1000000);
+  std::thread t1(work, 5000000);
+  t0.join();
+  t1.join();
+
+  Debug_log::close();
+
+  std::ostringstream out;
+  ASSERT_TRUE(Debug_log::convert(file_name, out));
+
+  std::istringstream in(out.str());
+  std::string        line;
+  int                n[2] = {0, 0};
+  while (std::getline(in, line)) {
+    for (int t = 0; t < 2; ++t) {
+      Time_t base = t ? 5000000 : 1000000;
+      if (line == fmt::format("{} mshr: miss {} line={}", base + n[t], n[t], base)) {
+        n[t]++;
+      }
+    }
+  }
+  EXPECT_EQ(n[0], 20000);
+  EXPECT_EQ(n[1], 20000);
+}
+
+TEST_F(Debug_log_test, not_a_log) {
+  std::ostringstream out;
+  EXPECT_FALSE(Debug_log::convert("debug_log_test_missing.bin", out));
+
+  FILE* fp = fopen(file_name.c_str(), "wb");
+  fputs("DLOGBIN1 but not really", fp);
+  fclose(fp);
+  EXPECT_FALSE(Debug_log::convert(file_name, out));
+}
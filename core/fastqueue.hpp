@@ -18,6 +18,10 @@ private:
   uint32_t end;
   uint32_t nElems;
 
+  // Absolute positions, so a checkpoint survives wrap around and pops at the head
+  uint64_t head_pos;
+  uint64_t tail_pos;
+
 protected:
 public:
   explicit FastQueue(std::size_t size) {
@@ -36,6 +40,9 @@ public:
     start  = 0;
     end    = 0;
     nElems = 0;
+
+    head_pos = 0;
+    tail_pos = 0;
   }
 
   void push(Data d) {
@@ -45,6 +52,7 @@ public:
     I(end == ((start + nElems) & pipeMask));
     end = (end + 1) & pipeMask;
     nElems++;
+    tail_pos++;
   }
 
   void push_pipe_in_cluster(Data d) { pipe_in_cluster.push_back(d); }
@@ -81,12 +89,23 @@ public:
     nElems--;
     // printf("fastqueue::pop()::After nElems-- is %d\n", nElems);
     start = (start + 1) & pipeMask;
+    head_pos++;
   }
 
   void pop_from_back() {
     // I(nElems);
     nElems--;
     end = (end - 1) & pipeMask;
+    tail_pos--;
+  }
+
+  // Position of the next push. size_since() counts the entries still in the
+  // queue at or after that position: the youngest ones, without those popped
+  // from the head or from the back
+  [[nodiscard]] uint64_t checkpoint() const { return tail_pos; }
+  [[nodiscard]] uint32_t size_since(uint64_t ckpt) const {
+    uint64_t from = ckpt > head_pos ? ckpt : head_pos;
+    return tail_pos > from ? static_cast<uint32_t>(tail_pos - from) : 0;
   }
 
   [[nodiscard]] uint32_t getIDFromTop(uint32_t i) const {
@@ -0,0 +1,87 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "fastqueue.hpp"
+
+#include <deque>
+#include <random>
+
+#include "gtest/gtest.h"
+
+TEST(Fastqueue_test, size_since_checkpoint) {
+  FastQueue<int> q(8);
+
+  q.push(1);
+  q.push(2);
+  auto ckpt = q.checkpoint();
+  EXPECT_EQ(q.size_since(ckpt), 0);
+
+  q.push(3);
+  q.push(4);
+  q.push(5);
+  EXPECT_EQ(q.size_since(ckpt), 3);
+
+  q.pop_from_back();
+  EXPECT_EQ(q.size_since(ckpt), 2);
+  EXPECT_EQ(q.end_data(), 4);
+
+  // retire reaches the checkpointed entries
+  q.pop();
+  q.pop();
+  q.pop();
+  EXPECT_EQ(q.size_since(ckpt), 1);
+  EXPECT_EQ(q.top(), 4);
+
+  // squashed past the checkpoint
+  q.pop_from_back();
+  EXPECT_EQ(q.size_since(ckpt), 0);
+  q.push(6);
+  EXPECT_EQ(q.size_since(ckpt), 1);
+}
+
+// Random push, pop and pop_from_back across many wrap arounds, against a deque
+TEST(Fastqueue_test, checkpoint_wraps) {
+  FastQueue<int>  q(16);
+  std::deque<int> ref;
+  std::mt19937    rnd(7);
+
+  int  next   = 0;
+  auto ckpt   = q.checkpoint();
+  int  n_ckpt = 0;  // elements pushed since ckpt still in ref
+  int  below  = 0;  // popped from the back past ckpt, the next pushes refill those positions
+
+  for (int step = 0; step < 100000; ++step) {
+    auto r = rnd() % 8;
+    if (r < 4 && ref.size() < 16) {
+      q.push(next);
+      ref.push_back(next);
+      ++next;
+      if (below > 0) {
+        --below;
+      } else {
+        ++n_ckpt;
+      }
+    } else if (r < 6 && !ref.empty()) {
+      EXPECT_EQ(q.top(), ref.front());
+      q.pop();
+      ref.pop_front();
+      if (n_ckpt > static_cast<int>(ref.size())) {
+        n_ckpt = ref.size();
+      }
+    } else if (r < 7 && !ref.empty()) {
+      EXPECT_EQ(q.end_data(), ref.back());
+      q.pop_from_back();
+      ref.pop_back();
+      if (n_ckpt > 0) {
+        --n_ckpt;
+      } else {
+        ++below;
+      }
+    } else {
+      ckpt   = q.checkpoint();
+      n_ckpt = 0;
+      below  = 0;
+    }
+    ASSERT_EQ(q.size(), ref.size());
+    ASSERT_EQ(q.size_since(ckpt), n_ckpt) << "step " << step;
+  }
+}
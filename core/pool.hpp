@@ -4,7 +4,9 @@
 
 #include <pthread.h>
 
+#include <atomic>
 #include <cstring>
+#include <vector>
 
 #include "fmt/format.h"
 #include "iassert.hpp"
@@ -647,3 +649,118 @@ public:
 };
 
 //*********************************************
+
+// Like pool, but objects come from contiguous chunks and always go back to
+// the pool (thread) that created them. Each thread uses its own pool_home.
+// A free from the owner thread is a push on a local list. A free from
+// another thread (a request or callback finished by another Clock_domain) is
+// a lock free push on the owner remote list, taken in one exchange when the
+// local list runs out. With pool, those objects would move to the freeing thread, and
+// the creating thread would keep allocating new ones.
+template <class Ttype>
+class pool_home {
+protected:
+  class Holder : public Ttype {
+  public:
+    Holder*    holderNext;
+    pool_home* home;
+#ifndef NDEBUG
+    bool inPool;
+#endif
+  };
+
+  const int32_t Size;  // Holders per chunk
+  const char*   Name;
+
+  Holder*              first;   // owner thread only
+  std::atomic<Holder*> remote;  // freed by other threads
+  std::vector<Holder*> chunks;
+
+#ifndef NDEBUG
+  pthread_t thid;
+#endif
+
+  void reproduce() {
+    I(first == nullptr);
+
+    auto* c = new Holder[Size];
+    chunks.push_back(c);
+    for (int32_t i = Size - 1; i >= 0; --i) {
+      c[i].home       = this;
+      c[i].holderNext = first;
+#ifndef NDEBUG
+      c[i].inPool = true;
+#endif
+      first = &c[i];
+    }
+  }
+
+public:
+  pool_home(int32_t s = 256, const char* n = "pool_home name not declared") : Size(s), Name(n), first(nullptr), remote(nullptr) {
+    I(Size > 0);
+#ifndef NDEBUG
+    thid = pthread_self();
+#endif
+    reproduce();
+  }
+
+  ~pool_home() {
+    // Like pool, objects remain for the lifetime of the program. Other
+    // threads may still return them, so a pool_home is not deleted either.
+  }
+
+  Ttype* out() {
+    I(thid == pthread_self());
+    if (first == nullptr) {
+      first = remote.exchange(nullptr, std::memory_order_acquire);
+      if (first == nullptr) {
+        reproduce();
+      }
+    }
+
+    Holder* h = first;
+    first     = h->holderNext;
+#ifndef NDEBUG
+    I(h->inPool);
+    h->inPool = false;
+#endif
+    return h;
+  }
+
+  // Called on the pool of the freeing thread
+  void in(Ttype* data) {
+    I(thid == pthread_self());
+    Holder* h = static_cast<Holder*>(data);
+#ifndef NDEBUG
+    I(!h->inPool);
+    h->inPool = true;
+#endif
+
+    if (h->home == this) {
+      h->holderNext = first;
+      first         = h;
+      return;
+    }
+
+    auto* r    = &h->home->remote;
+    auto* head = r->load(std::memory_order_relaxed);
+    do {
+      h->holderNext = head;
+    } while (!r->compare_exchange_weak(head, h, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  [[nodiscard]] size_t capacity() const { return chunks.size() * Size; }
+
+#ifndef NDEBUG
+  template <typename F>
+  void for_each_in_use(F&& fn) {
+    for (auto* c : chunks) {
+      for (int32_t i = 0; i < Size; ++i) {
+        if (!c[i].inPool) {
+          fn(static_cast<Ttype*>(&c[i]));
+        }
+      }
+    }
+  }
+#endif
+};
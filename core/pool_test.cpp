@@ -0,0 +1,76 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "pool.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class Pool_obj {
+public:
+  int64_t val = 0;
+};
+
+TEST(Pool_test, home_reuses_local) {
+  pool_home<Pool_obj> p(16);
+
+  std::vector<Pool_obj*> v;
+  for (int i = 0; i < 16; ++i) {
+    v.push_back(p.out());
+  }
+  EXPECT_EQ(p.capacity(), 16);
+
+  auto* last = v.back();
+  for (auto* o : v) {
+    p.in(o);
+  }
+  EXPECT_EQ(p.out(), last);  // LIFO, still warm in the cache
+  EXPECT_EQ(p.capacity(), 16);
+}
+
+// Objects created by one thread and freed by another go back to the
+// creator, so its pool does not keep growing
+TEST(Pool_test, home_remote_free) {
+  pool_home<Pool_obj> prod(64);
+
+  constexpr int          n_rounds = 500;
+  constexpr int          n_batch  = 48;
+  std::atomic<int>       handed{0};
+  std::atomic<int>       freed{0};
+  std::vector<Pool_obj*> batch(n_batch);
+
+  std::thread consumer([&] {
+    pool_home<Pool_obj> local(64);
+    int                 seen = 0;
+    while (seen < n_rounds) {
+      if (handed.load(std::memory_order_acquire) > seen) {
+        for (auto* o : batch) {
+          EXPECT_EQ(o->val, seen);
+          local.in(o);
+        }
+        ++seen;
+        freed.store(seen, std::memory_order_release);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    EXPECT_EQ(local.capacity(), 64);  // never allocated, only returned objects
+  });
+
+  for (int r = 0; r < n_rounds; ++r) {
+    for (auto& o : batch) {
+      o      = prod.out();
+      o->val = r;
+    }
+    handed.store(r + 1, std::memory_order_release);
+    while (freed.load(std::memory_order_acquire) <= r) {
+      std::this_thread::yield();
+    }
+  }
+  consumer.join();
+
+  // 48 in flight, a single chunk is enough
+  EXPECT_EQ(prod.capacity(), 64);
+}
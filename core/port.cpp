@@ -2,11 +2,58 @@
 
 #include "port.hpp"
 
+#include <algorithm>
 #include <utility>
 
 #include "callback.hpp"
 #include "fmt/format.h"
 
+thread_local PortRequestFunction::poolType PortRequestFunction::prPool(32, "PRF");
+
+PortRequestFunction* PortRequestFunction::create(std::function<void(Time_t)> f) {
+  PortRequestFunction* pr = prPool.out();
+  pr->func                = std::move(f);
+
+  return pr;
+}
+
+void PortRequestFunction::grant(Time_t when) {
+  auto f = std::move(func);
+  prPool.in(this);
+  f(when);
+}
+
+void PortRequestFunction::discard() {
+  func = nullptr;
+  prPool.in(this);
+}
+
+// Heap helpers shared by the priority-managed ports. The vector keeps its
+// capacity, so steady state scheduling and draining never allocate.
+static void push_request(std::vector<PendingRequest>& queue, const PendingRequest& req) {
+  queue.push_back(req);
+  std::push_heap(queue.begin(), queue.end());
+}
+
+static PendingRequest pop_request(std::vector<PendingRequest>& queue) {
+  std::pop_heap(queue.begin(), queue.end());
+  auto req = queue.back();
+  queue.pop_back();
+  return req;
+}
+
+static void drop_transient(std::vector<PendingRequest>& queue) {
+  auto n = std::erase_if(queue, [](const PendingRequest& req) {
+    if (req.transient) {
+      req.callback->discard();
+    }
+    return req.transient;
+  });
+  if (n) {
+    std::make_heap(queue.begin(), queue.end());
+  }
+}
+
 PortGeneric::PortGeneric(const std::string& name) : avgTime(name) {}
 
 std::shared_ptr<PortGeneric> PortGeneric::create(const std::string& unitName, NumUnits_t nUnits, bool priority_managed) {
@@ -107,32 +154,18 @@ bool PortUnlimitedPriority::is_busy_for(TimeDelta_t clk) const {
   return false;
 }
 
-void PortUnlimitedPriority::schedule(bool en, Time_t priority, bool transient, std::function<void(Time_t)> cb) {
-  queue.push(PendingRequest{priority, std::move(cb), en, transient});
+void PortUnlimitedPriority::schedule(bool en, Time_t priority, bool transient, PortRequest* cb) {
+  push_request(queue, PendingRequest{priority, cb, en, transient});
 }
 
-void PortUnlimitedPriority::flush_transient() {
-  if (queue.empty()) {
-    return;
-  }
-  // Rebuild queue without transient entries.
-  std::priority_queue<PendingRequest> kept;
-  while (!queue.empty()) {
-    if (!queue.top().transient) {
-      kept.push(queue.top());
-    }
-    queue.pop();
-  }
-  queue = std::move(kept);
-}
+void PortUnlimitedPriority::flush_transient() { drop_transient(queue); }
 
 void PortUnlimitedPriority::drain_pending() {
   // Unlimited capacity: every request fires at the current cycle.
   while (!queue.empty()) {
-    auto req = queue.top();
-    queue.pop();
+    auto req = pop_request(queue);
     avgTime.sample(0, req.enable_stats);
-    req.callback(globalClock);
+    req.callback->grant(globalClock);
   }
 }
 
@@ -159,33 +192,22 @@ bool PortPipePriority::is_busy_for(TimeDelta_t /*clk*/) const {
   return false;
 }
 
-void PortPipePriority::schedule(bool en, Time_t priority, bool transient, std::function<void(Time_t)> cb) {
-  queue.push(PendingRequest{priority, std::move(cb), en, transient});
+void PortPipePriority::schedule(bool en, Time_t priority, bool transient, PortRequest* cb) {
+  push_request(queue, PendingRequest{priority, cb, en, transient});
 }
 
 void PortPipePriority::flush_transient() {
-  if (queue.empty()) {
-    return;
-  }
-  // Filter out transient entries.  Already-granted transients have already fired and
+  // Drop transient entries in place.  Already-granted transients have already fired and
   // consumed their cycle; nothing to undo because no future cycles were committed.
-  std::priority_queue<PendingRequest> kept;
-  while (!queue.empty()) {
-    if (!queue.top().transient) {
-      kept.push(queue.top());
-    }
-    queue.pop();
-  }
-  queue = std::move(kept);
+  drop_transient(queue);
 }
 
 void PortPipePriority::drain_pending() {
   align_cycle();
   while (!queue.empty() && granted_this_cycle < nUnits) {
-    auto req = queue.top();
-    queue.pop();
+    auto req = pop_request(queue);
     avgTime.sample(0, req.enable_stats);
-    req.callback(globalClock);
+    req.callback->grant(globalClock);
     ++granted_this_cycle;
   }
 }
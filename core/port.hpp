@@ -3,20 +3,93 @@
 #pragma once
 
 #include <functional>
-#include <queue>
+#include <vector>
 
 #include "iassert.hpp"
+#include "pool.hpp"
 #include "snippets.hpp"
 #include "stats.hpp"
 
 using NumUnits_t = uint16_t;
 
+// Grant callback for priority-managed ports. Requests come from a per-type
+// thread_local pool (like CallbackMember) and go back to it when the port
+// either grants them (grant fires the member) or drops them on a transient
+// flush (discard). Scheduling a request does not allocate.
+class PortRequest {
+public:
+  virtual ~PortRequest() = default;
+
+  virtual void grant(Time_t when) = 0;
+  virtual void discard()          = 0;
+};
+
+template <class ClassType, class Parameter1, void (ClassType::*memberPtr)(Time_t, Parameter1)>
+class PortRequestMember1 : public PortRequest {
+private:
+  using poolType = pool<PortRequestMember1>;
+
+  static thread_local poolType prPool;
+  friend class pool<PortRequestMember1>;
+
+  ClassType* instance;
+  Parameter1 p1;
+
+protected:
+  PortRequestMember1() {}
+
+public:
+  static PortRequestMember1* create(ClassType* i, Parameter1 a1) {
+    PortRequestMember1* pr = prPool.out();
+    pr->instance           = i;
+    pr->p1                 = a1;
+
+    return pr;
+  }
+
+  void grant(Time_t when) override {
+    // Recycle first: the member may schedule again on the same port
+    ClassType* i  = instance;
+    Parameter1 a1 = p1;
+    prPool.in(this);
+    (i->*memberPtr)(when, a1);
+  }
+
+  void discard() override { prPool.in(this); }
+};
+
+template <class ClassType, class Parameter1, void (ClassType::*memberPtr)(Time_t, Parameter1)>
+thread_local typename PortRequestMember1<ClassType, Parameter1, memberPtr>::poolType
+    PortRequestMember1<ClassType, Parameter1, memberPtr>::prPool(32, "PRM1");
+
+// Adapter for std::function callers (tests, one-off users). The holder is
+// pooled, but the std::function itself may still allocate for large captures.
+class PortRequestFunction : public PortRequest {
+private:
+  using poolType = pool<PortRequestFunction>;
+
+  static thread_local poolType prPool;
+  friend class pool<PortRequestFunction>;
+
+  std::function<void(Time_t)> func;
+
+protected:
+  PortRequestFunction() {}
+
+public:
+  static PortRequestFunction* create(std::function<void(Time_t)> f);
+
+  void grant(Time_t when) override;
+  void discard() override;
+};
+
 // Request placed on a priority-managed port. Lower priority value wins (older dinst ID).
+// Trivially copyable so the heap can live in a retained vector.
 struct PendingRequest {
-  Time_t                      priority;
-  std::function<void(Time_t)> callback;
-  bool                        enable_stats;
-  bool                        transient;
+  Time_t       priority;
+  PortRequest* callback;
+  bool         enable_stats;
+  bool         transient;
 
   bool operator<(const PendingRequest& other) const {
     return priority > other.priority;  // lowest priority value at top of heap
@@ -56,13 +129,17 @@ public:
 
   // Priority-managed API ---------------------------------------------------
   // Default implementations reject the call; priority-managed subclasses override.
-  virtual void schedule(bool en, Time_t priority, bool transient, std::function<void(Time_t)> cb) {
+  // The port owns cb until it is granted or flushed.
+  virtual void schedule(bool en, Time_t priority, bool transient, PortRequest* cb) {
     (void)en;
     (void)priority;
     (void)transient;
     (void)cb;
     I(0);  // Not a priority-managed port
   }
+  void schedule(bool en, Time_t priority, bool transient, std::function<void(Time_t)> cb) {
+    schedule(en, priority, transient, PortRequestFunction::create(std::move(cb)));
+  }
   virtual void flush_transient() {}    // no-op for simple ports
   virtual void drain_pending() {}      // no-op for simple ports; called each cycle
   [[nodiscard]] virtual bool has_pending() const { return false; }
@@ -111,14 +188,16 @@ public:
 // Unlimited capacity with age-ordered drain at end-of-cycle.
 // Every drained grant fires with when == globalClock.
 class PortUnlimitedPriority : public PortGeneric {
-  std::priority_queue<PendingRequest> queue;
+  std::vector<PendingRequest> queue;  // binary heap, capacity kept across cycles
 
 public:
   explicit PortUnlimitedPriority(const std::string& name);
 
+  using PortGeneric::schedule;
+
   Time_t             nextSlot(bool en) override;
   [[nodiscard]] bool is_busy_for(TimeDelta_t clk) const override;
-  void               schedule(bool en, Time_t priority, bool transient, std::function<void(Time_t)> cb) override;
+  void               schedule(bool en, Time_t priority, bool transient, PortRequest* cb) override;
   void               flush_transient() override;
   void               drain_pending() override;
   [[nodiscard]] bool has_pending() const override { return !queue.empty(); }
@@ -130,8 +209,8 @@ public:
 // with higher priority can still beat an older-cycle waiter, matching the "age-fair
 // across cycle boundaries" behavior of a real scheduler.
 class PortPipePriority : public PortGeneric {
-  const NumUnits_t                    nUnits;
-  std::priority_queue<PendingRequest> queue;
+  const NumUnits_t            nUnits;
+  std::vector<PendingRequest> queue;  // binary heap, capacity kept across cycles
 
   // Counter resets each new cycle.  granted_cycle tracks the cycle it's valid for.
   NumUnits_t granted_this_cycle = 0;
@@ -142,9 +221,11 @@ class PortPipePriority : public PortGeneric {
 public:
   PortPipePriority(const std::string& name, NumUnits_t n);
 
+  using PortGeneric::schedule;
+
   Time_t             nextSlot(bool en) override;
   [[nodiscard]] bool is_busy_for(TimeDelta_t clk) const override;
-  void               schedule(bool en, Time_t priority, bool transient, std::function<void(Time_t)> cb) override;
+  void               schedule(bool en, Time_t priority, bool transient, PortRequest* cb) override;
   void               flush_transient() override;
   void               drain_pending() override;
   [[nodiscard]] bool has_pending() const override;
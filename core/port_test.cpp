@@ -18,6 +18,14 @@ protected:
   void TearDown() override { EventScheduler::reset(); }
 };
 
+class Port_user {
+public:
+  std::vector<std::pair<int, Time_t>> granted;  // (tag, when)
+
+  void do_grant(Time_t when, int tag) { granted.push_back({tag, when}); }
+  using do_grantPR = PortRequestMember1<Port_user, int, &Port_user::do_grant>;
+};
+
 // --- Simple (non-priority) ports ---------------------------------------------
 
 TEST_F(Port_test, unlimited_always_available) {
@@ -276,3 +284,29 @@ TEST_F(Port_test, flush_transient_noop_on_simple_port) {
   port->flush_transient();
   EXPECT_EQ(port->nextSlot(true), 1ULL);
 }
+
+TEST_F(Port_test, pooled_requests_grant_and_flush) {
+  auto      port = PortGeneric::create("test_prio_pooled", 1, /*priority_managed=*/true);
+  Port_user user;
+
+  // Enough rounds to recycle every pooled request several times.
+  for (int round = 0; round < 100; ++round) {
+    port->schedule(true, 30, false, Port_user::do_grantPR::create(&user, 3));
+    port->schedule(true, 10, true, Port_user::do_grantPR::create(&user, 1));
+    port->schedule(true, 20, false, Port_user::do_grantPR::create(&user, 2));
+    port->schedule(true, 15, true, Port_user::do_grantPR::create(&user, 4));
+
+    port->flush_transient();
+
+    auto start = user.granted.size();
+    tick_one_cycle();
+    tick_one_cycle();
+    EXPECT_FALSE(port->has_pending());
+
+    ASSERT_EQ(user.granted.size(), start + 2);
+    EXPECT_EQ(user.granted[start].first, 2);
+    EXPECT_EQ(user.granted[start].second, globalClock - 1);
+    EXPECT_EQ(user.granted[start + 1].first, 3);
+    EXPECT_EQ(user.granted[start + 1].second, globalClock);
+  }
+}
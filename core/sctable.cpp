@@ -107,3 +107,10 @@ void SCTable::update(uint32_t cid, bool taken) {
     }
   }
 }
+
+void SCTable::snapshot(Snapshot_io& ar, const std::string& name) {
+  if (!ar.section(name, ((sizeMask + 1) << 8) | MaxValue)) {
+    return;
+  }
+  ar.io_bytes(table, sizeMask + 1);
+}
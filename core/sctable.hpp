@@ -8,6 +8,7 @@
 #include <string>
 
 #include "iassert.hpp"
+#include "snapshot.hpp"
 #include "snippets.hpp"
 
 class SCTable {
@@ -33,4 +34,6 @@ public:
   bool    isLowest(uint32_t cid) const { return table[cid & sizeMask] == 0; }
   bool    isHighest(uint32_t cid) const { return table[cid & sizeMask] == MaxValue; }
   uint8_t getValue(uint32_t cid) const { return table[cid & sizeMask]; }
+
+  void snapshot(Snapshot_io& ar, const std::string& name);
 };
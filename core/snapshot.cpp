@@ -0,0 +1,183 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "snapshot.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "config.hpp"
+#include "fmt/format.h"
+
+// File layout (little endian, native widths):
+//   header:    magic, n_sections, dir_offset (3 x uint64_t), padded to 64 bytes
+//   data:      section payloads
+//   directory: n_sections x {uint32_t name_len, name, key, offset, size}
+static constexpr uint64_t snapshot_magic  = 0x31305041'4e534544ULL;  // "DESNAP01"
+static constexpr size_t   snapshot_header = 64;
+
+Snapshot_io::Snapshot_io(bool _saving, const std::string& _file_name) : saving(_saving), file_name(_file_name) {}
+
+Snapshot_io::~Snapshot_io() {
+  if (saving) {
+    close();
+  } else if (map_base) {
+    munmap(const_cast<uint8_t*>(map_base), map_size);
+  }
+}
+
+std::unique_ptr<Snapshot_io> Snapshot_io::create(const std::string& file_name) {
+  std::unique_ptr<Snapshot_io> ar(new Snapshot_io(true, file_name));
+  ar->data.resize(snapshot_header, 0);
+  return ar;
+}
+
+std::unique_ptr<Snapshot_io> Snapshot_io::open(const std::string& file_name) {
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    Config::add_error(fmt::format("snapshot {} could not be opened", file_name));
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < snapshot_header) {
+    ::close(fd);
+    Config::add_error(fmt::format("snapshot {} is not a valid snapshot", file_name));
+    return nullptr;
+  }
+
+  auto  sz  = static_cast<size_t>(st.st_size);
+  void* ptr = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    Config::add_error(fmt::format("snapshot {} could not be mapped", file_name));
+    return nullptr;
+  }
+
+  std::unique_ptr<Snapshot_io> ar(new Snapshot_io(false, file_name));
+  ar->map_base = static_cast<const uint8_t*>(ptr);
+  ar->map_size = sz;
+
+  uint64_t hdr[3];
+  std::memcpy(hdr, ar->map_base, sizeof(hdr));
+  if (hdr[0] != snapshot_magic || hdr[2] > sz) {
+    Config::add_error(fmt::format("snapshot {} has a bad header", file_name));
+    return nullptr;
+  }
+
+  const uint8_t* p   = ar->map_base + hdr[2];
+  const uint8_t* end = ar->map_base + sz;
+  for (uint64_t i = 0; i < hdr[1]; ++i) {
+    uint32_t len;
+    if (p + sizeof(len) > end) {
+      break;
+    }
+    std::memcpy(&len, p, sizeof(len));
+    p += sizeof(len);
+
+    Entry e;
+    if (p + len + sizeof(e) > end) {
+      break;
+    }
+    std::string name(reinterpret_cast<const char*>(p), len);
+    p += len;
+    std::memcpy(&e, p, sizeof(e));
+    p += sizeof(e);
+
+    if (e.offset + e.size > hdr[2]) {
+      break;
+    }
+    ar->dir[name] = e;
+  }
+
+  if (ar->dir.size() != hdr[1]) {
+    Config::add_error(fmt::format("snapshot {} has a corrupted directory", file_name));
+    return nullptr;
+  }
+
+  return ar;
+}
+
+bool Snapshot_io::section(const std::string& name, uint64_t key) {
+  if (saving) {
+    if (in_section) {
+      dir[dir_order.back()].size = data.size() - dir[dir_order.back()].offset;
+    }
+    in_section = !dir.contains(name);  // Shared objects (SMT predictors) are saved once
+    if (in_section) {
+      dir[name] = Entry{key, data.size(), 0};
+      dir_order.emplace_back(name);
+    }
+    return in_section;
+  }
+
+  auto it    = dir.find(name);
+  in_section = it != dir.end() && it->second.key == key;
+  if (!in_section) {
+    n_skipped++;
+    return false;
+  }
+
+  n_restored++;
+  cursor     = map_base + it->second.offset;
+  cursor_end = cursor + it->second.size;
+  return true;
+}
+
+void Snapshot_io::bytes(void* ptr, size_t sz) {
+  if (!in_section) {
+    return;
+  }
+
+  if (saving) {
+    auto* src = static_cast<const uint8_t*>(ptr);
+    data.insert(data.end(), src, src + sz);
+    return;
+  }
+
+  if (cursor + sz > cursor_end) {
+    Config::add_error(fmt::format("snapshot {} has a truncated section", file_name));
+    in_section = false;
+    return;
+  }
+  std::memcpy(ptr, cursor, sz);
+  cursor += sz;
+}
+
+bool Snapshot_io::close() {
+  if (!saving || data.empty()) {
+    return true;
+  }
+
+  if (in_section) {
+    dir[dir_order.back()].size = data.size() - dir[dir_order.back()].offset;
+    in_section                 = false;
+  }
+
+  uint64_t hdr[3] = {snapshot_magic, dir_order.size(), data.size()};
+  std::memcpy(data.data(), hdr, sizeof(hdr));
+
+  for (const auto& name : dir_order) {
+    auto len = static_cast<uint32_t>(name.size());
+    auto e   = dir[name];
+    data.insert(data.end(), reinterpret_cast<const uint8_t*>(&len), reinterpret_cast<const uint8_t*>(&len) + sizeof(len));
+    data.insert(data.end(), name.begin(), name.end());
+    data.insert(data.end(), reinterpret_cast<const uint8_t*>(&e), reinterpret_cast<const uint8_t*>(&e) + sizeof(e));
+  }
+
+  auto* fp = fopen(file_name.c_str(), "wb");
+  bool  ok = fp && fwrite(data.data(), 1, data.size(), fp) == data.size();
+  if (fp) {
+    ok = fclose(fp) == 0 && ok;
+  }
+  data.clear();
+
+  if (!ok) {
+    Config::add_error(fmt::format("snapshot {} could not be written", file_name));
+  }
+  return ok;
+}
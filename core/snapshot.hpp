@@ -0,0 +1,97 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "iassert.hpp"
+
+// Binary snapshot of the timing state (cache tags, predictor tables, ...).
+//
+// The same object saves and restores, so each structure writes one snapshot()
+// method that calls io() on its fields in a fixed order:
+//
+//   if (!ar.section(name, key)) return;
+//   ar.io(table);
+//   ar.io(ghr);
+//
+// Sections are named (name must be unique) and carry a key with the geometry
+// of the owner (sizes, ways). A restore only reads a section whose key matches,
+// so a parameter sweep that changes one cache keeps everything else warm and
+// leaves that cache cold.
+//
+// The file is mmap-ed on restore and fields are copied out in place, so a
+// restore is a few memcpy per structure.
+class Snapshot_io {
+private:
+  struct Entry {
+    uint64_t key;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  const bool        saving;
+  const std::string file_name;
+
+  absl::flat_hash_map<std::string, Entry> dir;
+  std::vector<std::string>                dir_order;  // save order, written to the file directory
+
+  // Save side
+  std::vector<uint8_t> data;
+
+  // Restore side
+  const uint8_t* map_base{nullptr};
+  size_t         map_size{0};
+  const uint8_t* cursor{nullptr};
+  const uint8_t* cursor_end{nullptr};
+
+  bool     in_section{false};
+  uint64_t n_restored{0};
+  uint64_t n_skipped{0};
+
+  Snapshot_io(bool _saving, const std::string& _file_name);
+
+  void bytes(void* ptr, size_t sz);
+
+public:
+  ~Snapshot_io();
+
+  Snapshot_io(const Snapshot_io&)            = delete;
+  Snapshot_io& operator=(const Snapshot_io&) = delete;
+
+  // nullptr (and a Config error) when the file can not be used
+  static std::unique_ptr<Snapshot_io> create(const std::string& file_name);
+  static std::unique_ptr<Snapshot_io> open(const std::string& file_name);
+
+  [[nodiscard]] bool is_saving() const { return saving; }
+
+  // Starts a section. Returns false when the caller should skip its fields:
+  // a duplicated name on save, a missing section or a key mismatch on restore.
+  bool section(const std::string& name, uint64_t key);
+
+  template <class T>
+  void io(T& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    bytes(&v, sizeof(T));
+  }
+
+  // The vector must already have its final size on restore (set by the constructor)
+  template <class T>
+  void io(std::vector<T>& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    bytes(v.data(), v.size() * sizeof(T));
+  }
+
+  void io_bytes(void* ptr, size_t sz) { bytes(ptr, sz); }
+
+  // Save: writes the file. Returns false (and adds a Config error) on failure.
+  bool close();
+
+  [[nodiscard]] uint64_t get_n_restored() const { return n_restored; }
+  [[nodiscard]] uint64_t get_n_skipped() const { return n_skipped; }
+};
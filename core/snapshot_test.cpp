@@ -0,0 +1,125 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "snapshot.hpp"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cachecore.hpp"
+#include "config.hpp"
+#include "gtest/gtest.h"
+#include "sctable.hpp"
+
+class Snapshot_test : public ::testing::Test {
+protected:
+  std::string file_name;
+
+  void SetUp() override { file_name = fmt::format("snapshot_test_{}.snap", getpid()); }
+  void TearDown() override { unlink(file_name.c_str()); }
+};
+
+TEST_F(Snapshot_test, round_trip) {
+  {
+    auto ar = Snapshot_io::create(file_name);
+    ASSERT_NE(ar, nullptr);
+    EXPECT_TRUE(ar->is_saving());
+
+    uint64_t             a = 0x1234;
+    std::vector<int16_t> v = {1, -2, 3, -4};
+    EXPECT_TRUE(ar->section("a", 7));
+    ar->io(a);
+    ar->io(v);
+    EXPECT_FALSE(ar->section("a", 7));  // duplicated (shared) section is written once
+    EXPECT_TRUE(ar->close());
+  }
+
+  auto ar = Snapshot_io::open(file_name);
+  ASSERT_NE(ar, nullptr);
+  EXPECT_FALSE(ar->is_saving());
+
+  uint64_t             a = 0;
+  std::vector<int16_t> v(4, 0);
+  EXPECT_TRUE(ar->section("a", 7));
+  ar->io(a);
+  ar->io(v);
+  EXPECT_EQ(a, 0x1234U);
+  EXPECT_EQ(v, (std::vector<int16_t>{1, -2, 3, -4}));
+  EXPECT_EQ(ar->get_n_restored(), 1U);
+}
+
+TEST_F(Snapshot_test, skip_missing_and_mismatched) {
+  SCTable t1("t1", 64, 2);
+  SCTable t2("t2", 64, 2);
+  for (uint32_t i = 0; i < 64; ++i) {
+    t1.update(i, true);
+    t2.update(i, true);
+  }
+  {
+    auto ar = Snapshot_io::create(file_name);
+    t1.snapshot(*ar, "t1");
+    t2.snapshot(*ar, "t2");
+  }  // destructor writes the file
+
+  SCTable r1("r1", 64, 2);
+  SCTable r2("r2", 128, 2);  // new geometry, stays cold
+  SCTable r3("r3", 64, 2);   // not in the file
+
+  auto ar = Snapshot_io::open(file_name);
+  ASSERT_NE(ar, nullptr);
+  r1.snapshot(*ar, "t1");
+  r2.snapshot(*ar, "t2");
+  r3.snapshot(*ar, "t3");
+
+  EXPECT_EQ(ar->get_n_restored(), 1U);
+  EXPECT_EQ(ar->get_n_skipped(), 2U);
+  for (uint32_t i = 0; i < 64; ++i) {
+    EXPECT_EQ(r1.predict(i), t1.predict(i));
+    EXPECT_EQ(r2.predict(i), SCTable("cold", 128, 2).predict(i));
+  }
+}
+
+class Tag_state : public StateGeneric<uint64_t> {
+public:
+  explicit Tag_state(int32_t lineSize) { (void)lineSize; }
+};
+
+TEST_F(Snapshot_test, cache_tags) {
+  using Cache = CacheGeneric<Tag_state, uint64_t>;
+
+  auto* c1 = Cache::create(4096, 4, 64, 1, "LRU", false, false);
+  for (uint64_t i = 1; i <= 200; ++i) {  // tag 0 is an invalid line
+    c1->fillLine(i * 64 * 3);
+  }
+  {
+    auto ar = Snapshot_io::create(file_name);
+    c1->snapshot(*ar, "L1");
+  }
+
+  auto* c2 = Cache::create(4096, 4, 64, 1, "LRU", false, false);
+  {
+    auto ar = Snapshot_io::open(file_name);
+    ASSERT_NE(ar, nullptr);
+    c2->snapshot(*ar, "L1");
+    EXPECT_EQ(ar->get_n_restored(), 1U);
+  }
+
+  // Same hits, and the same victims afterwards (recency order restored)
+  for (uint64_t i = 1; i < 400; ++i) {
+    bool hit1 = c1->findLineNoEffect(i * 64, i * 64, 0) != nullptr;
+    bool hit2 = c2->findLineNoEffect(i * 64, i * 64, 0) != nullptr;
+    EXPECT_EQ(hit1, hit2);
+  }
+  for (uint64_t i = 1000; i < 1040; ++i) {
+    c1->fillLine(i * 64);
+    c2->fillLine(i * 64);
+  }
+  for (uint64_t i = 1; i < 1100; ++i) {
+    EXPECT_EQ(c1->findLineNoEffect(i * 64, i * 64, 0) != nullptr, c2->findLineNoEffect(i * 64, i * 64, 0) != nullptr);
+  }
+
+  c1->destroy();
+  c2->destroy();
+}
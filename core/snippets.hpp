@@ -9,8 +9,8 @@
 using Time_t               = uint64_t;
 constexpr uint64_t MaxTime = ((~0ULL) - 1024);  // -1024 is to give a little bit of margin
 
-extern Time_t globalClock;  // Defined in Thread.cpp
-extern Time_t deadClock;    // Defined in Thread.cpp
+extern thread_local Time_t globalClock;  // Defined in callback.cpp (one per Clock_domain thread)
+extern thread_local Time_t deadClock;    // Defined in callback.cpp
 
 using TimeDelta_t               = uint16_t;
 constexpr uint16_t MaxDeltaTime = (65535 - 1024);  // -1024 is to give a little bit of margin
@@ -0,0 +1,60 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "iassert.hpp"
+#include "snippets.hpp"
+
+// Fixed capacity single-producer/single-consumer ring.
+//
+// Entries are filled in place (ref_tail/push) and consumed in place
+// (ref_head/pop), so no copy is needed for large records. head and tail are
+// free-running counters on separate cache lines; each side only writes its own
+// counter, so producer and consumer can live in different threads.
+template <class Type>
+class Spsc_ring {
+private:
+  std::vector<Type> array;
+  const uint64_t    mask;
+
+  alignas(64) std::atomic<uint64_t> head{0};  // consumer
+  alignas(64) std::atomic<uint64_t> tail{0};  // producer
+
+public:
+  explicit Spsc_ring(uint32_t capacity) : array(roundUpPower2(capacity)), mask(roundUpPower2(capacity) - 1) {
+    I(capacity > 0);
+  }
+
+  [[nodiscard]] size_t capacity() const { return array.size(); }
+  [[nodiscard]] size_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+  [[nodiscard]] size_t free_slots() const { return capacity() - size(); }
+  [[nodiscard]] bool   empty() const { return size() == 0; }
+  [[nodiscard]] bool   full() const { return size() == capacity(); }
+
+  // Producer side: nullptr when full
+  Type* ref_tail() {
+    auto t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) >= capacity()) {
+      return nullptr;
+    }
+    return &array[t & mask];
+  }
+  void push() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  // Consumer side: nullptr when empty
+  Type* ref_head() {
+    auto h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &array[h & mask];
+  }
+  void pop() {
+    I(!empty());
+    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+};
@@ -2,6 +2,9 @@
 
 #include "stats.hpp"
 
+#include <cmath>
+#include <cstring>
+
 #include "config.hpp"
 #include "fmt/format.h"
 #include "report.hpp"
@@ -19,148 +22,567 @@ void Stats::subscribe() {
   }
 
   store[name] = this;
+  all_pos     = all.size();
+  all.push_back(this);
 }
 
 void Stats::unsubscribe() {
   I(!name.empty());
 
   auto it = store.find(name);
-  if (it != store.end()) {
+  if (it != store.end() && it->second == this) {
     store.erase(it);
+
+    all.back()->all_pos = all_pos;
+    all[all_pos]        = all.back();
+    all.pop_back();
+  }
+}
+
+void Stats::arena_alloc(const std::vector<std::string>& slot_names) {
+  constexpr size_t chunk = size_t(1) << arena_chunk_bits;
+  constexpr size_t line  = 64 / sizeof(double);
+
+  auto n = slot_names.size();
+  I(n > 0 && n <= chunk);
+
+  // Never straddle a chunk, and a line only when more than a line is needed
+  auto pos = arena_names.size() & (chunk - 1);
+  if (pos != 0 && pos + n > chunk) {
+    arena_names.resize(arena_names.size() + chunk - pos);
+  } else if ((n > line && (pos % line) != 0) || (n <= line && (pos % line) + n > line)) {
+    arena_names.resize(arena_names.size() + line - (pos % line));
+  }
+  if ((arena_names.size() >> arena_chunk_bits) == arena.size()) {
+    arena.emplace_back(new (std::align_val_t(64)) double[chunk]());
+  }
+
+  slot    = arena_names.size();
+  n_slots = n;
+  data    = &arena[slot >> arena_chunk_bits][slot & (chunk - 1)];
+  arena_names.insert(arena_names.end(), slot_names.begin(), slot_names.end());
+}
+
+void Stats::reset() {
+  for (uint32_t i = 0; i < n_slots; ++i) {
+    data[i] = 0;
   }
 }
 
 void Stats::report_all() {
   Report::field(fmt::format("#BEGIN Stats"));
 
-  for (const auto& e : store) {
-    e.second->report();
+  for (const auto* e : all) {
+    e->report();
   }
 
   Report::field(fmt::format("#END Stats"));
 }
 
 void Stats::reset_all() {
-  for (auto& e : store) {
-    e.second->reset();
+  for (auto* e : all) {
+    e->reset();
   }
 }
 
 /*********************** Stats_pwr */
 
-Stats_pwr::Stats_pwr(const std::string& str) : Stats(str) { subscribe(); }
+Stats_pwr::Stats_pwr(const std::string& str) : Stats(str) {
+  arena_alloc({name + ":tran", name + ":real"});
 
-void Stats_pwr::report() const { Report::field(fmt::format("pwr_{}:real={} tran={}\n", name, cntr_real, cntr_tran)); }
+  subscribe();
+}
 
-void Stats_pwr::reset() {
-  cntr_tran = 0;
-  cntr_real = 0;
+void Stats_pwr::report() const {
+  Report::field(fmt::format("pwr_{}:real={} tran={}\n", name, static_cast<uint64_t>(data[1]), static_cast<uint64_t>(data[0])));
 }
 
 /*********************** Stats_cntr */
 
 Stats_cntr::Stats_cntr(const std::string& str) : Stats(str) {
-  data = 0;
+  arena_alloc({name});
 
   subscribe();
 }
 
-void Stats_cntr::report() const { Report::field(fmt::format("{}={}\n", name, data)); }
-
-void Stats_cntr::reset() { data = 0; }
+void Stats_cntr::report() const { Report::field(fmt::format("{}={}\n", name, *data)); }
 
 /*********************** Stats_avg */
 
 Stats_avg::Stats_avg(const std::string& str) : Stats(str) {
-  data  = 0;
-  nData = 0;
+  arena_alloc({name + ":sum", name + ":n"});
 
   subscribe();
 }
 
-void Stats_avg::sample(const double v, bool en) {
-  data += en ? v : 0;
-  nData += en ? 1 : 0;
-}
-
 void Stats_avg::report() const {
-  auto v = data / nData;
+  auto nData = static_cast<int64_t>(data[1]);
+  auto v     = data[0] / nData;
 
   Report::field(fmt::format("{}:n={}::v={}\n", name, nData, v));  // n first for power
 }
 
-void Stats_avg::reset() {
-  data  = 0;
-  nData = 0;
-}
-
 /*********************** Stats_max */
 
 Stats_max::Stats_max(const std::string& str) : Stats(str) {
-  maxValue = 0;
-  nData    = 0;
+  arena_alloc({name + ":max", name + ":n"});
 
   subscribe();
 }
 
-void Stats_max::report() const { Report::field(fmt::format("{}:max={}:n={}\n", name, maxValue, nData)); }
-
-void Stats_max::sample(const double v, bool en) {
-  if (!en) {
-    return;
-  }
-  maxValue = v > maxValue ? v : maxValue;
-  nData++;
-}
-
-void Stats_max::reset() {
-  maxValue = 0;
-  nData    = 0;
+void Stats_max::report() const {
+  Report::field(fmt::format("{}:max={}:n={}\n", name, data[0], static_cast<int64_t>(data[1])));
 }
 
 /*********************** Stats_hist */
 
-Stats_hist::Stats_hist(const std::string& str) : Stats(str), numSample(0), cumulative(0) {
-  numSample  = 0;
-  cumulative = 0;
+Stats_hist::Stats_hist(const std::string& str, int32_t _n_dense) : Stats(str), n_dense(_n_dense) {
+  I(n_dense >= 0);
+
+  // Only the totals are exported to Stats_interval, not the buckets
+  std::vector<std::string> slot_names(2 + n_dense);
+  slot_names[0] = name + ":n";
+  slot_names[1] = name + ":sum";
+  arena_alloc(slot_names);
 
   subscribe();
 }
 
+void Stats_hist::sample_overflow(int32_t key, double weight) { overflow[key] += weight; }
+
+double Stats_hist::get_count(int32_t key) const {
+  if (static_cast<uint32_t>(key) < static_cast<uint32_t>(n_dense)) {
+    return data[2 + key];
+  }
+  auto it = overflow.find(key);
+  return it == overflow.end() ? 0 : it->second;
+}
+
 void Stats_hist::report() const {
   int32_t maxKey = 0;
 
-  for (const auto& e : hist) {
+  for (int32_t k = 0; k < n_dense; ++k) {
+    if (data[2 + k] != 0) {
+      Report::field(fmt::format("{}({})={}\n", name, k, data[2 + k]));
+      maxKey = k;
+    }
+  }
+  for (const auto& e : overflow) {
     Report::field(fmt::format("{}({})={}\n", name, e.first, e.second));
     if (e.first > maxKey) {
       maxKey = e.first;
     }
   }
-  long double div = cumulative;  // cummulative has 64bits (double has 54bits mantisa)
-  div /= numSample;
+  long double div = data[1];  // cummulative has 64bits (double has 54bits mantisa)
+  div /= data[0];
 
   Report::field(fmt::format("{}:max={}\n", name, maxKey));
   Report::field(fmt::format("{}:v={}\n", name, div));
-  Report::field(fmt::format("{}:n={}\n", name, numSample));
+  Report::field(fmt::format("{}:n={}\n", name, data[0]));
+}
+
+void Stats_hist::reset() {
+  Stats::reset();
+  overflow.clear();
+}
+
+/*********************** Stats_sampler */
+
+double Stats_sampler::get_cntr(const std::string& name) {
+  auto it = Stats::store.find(name);
+  if (it == Stats::store.end()) {
+    return 0;
+  }
+  const auto* c = dynamic_cast<const Stats_cntr*>(it->second);
+  return c ? c->getDouble() : 0;
+}
+
+void Stats_sampler::add_ratio(const std::string& name, const std::string& num, const std::string& den) {
+  ratios.push_back({name, num, den, {}, 0, 0});
+}
+
+void Stats_sampler::mark() {
+  for (const auto& e : Stats::store) {
+    const auto* c = dynamic_cast<const Stats_cntr*>(e.second);
+    if (c) {
+      accs[e.first].last = c->getDouble();
+    }
+  }
+  for (auto& r : ratios) {
+    r.last_num = get_cntr(r.num);
+    r.last_den = get_cntr(r.den);
+  }
+}
+
+void Stats_sampler::sample(double weight) {
+  I(weight > 0);
+
+  for (const auto& e : Stats::store) {
+    const auto* c = dynamic_cast<const Stats_cntr*>(e.second);
+    if (c == nullptr) {
+      continue;
+    }
+    auto& acc   = accs[e.first];
+    auto  delta = c->getDouble() - acc.last;
+    acc.last    = c->getDouble();
+    acc.sum_x += weight * delta;
+    acc.sum_x2 += weight * delta * delta;
+  }
+
+  for (auto& r : ratios) {
+    auto num   = get_cntr(r.num);
+    auto den   = get_cntr(r.den);
+    auto delta = (den > r.last_den) ? (num - r.last_num) / (den - r.last_den) : 0;
+    r.last_num = num;
+    r.last_den = den;
+    r.acc.sum_x += weight * delta;
+    r.acc.sum_x2 += weight * delta * delta;
+  }
+
+  ++n_samples;
+  sum_w += weight;
+  sum_w2 += weight * weight;
+}
+
+static double acc_mean(double sum_x, double sum_w) { return sum_w > 0 ? sum_x / sum_w : 0; }
+
+static double acc_ci95(double sum_x, double sum_x2, double sum_w, double sum_w2) {
+  if (sum_w <= 0) {
+    return 0;
+  }
+  // Weighted sample variance with the reliability weights correction. With
+  // equal weights it is the usual s^2 and the effective n is the sample count.
+  auto mean  = sum_x / sum_w;
+  auto v1    = sum_x2 / sum_w - mean * mean;
+  auto n_eff = sum_w * sum_w / sum_w2;
+  if (n_eff <= 1) {
+    return 0;
+  }
+  auto var = v1 * n_eff / (n_eff - 1);
+
+  return 1.96 * std::sqrt(var > 0 ? var : 0) / std::sqrt(n_eff);
+}
+
+double Stats_sampler::get_mean(const std::string& name) {
+  for (const auto& r : ratios) {
+    if (r.name == name) {
+      return acc_mean(r.acc.sum_x, sum_w);
+    }
+  }
+  auto it = accs.find(name);
+  return it == accs.end() ? 0 : acc_mean(it->second.sum_x, sum_w);
+}
+
+double Stats_sampler::get_ci95(const std::string& name) {
+  for (const auto& r : ratios) {
+    if (r.name == name) {
+      return acc_ci95(r.acc.sum_x, r.acc.sum_x2, sum_w, sum_w2);
+    }
+  }
+  auto it = accs.find(name);
+  return it == accs.end() ? 0 : acc_ci95(it->second.sum_x, it->second.sum_x2, sum_w, sum_w2);
+}
+
+void Stats_sampler::report_acc(const std::string& name, const Acc& acc) {
+  Report::field(fmt::format("sample_{}:mean={}:ci95={}\n",
+                            name,
+                            acc_mean(acc.sum_x, sum_w),
+                            acc_ci95(acc.sum_x, acc.sum_x2, sum_w, sum_w2)));
 }
 
-void Stats_hist::sample(int32_t key, bool enable, double weight) {
-  if (!enable) {
+void Stats_sampler::report() {
+  if (n_samples == 0) {
     return;
   }
-  if (hist.find(key) == hist.end()) {
-    hist[key] = 0;
+
+  Report::field(fmt::format("#BEGIN Sampling"));
+  Report::field(fmt::format("Sampling:n={}:weight={}\n", n_samples, sum_w));
+
+  for (const auto& r : ratios) {
+    report_acc(r.name, r.acc);
+  }
+  for (const auto& e : accs) {
+    if (e.second.sum_x != 0) {
+      report_acc(e.first, e.second);
+    }
   }
 
-  hist[key] += weight;
+  Report::field(fmt::format("#END Sampling"));
+}
 
-  numSample += weight;
-  cumulative += weight * key;
+void Stats_sampler::reset() {
+  accs.clear();
+  ratios.clear();
+  n_samples = 0;
+  sum_w     = 0;
+  sum_w2    = 0;
 }
 
-void Stats_hist::reset() {
-  hist.clear();
+/*********************** Stats_interval */
+
+static void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v) | 0x80);
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+bool Stats_interval::open(const std::string& file_name, uint64_t n_cycles) {
+  I(n_cycles > 0);
+  close();
+
+  fp = fopen(file_name.c_str(), "wb");
+  if (fp == nullptr) {
+    Config::add_error(fmt::format("unable to open stats interval file {}", file_name));
+    return false;
+  }
+  fwrite(&magic, sizeof(magic), 1, fp);
+  fwrite(&n_cycles, sizeof(n_cycles), 1, fp);
+
+  interval   = n_cycles;
+  next       = n_cycles;
+  n_scanned  = 0;
+  n_named    = 0;
+  group_cols = 0;
+  n_rows     = 0;
+  cols.clear();
+  rows.clear();
+  cycles.clear();
+  prev.clear();
+
+  return true;
+}
+
+void Stats_interval::close() {
+  if (fp == nullptr) {
+    return;
+  }
+
+  flush_group();
+  fclose(fp);
+  fp   = nullptr;
+  next = UINT64_MAX;
+}
+
+void Stats_interval::snapshot(uint64_t clk) {
+  I(fp);
+
+  constexpr size_t chunk = size_t(1) << Stats::arena_chunk_bits;
+
+  for (auto n_slots = Stats::arena_names.size(); n_scanned < n_slots; ++n_scanned) {
+    if (!Stats::arena_names[n_scanned].empty()) {
+      cols.push_back(n_scanned);
+    }
+  }
+  if (cols.size() != group_cols) {
+    flush_group();  // new stats since the last row
+    group_cols = cols.size();
+  }
+  rows.resize((n_rows + 1) * group_cols);
+
+  auto* row = &rows[n_rows * group_cols];
+  for (size_t c = 0; c < group_cols; ++c) {
+    auto s = cols[c];
+    row[c] = Stats::arena[s >> Stats::arena_chunk_bits][s & (chunk - 1)];
+  }
+  cycles.push_back(clk);
+  ++n_rows;
+
+  next = clk - (clk % interval) + interval;
+
+  if (n_rows == group_rows) {
+    flush_group();
+  }
+}
+
+// Group layout:
+//   u32 n_new_names, names (u16 length + bytes) for the columns after the
+//   previous ones, u32 n_cols, u32 n_rows, u64 cycle per row, then per
+//   column a flag byte (0 zigzag varint deltas, 1 raw doubles) and its rows
+void Stats_interval::flush_group() {
+  if (n_rows == 0) {
+    return;
+  }
+
+  std::vector<uint8_t> out;
+  auto                 put = [&out](const auto& v) {
+    const auto* b = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), b, b + sizeof(v));
+  };
+
+  uint32_t n_new = group_cols - n_named;
+  put(n_new);
+  for (auto i = n_named; i < group_cols; ++i) {
+    const auto& str = Stats::arena_names[cols[i]];
+    uint16_t    len = str.size();
+    put(len);
+    out.insert(out.end(), str.begin(), str.end());
+  }
+  n_named = group_cols;
+  prev.resize(group_cols, 0);
+
+  put(static_cast<uint32_t>(group_cols));
+  put(static_cast<uint32_t>(n_rows));
+  for (auto clk : cycles) {
+    put(clk);
+  }
+
+  for (size_t c = 0; c < group_cols; ++c) {
+    bool integer = true;
+    for (size_t r = 0; r < n_rows && integer; ++r) {
+      auto v  = rows[r * group_cols + c];
+      integer = v == std::trunc(v) && std::fabs(v) < 9007199254740992.0;  // 2^53
+    }
+
+    out.push_back(integer ? 0 : 1);
+    for (size_t r = 0; r < n_rows; ++r) {
+      auto v = rows[r * group_cols + c];
+      if (integer) {
+        auto d = static_cast<int64_t>(v) - static_cast<int64_t>(prev[c]);
+        put_varint(out, (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63));
+      } else {
+        put(v);
+      }
+      prev[c] = v;
+    }
+  }
+
+  fwrite(out.data(), 1, out.size(), fp);
+
+  n_rows = 0;
+  rows.clear();
+  cycles.clear();
+}
+
+bool Stats_interval::to_csv(const std::string& file_name, std::ostream& out, bool cumulative) {
+  FILE* in = fopen(file_name.c_str(), "rb");
+  if (in == nullptr) {
+    return false;
+  }
+  std::vector<uint8_t> buf;
+  uint8_t              tmp[65536];
+  size_t               sz;
+  while ((sz = fread(tmp, 1, sizeof(tmp), in)) > 0) {
+    buf.insert(buf.end(), tmp, tmp + sz);
+  }
+  fclose(in);
+
+  size_t pos = 0;
+  bool   bad = false;
+  auto   get = [&](auto& v) {
+    if (pos + sizeof(v) > buf.size()) {
+      bad = true;
+      return;
+    }
+    memcpy(&v, &buf[pos], sizeof(v));
+    pos += sizeof(v);
+  };
+  auto get_varint = [&]() {
+    uint64_t v     = 0;
+    int      shift = 0;
+    while (pos < buf.size() && shift < 64) {
+      auto b = buf[pos++];
+      v |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if ((b & 0x80) == 0) {
+        return v;
+      }
+      shift += 7;
+    }
+    bad = true;
+    return v;
+  };
+
+  uint64_t m = 0;
+  uint64_t n = 0;
+  get(m);
+  get(n);
+  if (bad || m != magic) {
+    return false;
+  }
+
+  std::vector<std::string>         names;
+  std::vector<double>              last;  // running value per column
+  std::vector<uint64_t>            all_cycles;
+  std::vector<std::vector<double>> all_rows;  // a row has the columns known at its group
+
+  while (pos < buf.size()) {
+    uint32_t n_new = 0;
+    get(n_new);
+    for (uint32_t i = 0; i < n_new && !bad; ++i) {
+      uint16_t len = 0;
+      get(len);
+      if (pos + len > buf.size()) {
+        return false;
+      }
+      names.emplace_back(reinterpret_cast<const char*>(&buf[pos]), len);
+      pos += len;
+    }
+
+    uint32_t n_cols = 0;
+    uint32_t n_grp  = 0;
+    get(n_cols);
+    get(n_grp);
+    if (bad || n_cols != names.size()) {
+      return false;
+    }
+
+    auto first = all_rows.size();
+    for (uint32_t r = 0; r < n_grp && !bad; ++r) {
+      uint64_t clk = 0;
+      get(clk);
+      all_cycles.push_back(clk);
+      all_rows.emplace_back(n_cols);
+    }
+
+    last.resize(n_cols, 0);
+    for (uint32_t c = 0; c < n_cols && !bad; ++c) {
+      uint8_t flag = 0;
+      get(flag);
+      for (uint32_t r = 0; r < n_grp && !bad; ++r) {
+        double v = 0;
+        if (flag == 0) {
+          auto z = get_varint();
+          v      = last[c] + static_cast<double>(static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1));
+        } else if (flag == 1) {
+          get(v);
+        } else {
+          return false;
+        }
+        all_rows[first + r][c] = cumulative ? v : v - last[c];
+        last[c]                = v;
+      }
+    }
+    if (bad) {
+      return false;
+    }
+  }
+
+  out << "cycle";
+  for (const auto& str : names) {
+    if (str.find_first_of(",\"") == std::string::npos) {
+      out << "," << str;
+      continue;
+    }
+    out << ",\"";
+    for (auto ch : str) {
+      out << (ch == '"' ? "\"\"" : std::string(1, ch));
+    }
+    out << "\"";
+  }
+  out << "\n";
+
+  // Stats created after a row leave its column empty
+  for (size_t r = 0; r < all_rows.size(); ++r) {
+    out << all_cycles[r];
+    for (size_t c = 0; c < names.size(); ++c) {
+      out << ",";
+      if (c < all_rows[r].size()) {
+        out << fmt::format("{}", all_rows[r][c]);
+      }
+    }
+    out << "\n";
+  }
 
-  numSample  = 0;
-  cumulative = 0;
+  return true;
 }
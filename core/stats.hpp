@@ -2,8 +2,13 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <list>
+#include <memory>
+#include <new>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -11,16 +16,44 @@
 #include "fmt/format.h"
 #include "iassert.hpp"
 
+class Stats_sampler;
+class Stats_interval;
+
 class Stats {
 private:
-  static inline absl::flat_hash_map<std::string, Stats*> store;
+  static inline absl::flat_hash_map<std::string, Stats*> store;  // by name
+  static inline std::vector<Stats*>                      all;    // report/reset scan
+
+  size_t all_pos;
+
+  // Values of every Stats, in fixed size chunks so a slot never moves. Slots
+  // are not reused; Stats_interval copies the named ones.
+  struct Arena_free {
+    void operator()(double* p) const { ::operator delete[](p, std::align_val_t(64)); }
+  };
+  static constexpr size_t                                          arena_chunk_bits = 14;
+  static inline std::vector<std::unique_ptr<double[], Arena_free>> arena;
+  static inline std::vector<std::string>                           arena_names;
+
+  friend class Stats_sampler;
+  friend class Stats_interval;
 
 protected:
   const std::string name;
 
+  // Arena handle, the first of n_slots consecutive slots
+  uint32_t slot{0};
+  uint32_t n_slots{0};
+  double*  data{nullptr};
+
   void subscribe();
   void unsubscribe();
 
+  // Zeroed slots, one per entry of slot_names (an empty name is not exported
+  // to Stats_interval). Up to 8 slots share one cache line, larger blocks
+  // start on a line.
+  void arena_alloc(const std::vector<std::string>& slot_names);
+
 public:
   Stats(const std::string& n) : name(n) {};
   virtual ~Stats();
@@ -29,95 +62,212 @@ public:
   static void reset_all();
 
   virtual void report() const = 0;
-  virtual void reset()        = 0;
+  virtual void reset();
 };
 
 class Stats_pwr : public Stats {
 private:
-  uint64_t cntr_tran{0};
-  uint64_t cntr_real{0};
-
+  // arena slots: tran, real
 protected:
 public:
   Stats_pwr(const std::string& format);
 
   void inc(bool transient) {
-    cntr_tran += transient ? 1 : 0;
-    cntr_real += transient ? 0 : 1;
+    data[0] += transient ? 1 : 0;
+    data[1] += transient ? 0 : 1;
   }
 
   void report() const final;
-  void reset() final;
 };
 
 class Stats_cntr : public Stats {
 private:
-  double data;
-
+  // arena slot: value
 protected:
 public:
   Stats_cntr(const std::string& format);
 
   Stats_cntr& operator+=(const double v) {
-    data += v;
+    *data += v;
     return *this;
   }
 
-  void add(const double v, bool en = true) { data += en ? v : 0; }
-  void inc(bool en = true) { data += en ? 1 : 0; }
+  void add(const double v, bool en = true) { *data += en ? v : 0; }
+  void inc(bool en = true) { *data += en ? 1 : 0; }
 
-  void dec(bool en) { data -= en ? 1 : 0; }
+  void dec(bool en) { *data -= en ? 1 : 0; }
+
+  [[nodiscard]] double getDouble() const { return *data; }
 
   void report() const final;
-  void reset() final;
 };
 
 class Stats_avg : public Stats {
 private:
+  // arena slots: sum, number of samples
 protected:
-  double  data;
-  int64_t nData;
-
 public:
   Stats_avg(const std::string& format);
 
-  void sample(const double v, bool en);
+  void sample(const double v, bool en) {
+    data[0] += en ? v : 0;
+    data[1] += en ? 1 : 0;
+  }
+  // Same as n calls with the same value (idle-cycle skip)
+  void sample(const double v, bool en, uint64_t n) {
+    data[0] += en ? v * n : 0;
+    data[1] += en ? n : 0;
+  }
   void sample(bool en, const double v) = delete;
 
+  [[nodiscard]] double get_samples() const { return data[1]; }
+  [[nodiscard]] double get_mean() const { return data[1] ? data[0] / data[1] : 0; }
+
   void report() const final;
-  void reset() final;
 };
 
 class Stats_max : public Stats {
 private:
+  // arena slots: max, number of samples
 protected:
-  double  maxValue;
-  int64_t nData;
-
 public:
   Stats_max(const std::string& format);
 
-  void sample(const double v, bool en);
+  void sample(const double v, bool en) {
+    if (!en) {
+      return;
+    }
+    data[0] = v > data[0] ? v : data[0];
+    data[1] += 1;
+  }
   void sample(bool en, const double v) = delete;
 
   void report() const final;
-  void reset() final;
 };
 
+// Keys in [0, n_dense) are counted in arena buckets, others (negative or
+// large) in a map
 class Stats_hist : public Stats {
 private:
-protected:
-  double numSample;
-  double cumulative;
+  // arena slots: number of samples, cumulative, then the n_dense buckets
+  const int32_t n_dense;
 
-  absl::flat_hash_map<int32_t, double> hist;
+  absl::flat_hash_map<int32_t, double> overflow;
 
-public:
-  Stats_hist(const std::string& format);
+  void sample_overflow(int32_t key, double weight);
 
-  void sample(int32_t key, bool enable, double weight = 1);
+protected:
+public:
+  Stats_hist(const std::string& format, int32_t _n_dense = 256);
+
+  void sample(int32_t key, bool enable, double weight = 1) {
+    if (!enable) {
+      return;
+    }
+    if (static_cast<uint32_t>(key) < static_cast<uint32_t>(n_dense)) {
+      data[2 + key] += weight;
+    } else {
+      sample_overflow(key, weight);
+    }
+
+    data[0] += weight;
+    data[1] += weight * key;
+  }
   void sample(bool enable, uint32_t key, double weight = 1) = delete;
 
+  [[nodiscard]] double get_count(int32_t key) const;
+  [[nodiscard]] double get_samples() const { return data[0]; }
+
   void report() const final;
   void reset() final;
 };
+
+// Statistical sampling (SMARTS/SimPoint). Each measured interval is bracketed
+// by mark()/sample(); the Stats_cntr deltas of every interval are accumulated
+// so the report can show a weighted mean per interval and a 95% confidence
+// interval (meaningful for periodic/random sampling, informative for SimPoint).
+class Stats_sampler {
+private:
+  struct Acc {
+    double last{0};
+    double sum_x{0};   // weighted
+    double sum_x2{0};  // weighted
+  };
+  struct Ratio {
+    std::string name;
+    std::string num;
+    std::string den;
+    Acc         acc;
+    double      last_num{0};
+    double      last_den{0};
+  };
+
+  static inline absl::flat_hash_map<std::string, Acc> accs;
+  static inline std::vector<Ratio>                     ratios;
+  static inline size_t                                 n_samples{0};
+  static inline double                                 sum_w{0};
+  static inline double                                 sum_w2{0};
+
+  static double get_cntr(const std::string& name);
+  static void   report_acc(const std::string& name, const Acc& acc);
+
+public:
+  // Per interval ratio of two Stats_cntr (e.g. CPI = clockTicks/nCommitted)
+  static void add_ratio(const std::string& name, const std::string& num, const std::string& den);
+
+  static void mark();                  // measured interval starts
+  static void sample(double weight);  // measured interval ends
+
+  [[nodiscard]] static size_t size() { return n_samples; }
+
+  [[nodiscard]] static double get_mean(const std::string& name);
+  [[nodiscard]] static double get_ci95(const std::string& name);
+
+  static void report();
+  static void reset();
+};
+
+// [stats] interval = N time series. Every N cycles the named Stats arena slots
+// (not the histogram buckets or the padding) are copied into a group of rows.
+// Full groups are written column major: each column is zigzag varint deltas
+// when its values are integers, raw doubles otherwise. New Stats names go in a schema block in
+// front of the group that first has them. to_csv (and the stats_csv tool)
+// dumps one row per interval.
+class Stats_interval {
+private:
+  static constexpr size_t   group_rows = 64;
+  static constexpr uint64_t magic      = 0x3130535441545344ULL;  // "DSTATS01"
+
+  static inline FILE*    fp       = nullptr;
+  static inline uint64_t interval = 0;
+  static inline uint64_t next     = UINT64_MAX;
+
+  static inline std::vector<uint32_t> cols;  // named arena slot per column
+  static inline size_t                n_scanned  = 0;  // arena slots already checked for a name
+  static inline size_t                n_named    = 0;  // names already in the file
+  static inline size_t                group_cols = 0;
+  static inline size_t                n_rows     = 0;
+  static inline std::vector<double>   rows;  // n_rows x group_cols
+  static inline std::vector<uint64_t> cycles;
+  static inline std::vector<double>   prev;  // last value written per column
+
+  static void flush_group();
+
+public:
+  static bool open(const std::string& file_name, uint64_t n_cycles);
+  static void close();
+
+  // Called with the current cycle, snapshots once every interval
+  static void tick(uint64_t clk) {
+    if (clk >= next) [[unlikely]] {
+      snapshot(clk);
+    }
+  }
+  static void snapshot(uint64_t clk);
+
+  [[nodiscard]] static bool     is_open() { return fp != nullptr; }
+  [[nodiscard]] static uint64_t get_next() { return next; }  // cycle of the next snapshot
+
+  // One row per snapshot, per interval deltas (or running values)
+  static bool to_csv(const std::string& file_name, std::ostream& out, bool cumulative);
+};
@@ -0,0 +1,76 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+#include "stats.hpp"
+
+// Many live counters touched in a scattered order, like the per-cycle
+// updates of a core with its caches and queues. Arg: number of counters
+static void BM_stats_cntr(benchmark::State& state) {
+  std::vector<std::unique_ptr<Stats_cntr>> v;
+  for (int i = 0; i < state.range(0); ++i) {
+    v.emplace_back(std::make_unique<Stats_cntr>(fmt::format("bench:cntr{}_{}", state.range(0), i)));
+  }
+
+  uint32_t x = 0x9E3779B9;
+  int64_t  n = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 1024; ++i) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      v[x % v.size()]->inc(x & 1);
+    }
+    n += 1024;
+  }
+  state.counters["updates"] = benchmark::Counter(n, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_stats_cntr)->Arg(64)->Arg(4096);
+
+static void BM_stats_avg(benchmark::State& state) {
+  std::vector<std::unique_ptr<Stats_avg>> v;
+  for (int i = 0; i < state.range(0); ++i) {
+    v.emplace_back(std::make_unique<Stats_avg>(fmt::format("bench:avg{}_{}", state.range(0), i)));
+  }
+
+  uint32_t x = 0x9E3779B9;
+  int64_t  n = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 1024; ++i) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      v[x % v.size()]->sample(x & 63, true);
+    }
+    n += 1024;
+  }
+  state.counters["updates"] = benchmark::Counter(n, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_stats_avg)->Arg(64)->Arg(4096);
+
+// Arg: key range, within the dense buckets (64) or mostly in the overflow map
+static void BM_stats_hist(benchmark::State& state) {
+  Stats_hist h(fmt::format("bench:hist{}", state.range(0)));
+
+  uint32_t x = 0x9E3779B9;
+  int64_t  n = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 1024; ++i) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      h.sample(x % state.range(0), true);
+    }
+    n += 1024;
+  }
+  state.counters["updates"] = benchmark::Counter(n, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_stats_hist)->Arg(64)->Arg(4096);
+
+int main(int argc, char* argv[]) {
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,34 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "fmt/format.h"
+#include "stats.hpp"
+
+// [stats] interval file to CSV: stats_csv [-c] stats_interval.<ext>.bin [out.csv]
+// Per interval deltas by default, running values with -c
+int main(int argc, char** argv) {
+  bool cumulative = argc > 1 && strcmp(argv[1], "-c") == 0;
+  int  first      = cumulative ? 2 : 1;
+
+  if (argc - first < 1 || argc - first > 2) {
+    fmt::print(stderr, "usage: {} [-c] <stats.bin> [out.csv]\n", argv[0]);
+    return 1;
+  }
+
+  bool ok;
+  if (argc - first == 2) {
+    std::ofstream out(argv[first + 1]);
+    ok = out && Stats_interval::to_csv(argv[first], out, cumulative);
+  } else {
+    ok = Stats_interval::to_csv(argv[first], std::cout, cumulative);
+  }
+
+  if (!ok) {
+    fmt::print(stderr, "{}: {} is not a valid stats interval file\n", argv[0], argv[first]);
+    return 1;
+  }
+  return 0;
+}
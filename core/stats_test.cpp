@@ -0,0 +1,275 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "stats.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+class Stats_sampler_test : public ::testing::Test {
+protected:
+  void SetUp() override { Stats_sampler::reset(); }
+  void TearDown() override { Stats_sampler::reset(); }
+};
+
+TEST_F(Stats_sampler_test, periodic_mean_and_ci) {
+  Stats_cntr inst("sampler_test:inst");
+  Stats_cntr cycles("sampler_test:cycles");
+  Stats_sampler::add_ratio("sampler_test:cpi", "sampler_test:cycles", "sampler_test:inst");
+
+  const double deltas[] = {10, 20, 30, 40};
+  for (auto d : deltas) {
+    inst.add(1000, true);  // not measured
+    cycles.add(5000, true);
+
+    Stats_sampler::mark();
+    inst.add(100, true);
+    cycles.add(d * 10, true);
+    Stats_sampler::sample(1);
+  }
+
+  EXPECT_EQ(Stats_sampler::size(), 4);
+  EXPECT_DOUBLE_EQ(Stats_sampler::get_mean("sampler_test:inst"), 100);
+  EXPECT_DOUBLE_EQ(Stats_sampler::get_ci95("sampler_test:inst"), 0);
+  EXPECT_DOUBLE_EQ(Stats_sampler::get_mean("sampler_test:cycles"), 250);
+
+  // s = sqrt(var(100,200,300,400)) with n-1 = 129.099
+  auto ci = 1.96 * 129.09944487358058 / 2;
+  EXPECT_NEAR(Stats_sampler::get_ci95("sampler_test:cycles"), ci, 1e-6);
+
+  EXPECT_DOUBLE_EQ(Stats_sampler::get_mean("sampler_test:cpi"), 2.5);
+  EXPECT_NEAR(Stats_sampler::get_ci95("sampler_test:cpi"), ci / 100, 1e-8);
+}
+
+TEST_F(Stats_sampler_test, simpoint_weights) {
+  Stats_cntr inst("sampler_test:winst");
+
+  Stats_sampler::mark();
+  inst.add(10, true);
+  Stats_sampler::sample(0.75);
+
+  Stats_sampler::mark();
+  inst.add(50, true);
+  Stats_sampler::sample(0.25);
+
+  EXPECT_EQ(Stats_sampler::size(), 2);
+  EXPECT_DOUBLE_EQ(Stats_sampler::get_mean("sampler_test:winst"), 0.75 * 10 + 0.25 * 50);
+}
+
+class Stats_interval_test : public ::testing::Test {
+protected:
+  std::string file_name;
+
+  void SetUp() override { file_name = fmt::format("stats_interval_test_{}.bin", getpid()); }
+  void TearDown() override {
+    Stats_interval::close();
+    unlink(file_name.c_str());
+  }
+
+  static std::vector<std::string> lines(const std::string& txt) {
+    std::vector<std::string> v;
+    std::istringstream       in(txt);
+    std::string              l;
+    while (std::getline(in, l)) {
+      v.push_back(l);
+    }
+    return v;
+  }
+};
+
+TEST_F(Stats_interval_test, deltas_per_interval) {
+  Stats_cntr inst("interval_test:inst");
+  Stats_avg  occ("interval_test:occ");
+
+  ASSERT_TRUE(Stats_interval::open(file_name, 100));
+
+  // 150 snapshots, so more than one group
+  for (uint64_t clk = 1; clk <= 15000; ++clk) {
+    inst.inc(clk % 3 == 0);
+    occ.sample(clk > 7500 ? 0.5 : 2, true);
+    Stats_interval::tick(clk);
+  }
+
+  Stats_cntr late("interval_test:late");  // shows up in a new schema block
+  late.add(7, true);
+  inst.add(10, true);
+  Stats_interval::tick(15100);
+  Stats_interval::close();
+
+  std::ostringstream out;
+  ASSERT_TRUE(Stats_interval::to_csv(file_name, out, false));
+  auto csv = lines(out.str());
+  ASSERT_EQ(csv.size(), 152U);
+
+  // Columns of this test only, other tests may have left stats in the arena
+  std::vector<std::string> header;
+  {
+    std::istringstream in(csv[0]);
+    std::string        f;
+    while (std::getline(in, f, ',')) {
+      header.push_back(f);
+    }
+  }
+  auto col = [&](const std::string& row, const std::string& name) {
+    auto               idx = std::find(header.begin(), header.end(), name) - header.begin();
+    std::istringstream in(row);
+    std::string        f;
+    for (long i = 0; i <= idx; ++i) {
+      std::getline(in, f, ',');
+    }
+    return f;
+  };
+  ASSERT_EQ(header[0], "cycle");
+
+  EXPECT_EQ(col(csv[1], "cycle"), "100");
+  EXPECT_EQ(col(csv[1], "interval_test:inst"), "33");
+  EXPECT_EQ(col(csv[2], "interval_test:inst"), "33");
+  EXPECT_EQ(col(csv[3], "interval_test:inst"), "34");
+  EXPECT_EQ(col(csv[1], "interval_test:occ:n"), "100");
+  EXPECT_EQ(col(csv[1], "interval_test:occ:sum"), "200");
+  EXPECT_EQ(col(csv[100], "interval_test:occ:sum"), "50");
+  EXPECT_EQ(col(csv[1], "interval_test:late"), "");
+
+  EXPECT_EQ(col(csv[151], "cycle"), "15100");
+  EXPECT_EQ(col(csv[151], "interval_test:inst"), "10");
+  EXPECT_EQ(col(csv[151], "interval_test:late"), "7");
+
+  std::ostringstream cum;
+  ASSERT_TRUE(Stats_interval::to_csv(file_name, cum, true));
+  auto csv_cum = lines(cum.str());
+  EXPECT_EQ(col(csv_cum[150], "interval_test:inst"), "5000");
+  EXPECT_EQ(col(csv_cum[151], "interval_test:inst"), "5010");
+}
+
+TEST_F(Stats_interval_test, fractional_and_reset) {
+  Stats_cntr energy("interval_test:energy");
+
+  ASSERT_TRUE(Stats_interval::open(file_name, 10));
+  energy.add(0.25, true);
+  Stats_interval::tick(10);
+  energy.add(0.5, true);
+  Stats_interval::tick(25);  // one snapshot, next at 30
+  Stats_interval::tick(29);
+  Stats::reset_all();
+  energy.add(1, true);
+  Stats_interval::tick(30);
+  Stats_interval::close();
+
+  std::ostringstream out;
+  ASSERT_TRUE(Stats_interval::to_csv(file_name, out, true));
+  auto csv = lines(out.str());
+  ASSERT_EQ(csv.size(), 4U);
+  EXPECT_EQ(csv[1].substr(0, 3), "10,");
+  EXPECT_NE(csv[1].find(",0.25"), std::string::npos);
+  EXPECT_EQ(csv[2].substr(0, 3), "25,");
+  EXPECT_NE(csv[2].find(",0.75"), std::string::npos);
+  EXPECT_EQ(csv[3].substr(0, 3), "30,");
+
+  std::ostringstream bad;
+  EXPECT_FALSE(Stats_interval::to_csv("stats_interval_test_missing.bin", bad, false));
+}
+
+TEST_F(Stats_interval_test, only_named_slots) {
+  Stats_cntr cntr("interval_test:named");
+  Stats_hist hist("interval_test:hist", 64);  // 64 unnamed buckets
+
+  ASSERT_TRUE(Stats_interval::open(file_name, 10));
+  cntr.inc(true);
+  hist.sample(3, true);
+  Stats_interval::tick(10);
+  Stats_interval::close();
+
+  std::ostringstream out;
+  ASSERT_TRUE(Stats_interval::to_csv(file_name, out, true));
+  auto csv = lines(out.str());
+  ASSERT_EQ(csv.size(), 2U);
+
+  auto n_fields = [](const std::string& l) { return std::count(l.begin(), l.end(), ',') + 1; };
+  EXPECT_EQ(csv[0].find(",,"), std::string::npos);
+  EXPECT_EQ(n_fields(csv[0]), n_fields(csv[1]));
+  EXPECT_NE(csv[0].find(",interval_test:hist:n"), std::string::npos);
+  EXPECT_NE(csv[0].find(",interval_test:hist:sum"), std::string::npos);
+
+  // Without the buckets and the padding, the file is tiny
+  FILE* fp = fopen(file_name.c_str(), "rb");
+  ASSERT_NE(fp, nullptr);
+  fseek(fp, 0, SEEK_END);
+  EXPECT_LT(ftell(fp), 40 * n_fields(csv[0]));
+  fclose(fp);
+}
+
+class Stats_arena_test : public ::testing::Test {
+protected:
+  class Stats_probe : public Stats {
+  public:
+    Stats_probe(const std::string& str, size_t n) : Stats(str) {
+      std::vector<std::string> slot_names(n);
+      slot_names[0] = name;
+      arena_alloc(slot_names);
+      subscribe();
+    }
+    [[nodiscard]] uintptr_t addr() const { return reinterpret_cast<uintptr_t>(data); }
+    void                    report() const override {}
+  };
+};
+
+TEST_F(Stats_arena_test, blocks_stay_in_a_line) {
+  std::vector<std::unique_ptr<Stats_probe>> v;
+  for (int i = 0; i < 40; ++i) {
+    size_t n = (i % 5 == 4) ? 20 : 1 + (i % 5);
+    v.emplace_back(std::make_unique<Stats_probe>(fmt::format("arena_test:p{}", i), n));
+
+    auto a = v.back()->addr();
+    if (n > 8) {
+      EXPECT_EQ(a % 64, 0U) << i;
+    } else {
+      EXPECT_LE(a % 64 + n * sizeof(double), 64U) << i;
+    }
+  }
+}
+
+TEST_F(Stats_arena_test, hist_dense_and_overflow) {
+  Stats_hist h("arena_test:hist", 4);
+
+  h.sample(0, true);
+  h.sample(3, true, 2);
+  h.sample(4, true);   // first overflow key
+  h.sample(-1, true);  // negative keys overflow too
+  h.sample(1, false);
+
+  EXPECT_DOUBLE_EQ(h.get_count(0), 1);
+  EXPECT_DOUBLE_EQ(h.get_count(1), 0);
+  EXPECT_DOUBLE_EQ(h.get_count(3), 2);
+  EXPECT_DOUBLE_EQ(h.get_count(4), 1);
+  EXPECT_DOUBLE_EQ(h.get_count(-1), 1);
+  EXPECT_DOUBLE_EQ(h.get_samples(), 5);
+}
+
+TEST_F(Stats_arena_test, reset_all) {
+  Stats_cntr c("arena_test:cntr");
+  Stats_avg  a("arena_test:avg");
+  Stats_hist h("arena_test:hist2", 2);
+
+  c.add(5, true);
+  a.sample(3, true);
+  h.sample(1, true);
+  h.sample(100, true);
+
+  Stats::reset_all();
+
+  EXPECT_DOUBLE_EQ(c.getDouble(), 0);
+  EXPECT_DOUBLE_EQ(h.get_count(1), 0);
+  EXPECT_DOUBLE_EQ(h.get_count(100), 0);
+  EXPECT_DOUBLE_EQ(h.get_samples(), 0);
+
+  // Destruction order does not matter to the report list
+  {
+    Stats_cntr tmp("arena_test:tmp");
+  }
+  c.inc(true);
+  EXPECT_DOUBLE_EQ(c.getDouble(), 1);
+}
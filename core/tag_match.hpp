@@ -0,0 +1,108 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "iassert.hpp"
+
+// Compare a run of tags against one value. 64 bit tags are compared a vector
+// at a time (AVX2 4 lanes, SSE2/NEON 2 lanes), other sizes one by one.
+//
+//   tag_match_mask:  bit i set when tags[i] == tag, for sets of up to 64 ways
+//   tag_match_first: index of the first tags[i] == tag, or -1
+namespace tag_match {
+
+#if defined(__AVX2__)
+inline constexpr uint32_t lanes = 4;
+using Splat                     = __m256i;
+
+inline Splat splat(uint64_t tag) { return _mm256_set1_epi64x(static_cast<long long>(tag)); }
+
+inline uint32_t compare(const uint64_t* tags, Splat t) {
+  __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags));
+  return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, t))));
+}
+#elif defined(__SSE2__)
+inline constexpr uint32_t lanes = 2;
+using Splat                     = __m128i;
+
+inline Splat splat(uint64_t tag) { return _mm_set1_epi64x(static_cast<long long>(tag)); }
+
+inline uint32_t compare(const uint64_t* tags, Splat t) {
+  // No 64 bit compare in SSE2, both 32 bit halves must match
+  __m128i c = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tags)), t);
+  c         = _mm_and_si128(c, _mm_shuffle_epi32(c, 0xB1));
+  return static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(c)));
+}
+#elif defined(__ARM_NEON)
+inline constexpr uint32_t lanes = 2;
+using Splat                     = uint64x2_t;
+
+inline Splat splat(uint64_t tag) { return vdupq_n_u64(tag); }
+
+inline uint32_t compare(const uint64_t* tags, Splat t) {
+  uint64x2_t c = vceqq_u64(vld1q_u64(tags), t);
+  return static_cast<uint32_t>((vgetq_lane_u64(c, 0) & 1) | ((vgetq_lane_u64(c, 1) & 1) << 1));
+}
+#else
+inline constexpr uint32_t lanes = 1;
+using Splat                     = uint64_t;
+
+inline Splat    splat(uint64_t tag) { return tag; }
+inline uint32_t compare(const uint64_t* tags, Splat t) { return tags[0] == t; }
+#endif
+
+}  // namespace tag_match
+
+template <class Tag>
+uint64_t tag_match_mask(const Tag* tags, uint32_t n, std::type_identity_t<Tag> tag) {
+  I(n <= 64);
+  uint64_t mask = 0;
+  uint32_t w    = 0;
+
+  if constexpr (sizeof(Tag) == 8) {
+    const auto t = tag_match::splat(static_cast<uint64_t>(tag));
+    for (; w + tag_match::lanes <= n; w += tag_match::lanes) {
+      mask |= static_cast<uint64_t>(tag_match::compare(reinterpret_cast<const uint64_t*>(tags + w), t)) << w;
+    }
+  }
+
+  // Branch free for the leftover ways (or other tag sizes)
+  for (; w < n; ++w) {
+    mask |= static_cast<uint64_t>(tags[w] == tag) << w;
+  }
+
+  return mask;
+}
+
+template <class Tag>
+int32_t tag_match_first(const Tag* tags, uint32_t n, std::type_identity_t<Tag> tag) {
+  uint32_t w = 0;
+
+  if constexpr (sizeof(Tag) == 8) {
+    const auto t = tag_match::splat(static_cast<uint64_t>(tag));
+    for (; w + tag_match::lanes <= n; w += tag_match::lanes) {
+      auto m = tag_match::compare(reinterpret_cast<const uint64_t*>(tags + w), t);
+      if (m) {
+        return static_cast<int32_t>(w + std::countr_zero(m));
+      }
+    }
+  }
+
+  for (; w < n; ++w) {
+    if (tags[w] == tag) {
+      return static_cast<int32_t>(w);
+    }
+  }
+
+  return -1;
+}
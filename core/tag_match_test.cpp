@@ -0,0 +1,49 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "tag_match.hpp"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Every length covers the vector loop and the scalar leftovers
+TEST(Tag_match_test, mask_and_first_agree_with_scalar) {
+  for (uint32_t n = 1; n <= 64; ++n) {
+    std::vector<uint64_t> tags(n);
+    for (uint32_t i = 0; i < n; ++i) {
+      tags[i] = (i % 3 == 2) ? 0xdead'beef'0000'0042ULL : 0x1000 + i;
+    }
+
+    uint64_t ref_mask  = 0;
+    int32_t  ref_first = -1;
+    for (uint32_t i = 0; i < n; ++i) {
+      if (tags[i] == 0xdead'beef'0000'0042ULL) {
+        ref_mask |= 1ULL << i;
+        if (ref_first < 0) {
+          ref_first = static_cast<int32_t>(i);
+        }
+      }
+    }
+
+    EXPECT_EQ(tag_match_mask(tags.data(), n, 0xdead'beef'0000'0042ULL), ref_mask) << n;
+    EXPECT_EQ(tag_match_first(tags.data(), n, 0xdead'beef'0000'0042ULL), ref_first) << n;
+  }
+}
+
+// SSE2 compares 32 bit halves, a match on only one half is not a match
+TEST(Tag_match_test, half_match_is_a_miss) {
+  std::vector<uint64_t> tags = {0x0000'0001'0000'0042ULL, 0x0000'0042'0000'0001ULL, 0x0000'0042ULL, 0x1'0000'0042ULL};
+
+  EXPECT_EQ(tag_match_mask(tags.data(), 4, uint64_t{0x42}), 0b0100U);
+  EXPECT_EQ(tag_match_first(tags.data(), 4, uint64_t{0x42}), 2);
+  EXPECT_EQ(tag_match_first(tags.data(), 4, uint64_t{0x43}), -1);
+}
+
+// Other tag sizes take the scalar path
+TEST(Tag_match_test, narrow_tags) {
+  std::vector<uint32_t> tags = {7, 3, 7, 9, 7};
+
+  EXPECT_EQ(tag_match_mask(tags.data(), 5, 7U), 0b10101U);
+  EXPECT_EQ(tag_match_first(tags.data(), 5, 9U), 3);
+  EXPECT_EQ(tag_match_first(tags.data(), 0, 7U), -1);
+}
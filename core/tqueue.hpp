@@ -19,6 +19,8 @@ ESESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 */
 
+#pragma once
+
 #include <algorithm>
 #include <cstdlib>
 #include <vector>
@@ -186,6 +188,11 @@ public:
     }
 
     if (minTooFar <= cTime) {
+      if (nNodes == 0) {
+        // The clock jumped (idle-cycle skip), move the window before pulling the far jobs
+        minTime = cTime;
+        minPos  = 0;
+      }
       adjustTooFar();
     }
 
@@ -204,6 +211,9 @@ public:
     }
 
     if (node == nullptr) {
+      if (minTooFar <= cTime) {
+        return nextJob(cTime);  // the window reached cTime, the far jobs fit now
+      }
       return nullptr;
     }
 
@@ -286,6 +296,18 @@ public:
     insert(node, rTime);
   };
 
+  // Time of the earliest job without popping it (MaxTime if empty)
+  [[nodiscard]] Time nextTime() const {
+    if (nNodes) {
+      for (uint32_t i = 0; i < AccessSize; ++i) {
+        if (access[(minPos + i) & AccessMask]) {
+          return std::min<Time>(minTime + i, minTooFar);
+        }
+      }
+    }
+    return minTooFar;
+  };
+
   [[nodiscard]] size_t size() const noexcept { return nNodes + tooFar.size(); };
   [[nodiscard]] bool   empty() const noexcept { return nNodes == 0 && tooFar.empty(); };
 
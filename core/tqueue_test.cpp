@@ -0,0 +1,177 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "callback.hpp"  // STRICT_PRIORITY
+#include "gtest/gtest.h"
+#include "tqueue.hpp"
+#include "twheel.hpp"
+
+class Node : public TQueue<Node*, Time_t>::User {
+public:
+  Time_t   priority = 0;
+  uint32_t id       = 0;
+
+  [[nodiscard]] Time_t getPriority() const { return priority; }
+};
+
+using Event = std::pair<Time_t, Time_t>;  // (time, priority)
+
+// Runs the same insert stream through a queue and returns the pop order.
+// Latencies mix pipeline (1-20), memory (30-600) and far (beyond 64K) events.
+template <class Queue>
+static std::vector<Event> run_stream(Queue& q, uint32_t n_events, uint32_t seed) {
+  std::vector<std::unique_ptr<Node>> nodes;
+  std::vector<Event>                 popped;
+
+  std::mt19937 rnd(seed);
+  Time_t       clk = 0;
+
+  for (uint32_t i = 0; i < n_events; ++i) {
+    nodes.emplace_back(std::make_unique<Node>());
+    auto* node     = nodes.back().get();
+    node->id       = i;
+    node->priority = rnd() % 8;
+
+    auto   r   = rnd() % 100;
+    Time_t lat = 0;
+    if (r < 60) {
+      lat = 1 + rnd() % 20;
+    } else if (r < 95) {
+      lat = 30 + rnd() % 600;
+    } else {
+      lat = 70000 + rnd() % 20000;
+    }
+    q.insert(node, clk + lat);
+
+    if (rnd() % 2) {
+      clk++;
+      while (auto* done = q.nextJob(clk)) {
+        EXPECT_EQ(done->getTQTime(), clk);
+        popped.push_back({done->getTQTime(), done->priority});
+      }
+    }
+  }
+
+  while (!q.empty()) {
+    clk++;
+    while (auto* done = q.nextJob(clk)) {
+      EXPECT_EQ(done->getTQTime(), clk);
+      popped.push_back({done->getTQTime(), done->priority});
+    }
+  }
+
+  return popped;
+}
+
+TEST(TQueue_test, twheel_matches_tqueue) {
+  TQueue<Node*, Time_t> tq(256);
+  TWheel<Node*, Time_t> tw(256, 16);  // small level 1 to exercise the overflow heap
+
+  auto ref = run_stream(tq, 20000, 7);
+  auto out = run_stream(tw, 20000, 7);
+
+  ASSERT_EQ(ref.size(), 20000U);
+  EXPECT_EQ(ref, out);
+  EXPECT_TRUE(std::is_sorted(out.begin(), out.end()));
+}
+
+TEST(TQueue_test, twheel_fifo_for_equal_priority) {
+  TWheel<Node*, Time_t> tw(8, 4);
+
+  std::vector<Node> nodes(6);
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    nodes[i].id       = i;
+    nodes[i].priority = (i == 2 || i == 4) ? 0 : 1;
+    tw.insert(&nodes[i], 20);  // level 1 bucket, cascaded later
+  }
+
+  std::vector<uint32_t> order;
+  for (Time_t clk = 1; clk <= 20; ++clk) {
+    while (auto* done = tw.nextJob(clk)) {
+      order.push_back(done->id);
+    }
+  }
+
+  EXPECT_EQ(order, (std::vector<uint32_t>{2, 4, 0, 1, 3, 5}));
+  EXPECT_TRUE(tw.empty());
+}
+
+TEST(TQueue_test, twheel_remove_from_every_level) {
+  TWheel<Node*, Time_t> tw(8, 4);
+
+  std::vector<Node> nodes(6);
+  Time_t            when[] = {3, 5, 12, 20, 100, 200};  // level 0, level 1, heap
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    nodes[i].id = i;
+    tw.insert(&nodes[i], when[i]);
+  }
+  EXPECT_EQ(tw.size(), 6U);
+
+  tw.remove(&nodes[1]);
+  tw.remove(&nodes[3]);
+  tw.remove(&nodes[5]);
+  EXPECT_EQ(tw.size(), 3U);
+  EXPECT_FALSE(nodes[5].isInQueue());
+
+  std::vector<uint32_t> order;
+  for (Time_t clk = 1; clk <= 256; ++clk) {
+    while (auto* done = tw.nextJob(clk)) {
+      EXPECT_EQ(done->getTQTime(), clk);
+      order.push_back(done->id);
+    }
+  }
+
+  EXPECT_EQ(order, (std::vector<uint32_t>{0, 2, 4}));
+  EXPECT_TRUE(tw.empty());
+}
+
+// Jumps the clock to nextTime like the idle-cycle skip does, every pop must
+// land exactly on it and nothing may be left behind
+template <class Queue>
+static void jump_stream(Queue& q, uint32_t seed) {
+  std::vector<std::unique_ptr<Node>> nodes;
+  std::mt19937                       rnd(seed);
+  Time_t                             clk = 0;
+
+  EXPECT_EQ(q.nextTime(), MaxTime);
+  for (uint32_t i = 0; i < 4000; ++i) {
+    nodes.emplace_back(std::make_unique<Node>());
+    auto   r   = rnd() % 100;
+    Time_t lat = r < 50 ? 1 + rnd() % 20 : (r < 95 ? 30 + rnd() % 600 : 70000 + rnd() % 20000);
+    q.insert(nodes.back().get(), clk + lat);
+
+    if (rnd() % 3 == 0) {
+      auto t = q.nextTime();
+      ASSERT_GT(t, clk);
+      EXPECT_EQ(q.nextJob(t - 1), nullptr);
+      clk      = t;
+      auto* ev = q.nextJob(clk);
+      ASSERT_NE(ev, nullptr);
+      EXPECT_EQ(ev->getTQTime(), clk);
+      while (q.nextJob(clk)) {
+      }
+    }
+  }
+
+  while (!q.empty()) {
+    clk = q.nextTime();
+    ASSERT_NE(q.nextJob(clk), nullptr);
+    while (q.nextJob(clk)) {
+    }
+  }
+  EXPECT_EQ(q.nextTime(), MaxTime);
+}
+
+TEST(TQueue_test, next_time_for_idle_skip) {
+  TQueue<Node*, Time_t> tq(256);
+  TWheel<Node*, Time_t> tw(256, 16);
+
+  jump_stream(tq, 3);
+  jump_stream(tw, 3);
+}
@@ -0,0 +1,371 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "fmt/format.h"
+#include "iassert.hpp"
+#include "tqueue.hpp"
+
+// Two level timing wheel with the same interface as TQueue.
+//
+// Level 0 has one bucket per cycle for the current block of L0Size cycles.
+// Level 1 has one bucket per block for the next L1Size blocks. Events beyond
+// that horizon (L0Size*L1Size cycles) go to an overflow heap. Inserting into
+// any wheel level is O(1); a level 1 bucket is moved to level 0 when its block
+// starts, and the heap refills level 1 at the same point, so each event is
+// moved at most twice.
+//
+// With STRICT_PRIORITY, buckets are appended in O(1) and only flagged when an
+// event arrives out of priority order. A flagged bucket is stable sorted once
+// when it is first popped, which keeps the FIFO order of equal priorities
+// (same result as TQueue's ordered insert, without a walk on every insert).
+template <class Data, class Time>
+class TWheel {
+public:
+  using User = typename TQueue<Data, Time>::User;
+
+private:
+  struct Bucket {
+    Data head     = nullptr;
+    Data tail     = nullptr;
+    bool unsorted = false;
+  };
+
+  const uint32_t L0Bits;
+  const uint32_t L0Size;
+  const uint32_t L0Mask;
+  const uint32_t L1Size;
+  const uint32_t L1Mask;
+
+  Time     minTime;  // All level 0 events are in [minTime, end of minTime block)
+  uint32_t minPos;
+
+  int32_t nNodes;  // level 0
+  int32_t nWheel;  // level 1
+
+  std::vector<Bucket> level0;
+  std::vector<Bucket> level1;
+
+  class DLess {
+  public:
+    bool operator()(const Data x, const Data y) const { return x->getTQTime() > y->getTQTime(); };
+  } dLess;
+
+  std::vector<Data> tooFar;
+
+  [[nodiscard]] Time block_of(Time t) const { return t >> L0Bits; }
+
+  static void append(Bucket& b, Data node) {
+    node->setTQNext(nullptr);
+    if (b.head == nullptr) {
+      b.head = node;
+    } else {
+#ifdef STRICT_PRIORITY
+      if (b.tail->getPriority() > node->getPriority()) {
+        b.unsorted = true;
+      }
+#endif
+      b.tail->setTQNext(node);
+    }
+    b.tail = node;
+  }
+
+  static bool unlink(Bucket& b, Data node) {
+    Data prev = nullptr;
+    Data curr = b.head;
+    while (curr && curr != node) {
+      prev = curr;
+      curr = curr->getTQNext();
+    }
+    if (curr == nullptr) {
+      return false;
+    }
+    if (prev == nullptr) {
+      b.head = curr->getTQNext();
+    } else {
+      prev->setTQNext(curr->getTQNext());
+    }
+    if (b.tail == node) {
+      b.tail = prev;
+    }
+    return true;
+  }
+
+  void sort_bucket(Bucket& b) {
+    // Stable insertion sort on the list. Buckets are short and mostly in
+    // order, so this beats copying to a vector and std::stable_sort.
+    Data node = b.head;
+    b         = Bucket{};
+    while (node) {
+      Data next = node->getTQNext();
+      if (b.tail == nullptr || b.tail->getPriority() <= node->getPriority()) {
+        append(b, node);
+      } else {
+        Data prev = nullptr;
+        Data cur  = b.head;
+        while (cur->getPriority() <= node->getPriority()) {
+          prev = cur;
+          cur  = cur->getTQNext();
+        }
+        node->setTQNext(cur);
+        if (prev == nullptr) {
+          b.head = node;
+        } else {
+          prev->setTQNext(node);
+        }
+      }
+      node = next;
+    }
+  }
+
+  void add_level0(Data node) {
+    I(block_of(node->getTQTime()) == block_of(minTime));
+    append(level0[node->getTQTime() & L0Mask], node);
+    node->setInFastQueue();
+    nNodes++;
+  }
+
+  void add_level1(Data node) {
+    append(level1[block_of(node->getTQTime()) & L1Mask], node);
+    node->setInFastQueue();
+    nWheel++;
+  }
+
+  // minTime just entered a new block: move its level 1 bucket to level 0, then
+  // pull the heap events that are now within the horizon
+  void cascade() {
+    I((minTime & L0Mask) == 0);
+    I(nNodes == 0);
+
+    auto blk = block_of(minTime);
+
+    auto& b    = level1[blk & L1Mask];
+    Data  node = b.head;
+    b          = Bucket{};
+    while (node) {
+      auto next = node->getTQNext();
+      nWheel--;
+      node->removeFromQueue();
+      add_level0(node);
+      node = next;
+    }
+
+    while (!tooFar.empty() && block_of(tooFar.front()->getTQTime()) - blk <= L1Size) {
+      node = tooFar.front();
+      std::pop_heap(tooFar.begin(), tooFar.end(), dLess);
+      tooFar.pop_back();
+
+      node->removeFromQueue();
+      if (block_of(node->getTQTime()) == blk) {
+        add_level0(node);
+      } else {
+        add_level1(node);
+      }
+    }
+  }
+
+  Data pop(Bucket& b) {
+    I(nNodes);
+    Data node = b.head;
+    b.head    = node->getTQNext();
+    if (b.head == nullptr) {
+      b.tail = nullptr;
+    }
+    nNodes--;
+    node->removeFromQueue();
+    return node;
+  }
+
+public:
+  TWheel(uint32_t Level0Size, uint32_t Level1Size);
+  ~TWheel();
+
+  void reset();
+
+  void insert(Data data, Time time) {
+    I(!data->isInQueue());
+    I(time >= minTime);
+
+    data->setTQTime(time);
+
+    auto dist = block_of(time) - block_of(minTime);
+    if (dist == 0) {
+      add_level0(data);
+    } else if (dist <= L1Size) {
+      add_level1(data);
+    } else {
+      data->setInTooFarQueue();
+
+      tooFar.push_back(data);
+      std::push_heap(tooFar.begin(), tooFar.end(), dLess);
+    }
+  };
+
+  Data nextJob(Time cTime) {
+    {
+      auto& b = level0[minPos];
+      if (likely(b.head && minTime == cTime && !b.unsorted)) {
+        /* Common case. Only for speed up reasons */
+        return pop(b);
+      }
+    }
+
+    while (true) {
+      auto& b = level0[minPos];
+      if (b.head) {
+        if (b.unsorted) {
+          sort_bucket(b);
+        }
+        return pop(b);
+      }
+
+      if (minTime >= cTime) {
+        return nullptr;
+      }
+
+      if (nNodes) {
+        // Level 0 events never cross the block end
+        minTime++;
+        minPos = (minPos + 1) & L0Mask;
+        continue;
+      }
+
+      Time nextBlock = (minTime | L0Mask) + 1;
+      if (nWheel == 0) {
+        if (tooFar.empty()) {
+          minTime = cTime;
+          minPos  = cTime & L0Mask;
+          return nullptr;
+        }
+        nextBlock = std::max(nextBlock, tooFar.front()->getTQTime() & ~static_cast<Time>(L0Mask));
+      }
+      if (nextBlock > cTime) {
+        I(block_of(cTime) == block_of(minTime) || nWheel == 0);
+        minTime = cTime;
+        minPos  = cTime & L0Mask;
+        return nullptr;
+      }
+
+      minTime = nextBlock;
+      minPos  = 0;
+      cascade();
+    }
+  };
+
+  void remove(Data node) {
+    if (node->isInTooFarQueue()) {
+      auto it = std::find(tooFar.begin(), tooFar.end(), node);
+
+      I(it != tooFar.end());
+      tooFar.erase(it);
+      std::make_heap(tooFar.begin(), tooFar.end(), dLess);
+    } else if (node->isInFastQueue()) {
+      Time t = node->getTQTime();
+      if (block_of(t) == block_of(minTime)) {
+        [[maybe_unused]] bool found = unlink(level0[t & L0Mask], node);
+        I(found);
+        nNodes--;
+      } else {
+        [[maybe_unused]] bool found = unlink(level1[block_of(t) & L1Mask], node);
+        I(found);
+        nWheel--;
+      }
+    } else {
+      I(!node->isInQueue());
+    }
+    node->removeFromQueue();
+  };
+
+  void reschedule(Data node, Time rTime) {
+    remove(node);
+
+    I(!node->isInQueue());
+
+    insert(node, rTime);
+  };
+
+  // Time of the earliest event without popping it (MaxTime if empty)
+  [[nodiscard]] Time nextTime() const {
+    if (nNodes) {
+      for (uint32_t pos = minPos; pos < L0Size; ++pos) {
+        if (level0[pos].head) {
+          return (minTime & ~static_cast<Time>(L0Mask)) + pos;
+        }
+      }
+    }
+
+    Time t = tooFar.empty() ? static_cast<Time>(MaxTime) : tooFar.front()->getTQTime();
+    if (nWheel) {
+      // level 1 buckets are not sorted, the first non empty block is walked
+      auto blk = block_of(minTime);
+      for (uint32_t d = 1; d <= L1Size; ++d) {
+        const auto& b = level1[(blk + d) & L1Mask];
+        if (b.head == nullptr) {
+          continue;
+        }
+        for (Data node = b.head; node; node = node->getTQNext()) {
+          t = std::min(t, node->getTQTime());
+        }
+        break;
+      }
+    }
+    return t;
+  };
+
+  [[nodiscard]] size_t size() const noexcept { return nNodes + nWheel + tooFar.size(); };
+  [[nodiscard]] bool   empty() const noexcept { return nNodes == 0 && nWheel == 0 && tooFar.empty(); };
+
+  void dump();
+};
+
+template <class Data, class Time>
+TWheel<Data, Time>::TWheel(uint32_t Level0Size, uint32_t Level1Size)
+    : L0Bits(log2i(Level0Size))
+    , L0Size(Level0Size)
+    , L0Mask(Level0Size - 1)
+    , L1Size(Level1Size)
+    , L1Mask(Level1Size - 1)
+    , level0(Level0Size)
+    , level1(Level1Size) {
+  I(L0Size > 7);
+  I((L0Size & (L0Size - 1)) == 0);
+  I(L1Size > 1);
+  I((L1Size & (L1Size - 1)) == 0);
+
+  reset();
+}
+
+template <class Data, class Time>
+void TWheel<Data, Time>::reset() {
+  std::fill(level0.begin(), level0.end(), Bucket{});
+  std::fill(level1.begin(), level1.end(), Bucket{});
+  tooFar.clear();
+
+  nNodes  = 0;
+  nWheel  = 0;
+  minTime = 0;
+  minPos  = 0;
+}
+
+template <class Data, class Time>
+TWheel<Data, Time>::~TWheel() {
+  if (!empty()) {
+    fmt::print("Destroying TWheel {} with pending nodes\n", size());
+  }
+}
+
+template <class Data, class Time>
+void TWheel<Data, Time>::dump() {
+  fmt::print("TWheel dump: size={} level0={} level1={} tooFar={}\n", size(), nNodes, nWheel, tooFar.size());
+
+  for (uint32_t i = 0; i < L0Size; ++i) {
+    for (Data node = level0[(minPos + i) & L0Mask].head; node; node = node->getTQNext()) {
+      fmt::print(" {} @ {} ", fmt::ptr(node), node->getTQTime());
+    }
+  }
+  fmt::print("\n");
+}
@@ -0,0 +1,30 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "decode_cache.hpp"
+
+#include <algorithm>
+
+#include "emul_dromajo.hpp"
+#include "snippets.hpp"
+
+Decode_cache::Decode_cache(Hartid_t fid, const std::string& sec, uint32_t size)
+    : entries(roundUpPower2(std::max<uint32_t>(size, 2)),
+              {0, false, Instruction(Opcode::iOpInvalid, LREG_ZERO, LREG_ZERO, LREG_ZERO, LREG_ZERO)})
+    , bits(log2i(entries.size()))
+    , hits(fmt::format("P({})_{}:decode_hit", fid, sec))
+    , misses(fmt::format("P({})_{}:decode_miss", fid, sec)) {}
+
+const Instruction& Decode_cache::lookup(uint32_t insn_raw, bool& hit) {
+  // Fibonacci hash: compressed encodings only use the low 16 bits
+  auto  pos = (insn_raw * 0x9E3779B1u) >> (32 - bits);
+  auto& e   = entries[pos];
+
+  hit = e.valid && e.insn_raw == insn_raw;
+  if (!hit) {
+    e.insn_raw = insn_raw;
+    e.valid    = true;
+    e.inst     = Emul_dromajo::decode(insn_raw);
+  }
+
+  return e.inst;
+}
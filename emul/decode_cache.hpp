@@ -0,0 +1,44 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "instruction.hpp"
+#include "opcode.hpp"
+#include "stats.hpp"
+
+// Direct mapped cache of Emul_dromajo::decode() results, indexed by a hash of
+// insn_raw. Hot loops reuse a few hundred encodings, so most peeks skip the
+// switch. One per hart, shared by Emul_dromajo and Emul_trace.
+class Decode_cache {
+private:
+  struct Entry {
+    uint32_t    insn_raw;
+    bool        valid;
+    Instruction inst;
+  };
+  std::vector<Entry> entries;
+  uint32_t           bits;
+
+  Stats_cntr hits;
+  Stats_cntr misses;
+
+public:
+  // size is rounded up to a power of two, at least 2
+  Decode_cache(Hartid_t fid, const std::string& sec, uint32_t size);
+
+  // No stats here: lookup may run ahead in another thread, the consumer of the
+  // instruction calls count()
+  const Instruction& lookup(uint32_t insn_raw, bool& hit);
+
+  void count(bool hit) {
+    if (hit) {
+      hits.inc();
+    } else {
+      misses.inc();
+    }
+  }
+};
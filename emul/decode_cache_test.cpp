@@ -0,0 +1,42 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "decode_cache.hpp"
+
+#include "emul_dromajo.hpp"
+#include "gtest/gtest.h"
+
+// A repeated encoding hits and decodes like Emul_dromajo::decode
+TEST(Decode_cache_test, hit_after_miss) {
+  Decode_cache dc(0, "decode_cache_test", 16);
+
+  for (uint32_t insn_raw : {0x0505u, 0x0005b503u, 0xfe050de3u, 0x00a5b023u}) {
+    bool hit  = true;
+    auto inst = dc.lookup(insn_raw, hit);
+    EXPECT_FALSE(hit);
+
+    auto ref = Emul_dromajo::decode(insn_raw);
+    EXPECT_EQ(inst.getOpcode(), ref.getOpcode());
+    EXPECT_EQ(inst.getSrc1(), ref.getSrc1());
+    EXPECT_EQ(inst.getDst1(), ref.getDst1());
+
+    dc.lookup(insn_raw, hit);
+    EXPECT_TRUE(hit);
+  }
+}
+
+// Two entries: conflicting encodings evict each other
+TEST(Decode_cache_test, conflicts_miss) {
+  Decode_cache dc(0, "decode_cache_conflict", 1);
+
+  bool     hit = false;
+  uint32_t a   = 0x0505;
+  uint32_t b   = a + 1;
+  while (((a * 0x9E3779B1u) >> 31) != ((b * 0x9E3779B1u) >> 31)) {
+    ++b;
+  }
+  dc.lookup(a, hit);
+  dc.lookup(b, hit);
+  EXPECT_FALSE(hit);
+  dc.lookup(a, hit);
+  EXPECT_FALSE(hit);
+}
@@ -9,7 +9,7 @@
 #include "iassert.hpp"
 #include "tracer.hpp"
 
-pool<Dinst> Dinst::dInstPool(32768, "Dinst");  // 4 * tsfifo size
+thread_local pool<Dinst> Dinst::dInstPool(32768, "Dinst");  // 4 * tsfifo size
 
 Dinst::Dinst()
     : inst(Instruction(Opcode::iOpInvalid, RegType::LREG_R0, RegType::LREG_R0, RegType::LREG_InvalidOutput,
@@ -25,7 +25,7 @@ void Dinst::dump(std::string_view str) {
              str,
              fid,
              (long long)ID,
-             keep_stats ? 't' : 'd',
+             has_stats() ? 't' : 'd',
              (long long)pc,
              (long long)addr,
              (int)(inst.getSrc1()),
@@ -64,18 +64,18 @@ void Dinst::dump(std::string_view str) {
     fmt::print("    na");
   }
 
-  if (performed) {
+  if (isPerformed()) {
     fmt::print(" performed");
-  } else if (executing) {
+  } else if (isExecuting()) {
     fmt::print(" executing");
-  } else if (executed) {
+  } else if (isExecuted()) {
     fmt::print(" executed");
-  } else if (issued) {
+  } else if (isIssued()) {
     fmt::print(" issued");
   } else {
     fmt::print(" non-issued");
   }
-  if (replay) {
+  if (isReplay()) {
     fmt::print(" REPLAY ");
   }
 
@@ -171,11 +171,16 @@ DataSign Dinst::calcDataSign(int64_t _data) {
 }
 
 void Dinst::setDataSign(int64_t _data, Addr_t _ldpc) {
-  ldpc      = _ldpc;
-  data_sign = calcDataSign(_data);
+  auto& rec     = trace_rec();
+  rec.ldpc      = _ldpc;
+  rec.data_sign = calcDataSign(_data);
 }
 
 void Dinst::addDataSign(int ds, int64_t _data, Addr_t _ldpc) {
+  auto& ldpc      = trace_rec().ldpc;
+  auto& data      = trace_rec().data;
+  auto& data_sign = trace_rec().data_sign;
+
   ldpc = (ldpc << 4) ^ _ldpc;
 
   if (ds == 0) {
@@ -211,8 +216,8 @@ void Dinst::scrap() {
 void Dinst::destroy() {
   I(nDeps == 0);
 
-  I(issued);
-  I(executed);
+  I(isIssued());
+  I(isExecuted());
 
   I(first == nullptr);
 
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <memory>
 
@@ -104,79 +105,20 @@ enum DataSign {
   DS_OPos   = 40
 };
 
-class Dinst {
-private:
-  // In a typical RISC processor MAX_PENDING_SOURCES should be 2
-  static const int32_t MAX_PENDING_SOURCES = 3;
 
-  static pool<Dinst> dInstPool;
-
-  DinstNext  pend[MAX_PENDING_SOURCES];
-  DinstNext* last;
-  DinstNext* first;
-
-  Hartid_t fid;
-
-  // BEGIN Boolean flags
-  Time_t fetched;
+// Fields only read by stats, wavesnap, debug dumps, and the ESESC_TRACE_DATA
+// predictors. Allocated the first time a pooled Dinst needs it and kept with
+// the Dinst across reuses, so the pipeline never touches it for warmup or
+// no-stats instructions.
+class Dinst_cold {
+public:
   Time_t renamed;
   Time_t issued;
   Time_t executing;
-  Time_t executed;
 
-  bool branchMiss;
-  bool use_level3;
-  bool branch_hit2_miss3;
-  bool branch_hit3_miss2;
-  bool branchHit_level1;
-  bool branchHit_level2;
-  bool branchHit_level3;
-  bool branchMiss_level1;
-  bool branchMiss_level2;
-  bool branchMiss_level3;
-  bool level3_NoPrediction;
-
-  bool retired;
-  bool loadForwarded;
-  bool replay;
-  bool performed;
-
-  bool interCluster;
-  bool keep_stats;
-  bool biasBranch;
-  bool imli_highconf;
-
-  bool prefetch;
-  bool dispatched;
-  bool fullMiss;
-  bool speculative;
-  bool transient;
-  bool del_entry;
-  bool is_rrob;
-  bool present_in_rob;
-  bool present_in_scb;
-  bool in_cluster;
-
-  bool flush_transient;
-  bool try_flush_transient;
-  bool to_be_destroyed;
-  bool to_be_load_destroyed;
-  bool load_destroyed_retired_spec;
-  bool load_destroyed_retired_safe_write;
-  bool load_destroyed_performed_spec;
-  bool load_destroyed_performed_safe_write;
-  bool destroy_transient;
-  bool to_be_load_scb_all;
-  bool write_scb_r;
-  // END Boolean flags
-
-  SSID_t      SSID;
-  Addr_t      conflictStorePC;
-  Instruction inst;
-  Addr_t      pc;
-  Addr_t      addr;
-  uint64_t    inflight;
-  int16_t     bb;
+#ifndef NDEBUG
+  uint64_t mreq_id;
+#endif
 
 #ifdef ESESC_TRACE_DATA
   Addr_t   ldpc;
@@ -199,7 +141,137 @@ private:
   bool     br_ld_chain;
 #endif
 
-    std::shared_ptr<Cluster>      cluster;
+  void reset() {
+    renamed   = 0;
+    issued    = 0;
+    executing = 0;
+#ifndef NDEBUG
+    mreq_id = 0;
+#endif
+#ifdef ESESC_TRACE_DATA
+    data           = 0;
+    data2          = 0;
+    br_data1       = 0;
+    br_data2       = 0;
+    ld_br_type     = 0;
+    dep_depth      = 0;
+    ldpc           = 0;
+    ld_addr        = 0;
+    base_pref_addr = 0;
+    data_sign      = DS_NoData;
+    chained        = 0;
+    brpc           = 0;
+    delta          = 0;
+    br_ld_chain    = false;
+    br_op_type     = -1;
+#endif
+  }
+};
+
+class Dinst {
+private:
+  // In a typical RISC processor MAX_PENDING_SOURCES should be 2
+  static const int32_t MAX_PENDING_SOURCES = 3;
+
+  static thread_local pool<Dinst> dInstPool;  // per Clock_domain thread
+
+  // Every create fills a cold record (stats off too), set by the tracer.
+  // Read by every Clock_domain thread in Dinst::create.
+#ifdef ESESC_TRACE_DATA
+  static inline std::atomic<bool> cold_all{true};
+#else
+  static inline std::atomic<bool> cold_all{false};
+#endif
+
+  // One bit each in flags
+  enum Flag : uint8_t {
+    f_branchMiss,
+    f_use_level3,
+    f_branch_hit2_miss3,
+    f_branch_hit3_miss2,
+    f_branchHit_level1,
+    f_branchHit_level2,
+    f_branchHit_level3,
+    f_branchMiss_level1,
+    f_branchMiss_level2,
+    f_branchMiss_level3,
+    f_level3_NoPrediction,
+
+    f_retired,
+    f_loadForwarded,
+    f_replay,
+    f_performed,
+
+    f_interCluster,
+    f_keep_stats,
+    f_biasBranch,
+    f_imli_highconf,
+
+    f_prefetch,
+    f_dispatched,
+    f_fullMiss,
+    f_speculative,
+    f_transient,
+    f_del_entry,
+    f_is_rrob,
+    f_present_in_rob,
+    f_present_in_scb,
+    f_in_cluster,
+
+    f_flush_transient,
+    f_try_flush_transient,
+    f_to_be_destroyed,
+    f_to_be_load_destroyed,
+    f_load_destroyed_retired_spec,
+    f_load_destroyed_retired_safe_write,
+    f_load_destroyed_performed_spec,
+    f_load_destroyed_performed_safe_write,
+    f_destroy_transient,
+    f_to_be_load_scb_all,
+    f_write_scb_r,
+
+    // Stage reached, the times are in the cold record
+    f_renamed,
+    f_issued,
+    f_executing,
+
+    f_cold,  // cold record valid for this instruction
+
+    // First and last instruction of a timed sampling interval
+    f_sample_begin,
+    f_sample_end,
+
+    f_last
+  };
+  static_assert(f_last <= 64);
+
+  // Hot record: dependence wakeup first, then the fields every stage reads
+  DinstNext  pend[MAX_PENDING_SOURCES];
+  DinstNext* last;
+  DinstNext* first;
+
+  uint64_t flags;
+
+  Time_t fetched;
+  Time_t executed;
+
+  // static ID, increased every create (currentID). pointer
+  // static ID, increased every Non_Transient create (currentID). pointer
+  Time_t ID;
+  Time_t original_id;
+
+  Instruction inst;
+  SSID_t      SSID;
+  Hartid_t    fid;
+  int16_t     bb;
+  char        nDeps;
+
+  Addr_t   pc;
+  Addr_t   addr;
+  Addr_t   conflictStorePC;
+  uint64_t inflight;
+
+  std::shared_ptr<Cluster>      cluster;
   std::shared_ptr<Resource>     resource;
   std::shared_ptr<Store_buffer> scb;
   Dinst**                       RAT1Entry;
@@ -208,26 +280,23 @@ private:
   FetchEngine*                  fetch;
   GProcessor*                   gproc;
 
-  char nDeps;
+  std::unique_ptr<Dinst_cold> cold;
 
-  static inline Time_t currentID           = 0;
-  static inline Time_t current_original_id = 0;
-  static inline Time_t currentID_trans     = 1000000;
+  static inline thread_local Time_t currentID           = 0;
+  static inline thread_local Time_t current_original_id = 0;
+  static inline thread_local Time_t currentID_trans     = 1000000;
 
-  // static ID, increased every create (currentID). pointer
-  // static ID, increased every Non_Transient create (currentID). pointer
-  Time_t ID;
-  Time_t original_id;
+  [[nodiscard]] bool has_flag(Flag f) const { return (flags >> f) & 1; }
+  void               set_flag(Flag f) { flags |= (1ULL << f); }
+  void               set_flag(Flag f, bool v) { flags = (flags & ~(1ULL << f)) | (static_cast<uint64_t>(v) << f); }
+  void               clear_flag(Flag f) { flags &= ~(1ULL << f); }
 
-#ifndef NDEBUG
-  uint64_t mreq_id;
-#endif
-  void setup() {
+  void setup(bool keep_stats) {
     ID = currentID++;
-#ifndef NDEBUG
-    mreq_id = 0;
-#endif
+
     first = nullptr;
+    last  = nullptr;
+    nDeps = 0;
 
     RAT1Entry      = nullptr;
     RAT2Entry      = nullptr;
@@ -241,55 +310,17 @@ private:
     SSID            = -1;
     conflictStorePC = 0;
 
-    branchMiss          = false;
-    use_level3          = false;
-    branch_hit2_miss3   = false;
-    branch_hit3_miss2   = false;
-    branchHit_level1    = false;
-    branchHit_level2    = false;
-    branchHit_level3    = false;
-    branchMiss_level1   = false;
-    branchMiss_level2   = false;
-    branchMiss_level3   = false;
-    level3_NoPrediction = false;
-
-    fetched   = 0;
-    renamed   = 0;
-    issued    = 0;
-    executing = 0;
-    executed  = 0;
-
-    retired       = false;
-    loadForwarded = false;
-    replay        = false;
-    performed     = false;
-
-    interCluster  = false;
-    biasBranch    = false;
-    imli_highconf = false;
-
-    prefetch       = false;
-    dispatched     = false;
-    fullMiss       = false;
-    speculative    = true;
-    transient      = false;
-    del_entry      = false;
-    is_rrob        = false;
-    present_in_rob = false;
-    present_in_rob = false;
-    in_cluster     = false;
-
-    flush_transient                     = false;
-    try_flush_transient                 = false;
-    to_be_destroyed                     = false;
-    to_be_load_destroyed                = false;
-    load_destroyed_retired_spec         = false;
-    load_destroyed_retired_safe_write   = false;
-    load_destroyed_performed_spec       = false;
-    load_destroyed_performed_safe_write = false;
-    destroy_transient                   = false;
-    to_be_load_scb_all                  = false;
-    write_scb_r                         = false;
+    fetched  = 0;
+    executed = 0;
+
+    flags = (1ULL << f_speculative) | (static_cast<uint64_t>(keep_stats) << f_keep_stats);
+    if (keep_stats || cold_all.load(std::memory_order_relaxed)) {
+      if (!cold) {
+        cold = std::make_unique<Dinst_cold>();
+      }
+      cold->reset();
+      set_flag(f_cold);
+    }
 
 #ifdef DINST_PARENT
     pend[0].setParentDinst(nullptr);
@@ -297,9 +328,6 @@ private:
     pend[2].setParentDinst(nullptr);
 #endif
 
-    last  = nullptr;
-    nDeps = 0;
-
     pend[0].isUsed = false;
     pend[1].isUsed = false;
     pend[2].isUsed = false;
@@ -309,87 +337,98 @@ private:
     pend[2].setNextDep(nullptr);
   }
 
+  // Cold time for a stage, 0 when the record is not kept
+  [[nodiscard]] Time_t cold_time(Time_t Dinst_cold::* t) const { return has_flag(f_cold) ? (*cold).*t : 0; }
+  void                 mark_cold_time(Time_t Dinst_cold::* t) {
+    if (has_flag(f_cold)) {
+      (*cold).*t = globalClock;
+    }
+  }
+
 protected:
 public:
   Dinst();
 
+  // Instructions created from now on fill the cold record even without stats
+  static void keep_cold(bool all) { cold_all.store(all, std::memory_order_relaxed); }
+
   // bool is_safe() const { return !speculative; }
   // bool is_spec() const { return speculative; }
-  void set_safe() { speculative = false; }
-  void set_spec() { speculative = true; }
+  void set_safe() { clear_flag(f_speculative); }
+  void set_spec() { set_flag(f_speculative); }
 
   // bool isTransient() const { return transient; }
   void set_original_id() {
-    I(!transient);
+    I(!has_flag(f_transient));
     original_id = current_original_id++;
   }
 
   void setTransient() {
-    transient = true;
+    set_flag(f_transient);
     // ID = currentID_trans++;
   }
   void mark_to_be_destroyed() {
-    to_be_destroyed = true;
+    set_flag(f_to_be_destroyed);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
   void set_to_be_load_destroyed() {
-    to_be_load_destroyed = true;
+    set_flag(f_to_be_load_destroyed);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
   void clear_to_be_destroyed() {
-    to_be_destroyed = false;
+    clear_flag(f_to_be_destroyed);
     // printf("Clearing is_to_be_destroyed_transient to false ::dinst %ld\n", ID);
   }
 
-  void set_write_scb_r() { write_scb_r = true; }
-  bool is_write_scb_r() { return write_scb_r; }
+  void set_write_scb_r() { set_flag(f_write_scb_r); }
+  bool is_write_scb_r() { return has_flag(f_write_scb_r); }
   void set_load_destroyed_retired_spec() {
-    load_destroyed_retired_spec = true;
+    set_flag(f_load_destroyed_retired_spec);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
   bool is_load_destroyed_retired_spec() {
-    return load_destroyed_retired_spec;
+    return has_flag(f_load_destroyed_retired_spec);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
 
   void set_load_destroyed_retired_safe_write() {
-    load_destroyed_retired_safe_write = true;
+    set_flag(f_load_destroyed_retired_safe_write);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
   bool is_load_destroyed_retired_safe_write() {
-    return load_destroyed_retired_safe_write;
+    return has_flag(f_load_destroyed_retired_safe_write);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
 
   void set_load_destroyed_performed_spec() {
-    load_destroyed_performed_spec = true;
+    set_flag(f_load_destroyed_performed_spec);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
 
   bool is_load_destroyed_performed_spec() {
-    return load_destroyed_performed_spec;
+    return has_flag(f_load_destroyed_performed_spec);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
 
   void set_load_destroyed_performed_safe_write() {
-    load_destroyed_performed_safe_write = true;
+    set_flag(f_load_destroyed_performed_safe_write);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
   bool is_load_destroyed_performed_safe_write() {
-    return load_destroyed_performed_safe_write;
+    return has_flag(f_load_destroyed_performed_safe_write);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
 
   void mark_destroy_transient() {
-    destroy_transient = true;
+    set_flag(f_destroy_transient);
     // printf("Setting mark_to_be_destroyed_transient ::dinst %ld\n", this->ID);
   }
 
-  [[nodiscard]] bool is_safe() const { return !speculative; }
-  [[nodiscard]] bool is_spec() const { return speculative; }
-  void               mark_safe() { speculative = false; }
+  [[nodiscard]] bool is_safe() const { return !has_flag(f_speculative); }
+  [[nodiscard]] bool is_spec() const { return has_flag(f_speculative); }
+  void               mark_safe() { clear_flag(f_speculative); }
 
-  [[nodiscard]] bool isTransient() const { return transient; }
+  [[nodiscard]] bool isTransient() const { return has_flag(f_transient); }
   // void               setTransient() { transient = true; }
   // void               mark_to_be_destroyed() { to_be_destroyed = true; }
 
@@ -397,33 +436,41 @@ public:
 
   // void mark_destroy_transient() { destroy_transient = true; }
 
-  bool is_destroy_transient() { return to_be_destroyed; }
-
-  void mark_del_entry() { del_entry = true; }
-
-  void unmark_del_entry() { del_entry = false; }
-  void mark_rrob() { is_rrob = true; }
-  bool is_in_cluster() const { return in_cluster; }
-  void set_in_cluster() { in_cluster = true; }
-
-  void mark_flush_transient() { flush_transient = true; }
-  void mark_try_flush_transient() { try_flush_transient = true; }
-
-  bool is_present_in_rob() { return present_in_rob; }
-  void set_present_in_rob() { present_in_rob = true; }
-  bool is_present_in_scb() { return present_in_scb; }
-  void set_present_in_scb() { present_in_scb = true; }
-  void reset_present_in_scb() { present_in_scb = false; }
-  bool is_flush_transient() { return flush_transient; }
-  bool is_try_flush_transient() { return try_flush_transient; }
-  bool has_stats() const { return keep_stats; }
-  bool is_del_entry() { return del_entry; }
-  bool is_present_rrob() { return is_rrob; }
-  bool is_to_be_destroyed() { return to_be_destroyed; }
-
-  bool is_to_be_load_destroyed() { return to_be_load_destroyed; }
-  bool is_load_scb_all() { return to_be_load_scb_all; }
-  bool set_load_scb_all() { return to_be_load_scb_all = true; }
+  bool is_destroy_transient() { return has_flag(f_to_be_destroyed); }
+
+  void mark_del_entry() { set_flag(f_del_entry); }
+
+  void unmark_del_entry() { clear_flag(f_del_entry); }
+  void mark_rrob() { set_flag(f_is_rrob); }
+  bool is_in_cluster() const { return has_flag(f_in_cluster); }
+  void set_in_cluster() { set_flag(f_in_cluster); }
+
+  void mark_flush_transient() { set_flag(f_flush_transient); }
+  void mark_try_flush_transient() { set_flag(f_try_flush_transient); }
+
+  bool is_present_in_rob() { return has_flag(f_present_in_rob); }
+  void set_present_in_rob() { set_flag(f_present_in_rob); }
+  bool is_present_in_scb() { return has_flag(f_present_in_scb); }
+  void set_present_in_scb() { set_flag(f_present_in_scb); }
+  void reset_present_in_scb() { clear_flag(f_present_in_scb); }
+  bool is_flush_transient() { return has_flag(f_flush_transient); }
+  bool is_try_flush_transient() { return has_flag(f_try_flush_transient); }
+  bool has_stats() const { return has_flag(f_keep_stats); }
+  bool has_cold() const { return has_flag(f_cold); }
+  bool is_sample_begin() const { return has_flag(f_sample_begin); }
+  void set_sample_begin() { set_flag(f_sample_begin); }
+  bool is_sample_end() const { return has_flag(f_sample_end); }
+  void set_sample_end() { set_flag(f_sample_end); }
+  bool is_del_entry() { return has_flag(f_del_entry); }
+  bool is_present_rrob() { return has_flag(f_is_rrob); }
+  bool is_to_be_destroyed() { return has_flag(f_to_be_destroyed); }
+
+  bool is_to_be_load_destroyed() { return has_flag(f_to_be_load_destroyed); }
+  bool is_load_scb_all() { return has_flag(f_to_be_load_scb_all); }
+  bool set_load_scb_all() {
+    set_flag(f_to_be_load_scb_all);
+    return true;
+  }
 
   [[nodiscard]] static Dinst* create(Instruction&& inst, Addr_t pc, Addr_t address, Hartid_t fid, bool keep_stats) {
     Dinst* i = dInstPool.out();
@@ -435,101 +482,89 @@ public:
     i->addr     = address;
     i->inflight = 0;
     i->bb       = -1;
-#ifdef ESESC_TRACE_DATA
-    i->data           = 0;
-    i->data2          = 0;
-    i->br_data1       = 0;
-    i->br_data2       = 0;
-    i->ld_br_type     = 0;
-    i->dep_depth      = 0;
-    i->ldpc           = 0;
-    i->ld_addr        = 0;
-    i->base_pref_addr = 0;
-    i->data_sign      = DS_NoData;
-    i->chained        = 0;
-    i->brpc           = 0;
-    i->delta          = 0;
-    i->br_ld_chain    = false;
-    i->br_op_type     = -1;
-#endif
-    i->fetched    = 0;
-    i->keep_stats = keep_stats;
 
-    i->setup();
+    i->setup(keep_stats);
     I(i->getInst()->getOpcode() != Opcode::iOpInvalid);
 
     return i;
   }
 #ifdef ESESC_TRACE_DATA
-  uint64_t getDelta() const { return delta; }
+  // The predictor fields live in the cold record, kept for every instruction
+  // with ESESC_TRACE_DATA (cold_all)
+  [[nodiscard]] Dinst_cold& trace_rec() const {
+    I(has_flag(f_cold));
+    return *cold;
+  }
 
-  void setDelta(uint64_t _delta) { delta = _delta; }
+  uint64_t getDelta() const { return trace_rec().delta; }
 
-  int getRetireBrCount() const { return ret_br_count; }
+  void setDelta(uint64_t _delta) { trace_rec().delta = _delta; }
 
-  void setRetireBrCount(int _cnt) { ret_br_count = _cnt; }
+  int getRetireBrCount() const { return trace_rec().ret_br_count; }
 
-  bool is_br_ld_chain() const { return br_ld_chain; }
+  void setRetireBrCount(int _cnt) { trace_rec().ret_br_count = _cnt; }
 
-  void set_br_ld_chain() { br_ld_chain = true; }
+  bool is_br_ld_chain() const { return trace_rec().br_ld_chain; }
 
-  bool is_br_ld_chain_predictable() { return br_ld_chain_predictable; }
+  void set_br_ld_chain() { trace_rec().br_ld_chain = true; }
 
-  void set_br_ld_chain_predictable() { br_ld_chain_predictable = true; }
+  bool is_br_ld_chain_predictable() { return trace_rec().br_ld_chain_predictable; }
 
-  Addr_t getBasePrefAddr() const { return base_pref_addr; }
+  void set_br_ld_chain_predictable() { trace_rec().br_ld_chain_predictable = true; }
 
-  void setBasePrefAddr(Addr_t _base_addr) { base_pref_addr = _base_addr; }
+  Addr_t getBasePrefAddr() const { return trace_rec().base_pref_addr; }
 
-  Addr_t getLdAddr() const { return ld_addr; }
+  void setBasePrefAddr(Addr_t _base_addr) { trace_rec().base_pref_addr = _base_addr; }
 
-  void setLdAddr(Addr_t _ld_addr) { ld_addr = _ld_addr; }
+  Addr_t getLdAddr() const { return trace_rec().ld_addr; }
 
-  Addr_t getBrPC() const { return brpc; }
+  void setLdAddr(Addr_t _ld_addr) { trace_rec().ld_addr = _ld_addr; }
 
-  void setBrPC(Addr_t _brpc) { brpc = _brpc; }
+  Addr_t getBrPC() const { return trace_rec().brpc; }
+
+  void setBrPC(Addr_t _brpc) { trace_rec().brpc = _brpc; }
 
   [[nodiscard]] static DataSign calcDataSign(int64_t data);
 
-  [[nodiscard]] int getDepDepth() const { return dep_depth; }
+  [[nodiscard]] int getDepDepth() const { return trace_rec().dep_depth; }
 
-  void setDepDepth(int d) { dep_depth = d; }
+  void setDepDepth(int d) { trace_rec().dep_depth = d; }
 
-  [[nodiscard]] int getLBType() const { return ld_br_type; }
+  [[nodiscard]] int getLBType() const { return trace_rec().ld_br_type; }
 
-  void setLBType(int lb) { ld_br_type = lb; }
+  void setLBType(int lb) { trace_rec().ld_br_type = lb; }
 
-  [[nodiscard]] Data_t getBrData1() const { return br_data1; }
+  [[nodiscard]] Data_t getBrData1() const { return trace_rec().br_data1; }
 
-  [[nodiscard]] Data_t getBrData2() const { return br_data2; }
+  [[nodiscard]] Data_t getBrData2() const { return trace_rec().br_data2; }
 
-  [[nodiscard]] Data_t getData() const { return data; }
+  [[nodiscard]] Data_t getData() const { return trace_rec().data; }
 
-  [[nodiscard]] Data_t getData2() const { return data2; }
+  [[nodiscard]] Data_t getData2() const { return trace_rec().data2; }
 
-  [[nodiscard]] DataSign getDataSign() const { return (DataSign)(int(data_sign) & 0x1FF); }
+  [[nodiscard]] DataSign getDataSign() const { return (DataSign)(int(trace_rec().data_sign) & 0x1FF); }
 
   // DataSign getDataSign() const { return data_sign; }
   void setDataSign(int64_t _data, Addr_t ldpc);
   void addDataSign(int ds, int64_t _data, Addr_t ldpc);
 
-  void setBrData1(Data_t _data) { br_data1 = _data; }
+  void setBrData1(Data_t _data) { trace_rec().br_data1 = _data; }
 
-  void setBrData2(Data_t _data) { br_data2 = _data; }
+  void setBrData2(Data_t _data) { trace_rec().br_data2 = _data; }
 
-  void setData(uint64_t _data) { data = _data; }
+  void setData(uint64_t _data) { trace_rec().data = _data; }
 
-  void setData2(uint64_t _data) { data2 = _data; }
+  void setData2(uint64_t _data) { trace_rec().data2 = _data; }
 
-  [[nodiscard]] Addr_t getLDPC() const { return ldpc; }
+  [[nodiscard]] Addr_t getLDPC() const { return trace_rec().ldpc; }
   void                 setChain(FetchEngine* fe, int c) {
     I(fetch == nullptr);
     I(c);
     I(fe);
-    fetch   = fe;
-    chained = c;
+    fetch         = fe;
+    trace_rec().chained = c;
   }
-  [[nodiscard]] int getChained() const { return chained; }
+  [[nodiscard]] int getChained() const { return trace_rec().chained; }
 #else
   static DataSign calcDataSign([[maybe_unused]] int64_t data) { return DS_NoData; }
   Data_t          getData() const { return 0; }
@@ -611,20 +646,20 @@ public:
 #endif
 
   void lockFetch(FetchEngine* fe) {
-    I(!branchMiss);
+    I(!has_flag(f_branchMiss));
     I(fetch == nullptr);
-    fetch      = fe;
-    branchMiss = true;
-    fetched    = globalClock;
+    fetch = fe;
+    set_flag(f_branchMiss);
+    fetched = globalClock;
   }
 
   void setFetchTime() {
 #ifdef ESESC_TRACE_DATA
-    I(fetch == nullptr || chained);
+    I(fetch == nullptr || trace_rec().chained);
 #else
     I(fetch == nullptr);
 #endif
-    I(!branchMiss);
+    I(!has_flag(f_branchMiss));
     fetched = globalClock;
   }
   [[nodiscard]] int16_t getBB() const { return bb; }
@@ -634,37 +669,37 @@ public:
 
   void setInflight(uint64_t _inf) { inflight = _inf; }
 
-  [[nodiscard]] bool isUseLevel3() const { return use_level3; }
+  [[nodiscard]] bool isUseLevel3() const { return has_flag(f_use_level3); }
 
-  void setUseLevel3() { use_level3 = true; }
+  void setUseLevel3() { set_flag(f_use_level3); }
 
-  void setBranch_hit2_miss3() { branch_hit2_miss3 = true; }
-  void setBranch_hit3_miss2() { branch_hit3_miss2 = true; }
+  void setBranch_hit2_miss3() { set_flag(f_branch_hit2_miss3); }
+  void setBranch_hit3_miss2() { set_flag(f_branch_hit3_miss2); }
 
-  [[nodiscard]] bool isBranch_hit2_miss3() const { return branch_hit2_miss3; }
-  [[nodiscard]] bool isBranch_hit3_miss2() const { return branch_hit3_miss2; }
+  [[nodiscard]] bool isBranch_hit2_miss3() const { return has_flag(f_branch_hit2_miss3); }
+  [[nodiscard]] bool isBranch_hit3_miss2() const { return has_flag(f_branch_hit3_miss2); }
 
-  void setBranchHit_level1() { branchHit_level1 = true; }
-  void setBranchHit_level2() { branchHit_level2 = true; }
-  void setBranchHit_level3() { branchHit_level3 = true; }
+  void setBranchHit_level1() { set_flag(f_branchHit_level1); }
+  void setBranchHit_level2() { set_flag(f_branchHit_level2); }
+  void setBranchHit_level3() { set_flag(f_branchHit_level3); }
 
-  [[nodiscard]] bool isBranchHit_level1() const { return branchHit_level1; }
-  [[nodiscard]] bool isBranchHit_level2() const { return branchHit_level2; }
-  [[nodiscard]] bool isBranchHit_level3() const { return branchHit_level3; }
+  [[nodiscard]] bool isBranchHit_level1() const { return has_flag(f_branchHit_level1); }
+  [[nodiscard]] bool isBranchHit_level2() const { return has_flag(f_branchHit_level2); }
+  [[nodiscard]] bool isBranchHit_level3() const { return has_flag(f_branchHit_level3); }
 
-  void setBranchMiss_level1() { branchMiss_level1 = true; }
-  void setBranchMiss_level2() { branchMiss_level2 = true; }
-  void setBranchMiss_level3() { branchMiss_level3 = true; }
+  void setBranchMiss_level1() { set_flag(f_branchMiss_level1); }
+  void setBranchMiss_level2() { set_flag(f_branchMiss_level2); }
+  void setBranchMiss_level3() { set_flag(f_branchMiss_level3); }
 
-  [[nodiscard]] bool isBranchMiss_level1() const { return branchMiss_level1; }
-  [[nodiscard]] bool isBranchMiss_level2() const { return branchMiss_level2; }
-  [[nodiscard]] bool isBranchMiss_level3() const { return branchMiss_level3; }
+  [[nodiscard]] bool isBranchMiss_level1() const { return has_flag(f_branchMiss_level1); }
+  [[nodiscard]] bool isBranchMiss_level2() const { return has_flag(f_branchMiss_level2); }
+  [[nodiscard]] bool isBranchMiss_level3() const { return has_flag(f_branchMiss_level3); }
 
-  void setLevel3_NoPrediction() { level3_NoPrediction = true; }
+  void setLevel3_NoPrediction() { set_flag(f_level3_NoPrediction); }
 
-  [[nodiscard]] bool isLevel3_NoPrediction() const { return level3_NoPrediction; }
+  [[nodiscard]] bool isLevel3_NoPrediction() const { return has_flag(f_level3_NoPrediction); }
 
-  [[nodiscard]] bool         isBranchMiss() const { return branchMiss; }
+  [[nodiscard]] bool         isBranchMiss() const { return has_flag(f_branchMiss); }
   [[nodiscard]] FetchEngine* getFetchEngine() const { return fetch; }
 
   Time_t getFetchTime() const { return fetched; }
@@ -794,66 +829,75 @@ public:
   void dump(std::string_view txt);
 
   // methods required for LDSTBuffer
-  bool isLoadForwarded() const { return loadForwarded; }
+  bool isLoadForwarded() const { return has_flag(f_loadForwarded); }
   void setLoadForwarded() {
-    I(!loadForwarded);
-    loadForwarded = true;
+    I(!has_flag(f_loadForwarded));
+    set_flag(f_loadForwarded);
   }
 
-  bool hasInterCluster() const { return interCluster; }
-  void markInterCluster() { interCluster = true; }
+  bool hasInterCluster() const { return has_flag(f_interCluster); }
+  void markInterCluster() { set_flag(f_interCluster); }
 
-  bool isIssued() const { return issued; }
+  bool isIssued() const { return has_flag(f_issued); }
 
   void markRenamed() {
-    I(renamed == 0);
-    renamed = globalClock;
+    I(!has_flag(f_renamed));
+    set_flag(f_renamed);
+    mark_cold_time(&Dinst_cold::renamed);
   }
-  bool isRenamed() const { return renamed != 0; }
+  bool isRenamed() const { return has_flag(f_renamed); }
 
   void markIssued() {
-    I(issued == 0);
-    I(executing == 0);
+    I(!has_flag(f_issued));
+    I(!has_flag(f_executing));
     I(executed == 0);
-    issued = globalClock;
+    set_flag(f_issued);
+    mark_cold_time(&Dinst_cold::issued);
   }
 
-  void markIssuedTransient() { issued = globalClock; }
+  void markIssuedTransient() {
+    set_flag(f_issued);
+    mark_cold_time(&Dinst_cold::issued);
+  }
 
   bool isExecuted() const { return executed; }
   void markExecuted() {
     if (!this->is_spec()) {
-      I(issued != 0);
+      I(has_flag(f_issued));
       I(executed == 0);
     }
     executed = globalClock;
   }
-    void markExecutedTransient() { executed = globalClock; }
+  void markExecutedTransient() { executed = globalClock; }
 
-  bool isExecuting() const { return executing; }
+  bool isExecuting() const { return has_flag(f_executing); }
   void markExecuting() {
-    I(issued != 0);
-    I(executing == 0);
-    executing = globalClock;
+    I(has_flag(f_issued));
+    I(!has_flag(f_executing));
+    set_flag(f_executing);
+    mark_cold_time(&Dinst_cold::executing);
+  }
+  void markExecutingTransient() {
+    set_flag(f_executing);
+    mark_cold_time(&Dinst_cold::executing);
   }
-  void markExecutingTransient() { executing = globalClock; }
 
-  bool isReplay() const { return replay; }
-  void markReplay() { replay = true; }
+  bool isReplay() const { return has_flag(f_replay); }
+  void markReplay() { set_flag(f_replay); }
 
-  void setBiasBranch(bool b) { biasBranch = b; }
-  bool isBiasBranch() const { return biasBranch; }
+  void setBiasBranch(bool b) { set_flag(f_biasBranch, b); }
+  bool isBiasBranch() const { return has_flag(f_biasBranch); }
 
-  void setImliHighConf() { imli_highconf = true; }
+  void setImliHighConf() { set_flag(f_imli_highconf); }
 
-  bool getImliHighconf() const { return imli_highconf; }
+  bool getImliHighconf() const { return has_flag(f_imli_highconf); }
 
   bool isTaken() const {
     I(getInst()->isControl());
     return addr != 0;
   }
 
-  bool isPerformed() const { return performed; }
+  bool isPerformed() const { return has_flag(f_performed); }
   void markPerformed() {
     // Loads get performed first, and then executed
     // printf("Dinst ::markPerformed Insit %ld and isTransient is %b\n", getID(), isTransient());
@@ -864,35 +908,41 @@ public:
       GI(!inst.isLoad(), executed != 0);
     }
 
-    performed = true;
+    set_flag(f_performed);
   }
 
-  bool isRetired() const { return retired; }
+  bool isRetired() const { return has_flag(f_retired); }
   void markRetired() {
     I(inst.isStore());
-    retired = true;
+    set_flag(f_retired);
   }
-  void mark_retired() { retired = true; }
+  void mark_retired() { set_flag(f_retired); }
 
-  bool isPrefetch() const { return prefetch; }
-  void markPrefetch() { prefetch = true; }
-  bool isDispatched() const { return dispatched; }
-  void markDispatched() { dispatched = true; }
-  bool isFullMiss() const { return fullMiss; }
-  void setFullMiss(bool t) { fullMiss = t; }
+  bool isPrefetch() const { return has_flag(f_prefetch); }
+  void markPrefetch() { set_flag(f_prefetch); }
+  bool isDispatched() const { return has_flag(f_dispatched); }
+  void markDispatched() { set_flag(f_dispatched); }
+  bool isFullMiss() const { return has_flag(f_fullMiss); }
+  void setFullMiss(bool t) { set_flag(f_fullMiss, t); }
 
+  // Renamed/issued/executing times are only kept with the cold record
+  // (stats or tracing), 0 otherwise
   Time_t getFetchedTime() const { return fetched; }
-  Time_t getRenamedTime() const { return renamed; }
-  Time_t getIssuedTime() const { return issued; }
-  Time_t getExecutingTime() const { return executing; }
+  Time_t getRenamedTime() const { return cold_time(&Dinst_cold::renamed); }
+  Time_t getIssuedTime() const { return cold_time(&Dinst_cold::issued); }
+  Time_t getExecutingTime() const { return cold_time(&Dinst_cold::executing); }
   Time_t getExecutedTime() const { return executed; }
 
   Time_t getID() const { return ID; }
   Time_t get_original_id() const { return original_id; }
 
 #ifndef NDEBUG
-  uint64_t getmreq_id() { return mreq_id; }
-  void     setmreq_id(uint64_t _mreq_id) { mreq_id = _mreq_id; }
+  uint64_t getmreq_id() { return has_flag(f_cold) ? cold->mreq_id : 0; }
+  void     setmreq_id(uint64_t _mreq_id) {
+    if (has_flag(f_cold)) {
+      cold->mreq_id = _mreq_id;
+    }
+  }
 #endif
 };
 
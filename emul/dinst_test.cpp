@@ -0,0 +1,116 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "dinst.hpp"
+
+#include "gtest/gtest.h"
+
+class Dinst_test : public ::testing::Test {
+protected:
+  static Dinst* make(bool keep_stats) {
+    return Dinst::create(Instruction(Opcode::iAALU, RegType::LREG_R1, RegType::LREG_R2, RegType::LREG_R3, RegType::LREG_R4),
+                         0x1000,
+                         0,
+                         0,
+                         keep_stats);
+  }
+
+  void TearDown() override { Dinst::keep_cold(false); }
+};
+
+TEST_F(Dinst_test, footprint) {
+  RecordProperty("sizeof_Dinst", static_cast<int>(sizeof(Dinst)));
+  RecordProperty("sizeof_Dinst_cold", static_cast<int>(sizeof(Dinst_cold)));
+
+  // 392 bytes with one bool per flag and the five stage times inline
+  EXPECT_LE(sizeof(Dinst), 320U);
+}
+
+TEST_F(Dinst_test, flags_are_independent) {
+  auto* d = make(true);
+
+  EXPECT_TRUE(d->has_stats());
+  EXPECT_TRUE(d->is_spec());
+  EXPECT_FALSE(d->isTransient());
+  EXPECT_FALSE(d->isPrefetch());
+  EXPECT_FALSE(d->is_present_in_scb());
+
+  d->markPrefetch();
+  d->setFullMiss(true);
+  d->setBiasBranch(true);
+  d->mark_safe();
+  d->set_present_in_scb();
+
+  EXPECT_TRUE(d->isPrefetch());
+  EXPECT_TRUE(d->isFullMiss());
+  EXPECT_TRUE(d->isBiasBranch());
+  EXPECT_TRUE(d->is_safe());
+  EXPECT_TRUE(d->has_stats());
+  EXPECT_FALSE(d->isReplay());
+  EXPECT_FALSE(d->isDispatched());
+
+  d->setFullMiss(false);
+  d->reset_present_in_scb();
+  EXPECT_FALSE(d->isFullMiss());
+  EXPECT_FALSE(d->is_present_in_scb());
+  EXPECT_TRUE(d->isBiasBranch());
+  EXPECT_TRUE(d->isPrefetch());
+
+  d->scrap();
+
+  // A reused slot starts clean
+  auto* d2 = make(false);
+  EXPECT_FALSE(d2->isPrefetch());
+  EXPECT_FALSE(d2->isBiasBranch());
+  EXPECT_FALSE(d2->has_stats());
+  EXPECT_TRUE(d2->is_spec());
+  d2->scrap();
+}
+
+TEST_F(Dinst_test, cold_times_only_with_stats) {
+  globalClock = 100;
+
+  auto* d = make(true);
+  EXPECT_TRUE(d->has_cold());
+  d->setFetchTime();
+  globalClock = 103;
+  d->markRenamed();
+  globalClock = 110;
+  d->markIssued();
+  d->markExecuting();
+  globalClock = 115;
+  d->markExecuted();
+
+  EXPECT_EQ(d->getFetchTime(), 100U);
+  EXPECT_EQ(d->getRenamedTime(), 103U);
+  EXPECT_EQ(d->getIssuedTime(), 110U);
+  EXPECT_EQ(d->getExecutingTime(), 110U);
+  EXPECT_EQ(d->getExecutedTime(), 115U);
+  d->destroy();
+
+  // No stats, the stages are tracked but only the hot times are kept
+  auto* n = make(false);
+  EXPECT_FALSE(n->has_cold());
+  n->setFetchTime();
+  n->markRenamed();
+  n->markIssued();
+  n->markExecuting();
+  n->markExecuted();
+
+  EXPECT_TRUE(n->isRenamed());
+  EXPECT_TRUE(n->isIssued());
+  EXPECT_TRUE(n->isExecuting());
+  EXPECT_TRUE(n->isExecuted());
+  EXPECT_EQ(n->getRenamedTime(), 0U);
+  EXPECT_EQ(n->getIssuedTime(), 0U);
+  EXPECT_EQ(n->getExecutedTime(), 115U);
+  n->destroy();
+
+  // The tracer asks for the cold record on every instruction
+  Dinst::keep_cold(true);
+  auto* t = make(false);
+  EXPECT_TRUE(t->has_cold());
+  EXPECT_EQ(t->getRenamedTime(), 0U);
+  t->markRenamed();
+  EXPECT_EQ(t->getRenamedTime(), 115U);
+  t->scrap();
+}
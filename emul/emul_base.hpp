@@ -26,6 +26,15 @@ public:
 
   virtual void skip_rabbit(Hartid_t fid, size_t ninst) = 0;
 
+  // True while fid is in the functional warmup phase (between rabbit and
+  // detail). peek() keeps returning instructions, but they should only train
+  // caches and predictors, never enter the timing model.
+  virtual bool is_warmup(Hartid_t fid) const = 0;
+
+  // Statistical sampling: weight of the oldest timed interval, called when
+  // its last instruction (Dinst::is_sample_end) retires
+  virtual double pop_sample_weight() { return 1; }
+
   const std::string& get_type() const { return type; }
   const std::string& get_section() const { return section; }
 };
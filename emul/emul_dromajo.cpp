@@ -2,15 +2,20 @@
 
 #include "emul_dromajo.hpp"
 
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
 #include <print>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_split.h"
+#include "clock_domain.hpp"
 
 Emul_dromajo::Emul_dromajo() : Emul_base() {
   num = 0;
 
-  uint64_t rabbit = 0;
+  uint64_t rabbit      = 0;
+  uint64_t warmup_inst = 0;
 
   auto nemuls = Config::get_array_size("soc", "emul");
 
@@ -28,6 +33,33 @@ Emul_dromajo::Emul_dromajo() : Emul_base() {
       rabbit = Config::get_integer(section, "rabbit");
       detail = Config::get_integer(section, "detail");
       time   = Config::get_integer(section, "time");
+      if (Config::has_entry(section, "warmup")) {
+        warmup_inst = Config::get_integer(section, "warmup", 0);
+      }
+      if (Config::has_entry(section, "simpoints")) {
+        if (Config::has_entry(section, "samples")) {
+          Config::add_error(fmt::format("section {} has both samples and simpoints set. These are contradictory", section));
+        }
+        if (rabbit) {
+          Config::add_error(fmt::format("section {} with simpoints should have rabbit = 0 (simpoints sets it)", section));
+        }
+        read_simpoints(warmup_inst);
+      } else if (Config::has_entry(section, "samples")) {
+        auto nsamples = Config::get_integer(section, "samples", 1, 1 << 20);
+        intervals.resize(nsamples, {rabbit, warmup_inst, detail, time, 1.0});
+      }
+      if (Config::has_entry(section, "batch")) {
+        batch = Config::get_integer(section, "batch", 0, 65536);
+      }
+      if (batch && Config::has_entry(section, "batch_thread")) {
+        use_batch_thread = Config::get_bool(section, "batch_thread");
+      }
+      if (Config::has_entry(section, "decode_cache")) {
+        decode_cache_size = Config::get_integer(section, "decode_cache", 0, 1 << 20);
+      }
+      if (Config::has_entry(section, "record")) {
+        recorders.resize(nemuls);
+      }
       if (Config::has_entry(section, "bench")) {
         bench = Config::get_string(section, "bench");
         if (Config::has_entry(section, "load")) {
@@ -35,8 +67,19 @@ Emul_dromajo::Emul_dromajo() : Emul_base() {
         }
       }
     }
+    if (!recorders.empty()) {
+      recorders[i] = std::make_unique<Trace_writer>(Trace_reader::file_name(Config::get_string(section, "record"), i));
+    }
     ++num;
   }
+  if (!recorders.empty()) {
+    if (batch) {
+      Config::add_error(fmt::format("section {} record does not support batch", section));
+    }
+    if (!intervals.empty()) {
+      Config::add_error(fmt::format("section {} record does not support sampling (samples/simpoints)", section));
+    }
+  }
   if (!bench.empty()) {
     std::vector<std::string> bench_split = absl::StrSplit(bench, ' ');
     if (bench_split.empty() || !std::filesystem::exists(bench_split[0])) {
@@ -47,12 +90,43 @@ Emul_dromajo::Emul_dromajo() : Emul_base() {
       }
     }
   }
+  if (!intervals.empty()) {
+    if (num > 1) {
+      Config::add_error(fmt::format("section {} sampling (samples/simpoints) only supports one hart", section));
+    }
+    if (Config::has_entry("soc", "parallel") && Config::get_bool("soc", "parallel")) {
+      Config::add_error("[soc] parallel does not support sampling (samples/simpoints)");
+    }
+    if (time == 0) {
+      Config::add_error(fmt::format("section {} sampling needs time > 0", section));
+    }
+  }
   Config::exit_on_error();
 
+  if (!intervals.empty()) {
+    rabbit      = intervals[0].rabbit;
+    warmup_inst = intervals[0].warmup;
+    detail      = intervals[0].detail;
+    time        = intervals[0].time;
+  }
+  warmup.resize(num, warmup_inst);
+  peeked.resize(num);
+
   type = "dromajo";
   if (num) {
     init_dromajo_machine();
   }
+  if (decode_cache_size) {
+    for (auto i = 0u; i < num; ++i) {
+      decode_caches.emplace_back(std::make_unique<Decode_cache>(i, section, decode_cache_size));
+    }
+  }
+  if (batch) {
+    primed.resize(num, false);
+    for (auto i = 0u; i < num; ++i) {
+      rings.emplace_back(std::make_unique<Spsc_ring<Decoded_insn>>(std::max<uint32_t>(4 * batch, 1024)));
+    }
+  }
   if (rabbit) {
     for (auto i = 0u; i < num; ++i) {
       skip_rabbit(i, rabbit);
@@ -62,20 +136,113 @@ Emul_dromajo::Emul_dromajo() : Emul_base() {
       execute(i);  // to set the last
     }
   }
+
+  if (use_batch_thread && num) {
+    batch_thread = std::jthread([this](std::stop_token stoken) { run_batch_thread(stoken); });
+  }
+}
+
+void Emul_dromajo::read_simpoints(uint64_t warmup_inst) {
+  // Standard SimPoint output: "<interval> <cluster>" and "<weight> <cluster>"
+  auto sp_file = Config::get_string(section, "simpoints");
+  auto wt_file = Config::get_string(section, "weights");
+  auto size    = static_cast<uint64_t>(Config::get_integer(section, "simpoint_size", 1));
+
+  std::ifstream sp(sp_file);
+  std::ifstream wt(wt_file);
+  if (!sp.is_open() || !wt.is_open()) {
+    Config::add_error(fmt::format("section {} could not open simpoints {} or weights {}", section, sp_file, wt_file));
+    return;
+  }
+
+  absl::flat_hash_map<uint64_t, double> weight;  // per cluster
+  double                                w;
+  uint64_t                              cluster;
+  while (wt >> w >> cluster) {
+    weight[cluster] = w;
+  }
+
+  std::vector<std::pair<uint64_t, double>> points;  // interval, weight
+  uint64_t                                 interval;
+  while (sp >> interval >> cluster) {
+    auto it = weight.find(cluster);
+    if (it == weight.end()) {
+      Config::add_error(fmt::format("simpoints {} cluster {} has no weight in {}", sp_file, cluster, wt_file));
+      return;
+    }
+    if (it->second > 0) {
+      points.emplace_back(interval, it->second);
+    }
+  }
+  std::sort(points.begin(), points.end());
+
+  // Each point runs warmup+detail right before its interval, clipped so that
+  // it never overlaps the previous point
+  uint64_t pos = 0;
+  for (const auto& [pt, pt_weight] : points) {
+    uint64_t start = pt * size;
+    uint64_t pre   = warmup_inst + detail;
+    uint64_t begin = start > pre ? start - pre : 0;
+    if (begin < pos) {
+      begin = pos;
+    }
+    uint64_t n_detail = std::min<uint64_t>(detail, start - begin);
+    uint64_t n_warmup = start - begin - n_detail;
+
+    intervals.push_back({begin - pos, n_warmup, n_detail, size, pt_weight});
+    pos = start + size;
+  }
+
+  if (intervals.empty()) {
+    Config::add_error(fmt::format("simpoints {} has no interval with weight", sp_file));
+  }
+}
+
+bool Emul_dromajo::next_interval(Hartid_t fid) {
+  if (interval_pos + 1 >= intervals.size()) {
+    return false;
+  }
+
+  ++interval_pos;
+  const auto& s = intervals[interval_pos];
+
+  if (s.rabbit) {
+    skip_rabbit(fid, s.rabbit);
+  }
+  warmup[fid] = s.warmup;
+  detail      = s.detail;
+  time        = s.time;
+
+  return true;
 }
 
 void Emul_dromajo::destroy_machine() {
+  if (batch_thread.joinable()) {
+    batch_thread.request_stop();
+    batch_thread.join();
+  }
+  for (auto& rec : recorders) {
+    if (rec) {
+      rec->close();
+    }
+  }
   if (machine != nullptr) {
     virt_machine_end(machine);
   }
   // XXX - dromajo has a memory leak, needs to be fixed on that end
 }
 
-static inline uint32_t C_reg_decode(uint32_t rn) { return rn + 8; }
+std::unique_lock<std::mutex> Emul_dromajo::lock_machine() {
+  std::unique_lock<std::mutex> lock(machine_mutex, std::defer_lock);
+  if (Clock_domain::is_parallel()) {
+    lock.lock();
+  }
+  return lock;
+}
 
-Dinst* Emul_dromajo::peek(Hartid_t fid) {
-  uint32_t insn_raw = last[fid].insns;
+static inline uint32_t C_reg_decode(uint32_t rn) { return rn + 8; }
 
+Instruction Emul_dromajo::decode(uint32_t insn_raw) {
   // Assume compressed, default to 32-bit insn
   uint32_t funct7 = 0;
   uint32_t rs1    = 0;
@@ -377,21 +544,107 @@ Dinst* Emul_dromajo::peek(Hartid_t fid) {
   I(src2 != RegType::LREG_INVALID);
   I(dst1 != RegType::LREG_INVALID);
 
+  return Instruction(opcode, src1, src2, dst1, dst2);
+}
+
+Instruction Emul_dromajo::decode_cached(Hartid_t fid, uint32_t insn_raw, bool& hit) {
+  if (decode_caches.empty()) {
+    hit = false;
+    return decode(insn_raw);
+  }
+
+  return decode_caches[fid]->lookup(insn_raw, hit);
+}
+
+void Emul_dromajo::count_decode(Hartid_t fid, bool hit) {
+  if (!decode_caches.empty()) {
+    decode_caches[fid]->count(hit);
+  }
+}
+
+uint64_t Emul_dromajo::get_paddr(Opcode opcode, uint64_t pc, uint64_t next_pc, uint64_t addr) {
   uint64_t paddr = 0u;
-  uint64_t pc    = last[fid].pc;
   if (opcode == Opcode::iLALU_LD || opcode == Opcode::iSALU_ST) {
-    paddr = last[fid].addr;
+    paddr = addr;
   } else if (opcode == Opcode::iBALU_LBRANCH || opcode == Opcode::iBALU_RBRANCH) {
-    paddr = last[fid].next_pc;
+    paddr = next_pc;
     if ((paddr == pc + 2) || paddr == pc + 4) {
       paddr = 0;  // Not taken Control flow instruction
     }
   } else if (opcode == Opcode::iBALU_LJUMP || opcode == Opcode::iBALU_RJUMP || opcode == Opcode::iBALU_LCALL
              || opcode == Opcode::iBALU_RCALL || opcode == Opcode::iBALU_RET) {
-    paddr = last[fid].next_pc;
+    paddr = next_pc;
+  }
+
+  return paddr;
+}
+
+Dinst* Emul_dromajo::create_dinst(Instruction&& inst, uint64_t pc, uint64_t paddr, Hartid_t fid) {
+  auto& pk = peeked[fid];
+  if (!pk.valid) {
+    pk = {};
+    if (warmup[fid] > 0) {
+      --warmup[fid];
+    } else {
+      auto lock = lock_machine();  // detail/time are shared by all the harts
+      if (detail > 0) {
+        --detail;
+      } else if (time > 0) {
+        pk.stats = true;
+        if (!intervals.empty()) {
+          pk.begin  = !measuring;
+          pk.end    = time == 1;
+          measuring = !pk.end;
+          if (pk.end) {
+            sample_weights.push_back(intervals[interval_pos].weight);
+          }
+        }
+        --time;
+      } else {
+        return nullptr;
+      }
+    }
+    pk.valid = true;
+  }
+
+  auto* dinst = Dinst::create(std::move(inst), pc, paddr, fid, pk.stats);
+  if (pk.begin) {
+    dinst->set_sample_begin();
+  }
+  if (pk.end) {
+    dinst->set_sample_end();
+  }
+  return dinst;
+}
+
+double Emul_dromajo::pop_sample_weight() {
+  I(!sample_weights.empty());
+  auto weight = sample_weights.front();
+  sample_weights.pop_front();
+  return weight;
+}
+
+Dinst* Emul_dromajo::peek(Hartid_t fid) {
+  if (unlikely(is_interval_done(fid))) {
+    if (!next_interval(fid)) {
+      return nullptr;
+    }
+  }
+
+  if (batch) {
+    const auto* rec = ref_current(fid);
+    return create_dinst(Instruction(rec->opcode, rec->src1, rec->src2, rec->dst1, rec->dst2), rec->pc, rec->paddr, fid);
   }
 
+  uint32_t insn_raw = last[fid].insns;
+  bool     hit;
+  auto     inst = decode_cached(fid, insn_raw, hit);
+  count_decode(fid, hit);
+  uint64_t pc       = last[fid].pc;
+  uint64_t paddr    = get_paddr(inst.getOpcode(), pc, last[fid].next_pc, last[fid].addr);
+
 #ifdef TRACE_CALL_RET
+  auto opcode = inst.getOpcode();
   if (opcode == Opcode::iBALU_RET) {
     std::print("opcode ret   pc:{:x} next:{:x} insn_raw:{:x}\n", last[fid].pc, paddr, insn_raw);
   } else if (opcode == Opcode::iBALU_LCALL) {
@@ -403,21 +656,126 @@ Dinst* Emul_dromajo::peek(Hartid_t fid) {
   }
 #endif
 
-  if (detail > 0) {
-    --detail;
-    return Dinst::create(Instruction(opcode, src1, src2, dst1, dst2), pc, paddr, fid, false);
+  return create_dinst(std::move(inst), pc, paddr, fid);
+}
+
+void Emul_dromajo::step(Hartid_t fid, Decoded_insn& rec) {
+  auto* cpu = machine->cpu_state[fid];
+
+  uint32_t insn_raw = 0;
+  rec.pc            = cpu->pc;
+  (void)riscv_read_insn(cpu, &insn_raw, rec.pc);
+
+  virt_machine_run(machine, fid, 1);
+
+  auto inst  = decode_cached(fid, insn_raw, rec.decode_hit);
+  rec.opcode = inst.getOpcode();
+  rec.src1   = inst.getSrc1();
+  rec.src2   = inst.getSrc2();
+  rec.dst1   = inst.getDst1();
+  rec.dst2   = inst.getDst2();
+
+  rec.next_pc = cpu->pc;
+  rec.paddr   = get_paddr(rec.opcode, rec.pc, rec.next_pc, cpu->last_data_paddr);
+}
+
+size_t Emul_dromajo::fill(Hartid_t fid) {
+  auto& ring = *rings[fid];
+
+  size_t n    = 0;
+  auto   lock = lock_machine();
+  while (n < batch) {
+    auto* rec = ring.ref_tail();
+    if (rec == nullptr) {
+      break;
+    }
+    step(fid, *rec);
+    ring.push();
+    ++n;
   }
-  if (time > 0) {
-    --time;
-    return Dinst::create(Instruction(opcode, src1, src2, dst1, dst2), pc, paddr, fid, true);
+
+  return n;
+}
+
+const Emul_dromajo::Decoded_insn* Emul_dromajo::ref_current(Hartid_t fid) {
+  auto& ring = *rings[fid];
+
+  const auto* rec = ring.ref_head();
+  while (rec == nullptr) {
+    if (batch_thread.joinable()) {
+      std::unique_lock lock(batch_mutex);  // the stepping thread is behind
+      batch_data.wait(lock, [&ring] { return !ring.empty(); });
+    } else {
+      fill(fid);
+    }
+    rec = ring.ref_head();
+  }
+
+  return rec;
+}
+
+void Emul_dromajo::consume(Hartid_t fid, size_t ninst) {
+  if (!primed[fid]) {
+    // Like execute(), the first call only exposes the first instruction
+    primed[fid] = true;
+    --ninst;
   }
 
-  return nullptr;
+  auto& ring = *rings[fid];
+  while (ninst > 0) {
+    if (ring.empty() && !batch_thread.joinable() && ninst > 1) {
+      auto lock = lock_machine();
+      virt_machine_run(machine, fid, ninst - 1);  // nothing to decode while skipping
+      ninst = 1;
+      continue;
+    }
+    count_decode(fid, ref_current(fid)->decode_hit);
+    ring.pop();
+    --ninst;
+    if (batch_thread.joinable() && ring.free_slots() == batch) {
+      std::lock_guard lock(batch_mutex);  // the helper may be between its check and its wait
+      batch_space.notify_one();
+    }
+  }
+}
+
+bool Emul_dromajo::has_batch_space() const {
+  for (const auto& ring : rings) {
+    if (ring->free_slots() >= batch) {
+      return true;
+    }
+  }
+  return false;
 }
+
+void Emul_dromajo::run_batch_thread(std::stop_token stoken) {
+  while (!stoken.stop_requested()) {
+    size_t n = 0;
+    for (auto fid = 0u; fid < num; ++fid) {
+      if (rings[fid]->free_slots() >= batch) {
+        n += fill(fid);
+      }
+    }
+    std::unique_lock lock(batch_mutex);
+    if (n) {
+      batch_data.notify_all();
+      continue;
+    }
+    batch_space.wait(lock, stoken, [this] { return has_batch_space(); });
+  }
+}
+
 void Emul_dromajo::skip_rabbit(Hartid_t fid, size_t ninst) {
   I(ninst > 0);
+  peeked[fid].valid = false;
+
+  if (batch) {
+    consume(fid, ninst);
+    return;
+  }
 
   if (ninst > 1) {
+    auto lock = lock_machine();
     virt_machine_run(machine, fid, ninst - 1);
   }
 
@@ -425,6 +783,15 @@ void Emul_dromajo::skip_rabbit(Hartid_t fid, size_t ninst) {
 }
 
 void Emul_dromajo::execute(Hartid_t fid) {
+  peeked[fid].valid = false;
+
+  if (batch) {
+    consume(fid, 1);
+    return;
+  }
+
+  auto lock = lock_machine();
+
   last[fid].pc = machine->cpu_state[fid]->pc;
   (void)riscv_read_insn(machine->cpu_state[fid], &last[fid].insns, last[fid].pc);
 
@@ -432,6 +799,10 @@ void Emul_dromajo::execute(Hartid_t fid) {
 
   last[fid].addr    = machine->cpu_state[fid]->last_data_paddr;
   last[fid].next_pc = machine->cpu_state[fid]->pc;
+
+  if (unlikely(!recorders.empty())) {
+    recorders[fid]->append({last[fid].pc, last[fid].next_pc, last[fid].addr, last[fid].insns});
+  }
 }
 
 Hartid_t Emul_dromajo::get_num() const { return num; }
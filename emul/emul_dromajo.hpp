@@ -2,17 +2,66 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "decode_cache.hpp"
 #include "dromajo.h"
 #include "emul_base.hpp"
+#include "instruction.hpp"
+#include "spsc_ring.hpp"
+#include "stats.hpp"
+#include "trace_file.hpp"
 
 class Emul_dromajo : public Emul_base {
 private:
   RISCVMachine* machine = nullptr;
 
+  // All harts share one machine. Only taken when cores run in parallel threads.
+  static inline std::mutex machine_mutex;
+  [[nodiscard]] std::unique_lock<std::mutex> lock_machine();
+
   uint64_t num;
   uint64_t detail;
   uint64_t time;
 
+  std::vector<uint64_t> warmup;  // per hart, consumed before detail
+
+  // Statistical sampling: the run is a list of rabbit/warmup/detail/time
+  // intervals (periodic with `samples`, or from SimPoint files). Each time
+  // phase is one Stats_sampler sample, bracketed at retire by the first and
+  // last timed instructions (Dinst::is_sample_begin/is_sample_end).
+  struct Sample_interval {
+    uint64_t rabbit;
+    uint64_t warmup;
+    uint64_t detail;
+    uint64_t time;
+    double   weight;
+  };
+  std::vector<Sample_interval> intervals;
+  size_t                       interval_pos = 0;
+  bool                         measuring    = false;
+  std::deque<double>           sample_weights;  // timed intervals whose last instruction did not retire yet
+
+  void               read_simpoints(uint64_t warmup_inst);
+  bool               next_interval(Hartid_t fid);
+  [[nodiscard]] bool is_interval_done(Hartid_t fid) const {
+    return !intervals.empty() && !peeked[fid].valid && time == 0 && detail == 0 && warmup[fid] == 0;
+  }
+
+  // Fetch may drop a peeked instruction and peek it again. The phase
+  // counters and the sampling brackets move once, when it is first peeked.
+  struct Peeked {
+    bool valid = false;  // peeked, not executed yet
+    bool stats = false;
+    bool begin = false;
+    bool end   = false;
+  };
+  std::vector<Peeked> peeked;
+
   std::string bench;
 
   void init_dromajo_machine();
@@ -25,11 +74,59 @@ private:
   };
   std::vector<Last_state> last;
 
+  std::vector<std::unique_ptr<Trace_writer>> recorders;  // per hart with `record`, replayed by Emul_trace
+
+  // Batched mode (batch > 0): the machine runs ahead in blocks of batch
+  // instructions and each retired instruction is decoded once into a per-hart
+  // ring. peek/execute only touch the ring head. With batch_thread the blocks
+  // are stepped by a helper thread, overlapping emulation with timing.
+  struct Decoded_insn {
+    uint64_t pc;
+    uint64_t next_pc;
+    uint64_t paddr;
+    Opcode   opcode;
+    RegType  src1;
+    RegType  src2;
+    RegType  dst1;
+    RegType  dst2;
+    bool     decode_hit;  // counted by the consumer, the stats are not thread safe
+  };
+  uint32_t                                              batch            = 0;
+  bool                                                  use_batch_thread = false;
+  std::vector<std::unique_ptr<Spsc_ring<Decoded_insn>>> rings;
+  std::vector<bool>                                     primed;  // first execute() exposes the ring head
+
+  // The helper thread sleeps until a ring has room for a block, and a core
+  // sleeps until its ring gets one. Each side notifies once per block.
+  std::mutex                  batch_mutex;
+  std::condition_variable_any batch_space;
+  std::condition_variable_any batch_data;
+
+  uint32_t                                   decode_cache_size = 4096;  // 0 disables it
+  std::vector<std::unique_ptr<Decode_cache>> decode_caches;             // per hart, each core thread only touches its own
+
+  Instruction decode_cached(Hartid_t fid, uint32_t insn_raw, bool& hit);
+  void        count_decode(Hartid_t fid, bool hit);
+  Dinst*      create_dinst(Instruction&& inst, uint64_t pc, uint64_t paddr, Hartid_t fid);
+
+  void                step(Hartid_t fid, Decoded_insn& rec);
+  size_t              fill(Hartid_t fid);
+  const Decoded_insn* ref_current(Hartid_t fid);
+  void                consume(Hartid_t fid, size_t ninst);
+  bool                has_batch_space() const;
+  void                run_batch_thread(std::stop_token stoken);
+
+  std::jthread batch_thread;  // Last member: stopped before the rings go away
+
 public:
+  // Also used by Emul_trace to replay recorded encodings
+  static Instruction decode(uint32_t insn_raw);
+  static uint64_t    get_paddr(Opcode opcode, uint64_t pc, uint64_t next_pc, uint64_t addr);
+
   Emul_dromajo();
-  Emul_dromajo(const Emul_dromajo&)            = default;
+  Emul_dromajo(const Emul_dromajo&)            = delete;
   Emul_dromajo(Emul_dromajo&&)                 = delete;
-  Emul_dromajo& operator=(const Emul_dromajo&) = default;
+  Emul_dromajo& operator=(const Emul_dromajo&) = delete;
   Emul_dromajo& operator=(Emul_dromajo&&)      = delete;
   ~Emul_dromajo() override                     = default;
 
@@ -42,7 +139,14 @@ public:
 
   [[nodiscard]] Hartid_t get_num() const final;
   [[nodiscard]] bool     is_sleeping(Hartid_t fid) const override;
+  // Also true when the next peek starts a sampling interval with a warmup
+  [[nodiscard]] bool is_warmup(Hartid_t fid) const final {
+    return warmup[fid] > 0
+           || (is_interval_done(fid) && interval_pos + 1 < intervals.size() && intervals[interval_pos + 1].warmup > 0);
+  }
+  double pop_sample_weight() final;
 
   void set_detail(uint64_t ninst) { detail = ninst; }
   void set_time(uint64_t ninst) { time = ninst; }
+  void set_warmup(Hartid_t fid, uint64_t ninst) { warmup[fid] = ninst; }
 };
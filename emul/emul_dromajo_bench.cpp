@@ -1,9 +1,14 @@
 // This file is distributed under the BSD 3-Clause License. See LICENSE for details.
 
+#include <fstream>
+#include <string>
+
 #include "benchmark/benchmark.h"
 #include "emul_dromajo.hpp"
 
 std::shared_ptr<Emul_dromajo> dromajo_ptr;
+std::shared_ptr<Emul_dromajo> batched_ptr;
+std::shared_ptr<Emul_dromajo> nocache_ptr;
 
 static void BM_InstructionExecuteAndDecode(benchmark::State& state) {
   dromajo_ptr->set_time(1024 * 1024 * 1024);  // Lots of instructions to make sure that it runs
@@ -23,24 +28,53 @@ static void BM_InstructionExecute(benchmark::State& state) {
 }
 BENCHMARK(BM_InstructionExecute);
 
-int main(int argc, char* argv[]) {
+static void BM_UncachedExecuteAndDecode(benchmark::State& state) {
+  nocache_ptr->set_time(1024 * 1024 * 1024);
+  for (auto _ : state) {
+    nocache_ptr->execute(0);
+    Dinst* dinst = nocache_ptr->peek(0);
+    dinst->scrap();
+  }
+}
+BENCHMARK(BM_UncachedExecuteAndDecode);
+
+static void BM_BatchedExecuteAndDecode(benchmark::State& state) {
+  batched_ptr->set_time(1024 * 1024 * 1024);
+  for (auto _ : state) {
+    batched_ptr->execute(0);
+    Dinst* dinst = batched_ptr->peek(0);
+    dinst->scrap();
+  }
+}
+BENCHMARK(BM_BatchedExecuteAndDecode);
+
+static std::shared_ptr<Emul_dromajo> create_emul(const std::string& sec, const std::string& extra) {
   std::ofstream file;
   file.open("emul_dromajo_test.toml");
 
   file << "[soc]\n";
   file << "core = \"c0\"\n";
-  file << "emul = [\"drom_emu\"]\n";
-  file << "\n[drom_emu]\n";
+  file << "emul = [\"" << sec << "\"]\n";
+  file << "\n[" << sec << "]\n";
   file << "num = \"1\"\n";
   file << "type = \"dromajo\"\n";
   file << "bench =\"conf/dhrystone.riscv\"\n";
   file << "rabbit = 1e6\n";
   file << "detail = 1e6\n";
   file << "time = 2e6\n";
+  file << extra;
   file.close();
 
   Config::init("emul_dromajo_test.toml");
 
-  dromajo_ptr = std::make_shared<Emul_dromajo>();
+  return std::make_shared<Emul_dromajo>();
+}
+
+int main(int argc, char* argv[]) {
+  dromajo_ptr = create_emul("drom_emu", "");
+  nocache_ptr = create_emul("drom_nocache", "decode_cache = 0\n");
+  batched_ptr = create_emul("drom_batch", "batch = 64\n");
+
+  benchmark::Initialize(&argc, argv);
   benchmark::RunSpecifiedBenchmarks();
 }
@@ -146,3 +146,144 @@ TEST_F(Emul_Dromajo_test, dhrystone_test) {
   EXPECT_TRUE(inst->isStore());
   dinst->scrap();
 }
+
+static std::shared_ptr<Emul_dromajo> create_variant(const std::string& sec, const std::string& extra) {
+  std::ofstream file;
+  file.open("emul_dromajo_variant_test.toml");
+
+  file << "[soc]\n";
+  file << "core = \"c0\"\n";
+  file << "emul = [\"" << sec << "\"]\n";
+  file << "\n[" << sec << "]\n";
+  file << "num = \"1\"\n";
+  file << "type = \"dromajo\"\n";
+  file << "rabbit = 0\n";
+  file << "detail = 1e6\n";
+  file << "time = 2e6\n";
+  file << extra;
+  file << "bench=\"conf/dhrystone.riscv\"\n";
+  file.close();
+
+  Config::init("emul_dromajo_variant_test.toml");
+
+  return std::make_shared<Emul_dromajo>();
+}
+
+static void expect_same_stream(Emul_dromajo* ref, Emul_dromajo* other, int ninst) {
+  for (int i = 0; i < ninst; ++i) {
+    Dinst* d1 = ref->peek(0);
+    Dinst* d2 = other->peek(0);
+
+    EXPECT_EQ(d1->getPC(), d2->getPC());
+    EXPECT_EQ(d1->getAddr(), d2->getAddr());
+    EXPECT_EQ(d1->getInst()->getOpcode(), d2->getInst()->getOpcode());
+    EXPECT_EQ(d1->getInst()->getSrc1(), d2->getInst()->getSrc1());
+    EXPECT_EQ(d1->getInst()->getSrc2(), d2->getInst()->getSrc2());
+    EXPECT_EQ(d1->getInst()->getDst1(), d2->getInst()->getDst1());
+    EXPECT_EQ(d1->getInst()->getDst2(), d2->getInst()->getDst2());
+
+    d1->scrap();
+    d2->scrap();
+
+    ref->execute(0);
+    other->execute(0);
+  }
+}
+
+TEST_F(Emul_Dromajo_test, batched_matches_single_step) {
+  auto batched_ptr = create_variant("drom_batch", "batch = 64\n");
+
+  dromajo_ptr->skip_rabbit(0, 100);
+  batched_ptr->skip_rabbit(0, 100);
+
+  expect_same_stream(dromajo_ptr.get(), batched_ptr.get(), 5000);
+}
+
+TEST_F(Emul_Dromajo_test, decode_cache_matches_decode) {
+  // Tiny cache to force conflicts (hits, misses, and replacements)
+  auto nocache_ptr = create_variant("drom_nocache", "decode_cache = 0\n");
+  auto tiny_ptr    = create_variant("drom_tiny", "decode_cache = 8\n");
+
+  expect_same_stream(nocache_ptr.get(), tiny_ptr.get(), 5000);
+}
+
+TEST_F(Emul_Dromajo_test, warmup_before_detail) {
+  auto warm_ptr = create_variant("drom_warm", "warmup = 100\n");
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(warm_ptr->is_warmup(0));
+    Dinst* dinst = warm_ptr->peek(0);
+    ASSERT_NE(dinst, nullptr);
+    EXPECT_FALSE(dinst->has_stats());
+    dinst->scrap();
+    warm_ptr->execute(0);
+  }
+  EXPECT_FALSE(warm_ptr->is_warmup(0));
+  EXPECT_FALSE(dromajo_ptr->is_warmup(0));
+
+  // Warmup does not consume the detail/time budget
+  warm_ptr->set_detail(0);
+  warm_ptr->set_time(1);
+  Dinst* dinst = warm_ptr->peek(0);
+  ASSERT_NE(dinst, nullptr);
+  EXPECT_TRUE(dinst->has_stats());
+  dinst->scrap();
+}
+
+TEST_F(Emul_Dromajo_test, periodic_sampling) {
+  std::ofstream file;
+  file.open("emul_dromajo_sample_test.toml");
+
+  file << "[soc]\n";
+  file << "core = \"c0\"\n";
+  file << "emul = [\"drom_sample\"]\n";
+  file << "\n[drom_sample]\n";
+  file << "num = \"1\"\n";
+  file << "type = \"dromajo\"\n";
+  file << "rabbit = 50\n";
+  file << "warmup = 10\n";
+  file << "detail = 5\n";
+  file << "time = 20\n";
+  file << "samples = 3\n";
+  file << "bench=\"conf/dhrystone.riscv\"\n";
+  file.close();
+
+  Config::init("emul_dromajo_sample_test.toml");
+  Stats_sampler::reset();
+
+  auto sample_ptr = std::make_shared<Emul_dromajo>();
+
+  int n_stats = 0;
+  int n_total = 0;
+  int n_warm  = 0;
+  while (true) {
+    bool   warm  = sample_ptr->is_warmup(0);  // fetch checks it before peeking
+    Dinst* dinst = sample_ptr->peek(0);
+    if (dinst == nullptr) {
+      break;
+    }
+    // fetch may drop a peeked instruction and peek it again
+    dinst->scrap();
+    dinst = sample_ptr->peek(0);
+    ASSERT_NE(dinst, nullptr);
+
+    n_warm += warm ? 1 : 0;
+    n_stats += dinst->has_stats() ? 1 : 0;
+    ++n_total;
+
+    // retire
+    if (dinst->is_sample_begin()) {
+      Stats_sampler::mark();
+    }
+    if (dinst->is_sample_end()) {
+      Stats_sampler::sample(sample_ptr->pop_sample_weight());
+    }
+    dinst->scrap();
+    sample_ptr->execute(0);
+  }
+
+  EXPECT_EQ(n_total, 3 * (10 + 5 + 20));  // rabbit is skipped
+  EXPECT_EQ(n_warm, 3 * 10);
+  EXPECT_EQ(n_stats, 3 * 20);
+  EXPECT_EQ(Stats_sampler::size(), 3);
+}
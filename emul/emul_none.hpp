@@ -0,0 +1,34 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include "emul_base.hpp"
+
+// Emulator slot for cores that generate their own work (accel, traffic). It
+// never has instructions, it only makes the hart run.
+class Emul_none : public Emul_base {
+public:
+  Emul_none() { type = "none"; }
+
+  Dinst* peek(Hartid_t fid) override {
+    (void)fid;
+    return nullptr;
+  }
+  void execute(Hartid_t fid) override { (void)fid; }
+
+  Hartid_t get_num() const override { return 0; }
+  bool     is_sleeping(Hartid_t fid) const override {
+    (void)fid;
+    return false;
+  }
+
+  void skip_rabbit(Hartid_t fid, size_t ninst) override {
+    (void)fid;
+    (void)ninst;
+  }
+
+  bool is_warmup(Hartid_t fid) const override {
+    (void)fid;
+    return false;
+  }
+};
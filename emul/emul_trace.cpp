@@ -0,0 +1,134 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "emul_trace.hpp"
+
+#include "clock_domain.hpp"
+#include "emul_dromajo.hpp"
+#include "snippets.hpp"
+
+Emul_trace::Emul_trace() : Emul_base() {
+  num    = 0;
+  detail = 0;
+  time   = 0;
+
+  uint64_t    rabbit      = 0;
+  uint64_t    warmup_inst = 0;
+  uint32_t    cache_size  = 4096;
+  std::string prefix;
+
+  auto nemuls = Config::get_array_size("soc", "emul");
+  harts.resize(nemuls);
+
+  for (auto i = 0u; i < nemuls; ++i) {
+    auto tp = Config::get_string("soc", "emul", i, "type");
+    if (tp != "trace") {
+      continue;
+    }
+
+    if (num == 0) {
+      section = Config::get_string("soc", "emul", i);
+
+      prefix = Config::get_string(section, "trace");
+      rabbit = Config::get_integer(section, "rabbit");
+      detail = Config::get_integer(section, "detail");
+      time   = Config::get_integer(section, "time");
+      if (Config::has_entry(section, "warmup")) {
+        warmup_inst = Config::get_integer(section, "warmup", 0);
+      }
+      if (Config::has_entry(section, "samples") || Config::has_entry(section, "simpoints")) {
+        Config::add_error(fmt::format("section {} sampling (samples/simpoints) is not supported by trace", section));
+      }
+      if (Config::has_entry(section, "decode_cache")) {
+        cache_size = Config::get_integer(section, "decode_cache", 2, 1 << 20);
+      }
+    }
+
+    harts[i].reader = Trace_reader::open(Trace_reader::file_name(prefix, i));
+    harts[i].valid  = false;
+    harts[i].warmup = warmup_inst;
+    ++num;
+  }
+  Config::exit_on_error();
+
+  type = "trace";
+
+  decode_caches.resize(nemuls);
+  for (auto i = 0u; i < nemuls; ++i) {
+    if (harts[i].reader) {
+      decode_caches[i] = std::make_unique<Decode_cache>(i, section, cache_size);
+      if (rabbit) {
+        skip_rabbit(i, rabbit);
+      } else {
+        execute(i);  // to set the last
+      }
+    }
+  }
+}
+
+std::unique_lock<std::mutex> Emul_trace::lock_counters() {
+  std::unique_lock<std::mutex> lock(counters_mutex, std::defer_lock);
+  if (Clock_domain::is_parallel()) {
+    lock.lock();
+  }
+  return lock;
+}
+
+Instruction Emul_trace::decode_cached(Hartid_t fid, uint32_t insn_raw) {
+  auto& dc = *decode_caches[fid];
+
+  bool hit;
+  auto inst = dc.lookup(insn_raw, hit);
+  dc.count(hit);
+
+  return inst;
+}
+
+Dinst* Emul_trace::peek(Hartid_t fid) {
+  auto& h = harts[fid];
+  if (unlikely(!h.valid)) {
+    return nullptr;  // end of trace
+  }
+
+  auto inst  = decode_cached(fid, h.last.insn);
+  auto paddr = Emul_dromajo::get_paddr(inst.getOpcode(), h.last.pc, h.last.next_pc, h.last.addr);
+
+  if (h.warmup > 0) {
+    --h.warmup;
+    return Dinst::create(std::move(inst), h.last.pc, paddr, fid, false);
+  }
+
+  auto lock = lock_counters();
+  if (detail > 0) {
+    --detail;
+    return Dinst::create(std::move(inst), h.last.pc, paddr, fid, false);
+  }
+  if (time > 0) {
+    --time;
+    return Dinst::create(std::move(inst), h.last.pc, paddr, fid, true);
+  }
+
+  return nullptr;
+}
+
+void Emul_trace::skip_rabbit(Hartid_t fid, size_t ninst) {
+  I(ninst > 0);
+
+  auto& h = harts[fid];
+  for (size_t i = 1; i < ninst; ++i) {
+    if (!h.reader->next(h.last)) {
+      break;
+    }
+  }
+
+  execute(fid);
+}
+
+void Emul_trace::execute(Hartid_t fid) {
+  auto& h = harts[fid];
+  h.valid = h.reader->next(h.last);
+}
+
+bool Emul_trace::is_sleeping(Hartid_t fid) const {
+  fmt::print("called is_sleeping on hartid {}\n", static_cast<int>(fid));
+  return true;
+}
@@ -0,0 +1,54 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "decode_cache.hpp"
+#include "emul_base.hpp"
+#include "instruction.hpp"
+#include "trace_file.hpp"
+
+// Replays traces recorded by Emul_dromajo (`record` option). There is no
+// machine to step, so a sweep over the same workload only pays for the timing
+// model. The rabbit/warmup/detail/time phases work like in Emul_dromajo, and
+// replaying with the same phases gives the same instruction stream.
+class Emul_trace : public Emul_base {
+private:
+  static inline std::mutex counters_mutex;  // detail/time are shared by all the harts
+  [[nodiscard]] std::unique_lock<std::mutex> lock_counters();
+
+  uint64_t num;
+  uint64_t detail;
+  uint64_t time;
+
+  struct Hart {
+    std::unique_ptr<Trace_reader> reader;
+    Trace_record                  last;
+    bool                          valid;  // last is an instruction, false at the end of the trace
+    uint64_t                      warmup;
+  };
+  std::vector<Hart> harts;  // indexed by fid, only the trace harts have a reader
+
+  std::vector<std::unique_ptr<Decode_cache>> decode_caches;  // only the trace harts have one
+
+  Instruction decode_cached(Hartid_t fid, uint32_t insn_raw);
+
+public:
+  Emul_trace();
+  Emul_trace(const Emul_trace&)            = delete;
+  Emul_trace& operator=(const Emul_trace&) = delete;
+  ~Emul_trace() override                   = default;
+
+  Dinst* peek(Hartid_t fid) final;
+
+  void skip_rabbit(Hartid_t fid, size_t ninst) final;
+  void execute(Hartid_t fid) final;
+
+  [[nodiscard]] Hartid_t get_num() const final { return num; }
+  [[nodiscard]] bool     is_sleeping(Hartid_t fid) const final;
+  [[nodiscard]] bool     is_warmup(Hartid_t fid) const final { return harts[fid].warmup > 0; }
+};
@@ -0,0 +1,137 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "emul_trace.hpp"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "trace_file.hpp"
+
+// c.addi, ld, beq (taken), c.j, sd, jal
+static std::vector<Trace_record> sample_records() {
+  return {
+      {0x80000000, 0x80000002, 0, 0x0505},             // c.addi a0, 1
+      {0x80000002, 0x80000006, 0x80001000, 0x0005b503},  // ld a0, 0(a1)
+      {0x80000006, 0x80000000, 0x80001000, 0xfe050de3},  // beq a0, x0, -6 (taken)
+      {0x80000000, 0x80000002, 0x80001000, 0x0505},      // c.addi a0, 1
+      {0x80000002, 0x80000006, 0x80000ff8, 0x0005b503},  // ld a0, 0(a1) (new address)
+      {0x80000006, 0x8000000a, 0x80000ff8, 0xfe050de3},  // beq not taken
+      {0x8000000a, 0x8000000e, 0x80002000, 0x00a5b023},  // sd a0, 0(a1)
+      {0x8000000e, 0x80100000, 0x80002000, 0x0f2000ef},  // jal ra, far
+  };
+}
+
+class Emul_trace_test : public ::testing::Test {
+protected:
+  std::string prefix;
+
+  void SetUp() override {
+    prefix = fmt::format("emul_trace_test_{}", getpid());
+
+    Trace_writer wr(Trace_reader::file_name(prefix, 0));
+    for (const auto& r : sample_records()) {
+      wr.append(r);
+    }
+  }
+
+  void TearDown() override { unlink(Trace_reader::file_name(prefix, 0).c_str()); }
+
+  void config(const std::string& phases) {
+    std::ofstream file("emul_trace_test.toml");
+    file << "[soc]\n";
+    file << "core = [\"c0\"]\n";
+    file << "emul = [\"trace_emu\"]\n";
+    file << "\n[trace_emu]\n";
+    file << "type = \"trace\"\n";
+    file << "trace = \"" << prefix << "\"\n";
+    file << phases;
+    file.close();
+
+    Config::init("emul_trace_test.toml");
+  }
+};
+
+TEST_F(Emul_trace_test, round_trip) {
+  auto ref = sample_records();
+
+  auto tr = Trace_reader::open(Trace_reader::file_name(prefix, 0));
+  ASSERT_NE(tr, nullptr);
+  EXPECT_EQ(tr->get_n_records(), ref.size());
+
+  Trace_record rec;
+  for (const auto& r : ref) {
+    ASSERT_TRUE(tr->next(rec));
+    EXPECT_EQ(rec.pc, r.pc);
+    EXPECT_EQ(rec.next_pc, r.next_pc);
+    EXPECT_EQ(rec.addr, r.addr);
+    EXPECT_EQ(rec.insn, r.insn);
+  }
+  EXPECT_FALSE(tr->next(rec));
+
+  // Sequential instructions only pay for the flags and the encoding
+  auto sz = std::ifstream(Trace_reader::file_name(prefix, 0), std::ios::binary | std::ios::ate).tellg();
+  EXPECT_LT(sz, static_cast<std::streamoff>(16 + ref.size() * 8));
+}
+
+TEST_F(Emul_trace_test, replay_phases) {
+  config("rabbit = 0\nwarmup = 2\ndetail = 1\ntime = 4\n");
+
+  Emul_trace emul;
+  EXPECT_EQ(emul.get_num(), 1U);
+
+  std::vector<Dinst*> insts;
+  std::vector<bool>   warm;
+  while (true) {
+    warm.push_back(emul.is_warmup(0));
+    auto* dinst = emul.peek(0);
+    if (dinst == nullptr) {
+      break;
+    }
+    insts.push_back(dinst);
+    emul.execute(0);
+  }
+  ASSERT_EQ(insts.size(), 7U);  // warmup + detail + time
+
+  EXPECT_TRUE(warm[0] && warm[1] && !warm[2]);
+  EXPECT_FALSE(insts[2]->has_stats());
+  EXPECT_TRUE(insts[3]->has_stats());
+
+  EXPECT_EQ(insts[1]->getPC(), 0x80000002U);
+  EXPECT_TRUE(insts[1]->getInst()->isLoad());
+  EXPECT_EQ(insts[1]->getAddr(), 0x80001000U);
+
+  EXPECT_TRUE(insts[2]->getInst()->isBranch());
+  EXPECT_EQ(insts[2]->getAddr(), 0x80000000U);  // taken
+  EXPECT_EQ(insts[5]->getAddr(), 0U);           // not taken
+
+  EXPECT_TRUE(insts[6]->getInst()->isStore());
+  EXPECT_EQ(insts[6]->getAddr(), 0x80002000U);
+
+  for (auto* dinst : insts) {
+    dinst->scrap();
+  }
+}
+
+TEST_F(Emul_trace_test, rabbit_and_end_of_trace) {
+  config("rabbit = 3\ndetail = 0\ntime = 100\n");
+
+  Emul_trace emul;
+
+  auto* dinst = emul.peek(0);
+  ASSERT_NE(dinst, nullptr);
+  EXPECT_EQ(dinst->getPC(), 0x80000006U);  // third record, same position as Emul_dromajo::skip_rabbit
+  EXPECT_EQ(dinst->getAddr(), 0x80000000U);
+  dinst->scrap();
+
+  int n = 1;
+  emul.execute(0);
+  while ((dinst = emul.peek(0)) != nullptr) {
+    dinst->scrap();
+    emul.execute(0);
+    ++n;
+  }
+  EXPECT_EQ(n, 6);
+}
@@ -0,0 +1,219 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "trace_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "config.hpp"
+#include "fmt/format.h"
+
+static constexpr uint64_t trace_magic  = 0x31304352'54534544ULL;  // "DESTRC01"
+static constexpr size_t   trace_header = 16;
+static constexpr size_t   trace_flush  = 1 << 20;
+
+enum Trace_flags : uint8_t {
+  flag_pc_jump = 1,
+  flag_rvc     = 2,
+  flag_taken   = 4,
+  flag_addr    = 8,
+};
+
+static inline uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+static inline int64_t  unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+std::string Trace_reader::file_name(const std::string& prefix, uint32_t fid) { return fmt::format("{}.{}.trace", prefix, fid); }
+
+//////////////////////////////////////////////
+// Trace_writer
+
+Trace_writer::Trace_writer(const std::string& _file_name) : file_name(_file_name) {
+  fp = fopen(file_name.c_str(), "wb");
+  if (fp == nullptr) {
+    Config::add_error(fmt::format("trace {} could not be created", file_name));
+    return;
+  }
+
+  uint64_t hdr[2] = {trace_magic, 0};
+  fwrite(hdr, sizeof(hdr), 1, fp);
+  buffer.reserve(trace_flush + 64);
+}
+
+Trace_writer::~Trace_writer() { close(); }
+
+void Trace_writer::put_varint(int64_t v) {
+  uint64_t u = zigzag(v);
+  while (u >= 0x80) {
+    buffer.push_back(static_cast<uint8_t>(u | 0x80));
+    u >>= 7;
+  }
+  buffer.push_back(static_cast<uint8_t>(u));
+}
+
+void Trace_writer::flush() {
+  if (fp && !buffer.empty()) {
+    fwrite(buffer.data(), 1, buffer.size(), fp);
+  }
+  buffer.clear();
+}
+
+void Trace_writer::append(const Trace_record& rec) {
+  bool     rvc = (rec.insn & 0x3) != 0x3;
+  uint64_t len = rvc ? 2 : 4;
+
+  uint8_t flags = rvc ? flag_rvc : 0;
+  if (rec.pc != last_next_pc) {
+    flags |= flag_pc_jump;
+  }
+  if (rec.next_pc != rec.pc + len) {
+    flags |= flag_taken;
+  }
+  if (rec.addr != last_addr) {
+    flags |= flag_addr;
+  }
+
+  buffer.push_back(flags);
+  buffer.push_back(static_cast<uint8_t>(rec.insn));
+  buffer.push_back(static_cast<uint8_t>(rec.insn >> 8));
+  if (!rvc) {
+    buffer.push_back(static_cast<uint8_t>(rec.insn >> 16));
+    buffer.push_back(static_cast<uint8_t>(rec.insn >> 24));
+  }
+  if (flags & flag_pc_jump) {
+    put_varint(static_cast<int64_t>(rec.pc - last_next_pc));
+  }
+  if (flags & flag_taken) {
+    put_varint(static_cast<int64_t>(rec.next_pc - rec.pc));
+  }
+  if (flags & flag_addr) {
+    put_varint(static_cast<int64_t>(rec.addr - last_addr));
+  }
+
+  last_next_pc = rec.next_pc;
+  last_addr    = rec.addr;
+  n_records++;
+
+  if (buffer.size() >= trace_flush) {
+    flush();
+  }
+}
+
+void Trace_writer::close() {
+  if (fp == nullptr) {
+    return;
+  }
+
+  flush();
+
+  uint64_t hdr[2] = {trace_magic, n_records};
+  fseek(fp, 0, SEEK_SET);
+  fwrite(hdr, sizeof(hdr), 1, fp);
+  fclose(fp);
+  fp = nullptr;
+}
+
+//////////////////////////////////////////////
+// Trace_reader
+
+Trace_reader::~Trace_reader() {
+  if (map_base) {
+    munmap(const_cast<uint8_t*>(map_base), map_size);
+  }
+}
+
+std::unique_ptr<Trace_reader> Trace_reader::open(const std::string& file_name) {
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    Config::add_error(fmt::format("trace {} could not be opened", file_name));
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < trace_header) {
+    ::close(fd);
+    Config::add_error(fmt::format("trace {} is not a valid trace", file_name));
+    return nullptr;
+  }
+
+  auto  sz  = static_cast<size_t>(st.st_size);
+  void* ptr = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    Config::add_error(fmt::format("trace {} could not be mapped", file_name));
+    return nullptr;
+  }
+  madvise(ptr, sz, MADV_SEQUENTIAL);
+
+  std::unique_ptr<Trace_reader> tr(new Trace_reader());
+  tr->map_base = static_cast<const uint8_t*>(ptr);
+  tr->map_size = sz;
+
+  uint64_t hdr[2];
+  std::memcpy(hdr, tr->map_base, sizeof(hdr));
+  if (hdr[0] != trace_magic) {
+    Config::add_error(fmt::format("trace {} has a bad header", file_name));
+    return nullptr;
+  }
+
+  tr->n_records = hdr[1];
+  tr->cursor    = tr->map_base + trace_header;
+  tr->end       = tr->map_base + sz;
+
+  return tr;
+}
+
+int64_t Trace_reader::get_varint() {
+  uint64_t u     = 0;
+  int      shift = 0;
+  while (cursor < end) {
+    uint8_t b = *cursor++;
+    u |= static_cast<uint64_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) {
+      break;
+    }
+    shift += 7;
+  }
+  return unzigzag(u);
+}
+
+bool Trace_reader::next(Trace_record& rec) {
+  if (n_read >= n_records || cursor + 3 > end) {
+    return false;
+  }
+
+  uint8_t flags = *cursor++;
+  bool    rvc   = flags & flag_rvc;
+
+  rec.insn = cursor[0] | (static_cast<uint32_t>(cursor[1]) << 8);
+  cursor += 2;
+  if (!rvc) {
+    if (cursor + 2 > end) {
+      return false;
+    }
+    rec.insn |= (static_cast<uint32_t>(cursor[0]) << 16) | (static_cast<uint32_t>(cursor[1]) << 24);
+    cursor += 2;
+  }
+
+  rec.pc = last_next_pc;
+  if (flags & flag_pc_jump) {
+    rec.pc += get_varint();
+  }
+  rec.next_pc = rec.pc + (rvc ? 2 : 4);
+  if (flags & flag_taken) {
+    rec.next_pc = rec.pc + get_varint();
+  }
+  rec.addr = last_addr;
+  if (flags & flag_addr) {
+    rec.addr += get_varint();
+  }
+
+  last_next_pc = rec.next_pc;
+  last_addr    = rec.addr;
+  n_read++;
+
+  return true;
+}
@@ -0,0 +1,93 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Instruction trace for the "trace" emulator, recorded from Emul_dromajo.
+//
+// Each record is one retired instruction: pc, raw encoding, next_pc, and the
+// last data address reported by the emulator. Records are delta encoded
+// against the previous one, so a sequential non-memory instruction takes 3 or
+// 5 bytes (flags plus the 16/32 bit encoding):
+//
+//   flags    pc_jump  pc != previous next_pc     zigzag varint (pc - previous next_pc)
+//            rvc      16 bit encoding            2 or 4 bytes of insn
+//            taken    next_pc != pc + length     zigzag varint (next_pc - pc)
+//            addr     addr != previous addr      zigzag varint (addr - previous addr)
+//
+// The file starts with a 16 byte header (magic, number of records) and is
+// mmap-ed on replay.
+struct Trace_record {
+  uint64_t pc;
+  uint64_t next_pc;
+  uint64_t addr;
+  uint32_t insn;
+};
+
+class Trace_writer {
+private:
+  const std::string file_name;
+  FILE*             fp;
+
+  std::vector<uint8_t> buffer;
+  uint64_t             n_records = 0;
+
+  uint64_t last_next_pc = 0;
+  uint64_t last_addr    = 0;
+
+  void put_varint(int64_t v);
+  void flush();
+
+public:
+  explicit Trace_writer(const std::string& _file_name);
+  ~Trace_writer();
+
+  Trace_writer(const Trace_writer&)            = delete;
+  Trace_writer& operator=(const Trace_writer&) = delete;
+
+  void append(const Trace_record& rec);
+  void close();
+
+  [[nodiscard]] uint64_t get_n_records() const { return n_records; }
+};
+
+class Trace_reader {
+private:
+  const uint8_t* map_base = nullptr;
+  size_t         map_size = 0;
+  const uint8_t* cursor   = nullptr;
+  const uint8_t* end      = nullptr;
+
+  uint64_t n_records = 0;
+  uint64_t n_read    = 0;
+
+  uint64_t last_next_pc = 0;
+  uint64_t last_addr    = 0;
+
+  Trace_reader() = default;
+
+  int64_t get_varint();
+
+public:
+  ~Trace_reader();
+
+  Trace_reader(const Trace_reader&)            = delete;
+  Trace_reader& operator=(const Trace_reader&) = delete;
+
+  // nullptr (and a Config error) when the file is missing or not a trace
+  static std::unique_ptr<Trace_reader> open(const std::string& file_name);
+
+  // false at the end of the trace
+  bool next(Trace_record& rec);
+
+  [[nodiscard]] uint64_t get_n_records() const { return n_records; }
+  [[nodiscard]] uint64_t get_n_read() const { return n_read; }
+
+  // One file per hart: <prefix>.<fid>.trace
+  static std::string file_name(const std::string& prefix, uint32_t fid);
+};
@@ -2,31 +2,209 @@
 
 #include "tracer.hpp"
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
 #include "absl/strings/str_cat.h"
+#include "clock_domain.hpp"
 #include "config.hpp"
 #include "fmt/format.h"
 #include "iassert.hpp"
 #include "report.hpp"
 
 bool Tracer::open(const std::string& fname) {
-  auto file_name = absl::StrCat(fname, ".", Report::get_extension());
+  close();
+
+  if (Clock_domain::is_parallel()) {
+    Config::add_error("[trace] range is not supported with [soc] parallel (the trace ring has a single producer)");
+    return false;
+  }
+
+  auto file_name = absl::StrCat(fname, ".", Report::get_extension(), ".bin");
 
-  ofs.open(file_name);
-  if (!ofs) {
+  fp = fopen(file_name.c_str(), "wb");
+  if (fp == nullptr) {
     Config::add_error(fmt::format("unable to open trace file {}", file_name));
     track_from = UINT64_MAX;
     track_to   = UINT64_MAX;
     return false;
   }
+  fwrite(&magic, sizeof(magic), 1, fp);
+
+  static bool exit_hook = false;
+  if (!exit_hook) {
+    std::atexit(Tracer::close);  // the writer thread must be joined before exit
+    exit_hook = true;
+  }
+
+  started.clear();
+  pc_index.clear();
+  pc_text.clear();
+  names.clear();
+  name_index.clear();
+
+  ring        = std::make_unique<Spsc_ring<Record>>(1 << 16);
+  writer_stop = false;
+  writer      = std::thread(writer_loop);
 
   main_clock_set = false;
-  last_clock     = 0;
   track_from     = 0;
   track_to       = UINT64_MAX;
   // track_to       = 2*UINT64_MAX;
 
+  Dinst::keep_cold(true);
+
   return true;
 }
+
+void Tracer::close() {
+  if (fp == nullptr) {
+    return;
+  }
+
+  writer_stop.store(true, std::memory_order_release);
+  writer.join();
+  ring = nullptr;
+
+  // Trailer: stage names, pc disassembly, and the trailer offset last
+  uint64_t offset = ftello(fp);
+
+  auto put_str = [](const std::string& str) {
+    uint16_t len = str.size();
+    fwrite(&len, sizeof(len), 1, fp);
+    fwrite(str.data(), 1, len, fp);
+  };
+
+  uint32_t n_names = names.size();
+  fwrite(&n_names, sizeof(n_names), 1, fp);
+  for (const auto& n : names) {
+    put_str(n);
+  }
+
+  uint32_t n_text = pc_text.size();
+  fwrite(&n_text, sizeof(n_text), 1, fp);
+  for (const auto& [pc, txt] : pc_text) {
+    fwrite(&pc, sizeof(pc), 1, fp);
+    put_str(txt);
+  }
+
+  fwrite(&offset, sizeof(offset), 1, fp);
+  fclose(fp);
+  fp = nullptr;
+
+  track_from = UINT64_MAX;
+  track_to   = UINT64_MAX;
+}
+
+// Each record is the kind byte followed by:
+//   begin, clock     varint (cycle - previous cycle)
+//   start            zigzag varint (id - previous id), varint text, varint fid
+//   stage, event     code byte, zigzag varint (id - previous id)
+//   retire, flush    zigzag varint (id - previous id)
+static void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v) | 0x80);
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+static uint64_t zigzag(uint64_t v, uint64_t last) {
+  auto d = static_cast<int64_t>(v - last);
+  return (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+}
+
+void Tracer::writer_loop() {
+  std::vector<uint8_t> buffer;
+  buffer.reserve(1 << 17);
+
+  uint64_t last_id    = 0;
+  uint64_t last_cycle = 0;
+
+  while (true) {
+    // Read before draining: once set, the producer has pushed its last record
+    bool stop = writer_stop.load(std::memory_order_acquire);
+
+    bool    drained = false;
+    Record* r;
+    while ((r = ring->ref_head()) != nullptr) {
+      buffer.push_back(static_cast<uint8_t>(r->kind));
+      switch (r->kind) {
+        case Kind::begin:
+        case Kind::clock:
+          put_varint(buffer, r->val - last_cycle);
+          last_cycle = r->val;
+          break;
+        case Kind::start:
+          put_varint(buffer, zigzag(r->val, last_id));
+          put_varint(buffer, r->text);
+          put_varint(buffer, r->fid);
+          last_id = r->val;
+          break;
+        case Kind::stage:
+        case Kind::event:
+          buffer.push_back(r->code);
+          [[fallthrough]];
+        default:
+          put_varint(buffer, zigzag(r->val, last_id));
+          last_id = r->val;
+          break;
+      }
+      ring->pop();
+      drained = true;
+
+      if (buffer.size() >= (1 << 16)) {
+        fwrite(buffer.data(), 1, buffer.size(), fp);
+        buffer.clear();
+      }
+    }
+
+    if (!buffer.empty()) {
+      fwrite(buffer.data(), 1, buffer.size(), fp);
+      buffer.clear();
+    }
+    if (stop) {
+      return;
+    }
+    if (!drained) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+}
+
+void Tracer::push(Kind kind, uint64_t val, uint8_t code, uint32_t text, uint16_t fid) {
+  I(ring);
+
+  Record* r = ring->ref_tail();
+  while (r == nullptr) {  // never drop, wait for the writer
+    std::this_thread::yield();
+    r = ring->ref_tail();
+  }
+
+  r->val  = val;
+  r->text = text;
+  r->kind = kind;
+  r->code = code;
+  r->fid  = fid;
+  ring->push();
+}
+
+uint8_t Tracer::name_code(std::string_view ev) {
+  std::string key{ev};  // stages and events fit the small string buffer
+
+  auto it = name_index.find(key);
+  if (it != name_index.end()) {
+    return it->second;
+  }
+
+  I(names.size() < 256);
+  uint8_t code = names.size();
+  names.emplace_back(key);
+  name_index.emplace(std::move(key), code);
+  return code;
+}
+
 bool Tracer::open_t(const std::string& fname_t) {
   auto file_name = absl::StrCat(fname_t, ".", Report::get_extension());
 
@@ -48,38 +226,37 @@ bool Tracer::open_t(const std::string& fname_t) {
 }
 
 void Tracer::track_range(uint64_t from, uint64_t to) {
-  I(ofs);
+  I(fp);
 
   track_from = from;
   track_to   = to;
 }
 
-void Tracer::stage(const Dinst* dinst, const std::string ev) {
+void Tracer::stage(const Dinst* dinst, std::string_view ev) {
   I(ev.size() <= 4);  // tracer stages should have 4 or less characers
 
-  if (dinst->getID() > track_to || dinst->getID() < track_from) {
+  if (!in_range(dinst)) {
     return;
   }
 
   adjust_clock();
   // if (!dinst->isTransient()) then id=getNTID()
   // if (dinst->isTransient()) then id=getNIID()//no increase in T
-  int id = dinst->getID();
-
-  if (!started.contains(id)) {
-    ofs << "I\t" << std::dec << id - track_from << "\t" << id - track_from << "\t" << dinst->getFlowId() << "\n";
-    ofs << "L\t" << std::dec << id - track_from << "\t0\t" << std::hex << dinst->getPC() << " " << dinst->getInst()->get_asm()
-        << "\n";
-    // dinst->getNTID(); which NTID will not increase in Transient instruction;only increase in NT instruction
-    // ofs << "L\t" << std::dec << id - track_from << "\t0\t" << std::hex << dinst->getPC() << " " << dinst->getNTID()
-    started.insert(id);
+  uint64_t id = dinst->getID();
+
+  if (started.insert(id).second) {
+    auto pc        = dinst->getPC();
+    auto [it, ins] = pc_index.try_emplace(pc, pc_text.size());
+    if (ins) {
+      pc_text.emplace_back(pc, dinst->getInst()->get_asm());
+    }
+    I(dinst->getFlowId() < 65535);
+    push(Kind::start, id - track_from, 0, it->second, dinst->getFlowId());
   }
 
-  ofs << fmt::format("S\t{}\t0\t{}\n", id - track_from, ev);
-  if (ev == "WB" || ev == "RN" || ev == "PNR") {
-    pending_end.emplace_back(fmt::format("E\t{}\t0\t{}\n", id - track_from, ev));
-  }
+  push(Kind::stage, id - track_from, name_code(ev));
 }
+
 void Tracer::time_diff(const Dinst* dinst, const std::string ev, int global_clock) {
   I(ev.size() <= 4);  // tracer stages should have 4 or less characers
 
@@ -111,69 +288,212 @@ void Tracer::time_diff(const Dinst* dinst, const std::string ev, int global_cloc
   // }
 }
 
-void Tracer::event(const Dinst* dinst, const std::string ev) {
+void Tracer::event(const Dinst* dinst, std::string_view ev) {
   I(ev.size() <= 8);  // tracer events should have 8 or less characers
 
-  if (dinst->getID() > track_to || dinst->getID() < track_from) {
+  if (!in_range(dinst)) {
     return;
   }
 
   I(started.contains(dinst->getID()));  // events should be called once an instruction is already started
 
   adjust_clock();
-  int id = dinst->getID();
-
-  ofs << fmt::format("S\t{}\t1\t{}\n", id - track_from, ev);
-
-  pending_end.emplace_back(fmt::format("E\t{}\t1\t{}\n", id - track_from, ev));
+  push(Kind::event, dinst->getID() - track_from, name_code(ev));
 }
 
 void Tracer::commit(const Dinst* dinst) {
-  if (dinst->getID() > track_to || dinst->getID() < track_from) {
+  if (!in_range(dinst)) {
     return;
   }
 
   adjust_clock();
-  int id = dinst->getID();
 
   stage(dinst, "CO");
-  pending_end.emplace_back(fmt::format("R\t{}\t{}\t0\n", id - track_from, id - track_from));
+  push(Kind::retire, dinst->getID() - track_from);
 }
 
 void Tracer::flush(const Dinst* dinst) {
-  if (dinst->getID() > track_to || dinst->getID() < track_from) {
+  if (!in_range(dinst)) {
     return;
   }
 
   adjust_clock();
-  int id = dinst->getID();
-
-  ofs << fmt::format("R\t{}\t{}\t1\n", id - track_from, id - track_from);
+  push(Kind::flush, dinst->getID() - track_from);
 }
 
 void Tracer::adjust_clock() {
   if (!main_clock_set) {
-    ofs << "Kanata\t0004\n";
-    // ofs << "C=\t" << std::dec << globalClock << "\n";
-    ofs << "C=\t0\n";  // Easier to read
+    push(Kind::begin, globalClock);
     main_clock_set = true;
-    last_clock     = globalClock;
   }
 }
 
 void Tracer::advance_clock() {
   if (main_clock_set) {
-    ofs << "C\t" << std::dec << globalClock - last_clock << "\n";
+    push(Kind::clock, globalClock);
   }
-  last_clock = globalClock;
+}
 
-  if (pending_end.empty()) {
-    return;
+bool Tracer::convert(const std::string& bin_file, std::ostream& out) {
+  FILE* in = fopen(bin_file.c_str(), "rb");
+  if (in == nullptr) {
+    return false;
+  }
+  std::vector<uint8_t> buf;
+  uint8_t              chunk[65536];
+  size_t               n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+    buf.insert(buf.end(), chunk, chunk + n);
+  }
+  fclose(in);
+
+  auto get = [&buf](size_t pos, auto& v) {
+    if (pos + sizeof(v) > buf.size()) {
+      return false;
+    }
+    memcpy(&v, &buf[pos], sizeof(v));
+    return true;
+  };
+
+  uint64_t m      = 0;
+  uint64_t offset = 0;
+  if (!get(0, m) || m != magic || !get(buf.size() - sizeof(offset), offset)) {
+    return false;
+  }
+  if (offset < sizeof(magic) || offset > buf.size() - sizeof(offset)) {
+    return false;
   }
 
-  I(main_clock_set);
-  for (const auto& txt : pending_end) {
-    ofs << txt;
+  size_t pos     = offset;
+  auto   get_str = [&](std::string& str) {
+    uint16_t len = 0;
+    if (!get(pos, len) || pos + sizeof(len) + len > buf.size()) {
+      return false;
+    }
+    str.assign(reinterpret_cast<const char*>(&buf[pos + sizeof(len)]), len);
+    pos += sizeof(len) + len;
+    return true;
+  };
+
+  uint32_t n_names = 0;
+  if (!get(pos, n_names)) {
+    return false;
   }
-  pending_end.clear();
+  pos += sizeof(n_names);
+  std::vector<std::string> code_names(n_names);
+  for (auto& str : code_names) {
+    if (!get_str(str)) {
+      return false;
+    }
+  }
+
+  uint32_t n_text = 0;
+  if (!get(pos, n_text)) {
+    return false;
+  }
+  pos += sizeof(n_text);
+  std::vector<std::pair<Addr_t, std::string>> text(n_text);
+  for (auto& [pc, txt] : text) {
+    if (!get(pos, pc)) {
+      return false;
+    }
+    pos += sizeof(pc);
+    if (!get_str(txt)) {
+      return false;
+    }
+  }
+
+  // Records, same encoding as writer_loop
+  pos      = sizeof(magic);
+  bool bad = false;
+
+  auto get_byte = [&]() -> uint8_t {
+    if (pos >= offset) {
+      bad = true;
+      return 0;
+    }
+    return buf[pos++];
+  };
+  auto get_varint = [&]() {
+    uint64_t v     = 0;
+    int      shift = 0;
+    uint8_t  b;
+    do {
+      b = get_byte();
+      v |= static_cast<uint64_t>(b & 0x7F) << shift;
+      shift += 7;
+    } while ((b & 0x80) && !bad && shift < 64);
+    return v;
+  };
+  uint64_t last_id = 0;
+  auto     get_id  = [&]() {
+    uint64_t z = get_varint();
+    last_id += static_cast<uint64_t>(static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1));
+    return last_id;
+  };
+
+  std::vector<std::string> pending_end;
+
+  while (pos < offset && !bad) {
+    auto kind = static_cast<Kind>(get_byte());
+
+    switch (kind) {
+      case Kind::begin:
+        get_varint();  // first cycle, the text starts at 0
+        out << "Kanata\t0004\n";
+        out << "C=\t0\n";  // Easier to read
+        break;
+      case Kind::clock: {
+        out << fmt::format("C\t{}\n", get_varint());
+        for (const auto& txt : pending_end) {
+          out << txt;
+        }
+        pending_end.clear();
+        break;
+      }
+      case Kind::start: {
+        auto id  = get_id();
+        auto idx = get_varint();
+        auto fid = get_varint();
+        if (idx >= text.size()) {
+          return false;
+        }
+        out << fmt::format("I\t{}\t{}\t{}\n", id, id, fid);
+        out << fmt::format("L\t{}\t0\t{:x} {}\n", id, text[idx].first, text[idx].second);
+        break;
+      }
+      case Kind::stage:
+      case Kind::event: {
+        auto code = get_byte();
+        auto id   = get_id();
+        if (code >= code_names.size()) {
+          return false;
+        }
+        const auto& name = code_names[code];
+        if (kind == Kind::event) {
+          out << fmt::format("S\t{}\t1\t{}\n", id, name);
+          pending_end.emplace_back(fmt::format("E\t{}\t1\t{}\n", id, name));
+        } else {
+          out << fmt::format("S\t{}\t0\t{}\n", id, name);
+          if (name == "WB" || name == "RN" || name == "PNR") {
+            pending_end.emplace_back(fmt::format("E\t{}\t0\t{}\n", id, name));
+          }
+        }
+        break;
+      }
+      case Kind::retire: {
+        auto id = get_id();
+        pending_end.emplace_back(fmt::format("R\t{}\t{}\t0\n", id, id));
+        break;
+      }
+      case Kind::flush: {
+        auto id = get_id();
+        out << fmt::format("R\t{}\t{}\t1\n", id, id);
+        break;
+      }
+      default: return false;
+    }
+  }
+
+  return !bad;
 }
@@ -1,18 +1,40 @@
 // See license for details
 
+#pragma once
+
+#include <atomic>
 #include <cstdint>
+#include <cstdio>
 #include <fstream>
+#include <memory>
+#include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "dinst.hpp"
+#include "spsc_ring.hpp"
 
+// Kanata pipeline trace for the [trace] range instructions.
+//
+// The simulation thread only pushes fixed size records (kind, stage code, id
+// or cycle) into an SPSC ring. A writer thread drains the ring and delta/varint
+// encodes it to <fname>.<ext>.bin, so a stage is about 3 bytes and a clock
+// tick 2. Stage names and the disassembly of each PC are interned and written
+// as a trailer on close. convert() (and the tracer_conv tool) produces the
+// Kanata 0004 text from the binary file.
+//
+// There is a single ring, so a single producer: tracing is rejected when
+// [soc] parallel runs the cores in their own threads.
 class Tracer {
 public:
   static bool open(const std::string& fname);
   static bool open_t(const std::string& fname_t);
+  static void close();
 
   Tracer() {
     // disabled until open
@@ -22,35 +44,60 @@ public:
 
   static void track_range(uint64_t from, uint64_t to = UINT64_MAX);
 
-  static void stage(const Dinst*, const std::string ev);
+  static void stage(const Dinst*, std::string_view ev);
   static void time_diff(const Dinst* dinst, const std::string ev, const int global_clock);
-  static void event(const Dinst*, const std::string ev);
+  static void event(const Dinst*, std::string_view ev);
 
   static void commit(const Dinst*);
   static void flush(const Dinst*);
 
   static void advance_clock();
 
+  // Binary trace to Kanata text, false if bin_file is not a trace
+  static bool convert(const std::string& bin_file, std::ostream& out);
+
   ~Tracer() {
-    if (ofs) {
-      ofs.close();
-    }
     if (ofst) {
       ofst.close();
     }
   }
 
 private:
-  static void adjust_clock();
+  enum class Kind : uint8_t { begin, clock, start, stage, event, retire, flush };
+
+  struct Record {
+    uint64_t val;   // cycle for begin/clock, id relative to track_from otherwise
+    uint32_t text;  // start: index in pc_text
+    Kind     kind;
+    uint8_t  code;  // stage/event: index in names
+    uint16_t fid;
+  };
+  static_assert(sizeof(Record) == 16);
 
-  static inline absl::flat_hash_set<uint64_t> started;
-  static inline std::vector<std::string>      pending_end;
+  static constexpr uint64_t magic = 0x31424154414e414bULL;  // "KANATAB1"
 
-  static inline bool   main_clock_set;
-  static inline Time_t last_clock;
+  static bool in_range(const Dinst* dinst) { return dinst->getID() <= track_to && dinst->getID() >= track_from; }
 
-  static inline uint64_t      track_from;
-  static inline uint64_t      track_to;
-  static inline std::ofstream ofs;
+  static void    adjust_clock();
+  static uint8_t name_code(std::string_view ev);
+  static void    push(Kind kind, uint64_t val, uint8_t code = 0, uint32_t text = 0, uint16_t fid = 0);
+  static void    writer_loop();
+
+  static inline absl::flat_hash_set<uint64_t>               started;
+  static inline absl::flat_hash_map<Addr_t, uint32_t>       pc_index;
+  static inline std::vector<std::pair<Addr_t, std::string>> pc_text;
+  static inline std::vector<std::string>                    names;
+  static inline absl::flat_hash_map<std::string, uint8_t>   name_index;
+
+  static inline bool main_clock_set;
+
+  // disabled until open
+  static inline uint64_t      track_from = UINT64_MAX;
+  static inline uint64_t      track_to   = UINT64_MAX;
   static inline std::ofstream ofst;
+
+  static inline FILE*                              fp = nullptr;
+  static inline std::unique_ptr<Spsc_ring<Record>> ring;
+  static inline std::thread                        writer;
+  static inline std::atomic<bool>                  writer_stop{false};
 };
@@ -0,0 +1,29 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include <fstream>
+#include <iostream>
+
+#include "fmt/format.h"
+#include "tracer.hpp"
+
+// Binary [trace] output to Kanata text: tracer_conv kanata_log.<ext>.bin [out.log]
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    fmt::print(stderr, "usage: {} <trace.bin> [kanata.log]\n", argv[0]);
+    return 1;
+  }
+
+  bool ok;
+  if (argc == 3) {
+    std::ofstream out(argv[2]);
+    ok = out && Tracer::convert(argv[1], out);
+  } else {
+    ok = Tracer::convert(argv[1], std::cout);
+  }
+
+  if (!ok) {
+    fmt::print(stderr, "{}: {} is not a valid trace\n", argv[0], argv[1]);
+    return 1;
+  }
+  return 0;
+}
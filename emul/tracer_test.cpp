@@ -0,0 +1,129 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "tracer.hpp"
+
+#include <unistd.h>
+
+#include <sstream>
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "report.hpp"
+
+class Tracer_test : public ::testing::Test {
+protected:
+  std::string prefix;
+  std::string bin_file;
+
+  static Dinst* make(Addr_t pc) {
+    return Dinst::create(Instruction(Opcode::iAALU, RegType::LREG_R1, RegType::LREG_R2, RegType::LREG_R3, RegType::LREG_R4),
+                         pc,
+                         0,
+                         0,
+                         false);
+  }
+
+  void SetUp() override {
+    prefix   = fmt::format("tracer_test_{}", getpid());
+    bin_file = fmt::format("{}.{}.bin", prefix, Report::get_extension());
+    ASSERT_TRUE(Tracer::open(prefix));
+  }
+
+  void TearDown() override {
+    Tracer::close();
+    Dinst::keep_cold(false);
+    unlink(bin_file.c_str());
+  }
+};
+
+TEST_F(Tracer_test, kanata_text) {
+  auto* d0 = make(0x1000);
+  auto* d1 = make(0x1004);
+  auto* d2 = make(0x1008);  // out of range
+  Tracer::track_range(d0->getID(), d1->getID());
+
+  Tracer::advance_clock();  // nothing before the first stage
+
+  globalClock = 10;
+  Tracer::stage(d0, "IF");
+  Tracer::stage(d1, "IF");
+  Tracer::stage(d2, "IF");
+
+  globalClock = 11;
+  Tracer::advance_clock();
+  Tracer::stage(d0, "RN");
+  Tracer::event(d0, "PNR");
+  Tracer::flush(d1);
+
+  globalClock = 13;
+  Tracer::advance_clock();
+  Tracer::commit(d0);
+
+  globalClock = 14;
+  Tracer::advance_clock();
+  Tracer::close();
+
+  auto asm_txt = d0->getInst()->get_asm();
+
+  std::string expected = "Kanata\t0004\nC=\t0\n";
+  expected += fmt::format("I\t0\t0\t0\nL\t0\t0\t1000 {}\nS\t0\t0\tIF\n", asm_txt);
+  expected += fmt::format("I\t1\t1\t0\nL\t1\t0\t1004 {}\nS\t1\t0\tIF\n", asm_txt);
+  expected += "C\t1\n";
+  expected += "S\t0\t0\tRN\nS\t0\t1\tPNR\nR\t1\t1\t1\n";
+  expected += "C\t2\nE\t0\t0\tRN\nE\t0\t1\tPNR\n";
+  expected += "S\t0\t0\tCO\n";
+  expected += "C\t1\nR\t0\t0\t0\n";
+
+  std::ostringstream out;
+  ASSERT_TRUE(Tracer::convert(bin_file, out));
+  EXPECT_EQ(out.str(), expected);
+
+  d0->scrap();
+  d1->scrap();
+  d2->scrap();
+}
+
+TEST_F(Tracer_test, ring_wraps_without_loss) {
+  auto* d = make(0x2000);
+  Tracer::track_range(d->getID());
+
+  globalClock = 100;
+  Tracer::stage(d, "IF");
+
+  // Several times the ring capacity
+  const int n = 300000;
+  for (int i = 0; i < n; ++i) {
+    Tracer::stage(d, "EX");
+    globalClock++;
+    Tracer::advance_clock();
+  }
+  Tracer::close();
+
+  std::ostringstream out;
+  ASSERT_TRUE(Tracer::convert(bin_file, out));
+
+  std::istringstream in(out.str());
+  std::string        line;
+  int                n_ex    = 0;
+  int                n_clock = 0;
+  while (std::getline(in, line)) {
+    n_ex += line == "S\t0\t0\tEX";
+    n_clock += line == "C\t1";
+  }
+  EXPECT_EQ(n_ex, n);
+  EXPECT_EQ(n_clock, n);
+
+  d->scrap();
+}
+
+TEST_F(Tracer_test, not_a_trace) {
+  Tracer::close();
+
+  std::ostringstream out;
+  EXPECT_FALSE(Tracer::convert("tracer_test_missing.bin", out));
+
+  FILE* fp = fopen(bin_file.c_str(), "wb");
+  fputs("Kanata\t0004\n", fp);
+  fclose(fp);
+  EXPECT_FALSE(Tracer::convert(bin_file, out));
+}
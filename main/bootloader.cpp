@@ -8,9 +8,13 @@
 #include <cstdlib>
 
 #include "accprocessor.hpp"
+#include "clock_domain.hpp"
 #include "config.hpp"
+#include "debug_log.hpp"
 #include "drawarch.hpp"
 #include "emul_dromajo.hpp"
+#include "emul_none.hpp"
+#include "emul_trace.hpp"
 #include "gmemory_system.hpp"
 #include "gprocessor.hpp"
 #include "gpusmprocessor.hpp"
@@ -18,7 +22,9 @@
 #include "memory_system.hpp"
 #include "oooprocessor.hpp"
 #include "report.hpp"
+#include "stats.hpp"
 #include "taskhandler.hpp"
+#include "traffic_gen.hpp"
 
 extern DrawArch arch;
 
@@ -85,6 +91,7 @@ void BootLoader::report(std::string_view str) {
   Report::field(fmt::format("OSSim:msecs={}", (double)msecs / 1000));
 
   Stats::report_all();
+  Stats_sampler::report();
 
   Report::field(fmt::format("#END:report {}", str));
   Report::close();
@@ -96,9 +103,11 @@ void BootLoader::plug_emuls() {
   auto nemuls = Config::get_array_size("soc", "emul");
 
   std::shared_ptr<Emul_dromajo> dromajo;
+  std::shared_ptr<Emul_trace>   trace;
+  std::shared_ptr<Emul_none>    none;
 
   for (auto i = 0u; i < nemuls; i++) {
-    auto type = Config::get_string("soc", "emul", i, "type", {"dromajo", "accel", "trace"});
+    auto type = Config::get_string("soc", "emul", i, "type", {"dromajo", "accel", "trace", "none"});
     if (type == "dromajo") {
       if (dromajo == nullptr) {
         dromajo = std::make_shared<Emul_dromajo>();
@@ -109,7 +118,15 @@ void BootLoader::plug_emuls() {
     } else if (type == "accel") {
       Config::add_error("accel still not implemented");
     } else if (type == "trace") {
-      Config::add_error("trace still not implemented");
+      if (trace == nullptr) {
+        trace = std::make_shared<Emul_trace>();
+      }
+      TaskHandler::add_emul(trace, i);
+    } else if (type == "none") {
+      if (none == nullptr) {
+        none = std::make_shared<Emul_none>();
+      }
+      TaskHandler::add_emul(none, i);
     }
   }
 }
@@ -117,7 +134,14 @@ void BootLoader::plug_emuls() {
 void BootLoader::plug_simus() {
   auto ncores = Config::get_array_size("soc", "core");
 
+  bool parallel = Clock_domain::setup();
+
   for (auto i = 0u; i < ncores; i++) {
+    if (parallel) {
+      // Everything built now (private caches, ports) belongs to this core domain
+      Clock_domain::set_current(Clock_domain::create(fmt::format("core{}", i)));
+    }
+
     std::shared_ptr<Gmemory_system> gm;
     auto                            caches = Config::get_bool("soc", "core", i, "caches");
     if (caches) {
@@ -126,7 +150,7 @@ void BootLoader::plug_simus() {
       gm = std::make_shared<Dummy_memory_system>(i);
     }
 
-    auto                       type = Config::get_string("soc", "core", i, "type", {"ooo", "inorder", "accel"});
+    auto                       type = Config::get_string("soc", "core", i, "type", {"ooo", "inorder", "accel", "traffic"});
     std::shared_ptr<Simu_base> simu;
     if (type == "ooo") {
       simu = std::make_shared<OoOProcessor>(gm, i);
@@ -134,9 +158,13 @@ void BootLoader::plug_simus() {
       simu = std::make_shared<InOrderProcessor>(gm, i);
     } else if (type == "accel") {
       simu = std::make_shared<AccProcessor>(gm, i);
+    } else if (type == "traffic") {
+      simu = std::make_shared<Traffic_gen>(gm, i);
     }
     TaskHandler::simu_create(simu);
   }
+
+  Clock_domain::set_current(nullptr);
 }
 
 void BootLoader::plug(int argc, const char** argv) {
@@ -153,6 +181,12 @@ void BootLoader::plug(int argc, const char** argv) {
         exit(-3);
       }
       conf_file = argv[i];
+    } else if (strcmp(argv[i], "-d") == 0) {
+      ++i;
+      if (i >= argc || !Debug_log::enable(argv[i])) {
+        fmt::print("after -d, there should be a comma separated list of debug channels\n");
+        exit(-3);
+      }
     } else if (strcasecmp(argv[i], "check") == 0) {
       just_check = true;
     } else {
@@ -224,4 +258,5 @@ void BootLoader::unplug() {
 #endif
 
   TaskHandler::unplug();
+  Clock_domain::unsetup();
 }
@@ -0,0 +1,101 @@
+#!/bin/bash
+# idle_skip regression test for desesc
+# This script runs a memory bound traffic generator with [soc] idle_skip
+# on and off, and checks that both runs report the same stats.
+
+set -e
+
+# Get the directory where this script is located
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+
+# Bazel puts the binary and data files in runfiles
+if [ -n "$TEST_SRCDIR" ]; then
+    # Running under bazel test
+    RUNFILES="$TEST_SRCDIR/$TEST_WORKSPACE"
+    DESESC="$RUNFILES/main/desesc"
+    CONF_DIR="$RUNFILES/conf"
+else
+    # Running standalone (from project root)
+    DESESC="${DESESC:-$SCRIPT_DIR/../bazel-bin/main/desesc}"
+    CONF_DIR="$SCRIPT_DIR/../conf"
+fi
+
+# Create temp directory for the configs and the outputs
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+# The default configuration with c0 as a traffic generator: a pointer chase
+# next to a random read/write stream, most cycles wait for memory
+make_config() {
+    sed -e 's/^emul = \["drom_emu"\]/emul = ["none_emu"]/' \
+        -e 's/^type  = "ooo"  # ooo or inorder or accel/type  = "traffic"\nstreams = ["st_chase", "st_bw"]/' \
+        -e "s/^#idle_skip = false/idle_skip = $1/" \
+        "$CONF_DIR/desesc.toml"
+    cat <<EOF
+
+[none_emu]
+type = "none"
+
+[st_chase]
+pattern    = "chase"
+size       = 8388608
+n_requests = 4000
+
+[st_bw]
+pattern         = "random"
+size            = 8388608
+write_pct       = 30
+n_requests      = 2000
+max_outstanding = 4
+EOF
+}
+
+cd "$TMPDIR"
+make_config true > on.toml
+make_config false > off.toml
+for f in on.toml off.toml; do
+    if ! grep -q '^type  = "traffic"' $f || ! grep -q '^idle_skip = ' $f; then
+        echo "ERROR: $f does not have the traffic generator or idle_skip, did conf/desesc.toml change?"
+        exit 1
+    fi
+done
+
+echo "Running desesc with idle_skip on and off..."
+REPORTFILE=on "$DESESC" -c on.toml
+REPORTFILE=off "$DESESC" -c off.toml
+
+ON_OUTPUT=$(ls desesc_on.* 2>/dev/null | head -1)
+OFF_OUTPUT=$(ls desesc_off.* 2>/dev/null | head -1)
+if [ -z "$ON_OUTPUT" ] || [ -z "$OFF_OUTPUT" ]; then
+    echo "ERROR: desesc output file not found"
+    ls -la
+    exit 1
+fi
+
+# Same filter as the gold run, minus the host time fields
+filter_and_sort_desesc_output() {
+    awk '/#BEGIN Stats/,0' | \
+    grep -v '^OSSim:beginTime=' | \
+    grep -v '^OSSim:endTime=' | \
+    grep -v '^OSSim:msecs=' | \
+    sed 's/-nan/nan/g' | \
+    perl -pe 's/(v=)(-?[0-9]+\.[0-9]+)/sprintf("%s%.2f", $1, $2)/ge' | \
+    sort
+}
+
+filter_and_sort_desesc_output < "$ON_OUTPUT" > on.txt
+filter_and_sort_desesc_output < "$OFF_OUTPUT" > off.txt
+
+if ! grep -q '^P(0)_tg_reads' on.txt; then
+    echo "ERROR: no traffic generator stats in $ON_OUTPUT"
+    exit 1
+fi
+
+if ! diff -q off.txt on.txt > /dev/null 2>&1; then
+    echo "ERROR: idle_skip changes the stats"
+    diff off.txt on.txt | head -100 || true
+    exit 1
+fi
+
+echo ""
+echo "SUCCESS: idle_skip on and off report the same stats"
@@ -0,0 +1,435 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "cache_prefetcher.hpp"
+
+#include <algorithm>
+
+#include "config.hpp"
+#include "fmt/format.h"
+#include "iassert.hpp"
+
+std::unique_ptr<Cache_prefetcher> Cache_prefetcher::create(const std::string& section, const std::string& name,
+                                                           uint32_t line_size)
+/* factory for the cache prefetcher type {{{1 */
+{
+  auto type = Config::get_string(section, "type", {"next_line", "stream", "bop", "spp"});
+
+  if (type == "stream") {
+    return std::make_unique<Stream_prefetcher>(section, name, line_size);
+  } else if (type == "bop") {
+    return std::make_unique<Bop_prefetcher>(section, name, line_size);
+  } else if (type == "spp") {
+    return std::make_unique<Spp_prefetcher>(section, name, line_size);
+  }
+  return std::make_unique<Next_line_prefetcher>(section, name, line_size);
+}
+/* }}} */
+
+static uint32_t get_opt(const std::string& section, const std::string& key, int def, int from, int to) {
+  if (Config::has_entry(section, key)) {
+    return Config::get_integer(section, key, from, to);
+  }
+  return def;
+}
+
+Cache_prefetcher::Cache_prefetcher(const std::string& section, const std::string& name, uint32_t line_size)
+    /* constructor {{{1 */
+    : line_bits(log2i(line_size))
+    , page_lines(line_size < (1U << page_bits) ? (1U << page_bits) / line_size : 1)
+    , nLate(fmt::format("{}:nPrefetchLate", name))
+    , avgDegree(fmt::format("{}_avgPrefetchDegree", name))
+    , avgAccuracy(fmt::format("{}_avgPrefetchAccuracy", name))
+    , avgOccupancy(fmt::format("{}_avgPrefetchMemOccupancy", name)) {
+  max_degree = Config::get_integer(section, "degree", 1, 32);
+  degree     = max_degree;
+
+  throttle = true;
+  if (Config::has_entry(section, "throttle")) {
+    throttle = Config::get_bool(section, "throttle");
+  }
+  epoch         = get_opt(section, "epoch", 4096, 64, 1 << 24);
+  acc_high      = get_opt(section, "acc_high", 75, 0, 100);
+  acc_low       = get_opt(section, "acc_low", 40, 0, 100);
+  late_pct      = get_opt(section, "late_pct", 10, 0, 100);
+  pollution_pct = get_opt(section, "pollution_pct", 25, 0, 100);
+  bw_high       = get_opt(section, "bw_high", 75, 1, 100);
+  bw_low        = get_opt(section, "bw_low", 50, 0, 100);
+
+  if (acc_low > acc_high) {
+    Config::add_error(fmt::format("{} prefetcher acc_low {} is over acc_high {}", section, acc_low, acc_high));
+  }
+  if (bw_low > bw_high) {
+    Config::add_error(fmt::format("{} prefetcher bw_low {} is over bw_high {}", section, bw_low, bw_high));
+  }
+
+  next_epoch = globalClock + epoch;
+  inflight.resize(256, 0);
+}
+/* }}} */
+
+void Cache_prefetcher::access(Addr_t addr, Addr_t pc, bool trigger, bool en, std::vector<Addr_t>& out)
+/* train with a demand access, and collect the lines to prefetch {{{1 */
+{
+  last_en = en;
+
+  scratch.clear();
+  predict(addr >> line_bits, pc, trigger, degree, scratch);
+  I(scratch.size() <= degree);
+
+  for (auto line : scratch) {
+    inflight[line % inflight.size()] = line;
+    out.push_back(line << line_bits);
+  }
+}
+/* }}} */
+
+void Cache_prefetcher::fill(Addr_t addr, bool prefetch)
+/* line allocated in the cache {{{1 */
+{
+  Addr_t line = addr >> line_bits;
+  if (prefetch) {
+    ++ep_fill;
+    auto& e = inflight[line % inflight.size()];
+    if (e == line) {
+      e = 0;
+    }
+  }
+  learn_fill(line, prefetch);
+}
+/* }}} */
+
+bool Cache_prefetcher::late(Addr_t addr, bool en)
+/* demand request found the line in flight {{{1 */
+{
+  Addr_t line = addr >> line_bits;
+  auto&  e    = inflight[line % inflight.size()];
+  if (e != line) {
+    return false;
+  }
+  e = 0;
+  ++ep_late;
+  nLate.inc(en);
+  return true;
+}
+/* }}} */
+
+void Cache_prefetcher::end_epoch(uint32_t occupancy)
+/* feedback directed degree {{{1 */
+{
+  next_epoch = globalClock + epoch;
+
+  sum_fill   = sum_fill / 2 + ep_fill;
+  sum_useful = sum_useful / 2 + ep_useful;
+  sum_late   = sum_late / 2 + ep_late;
+  sum_unused = sum_unused / 2 + ep_unused;
+  ep_fill    = 0;
+  ep_useful  = 0;
+  ep_late    = 0;
+  ep_unused  = 0;
+
+  avgOccupancy.sample(occupancy, last_en);
+
+  if (!throttle) {
+    avgDegree.sample(degree, last_en);
+    return;
+  }
+
+  bool room = occupancy < bw_low;
+  if (occupancy >= bw_high) {
+    degree /= 2;  // DRAM queues are filling up, back off fast even if accurate
+  } else if (degree == 0) {
+    if (room) {
+      degree = 1;
+    }
+  } else if (sum_fill) {
+    auto accuracy  = sum_useful * 100 / sum_fill;
+    auto lateness  = sum_useful ? sum_late * 100 / sum_useful : 0;
+    auto pollution = sum_unused * 100 / sum_fill;
+    avgAccuracy.sample(accuracy, last_en);
+
+    if (accuracy >= acc_high) {
+      if (room) {
+        ++degree;
+      }
+    } else if (accuracy >= acc_low) {
+      if (pollution >= pollution_pct) {
+        degree = std::max(degree - 1, 1U);
+      } else if (lateness >= late_pct && room) {
+        ++degree;
+      }
+    } else {
+      degree = std::max(degree - 1, 1U);  // only the bandwidth turns it off, to keep measuring the accuracy
+    }
+  }
+  degree = std::min(degree, max_degree);
+
+  avgDegree.sample(degree, last_en);
+}
+/* }}} */
+
+void Cache_prefetcher::snapshot(Snapshot_io& ar, const std::string& name) {
+  if (!ar.section(name, table_key() ^ (static_cast<uint64_t>(max_degree) << 8) ^ line_bits)) {
+    return;
+  }
+  ar.io(degree);
+  ar.io(sum_fill);
+  ar.io(sum_useful);
+  ar.io(sum_late);
+  ar.io(sum_unused);
+  snapshot_tables(ar);
+}
+
+void Next_line_prefetcher::predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines)
+/* the next n lines of the page {{{1 */
+{
+  (void)pc;
+  if (!trigger) {
+    return;
+  }
+  for (uint32_t i = 1; i <= n && same_page(line + i, line); ++i) {
+    lines.push_back(line + i);
+  }
+}
+/* }}} */
+
+Stream_prefetcher::Stream_prefetcher(const std::string& section, const std::string& name, uint32_t line_size)
+    /* constructor {{{1 */
+    : Cache_prefetcher(section, name, line_size), n_access(0) {
+  table.resize(get_opt(section, "streams", 16, 1, 1024));
+  distance = get_opt(section, "distance", 0, 0, page_lines - 1);
+}
+/* }}} */
+
+void Stream_prefetcher::predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines)
+/* every access trains the stream of its page {{{1 */
+{
+  (void)pc;
+  (void)trigger;
+
+  ++n_access;
+  Addr_t page = line / page_lines;
+
+  Entry* e   = nullptr;
+  Entry* lru = &table[0];
+  for (auto& t : table) {
+    if (t.last_use && t.page == page) {
+      e = &t;
+      break;
+    }
+    if (t.last_use < lru->last_use) {
+      lru = &t;
+    }
+  }
+  if (e == nullptr) {
+    *lru = {page, line, 0, 0, n_access};
+    return;
+  }
+  e->last_use = n_access;
+
+  if (line == e->last) {
+    return;
+  }
+  int32_t dir = line > e->last ? 1 : -1;
+  if (dir == e->dir) {
+    e->conf = std::min(e->conf + 1, 3U);
+  } else {
+    e->dir  = dir;
+    e->conf = 0;
+  }
+  e->last = line;
+
+  if (e->conf == 0) {
+    return;  // needs two steps in the same direction
+  }
+  for (uint32_t i = 1; i <= n; ++i) {
+    Addr_t l = line + static_cast<int64_t>(dir) * (distance + i);
+    if (!same_page(l, line)) {
+      break;
+    }
+    lines.push_back(l);
+  }
+}
+/* }}} */
+
+Bop_prefetcher::Bop_prefetcher(const std::string& section, const std::string& name, uint32_t line_size)
+    /* constructor {{{1 */
+    : Cache_prefetcher(section, name, line_size), test_pos(0), n_round(0), best(1), on(true) {
+  // offsets without prime factors over 5, inside the page
+  for (uint32_t d = 1; d < page_lines; ++d) {
+    auto r = d;
+    for (auto f : {2U, 3U, 5U}) {
+      while (r % f == 0) {
+        r /= f;
+      }
+    }
+    if (r == 1) {
+      offsets.push_back(d);
+    }
+  }
+  if (offsets.empty()) {
+    offsets.push_back(1);
+  }
+  scores.resize(offsets.size(), 0);
+  rr.resize(256, 0);
+}
+/* }}} */
+
+void Bop_prefetcher::end_phase()
+/* pick the best offset of the learning phase {{{1 */
+{
+  auto it = std::max_element(scores.begin(), scores.end());  // first one on a tie, the smallest offset
+  on      = *it > bad_score;
+  if (on) {
+    best = offsets[it - scores.begin()];
+  }
+
+  std::fill(scores.begin(), scores.end(), 0);
+  test_pos = 0;
+  n_round  = 0;
+}
+/* }}} */
+
+void Bop_prefetcher::predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines)
+/* test one offset, prefetch with the best one {{{1 */
+{
+  (void)pc;
+  if (!trigger) {
+    return;
+  }
+
+  if (rr_hit(line - offsets[test_pos]) && ++scores[test_pos] >= score_max) {
+    end_phase();
+  } else if (++test_pos == offsets.size()) {
+    test_pos = 0;
+    if (++n_round == round_max) {
+      end_phase();
+    }
+  }
+
+  if (!on) {
+    return;
+  }
+  for (uint32_t i = 1; i <= n; ++i) {
+    Addr_t l = line + i * best;
+    if (!same_page(l, line)) {
+      break;
+    }
+    lines.push_back(l);
+  }
+}
+/* }}} */
+
+void Bop_prefetcher::learn_fill(Addr_t line, bool prefetch)
+/* recent requests: the base address that would have prefetched the line {{{1 */
+{
+  if (prefetch) {
+    if (on) {
+      rr_insert(line - best);
+    }
+  } else if (!on || get_degree() == 0) {
+    rr_insert(line);
+  }
+}
+/* }}} */
+
+void Bop_prefetcher::snapshot_tables(Snapshot_io& ar) {
+  ar.io(scores);
+  ar.io(rr);
+  ar.io(test_pos);
+  ar.io(n_round);
+  ar.io(best);
+  ar.io(on);
+}
+
+Spp_prefetcher::Spp_prefetcher(const std::string& section, const std::string& name, uint32_t line_size)
+    /* constructor {{{1 */
+    : Cache_prefetcher(section, name, line_size) {
+  st.resize(256);
+  pt.resize(1 << sig_bits);
+  threshold = get_opt(section, "threshold", 25, 1, 100);
+}
+/* }}} */
+
+void Spp_prefetcher::update(uint16_t sig, int32_t delta)
+/* count delta after sig {{{1 */
+{
+  auto&    p      = pt[sig];
+  uint32_t slot   = n_deltas;
+  uint32_t victim = 0;
+  for (uint32_t i = 0; i < n_deltas; ++i) {
+    if (p.c_delta[i] && p.delta[i] == delta) {
+      slot = i;
+      break;
+    }
+    if (p.c_delta[i] < p.c_delta[victim]) {
+      victim = i;
+    }
+  }
+  if (slot == n_deltas) {
+    slot            = victim;
+    p.delta[slot]   = delta;
+    p.c_delta[slot] = 0;
+  }
+
+  if (p.c_sig == c_max) {
+    p.c_sig /= 2;
+    for (auto& c : p.c_delta) {
+      c /= 2;
+    }
+  }
+  ++p.c_sig;
+  ++p.c_delta[slot];
+}
+/* }}} */
+
+void Spp_prefetcher::predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines)
+/* train the page signature, then walk the most likely path {{{1 */
+{
+  (void)pc;
+  (void)trigger;
+
+  Addr_t  page   = line / page_lines;
+  int32_t offset = line % page_lines;
+
+  auto& e = st[page % st.size()];
+  if (e.page != page || e.offset < 0) {
+    e.page   = page;
+    e.offset = offset;
+    e.sig    = 0;
+    return;
+  }
+
+  int32_t delta = offset - e.offset;
+  if (delta == 0) {
+    return;
+  }
+  update(e.sig, delta);
+  e.sig    = next_sig(e.sig, delta);
+  e.offset = offset;
+
+  uint16_t sig  = e.sig;
+  uint32_t conf = 100;
+  while (lines.size() < n) {
+    const auto& p = pt[sig];
+    if (p.c_sig == 0) {
+      break;
+    }
+    uint32_t i = 0;
+    for (uint32_t j = 1; j < n_deltas; ++j) {
+      if (p.c_delta[j] > p.c_delta[i]) {
+        i = j;
+      }
+    }
+    conf = conf * p.c_delta[i] / p.c_sig;
+    if (conf < threshold) {
+      break;
+    }
+    offset += p.delta[i];
+    if (offset < 0 || offset >= static_cast<int32_t>(page_lines)) {
+      break;
+    }
+    lines.push_back(page * page_lines + offset);
+    sig = next_sig(sig, p.delta[i]);
+  }
+}
+/* }}} */
@@ -0,0 +1,224 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "opcode.hpp"
+#include "snapshot.hpp"
+#include "snippets.hpp"
+#include "stats.hpp"
+
+// Prefetcher attached to a CCache with `prefetcher = "<section>"`. The
+// section selects the engine and the throttle:
+//
+//   type             next_line, stream, bop (best offset) or spp (signature path)
+//   degree           max lines per trigger, the throttle moves between 0 and degree
+//   distance         stream: lines skipped ahead of the demand stream
+//   streams          stream: tracked streams
+//   threshold        spp: min path confidence (percent) to keep the lookahead going
+//   throttle         feedback directed degree (default true)
+//   epoch            cycles between throttle decisions
+//   acc_high/acc_low accuracy (useful/filled percent) bands
+//   late_pct         lateness (in flight demand hits/useful percent) to go more aggressive
+//   pollution_pct    unused evictions/filled percent to back off
+//   bw_high/bw_low   DRAM queue occupancy (percent) to halve the degree, or to grow again
+//
+// The engines work with line addresses and never cross a 4KB page. CCache
+// trains it with the demand stream and reports fills, useful hits, late hits
+// and unused evictions of the lines it brought (PSIGN_CACHE). Prefetches of
+// an upper level filled on their way up are PSIGN_CACHE_UP, plain fills here.
+class Cache_prefetcher {
+public:
+  static std::unique_ptr<Cache_prefetcher> create(const std::string& section, const std::string& name, uint32_t line_size);
+  virtual ~Cache_prefetcher() = default;
+
+  // Demand access. trigger is a miss, or a hit on a line this prefetcher
+  // brought. Appends at most get_degree() byte addresses to prefetch.
+  void access(Addr_t addr, Addr_t pc, bool trigger, bool en, std::vector<Addr_t>& out);
+
+  void fill(Addr_t addr, bool prefetch);
+  void useful() { ++ep_useful; }
+  void evicted_unused() { ++ep_unused; }
+  // Demand found the line in flight, true when it is a prefetch of ours
+  bool late(Addr_t addr, bool en);
+
+  [[nodiscard]] bool     is_epoch_done() const { return globalClock >= next_epoch; }
+  void                   end_epoch(uint32_t occupancy);
+  [[nodiscard]] uint32_t get_degree() const { return degree; }
+  [[nodiscard]] uint32_t get_epoch_fill() const { return ep_fill; }
+  [[nodiscard]] uint32_t get_epoch_useful() const { return ep_useful; }
+
+  // Engine tables, throttle degree and decayed sums. The epoch in progress
+  // and the in flight lines start over after a restore.
+  void snapshot(Snapshot_io& ar, const std::string& name);
+
+protected:
+  Cache_prefetcher(const std::string& section, const std::string& name, uint32_t line_size);
+
+  // trigger as in access(). Lines beyond degree are dropped by the caller.
+  virtual void predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines) = 0;
+  virtual void learn_fill(Addr_t line, bool prefetch) {
+    (void)line;
+    (void)prefetch;
+  }
+  // Engine type and table sizes, and its tables in a fixed order
+  [[nodiscard]] virtual uint64_t table_key() const { return 0; }
+  virtual void                   snapshot_tables(Snapshot_io& ar) { (void)ar; }
+
+  static constexpr uint32_t page_bits = 12;
+
+  uint32_t line_bits;
+  uint32_t page_lines;  // lines per page
+
+  [[nodiscard]] bool same_page(Addr_t a, Addr_t b) const { return (a ^ b) < page_lines; }
+
+private:
+  uint32_t max_degree;
+  uint32_t degree;
+
+  bool     throttle;
+  Time_t   epoch;
+  Time_t   next_epoch;
+  uint32_t acc_high;
+  uint32_t acc_low;
+  uint32_t late_pct;
+  uint32_t pollution_pct;
+  uint32_t bw_high;
+  uint32_t bw_low;
+
+  // epoch counters, and their decayed sums (half of the previous plus the epoch)
+  uint32_t ep_fill    = 0;
+  uint32_t ep_useful  = 0;
+  uint32_t ep_late    = 0;
+  uint32_t ep_unused  = 0;
+  uint64_t sum_fill   = 0;
+  uint64_t sum_useful = 0;
+  uint64_t sum_late   = 0;
+  uint64_t sum_unused = 0;
+  bool     last_en    = false;
+
+  std::vector<Addr_t> inflight;  // direct mapped, lines sent and not filled yet
+  std::vector<Addr_t> scratch;
+
+  Stats_cntr nLate;
+  Stats_avg  avgDegree;
+  Stats_avg  avgAccuracy;
+  Stats_avg  avgOccupancy;
+};
+
+class Next_line_prefetcher : public Cache_prefetcher {
+public:
+  Next_line_prefetcher(const std::string& section, const std::string& name, uint32_t line_size)
+      : Cache_prefetcher(section, name, line_size) {}
+
+protected:
+  void predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines) override;
+};
+
+// Per page stream table: two steps in the same direction confirm a stream
+class Stream_prefetcher : public Cache_prefetcher {
+public:
+  Stream_prefetcher(const std::string& section, const std::string& name, uint32_t line_size);
+
+protected:
+  void predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines) override;
+
+  [[nodiscard]] uint64_t table_key() const override { return (1ULL << 60) | table.size(); }
+  void                   snapshot_tables(Snapshot_io& ar) override {
+    ar.io(table);
+    ar.io(n_access);
+  }
+
+private:
+  struct Entry {
+    Addr_t   page     = 0;
+    Addr_t   last     = 0;
+    int32_t  dir      = 0;
+    uint32_t conf     = 0;
+    uint64_t last_use = 0;  // 0 is a free entry
+  };
+  std::vector<Entry> table;
+  uint32_t           distance;
+  uint64_t           n_access;
+};
+
+// Best-Offset prefetcher (Michaud, HPCA 2016). Each trigger tests one offset
+// d against the recent requests table (fills minus the current offset); the
+// best scoring offset of a learning phase is used for the next one, or
+// prefetching stops if no offset scores above bad_score.
+class Bop_prefetcher : public Cache_prefetcher {
+public:
+  Bop_prefetcher(const std::string& section, const std::string& name, uint32_t line_size);
+
+  [[nodiscard]] int32_t get_offset() const { return on ? best : 0; }
+
+protected:
+  void predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines) override;
+  void learn_fill(Addr_t line, bool prefetch) override;
+
+  [[nodiscard]] uint64_t table_key() const override { return (2ULL << 60) | (offsets.size() << 16) | rr.size(); }
+  void                   snapshot_tables(Snapshot_io& ar) override;
+
+private:
+  static constexpr uint32_t score_max = 31;
+  static constexpr uint32_t round_max = 100;
+  static constexpr uint32_t bad_score = 1;
+
+  std::vector<int32_t>  offsets;
+  std::vector<uint32_t> scores;
+  std::vector<Addr_t>   rr;  // recent requests, direct mapped
+
+  uint32_t test_pos;
+  uint32_t n_round;
+  int32_t  best;
+  bool     on;
+
+  void               rr_insert(Addr_t line) { rr[line % rr.size()] = line; }
+  [[nodiscard]] bool rr_hit(Addr_t line) const { return rr[line % rr.size()] == line; }
+  void               end_phase();
+};
+
+// Signature Path Prefetcher (Kim et al., MICRO 2016). A per page signature
+// of the last deltas indexes a pattern table; the lookahead follows the most
+// likely delta while the path confidence stays over threshold.
+class Spp_prefetcher : public Cache_prefetcher {
+public:
+  Spp_prefetcher(const std::string& section, const std::string& name, uint32_t line_size);
+
+protected:
+  void predict(Addr_t line, Addr_t pc, bool trigger, uint32_t n, std::vector<Addr_t>& lines) override;
+
+  [[nodiscard]] uint64_t table_key() const override { return (3ULL << 60) | (st.size() << 16) | pt.size(); }
+  void                   snapshot_tables(Snapshot_io& ar) override {
+    ar.io(st);
+    ar.io(pt);
+  }
+
+private:
+  static constexpr uint32_t sig_bits = 12;
+  static constexpr uint32_t n_deltas = 4;
+  static constexpr uint32_t c_max    = 15;
+
+  struct Sig_entry {
+    Addr_t   page   = 0;
+    int32_t  offset = -1;
+    uint16_t sig    = 0;
+  };
+  struct Pattern_entry {
+    int32_t  delta[n_deltas]   = {0, 0, 0, 0};
+    uint32_t c_delta[n_deltas] = {0, 0, 0, 0};
+    uint32_t c_sig             = 0;
+  };
+  std::vector<Sig_entry>     st;
+  std::vector<Pattern_entry> pt;
+  uint32_t                   threshold;
+
+  [[nodiscard]] static uint16_t next_sig(uint16_t sig, int32_t delta) {
+    uint32_t d = delta < 0 ? (0x40 | (-delta & 0x3F)) : (delta & 0x3F);  // sign and magnitude
+    return ((sig << 3) ^ d) & ((1 << sig_bits) - 1);
+  }
+  void update(uint16_t sig, int32_t delta);
+};
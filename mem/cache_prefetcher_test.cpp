@@ -0,0 +1,290 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "cache_prefetcher.hpp"
+
+#include <unistd.h>
+
+#include <fstream>
+
+#include "callback.hpp"
+#include "ccache.hpp"
+#include "config.hpp"
+#include "dinst.hpp"
+#include "gtest/gtest.h"
+#include "memory_system.hpp"
+#include "memrequest.hpp"
+#include "report.hpp"
+
+class Cache_prefetcher_test : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::ofstream file("cache_prefetcher_test.toml");
+    file << "[nl]\ntype = \"next_line\"\ndegree = 4\n";
+    file << "\n[st]\ntype = \"stream\"\ndegree = 2\ndistance = 1\n";
+    file << "\n[bop]\ntype = \"bop\"\ndegree = 1\n";
+    file << "\n[spp]\ntype = \"spp\"\ndegree = 4\nthreshold = 50\n";
+    file << "\n[fdp]\ntype = \"next_line\"\ndegree = 4\nepoch = 100\n";
+    file << "\n[bad]\ntype = \"next_line\"\ndegree = 4\nbw_low = 90\nbw_high = 80\n";
+    file.close();
+
+    Config::init("cache_prefetcher_test.toml");
+  }
+
+  static constexpr Addr_t page = 0x100000;  // 4KB aligned, 64B lines
+
+  // Demand access, and fill the prefetched lines right away
+  static std::vector<Addr_t> touch(Cache_prefetcher& p, Addr_t addr, bool trigger = true) {
+    std::vector<Addr_t> out;
+    p.access(addr, 0x400, trigger, true, out);
+    p.fill(addr, false);
+    for (auto a : out) {
+      p.fill(a, true);
+    }
+    return out;
+  }
+};
+
+// DL1s with a next line prefetcher over a shared L2 with a stream one
+class Cache_prefetcher_hier_test : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    std::ofstream file("cache_prefetcher_hier_test.toml");
+    file << "[soc]\ncore = [\"c0\",\"c0\"]\n"
+            "[c0]\ntype = \"ooo\"\ncaches = true\ndl1 = \"dl1_cache DL1\"\nil1 = \"dl1_cache IL1\"\n";
+    for (const auto* sec : {"dl1_cache", "l2_cache"}) {
+      bool l1 = sec[0] == 'd';
+      file << "[" << sec << "]\n"
+           << "type = \"cache\"\ncold_misses = true\nline_size = 64\nassoc = 4\nrepl_policy = \"lru\"\n"
+           << "size = " << (l1 ? 32768 : 1048576) << "\ndelay = " << (l1 ? 5 : 13) << "\nmiss_delay = 2\n"
+           << "port_occ = 1\nport_num = 1\nport_banks = 32\nsend_port_occ = 1\nsend_port_num = 1\n"
+           << "max_requests = 32\nallocate_miss = true\nvictim = false\ncoherent = true\ninclusive = true\n"
+           << "directory = false\nnlp_distance = 2\nnlp_degree = 0\nnlp_stride = 1\ndrop_prefetch = false\n"
+           << "prefetch_degree = 0\nmega_lines1K = 0\n"
+           << "prefetcher = \"" << (l1 ? "l1_pref" : "l2_pref") << "\"\n"
+           << "lower_level = \"" << (l1 ? "l2_cache PL2 sharedby 2" : "mem mem shared") << "\"\n";
+    }
+    file << "[mem]\ntype = \"nice\"\nline_size = 64\ndelay = 31\ncold_misses = false\nlower_level = \"\"\n";
+    file << "[l1_pref]\ntype = \"next_line\"\ndegree = 2\nthrottle = false\nepoch = 16777216\n";
+    file << "[l2_pref]\ntype = \"stream\"\ndegree = 2\nthrottle = false\nepoch = 16777216\n";
+    file.close();
+
+    Report::init();
+    Config::init("cache_prefetcher_hier_test.toml");
+    gms0 = new Memory_system(0);
+    gms1 = new Memory_system(1);
+    ASSERT_FALSE(Config::has_errors());
+    EventScheduler::advanceClock();
+  }
+
+  static void done(Dinst* dinst) {
+    --pending;
+    dinst->scrap();
+  }
+  using doneCB = CallbackFunction1<Dinst*, &done>;
+
+  static void read(Gmemory_system* gms, Addr_t addr) {
+    auto* dinst = Dinst::create(Instruction(Opcode::iLALU_LD, RegType::LREG_R1, RegType::LREG_R2, RegType::LREG_R3, RegType::LREG_R4),
+                                0x400,
+                                addr,
+                                0,
+                                true);
+    ++pending;
+    MemRequest::sendReqRead(gms->getDL1(), true, addr, dinst->getPC(), doneCB::create(dinst, dinst->getID()));
+    for (int i = 0; i < 2000 || pending; ++i) {
+      EventScheduler::advanceClock();  // and let the prefetches land
+    }
+  }
+
+  static const Cache_prefetcher* pref(Gmemory_system* gms) {
+    return static_cast<CCache*>(gms->getDL1())->get_prefetcher();
+  }
+  static const Cache_prefetcher* l2_pref() {
+    return static_cast<CCache*>(gms0->getDL1()->getRouter()->getDownNode())->get_prefetcher();
+  }
+
+  static constexpr Addr_t page = 0x100000;
+
+  static inline Gmemory_system* gms0    = nullptr;
+  static inline Gmemory_system* gms1    = nullptr;
+  static inline int             pending = 0;
+};
+
+// The DL1 prefetches fill the L2 too, but only the DL1 prefetcher owns them
+TEST_F(Cache_prefetcher_hier_test, lower_level_only_credits_its_own_prefetches) {
+  ASSERT_NE(pref(gms0), nullptr);
+  ASSERT_NE(l2_pref(), nullptr);
+
+  read(gms0, page);
+  EXPECT_EQ(pref(gms0)->get_epoch_fill(), 2U);
+  EXPECT_EQ(l2_pref()->get_epoch_fill(), 0U);  // one step, no stream yet
+
+  read(gms0, page + 64);  // DL1 prefetch hit
+  EXPECT_EQ(pref(gms0)->get_epoch_useful(), 1U);
+  EXPECT_EQ(pref(gms0)->get_epoch_fill(), 3U);
+
+  read(gms1, page + 128);  // L2 hit on a line the DL1 of core 0 prefetched
+  EXPECT_EQ(l2_pref()->get_epoch_useful(), 0U);
+  EXPECT_EQ(l2_pref()->get_epoch_fill(), 0U);
+}
+
+TEST_F(Cache_prefetcher_test, next_line_stays_in_the_page) {
+  auto p = Cache_prefetcher::create("nl", "L2", 64);
+
+  EXPECT_EQ(touch(*p, page + 64), (std::vector<Addr_t>{page + 128, page + 192, page + 256, page + 320}));
+  EXPECT_EQ(touch(*p, page + 4096 - 128), (std::vector<Addr_t>{page + 4096 - 64}));
+  EXPECT_TRUE(touch(*p, page + 64, false).empty());  // plain hit
+  EXPECT_FALSE(Config::has_errors());
+}
+
+TEST_F(Cache_prefetcher_test, stream_follows_the_direction) {
+  auto p = Cache_prefetcher::create("st", "L2", 64);
+
+  Addr_t a = page + 40 * 64;
+  EXPECT_TRUE(touch(*p, a).empty());
+  EXPECT_TRUE(touch(*p, a - 64).empty());  // direction set, not confirmed yet
+  auto out = touch(*p, a - 128);
+  EXPECT_EQ(out, (std::vector<Addr_t>{a - 4 * 64, a - 5 * 64}));  // distance 1, degree 2
+
+  // other pages have their own stream
+  EXPECT_TRUE(touch(*p, page + 8192).empty());
+  EXPECT_EQ(touch(*p, a - 192).size(), 2U);
+}
+
+TEST_F(Cache_prefetcher_test, bop_learns_the_stride) {
+  auto  p   = Cache_prefetcher::create("bop", "L2", 64);
+  auto* bop = dynamic_cast<Bop_prefetcher*>(p.get());
+  ASSERT_NE(bop, nullptr);
+  EXPECT_EQ(bop->get_offset(), 1);
+
+  for (Addr_t i = 0; i < 2000; ++i) {
+    touch(*p, page + i * 3 * 64);
+  }
+  auto offset = bop->get_offset();
+  EXPECT_GT(offset, 0);
+  EXPECT_EQ(offset % 3, 0);  // 3, or a multiple that the page crossings did not penalize
+
+  Addr_t a = page + 2000 * 3 * 64;
+  a -= a % 4096;  // start of a page
+  EXPECT_EQ(touch(*p, a), (std::vector<Addr_t>{a + offset * 64}));
+}
+
+TEST_F(Cache_prefetcher_test, bop_turns_off_without_pattern) {
+  auto  p   = Cache_prefetcher::create("bop", "L2", 64);
+  auto* bop = dynamic_cast<Bop_prefetcher*>(p.get());
+  ASSERT_NE(bop, nullptr);
+
+  // one access per page, no offset ever matches
+  for (Addr_t i = 0; i < 4000; ++i) {
+    touch(*p, page + i * 4096 * 7);
+  }
+  EXPECT_EQ(bop->get_offset(), 0);
+  EXPECT_TRUE(touch(*p, page).empty());
+}
+
+TEST_F(Cache_prefetcher_test, snapshot_round_trip) {
+  auto file_name = fmt::format("cache_prefetcher_test_{}.snap", getpid());
+  auto trained   = Cache_prefetcher::create("bop", "L2", 64);
+  for (Addr_t i = 0; i < 2000; ++i) {
+    touch(*trained, page + i * 3 * 64);
+  }
+  {
+    auto ar = Snapshot_io::create(file_name);
+    ASSERT_NE(ar, nullptr);
+    trained->snapshot(*ar, "L2:prefetcher");
+    ASSERT_TRUE(ar->close());
+  }
+
+  auto restored = Cache_prefetcher::create("bop", "L2", 64);
+  auto cold     = Cache_prefetcher::create("spp", "L2", 64);  // same name, other engine
+  {
+    auto ar = Snapshot_io::open(file_name);
+    ASSERT_NE(ar, nullptr);
+    restored->snapshot(*ar, "L2:prefetcher");
+    cold->snapshot(*ar, "L2:prefetcher");
+    EXPECT_EQ(ar->get_n_restored(), 1U);
+    EXPECT_EQ(ar->get_n_skipped(), 1U);
+  }
+  unlink(file_name.c_str());
+
+  auto* bop = dynamic_cast<Bop_prefetcher*>(restored.get());
+  ASSERT_NE(bop, nullptr);
+  EXPECT_EQ(bop->get_offset(), dynamic_cast<Bop_prefetcher*>(trained.get())->get_offset());
+  Addr_t a = page + 8192 * 64;
+  EXPECT_EQ(touch(*restored, a), touch(*trained, a));
+}
+
+TEST_F(Cache_prefetcher_test, spp_walks_the_delta_path) {
+  auto p = Cache_prefetcher::create("spp", "L2", 64);
+
+  // +1 +2 +1 +2 ... inside many pages
+  for (Addr_t pg = 0; pg < 16; ++pg) {
+    Addr_t off = 0;
+    for (int i = 0; off < 60; ++i) {
+      touch(*p, page + pg * 4096 + off * 64);
+      off += (i & 1) ? 2 : 1;
+    }
+  }
+
+  Addr_t base = page + 32 * 4096;
+  touch(*p, base);
+  touch(*p, base + 64);                 // +1
+  auto out = touch(*p, base + 3 * 64);  // +2, next are +1 +2 +1 +2
+  EXPECT_EQ(out, (std::vector<Addr_t>{base + 4 * 64, base + 6 * 64, base + 7 * 64, base + 9 * 64}));
+}
+
+TEST_F(Cache_prefetcher_test, throttle_follows_accuracy_and_bandwidth) {
+  auto p = Cache_prefetcher::create("fdp", "L2", 64);
+  EXPECT_EQ(p->get_degree(), 4U);
+
+  auto epoch = [&p](int filled, int used, uint32_t occupancy) {
+    for (int i = 0; i < filled; ++i) {
+      p->fill(page + i * 64, true);
+    }
+    for (int i = 0; i < used; ++i) {
+      p->useful();
+    }
+    p->end_epoch(occupancy);
+  };
+
+  epoch(100, 10, 0);  // inaccurate
+  epoch(100, 10, 0);
+  EXPECT_EQ(p->get_degree(), 2U);
+  for (int i = 0; i < 8; ++i) {
+    epoch(100, 10, 0);
+  }
+  EXPECT_EQ(p->get_degree(), 1U);  // accuracy alone never turns it off
+
+  for (int i = 0; i < 8; ++i) {
+    epoch(100, 95, 10);  // accurate, with bandwidth to spare
+  }
+  EXPECT_EQ(p->get_degree(), 4U);
+
+  epoch(100, 95, 90);  // DRAM queues almost full
+  EXPECT_EQ(p->get_degree(), 2U);
+  epoch(100, 95, 90);
+  epoch(100, 95, 90);
+  EXPECT_EQ(p->get_degree(), 0U);
+  EXPECT_TRUE(touch(*p, page).empty());
+
+  epoch(0, 0, 60);  // between bw_low and bw_high, stays off
+  EXPECT_EQ(p->get_degree(), 0U);
+  epoch(0, 0, 20);
+  EXPECT_EQ(p->get_degree(), 1U);
+}
+
+TEST_F(Cache_prefetcher_test, late_prefetch) {
+  auto                p = Cache_prefetcher::create("nl", "L2", 64);
+  std::vector<Addr_t> out;
+  p->access(page, 0x400, true, true, out);
+  ASSERT_FALSE(out.empty());
+
+  EXPECT_TRUE(p->late(out[0], true));  // demand before the fill
+  EXPECT_FALSE(p->late(out[0], true));
+  p->fill(out[1], true);
+  EXPECT_FALSE(p->late(out[1], true));
+}
+
+TEST_F(Cache_prefetcher_test, config_errors) {
+  auto p = Cache_prefetcher::create("bad", "L2", 64);
+  EXPECT_TRUE(Config::has_errors());
+}
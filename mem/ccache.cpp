@@ -140,6 +140,13 @@ CCache::CCache(Memory_system* gms, const std::string& sec, const std::string& n)
   lineSize     = cacheBank->getLineSize();
   lineSizeBits = log2i(lineSize);
 
+  if (Config::has_entry(section, "shadow")) {
+    shadow = std::make_unique<Shadow_cache>(section, name);
+  }
+  if (Config::has_entry(section, "prefetcher")) {
+    prefetcher = Cache_prefetcher::create(Config::get_string(section, "prefetcher"), name, lineSize);
+  }
+
   prefetch_degree = Config::get_integer(section, "prefetch_degree", 0, 32);
 
   auto mega_lines1K  = Config::get_integer(section, "mega_lines1K", 0, 32);  // number of lines touched in 1K to trigger mega
@@ -233,6 +240,18 @@ void CCache::dropPrefetch(MemRequest* mreq) {
   }
 }
 
+void CCache::prefetchAccess(MemRequest* mreq, bool trigger) {
+  if (prefetcher->is_epoch_done()) {
+    prefetcher->end_epoch(router->getDownOccupancy());
+  }
+
+  pref_addrs.clear();
+  prefetcher->access(mreq->getAddr(), mreq->getPC(), trigger, mreq->has_stats(), pref_addrs);
+  for (auto paddr : pref_addrs) {
+    tryPrefetch(paddr, mreq->has_stats(), 0, PSIGN_CACHE, mreq->getPC());
+  }
+}
+
 void CCache::displaceLine(Addr_t naddr, MemRequest* mreq, Line* l) {
   I(naddr != mreq->getAddr());  // naddr is the displace address, mreq is the trigger
   I(l->isValid());
@@ -313,16 +332,22 @@ CCache::Line* CCache::allocateLine(Addr_t addr, MemRequest* mreq) {
     if (l->isPrefetch() && !mreq->isPrefetch()) {
       nPrefetchWasteful.inc(mreq->has_stats());
     }
+    if (prefetcher && l->isPrefetch() && l->getSign() == PSIGN_CACHE) {
+      prefetcher->evicted_unused();
+    }
 
     // TODO: add a port for evictions. Schedule the displaceLine accordingly
     displaceLine(rpl_addr, mreq, l);
   }
 
-  l->set(mreq);
+  l->set(mreq, this);
 
   if (mreq->isPrefetch()) {
     nPrefetchLineFill.inc(mreq->has_stats());
   }
+  if (prefetcher && !mreq->isDisp()) {
+    prefetcher->fill(addr, l->isPrefetch() && l->getSign() == PSIGN_CACHE);
+  }
 
   if (prefetch_megaratio < 1) {
     static int conta = 0;
@@ -665,9 +690,13 @@ void CCache::CState::removeSharing(int16_t id) {
   }
 }
 
-void CCache::CState::set(const MemRequest* mreq) {
+void CCache::CState::set(const MemRequest* mreq, const MemObj* cache) {
   if (mreq->isPrefetch()) {
-    setPrefetch(mreq->getPC(), mreq->getSign(), mreq->getDegree());
+    auto sign = mreq->getSign();
+    if (sign == PSIGN_CACHE && mreq->getHomeNode() != cache) {
+      sign = PSIGN_CACHE_UP;
+    }
+    setPrefetch(mreq->getPC(), sign, mreq->getDegree());
   } else {
     clearPrefetch(mreq->getPC());
   }
@@ -681,6 +710,10 @@ void CCache::doReq(MemRequest* mreq) {
   Addr_t addr     = mreq->getAddr();
   bool   retrying = mreq->isRetrying();
 
+  if (shadow && !retrying && !mreq->isPrefetch() && !mreq->isNonCacheable()) {
+    shadow->access(addr, mreq->getAction() == ma_setDirty, mreq->has_stats());
+  }
+
   if (retrying) {  // reissued operation
     mreq->clearRetrying();
     // GI(mreq->isPrefetch() , !pmshr->canIssue(addr)); // the req is already queued if retrying
@@ -695,6 +728,10 @@ void CCache::doReq(MemRequest* mreq) {
       } else {
         mreq->setRetrying();
         mshr->addEntry(addr, MemRequest::redoReqCB::create(mreq, mreq->getPriority()), mreq);
+        if (prefetcher && !mreq->isNonCacheable()) {
+          prefetcher->late(addr, mreq->has_stats());
+          prefetchAccess(mreq, true);
+        }
       }
       return;
     }
@@ -740,6 +777,10 @@ void CCache::doReq(MemRequest* mreq) {
     }
   }
 
+  if (prefetcher && !retrying && !mreq->isPrefetch()) {
+    prefetchAccess(mreq, l == nullptr || (l->isPrefetch() && l->getSign() == PSIGN_CACHE));
+  }
+
   if (l && mreq->isPrefetch() && mreq->isHomeNode()) {
     nPrefetchDropped.inc(mreq->has_stats());
     mreq->setDropped();  // useless prefetch, already a hit
@@ -758,6 +799,9 @@ void CCache::doReq(MemRequest* mreq) {
   if (l->isPrefetch() && !mreq->isPrefetch()) {
     nPrefetchUseful.inc(mreq->has_stats());
     I(!victim);  // Victim should not have prefetch lines
+    if (prefetcher && l->getSign() == PSIGN_CACHE) {
+      prefetcher->useful();
+    }
   }
 
   if (l->isPrefetch() && mreq->isPrefetch()) {
@@ -959,7 +1003,7 @@ void CCache::doReqAck(MemRequest* mreq) {
           l = allocateLine(addr, mreq);
         }
       } else {
-        l->set(mreq);
+        l->set(mreq, this);
 
         if (notifyHigherLevels(l, mreq)) {
           // FIXME I(0);
@@ -1249,9 +1293,21 @@ bool CCache::isBusy(Addr_t addr) const {
 
 void CCache::dump() const { mshr->dump(); }
 
+void CCache::snapshot(Snapshot_io& ar) {
+  // MSHRs are empty between phases, only the array is long lived
+  cacheBank->snapshot(ar, fmt::format("{}:tags", name));
+  if (prefetcher) {
+    prefetcher->snapshot(ar, fmt::format("{}:prefetcher", name));
+  }
+}
+
 TimeDelta_t CCache::ffread(Addr_t addr) {
   Addr_t addr_r = 0;
 
+  if (shadow) {
+    shadow->access(addr, false, false);
+  }
+
   Line* l = cacheBank->readLine(addr, addr, 0xbeefbeef);
   if (l) {
     return 1;  // done!
@@ -1266,6 +1322,10 @@ TimeDelta_t CCache::ffread(Addr_t addr) {
 TimeDelta_t CCache::ffwrite(Addr_t addr) {
   Addr_t addr_r = 0;
 
+  if (shadow) {
+    shadow->access(addr, true, false);
+  }
+
   Line* l = cacheBank->writeLine(addr, addr, 0xbeefbeef);
   if (l == 0) {
     l = cacheBank->fillLine_replace(addr, addr, addr_r, 0xbeefbeef);
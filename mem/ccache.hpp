@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "cache_port.hpp"
+#include "cache_prefetcher.hpp"
 #include "cachecore.hpp"
 #include "estl.hpp"
 #include "gprocessor.hpp"
@@ -12,6 +13,7 @@
 #include "memory_system.hpp"
 #include "mshr.hpp"
 #include "sctable.hpp"
+#include "shadow_cache.hpp"
 #include "snippets.hpp"
 #include "stats.hpp"
 
@@ -106,7 +108,16 @@ protected:
     }
     void clearSharing() { nSharers = 0; }
 
-    void set(const MemRequest* mreq);
+    // cache is the one filling the line, it only owns its own PSIGN_CACHE prefetches
+    void set(const MemRequest* mreq, const MemObj* cache);
+
+    void io(Snapshot_io& ar) {
+      StateGeneric<Addr_t>::io(ar);
+      ar.io(state);
+      ar.io(shareState);
+      ar.io(nSharers);
+      ar.io(share);
+    }
   }; /*}}}*/
 
   typedef CacheGeneric<CState, Addr_t>            CacheType;
@@ -116,6 +127,11 @@ protected:
   MSHR*      mshr;
   MSHR*      pmshr;
 
+  std::unique_ptr<Shadow_cache> shadow;  // nullptr without a `shadow` list
+
+  std::unique_ptr<Cache_prefetcher> prefetcher;  // nullptr without a `prefetcher` section
+  std::vector<Addr_t>               pref_addrs;
+
   Time_t lastUpMsg;  // can not bypass up messages (races)
   Time_t inOrderUpMessageAbs(Time_t when) {
     if (lastUpMsg > when) {
@@ -220,6 +236,7 @@ protected:
   bool notifyHigherLevels(Line* l, MemRequest* mreq);
 
   void dropPrefetch(MemRequest* mreq);
+  void prefetchAccess(MemRequest* mreq, bool trigger);
 
   void
   cleanup();  // FIXME: Expose this to MemObj and call it from core on ctx switch or syscall (move to public and remove callback)
@@ -256,11 +273,15 @@ public:
 
   void dump() const;
 
+  void snapshot(Snapshot_io& ar) override;
+
   void setNeedsCoherence();
   void clearNeedsCoherence();
 
   bool isJustDirectory() const { return justDirectory; }
 
+  [[nodiscard]] const Cache_prefetcher* get_prefetcher() const { return prefetcher.get(); }
+
   bool Modified(Addr_t addr) const {
     Line* cl = cacheBank->findLineNoEffect(addr, addr, 0xbaadbaad);
     if (cl != 0) {
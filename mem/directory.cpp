@@ -0,0 +1,242 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "directory.hpp"
+
+#include <bit>
+
+#include "config.hpp"
+
+Directory::Directory(Memory_system* current, const std::string& sec, const std::string& n)
+    /* constructor {{{1 */
+    : MemObj(sec, n)
+    , delay(Config::get_integer(sec, "delay"))
+    , n_valid(0)
+    , avgOccupancy(fmt::format("{}_avgOccupancy", n))
+    , invFanout(fmt::format("{}_invFanout", n), 65)
+    , invFiltered(fmt::format("{}:invFiltered", n))
+    , invTargeted(fmt::format("{}:invTargeted", n))
+    , backInv(fmt::format("{}:backInv", n))
+    , nDowngrade(fmt::format("{}:nDowngrade", n)) {
+  NumUnits_t num = Config::get_integer(section, "port_num");
+
+  dataPort = PortGeneric::create(name + "_data", num);
+  cmdPort  = PortGeneric::create(name + "_cmd", num);
+
+  dir = DirType::create(section, "", name);
+
+  I(current);
+  MemObj* lower_level = current->declareMemoryObj(section, "lower_level");
+  if (lower_level) {
+    addLowerLevel(lower_level);
+  }
+}
+/* }}} */
+
+uint32_t Directory::get_grain() const
+/* up nodes per sharer bit {{{1 */
+{
+  return (router->getNumUpNodes() + 63) / 64;
+}
+/* }}} */
+
+uint64_t Directory::port_bit(int16_t port) const {
+  if (port < 0) {
+    return 0;  // created by a lower level, no up node to track
+  }
+  return 1ULL << (port / get_grain());
+}
+
+int32_t Directory::send_set_state(MemRequest* mreq, MsgAction ma, uint64_t sharers, int16_t skip_port)
+/* setState only to the up nodes in the sharers vector, return how many {{{1 */
+{
+  uint32_t grain = get_grain();
+  uint32_t n_up  = router->getNumUpNodes();
+
+  int32_t conta = 0;
+  for (; sharers; sharers &= sharers - 1) {
+    uint32_t first = std::countr_zero(sharers) * grain;
+    for (uint32_t pos = first; pos < first + grain && pos < n_up; ++pos) {
+      if (static_cast<int16_t>(pos) == skip_port) {
+        continue;
+      }
+      conta += router->sendSetStateOthersPos(pos, mreq, ma, delay);
+    }
+  }
+
+  invFanout.sample(conta, mreq->has_stats());
+  return conta;
+}
+/* }}} */
+
+void Directory::back_invalidate(Addr_t addr, uint64_t sharers, bool doStats)
+/* a replaced entry invalidates its sharers to keep the filter inclusive {{{1 */
+{
+  backInv.inc(doStats);
+
+  MemRequest* inv_req = MemRequest::createSetState(this, this, ma_setInvalid, addr, doStats);
+  int32_t     i       = send_set_state(inv_req, ma_setInvalid, sharers, -1);
+  if (i == 0) {
+    inv_req->ack();
+  }
+}
+/* }}} */
+
+Directory::Line* Directory::allocate(Addr_t addr, bool doStats)
+/* new entry, the victim sharers are invalidated {{{1 */
+{
+  Addr_t rpl_addr = 0;
+  Line*  l        = dir->fillLine_replace(addr, addr, rpl_addr, 0);
+
+  if (rpl_addr) {
+    if (l->sharers) {
+      back_invalidate(rpl_addr, l->sharers, doStats);
+    }
+  } else {
+    n_valid++;
+  }
+  l->sharers   = 0;
+  l->exclusive = false;
+
+  return l;
+}
+/* }}} */
+
+void Directory::release(Line* l) {
+  I(l->isValid());
+  l->invalidate();
+  n_valid--;
+}
+
+void Directory::doReq(MemRequest* mreq)
+/* invalidate or downgrade the other sharers, then forward {{{1 */
+{
+  bool doStats = mreq->has_stats();
+  avgOccupancy.sample(n_valid, doStats);
+
+  Line* l = dir->findLineNoEffect(mreq->getAddr(), mreq->getAddr(), mreq->getPC());
+  if (l) {
+    int16_t  portid = router->getCreatorPort(mreq);
+    uint64_t others = l->sharers & ~port_bit(portid);
+    if (get_grain() > 1) {
+      others = l->sharers;  // coarse, the creator group may have other sharers
+    }
+
+    int32_t nmsg = 0;
+    if (mreq->getAction() != ma_setValid && others) {
+      invTargeted.inc(doStats);
+      nmsg = send_set_state(mreq, ma_setInvalid, others, portid);
+      l->sharers &= ~others;
+      l->exclusive = false;
+    } else if (l->exclusive && others) {
+      nDowngrade.inc(doStats);
+      nmsg         = send_set_state(mreq, ma_setShared, others, portid);
+      l->exclusive = false;
+    }
+    if (nmsg) {
+      return;  // redoReq when all the setStateAck are back
+    }
+  }
+
+  TimeDelta_t when = cmdPort->nextSlotDelta(mreq->has_stats()) + delay;
+  router->scheduleReq(mreq, when);
+}
+/* }}} */
+
+void Directory::doDisp(MemRequest* mreq)
+/* the up node dropped the line {{{1 */
+{
+  // A coarse bit covers a group of up nodes and a displacement does not say
+  // if the rest of the group still has the line, so the bit stays set. The
+  // entry then lingers until a replacement or an invalidation clears it.
+  Line* l = dir->findLineNoEffect(mreq->getAddr(), mreq->getAddr(), mreq->getPC());
+  if (l && get_grain() == 1) {
+    l->sharers &= ~port_bit(router->getCreatorPort(mreq));
+    if (l->sharers == 0) {
+      release(l);
+    }
+  }
+
+  TimeDelta_t when = dataPort->nextSlotDelta(mreq->has_stats()) + delay;
+  router->scheduleDisp(mreq, when);
+}
+/* }}} */
+
+void Directory::doReqAck(MemRequest* mreq)
+/* data is coming back, track the new sharer {{{1 */
+{
+  TimeDelta_t when = dataPort->nextSlotDelta(mreq->has_stats()) + delay;
+
+  if (mreq->isHomeNode()) {
+    mreq->ack(when);
+    return;
+  }
+
+  Line* l = dir->readLine(mreq->getAddr(), mreq->getAddr(), mreq->getPC());
+  if (l == nullptr) {
+    l = allocate(mreq->getAddr(), mreq->has_stats());
+  }
+  uint64_t bit = port_bit(router->getCreatorPort(mreq));
+  if (mreq->getAction() == ma_setExclusive && (l->sharers & ~bit)) {
+    // the level below sees one up node, only the filter knows of the others
+    mreq->forceReqAction(ma_setShared);
+  }
+  l->sharers |= bit;
+  l->exclusive = mreq->getAction() != ma_setShared && std::popcount(l->sharers) == 1;
+
+  router->scheduleReqAck(mreq, when);
+}
+/* }}} */
+
+void Directory::doSetState(MemRequest* mreq)
+/* forward set state only to the sharers {{{1 */
+{
+  Line* l = dir->findLineNoEffect(mreq->getAddr(), mreq->getAddr(), mreq->getPC());
+
+  int32_t nmsg = 0;
+  if (l) {
+    nmsg = send_set_state(mreq, mreq->getAction(), l->sharers, -1);
+    if (mreq->getAction() == ma_setInvalid) {
+      release(l);
+    } else {
+      l->exclusive = false;
+    }
+  }
+
+  if (nmsg == 0) {
+    // no up node has it, same as a miss
+    invFiltered.inc(mreq->has_stats());
+    mreq->convert2SetStateAck(ma_setInvalid, false);
+    router->scheduleSetStateAck(mreq, delay);
+  }
+}
+/* }}} */
+
+void Directory::doSetStateAck(MemRequest* mreq)
+/* forward set state to all the lower nodes {{{1 */
+{
+  if (mreq->isHomeNode()) {
+    mreq->ack();
+    return;
+  }
+  router->scheduleSetStateAck(mreq, delay);
+}
+/* }}} */
+
+bool Directory::isBusy(Addr_t addr) const {
+  (void)addr;
+  return false;
+}
+
+void Directory::tryPrefetch(Addr_t addr, bool doStats, int degree, Addr_t pref_sign, Addr_t pc, CallbackBase* cb) {
+  router->tryPrefetch(addr, doStats, degree, pref_sign, pc, cb);
+}
+
+TimeDelta_t Directory::ffread(Addr_t addr) {
+  (void)addr;
+  return delay;
+}
+
+TimeDelta_t Directory::ffwrite(Addr_t addr) {
+  (void)addr;
+  return delay;
+}
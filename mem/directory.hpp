@@ -0,0 +1,99 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include "cachecore.hpp"
+#include "memobj.hpp"
+#include "memory_system.hpp"
+#include "memrequest.hpp"
+#include "port.hpp"
+#include "stats.hpp"
+
+// Snoop filter between the private caches (up nodes) and a shared level.
+//
+// It forwards requests like a Bus, but remembers which up nodes hold each
+// line in a 64 bit sharer vector, so invalidations and downgrades only go
+// to the sharers instead of every up node. With more than 64 up nodes the
+// vector becomes coarse: each bit covers a group of consecutive ports, and
+// a displacement does not clear it (the rest of the group may share).
+//
+// The filter is inclusive of the up nodes: replacing a directory entry
+// invalidates its sharers.
+class Directory : public MemObj {
+protected:
+  class DState : public StateGeneric<Addr_t> {
+  public:
+    uint64_t sharers;
+    bool     exclusive;  // the single sharer may hold the line E or M
+
+    DState(int32_t lineSize) {
+      (void)lineSize;
+      sharers   = 0;
+      exclusive = false;
+      clearTag();
+    }
+
+    void invalidate() override {
+      sharers   = 0;
+      exclusive = false;
+      StateGeneric<Addr_t>::invalidate();
+    }
+  };
+
+  using DirType = CacheGeneric<DState, Addr_t>;
+  using Line    = DirType::CacheLine;
+
+  TimeDelta_t delay;
+
+  std::shared_ptr<PortGeneric> dataPort;
+  std::shared_ptr<PortGeneric> cmdPort;
+
+  DirType* dir;
+  int32_t  n_valid;
+
+  Stats_avg  avgOccupancy;
+  Stats_hist invFanout;
+  Stats_cntr invFiltered;
+  Stats_cntr invTargeted;
+  Stats_cntr backInv;
+  Stats_cntr nDowngrade;
+
+  [[nodiscard]] uint32_t get_grain() const;
+  [[nodiscard]] uint64_t port_bit(int16_t port) const;
+
+  int32_t send_set_state(MemRequest* mreq, MsgAction ma, uint64_t sharers, int16_t skip_port);
+  void    back_invalidate(Addr_t addr, uint64_t sharers, bool doStats);
+  Line*   allocate(Addr_t addr, bool doStats);
+  void    release(Line* l);
+
+public:
+  Directory(Memory_system* current, const std::string& device_descr_section, const std::string& device_name = "");
+  ~Directory() {}
+
+  // Entry points to schedule that may schedule a do?? if needed
+  void req(MemRequest* req) { doReq(req); };
+  void reqAck(MemRequest* req) { doReqAck(req); };
+  void setState(MemRequest* req) { doSetState(req); };
+  void setStateAck(MemRequest* req) { doSetStateAck(req); };
+  void disp(MemRequest* req) { doDisp(req); }
+
+  // This do the real work
+  void doReq(MemRequest* r);
+  void doReqAck(MemRequest* req);
+  void doSetState(MemRequest* req);
+  void doSetStateAck(MemRequest* req);
+  void doDisp(MemRequest* req);
+
+  TimeDelta_t ffread(Addr_t addr);
+  TimeDelta_t ffwrite(Addr_t addr);
+
+  void tryPrefetch(Addr_t addr, bool doStats, int degree, Addr_t pref_sign, Addr_t pc, CallbackBase* cb = 0);
+
+  bool isBusy(Addr_t addr) const;
+
+  [[nodiscard]] double get_invTargeted() const { return invTargeted.getDouble(); }
+  [[nodiscard]] double get_invFiltered() const { return invFiltered.getDouble(); }
+  [[nodiscard]] double get_backInv() const { return backInv.getDouble(); }
+  [[nodiscard]] double get_nDowngrade() const { return nDowngrade.getDouble(); }
+  [[nodiscard]] double get_invFanout(int32_t n) const { return invFanout.get_count(n); }
+};
@@ -0,0 +1,142 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "directory.hpp"
+
+#include <fstream>
+
+#include "callback.hpp"
+#include "ccache.hpp"
+#include "config.hpp"
+#include "dinst.hpp"
+#include "gtest/gtest.h"
+#include "memory_system.hpp"
+#include "memrequest.hpp"
+#include "report.hpp"
+
+// Two DL1s over a directory with two entries, over a four line L2
+class Directory_test : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    std::ofstream file("directory_test.toml");
+    file << "[soc]\ncore = [\"c0\",\"c0\"]\n"
+            "[c0]\ntype = \"ooo\"\ncaches = true\ndl1 = \"dl1_cache DL1\"\nil1 = \"dl1_cache IL1\"\n";
+    for (const auto* sec : {"dl1_cache", "l2_cache"}) {
+      bool l1 = sec[0] == 'd';
+      file << "[" << sec << "]\n"
+           << "type = \"cache\"\ncold_misses = true\nline_size = 64\nrepl_policy = \"lru\"\n"
+           << "size = " << (l1 ? 32768 : 256) << "\nassoc = 4\ndelay = " << (l1 ? 5 : 13) << "\nmiss_delay = 2\n"
+           << "port_occ = 1\nport_num = 1\nport_banks = 32\nsend_port_occ = 1\nsend_port_num = 1\n"
+           << "max_requests = 32\nallocate_miss = true\nvictim = false\ncoherent = true\ninclusive = true\n"
+           << "directory = false\nnlp_distance = 2\nnlp_degree = 0\nnlp_stride = 1\ndrop_prefetch = false\n"
+           << "prefetch_degree = 0\nmega_lines1K = 0\n"
+           << "lower_level = \"" << (l1 ? "dir DIR shared" : "mem mem shared") << "\"\n";
+    }
+    file << "[dir]\ntype = \"directory\"\ndelay = 1\nport_num = 1\nsize = 128\nassoc = 2\nline_size = 64\n"
+            "repl_policy = \"lru\"\nlower_level = \"l2_cache L2 shared\"\n";
+    file << "[mem]\ntype = \"nice\"\nline_size = 64\ndelay = 31\ncold_misses = false\nlower_level = \"\"\n";
+    file.close();
+
+    Report::init();
+    Config::init("directory_test.toml");
+    gms0 = new Memory_system(0);
+    gms1 = new Memory_system(1);
+    ASSERT_FALSE(Config::has_errors());
+    EventScheduler::advanceClock();
+
+    dl1_0 = static_cast<CCache*>(gms0->getDL1());
+    dl1_1 = static_cast<CCache*>(gms1->getDL1());
+    dir   = static_cast<Directory*>(dl1_0->getRouter()->getDownNode());
+    ASSERT_EQ(dir->get_type(), "directory");
+    ASSERT_EQ(dl1_1->getRouter()->getDownNode(), dir);
+  }
+
+  static void done(Dinst* dinst) {
+    --pending;
+    dinst->scrap();
+  }
+  using doneCB = CallbackFunction1<Dinst*, &done>;
+
+  static void access(CCache* dl1, Addr_t addr, bool write) {
+    auto* dinst = Dinst::create(Instruction(write ? Opcode::iSALU_ST : Opcode::iLALU_LD,
+                                            RegType::LREG_R1,
+                                            RegType::LREG_R2,
+                                            RegType::LREG_R3,
+                                            RegType::LREG_R4),
+                                0x400,
+                                addr,
+                                0,
+                                true);
+    while (dl1->isBusy(addr)) {
+      EventScheduler::advanceClock();
+    }
+    ++pending;
+    auto* cb = doneCB::create(dinst, dinst->getID());
+    if (write) {
+      MemRequest::sendReqWrite(dl1, true, addr, dinst->getPC(), cb);
+    } else {
+      MemRequest::sendReqRead(dl1, true, addr, dinst->getPC(), cb);
+    }
+    for (int i = 0; i < 500 || pending; ++i) {
+      EventScheduler::advanceClock();  // and the setState/acks behind it
+    }
+  }
+  static void read(CCache* dl1, Addr_t addr) { access(dl1, addr, false); }
+  static void write(CCache* dl1, Addr_t addr) { access(dl1, addr, true); }
+
+  static inline Gmemory_system* gms0    = nullptr;
+  static inline Gmemory_system* gms1    = nullptr;
+  static inline CCache*         dl1_0   = nullptr;
+  static inline CCache*         dl1_1   = nullptr;
+  static inline Directory*      dir     = nullptr;
+  static inline int             pending = 0;
+};
+
+// A write to a shared line invalidates only the other sharer
+TEST_F(Directory_test, write_invalidates_the_sharer) {
+  read(dl1_0, 0x1000);
+  read(dl1_1, 0x1000);
+  EXPECT_TRUE(dl1_0->Shared(0x1000));
+  EXPECT_TRUE(dl1_1->Shared(0x1000));
+
+  auto targeted = dir->get_invTargeted();
+  auto fanout1  = dir->get_invFanout(1);
+  write(dl1_0, 0x1000);
+  EXPECT_EQ(dir->get_invTargeted(), targeted + 1);
+  EXPECT_EQ(dir->get_invFanout(1), fanout1 + 1);
+  EXPECT_TRUE(dl1_0->Modified(0x1000));
+  EXPECT_TRUE(dl1_1->Invalid(0x1000));
+}
+
+// A read of a line the other DL1 holds E or M downgrades it to shared
+TEST_F(Directory_test, read_downgrades_the_exclusive_sharer) {
+  write(dl1_0, 0x2000);
+  EXPECT_TRUE(dl1_0->Modified(0x2000));
+
+  auto downgrade = dir->get_nDowngrade();
+  auto targeted  = dir->get_invTargeted();
+  read(dl1_1, 0x2000);
+  EXPECT_EQ(dir->get_nDowngrade(), downgrade + 1);
+  EXPECT_EQ(dir->get_invTargeted(), targeted);
+  EXPECT_TRUE(dl1_0->Shared(0x2000));
+  EXPECT_TRUE(dl1_1->Shared(0x2000));
+}
+
+// Replacing a directory entry invalidates its sharers, and once the L2
+// evicts that line the invalidation from below stops at the directory
+TEST_F(Directory_test, back_invalidate_and_filtered_acks) {
+  read(dl1_0, 0x10000);
+  read(dl1_1, 0x10000);
+  read(dl1_0, 0x11000);
+
+  auto back = dir->get_backInv();
+  read(dl1_0, 0x12000);  // two entries, 0x10000 is the LRU
+  EXPECT_EQ(dir->get_backInv(), back + 1);
+  EXPECT_TRUE(dl1_0->Invalid(0x10000));
+  EXPECT_TRUE(dl1_1->Invalid(0x10000));
+  EXPECT_FALSE(dl1_0->Invalid(0x11000));
+
+  read(dl1_1, 0x13000);  // the L2 holds 0x10000 to 0x13000
+  auto filtered = dir->get_invFiltered();
+  read(dl1_1, 0x14000);  // L2 evicts 0x10000, no up node has it
+  EXPECT_EQ(dir->get_invFiltered(), filtered + 1);
+}
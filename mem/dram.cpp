@@ -0,0 +1,562 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "dram.hpp"
+
+#include <algorithm>
+
+#include "config.hpp"
+#include "fmt/format.h"
+#include "iassert.hpp"
+
+namespace {
+
+// All timings in DRAM clocks (nCK). row_size is the row buffer in bytes
+// seen by one channel. clock_ratio is core cycles per DRAM clock for a
+// ~3GHz core.
+struct Dram_preset {
+  const char* name;
+  uint32_t    tCL;
+  uint32_t    tCWL;
+  uint32_t    tRCD;
+  uint32_t    tRP;
+  uint32_t    tRAS;
+  uint32_t    tRTP;
+  uint32_t    tWR;
+  uint32_t    tBL;
+  uint32_t    tCCD_S;
+  uint32_t    tCCD_L;
+  uint32_t    tRRD_S;
+  uint32_t    tRRD_L;
+  uint32_t    tFAW;
+  uint32_t    tWTR_S;
+  uint32_t    tWTR_L;
+  uint32_t    tRTRS;
+  uint32_t    tREFI;
+  uint32_t    tRFC;
+  uint32_t    channels;
+  uint32_t    ranks;
+  uint32_t    bank_groups;
+  uint32_t    banks;
+  uint32_t    rows;
+  uint32_t    row_size;
+  uint32_t    clock_ratio;
+};
+
+// DDR4-3200 8Gb x8, DDR5-4800 16Gb x8 (two 32bit subchannels), HBM2 1GHz pseudo channels
+constexpr std::array<Dram_preset, 3> presets = {{
+    {"ddr4", 22, 16, 22, 22, 52, 12, 24, 4, 4, 8, 4, 8, 34, 4, 12, 2, 12480, 560, 1, 1, 4, 4, 65536, 8192, 2},
+    {"ddr5", 40, 38, 40, 40, 77, 18, 72, 8, 8, 12, 8, 12, 32, 6, 24, 2, 9360, 708, 2, 1, 8, 4, 65536, 4096, 1},
+    {"hbm", 14, 4, 14, 14, 34, 5, 16, 2, 2, 4, 4, 6, 16, 3, 8, 1, 3900, 350, 8, 1, 4, 4, 16384, 2048, 3},
+}};
+
+uint32_t get_opt(const std::string& sec, const std::string& name, uint32_t def, int from, int to) {
+  if (!Config::has_entry(sec, name)) {
+    return def;
+  }
+  return Config::get_integer(sec, name, from, to);
+}
+
+uint32_t get_opt_power2(const std::string& sec, const std::string& name, uint32_t def, int from, int to) {
+  if (!Config::has_entry(sec, name)) {
+    return def;
+  }
+  return Config::get_power2(sec, name, from, to);
+}
+
+}  // namespace
+
+Dram::Dram(const std::string& section, const std::string& name)
+    : nActivate(fmt::format("{}:nActivate", name))
+    , nPrecharge(fmt::format("{}:nPrecharge", name))
+    , nRefresh(fmt::format("{}:nRefresh", name))
+    , nRead(fmt::format("{}:nRead", name))
+    , nWrite(fmt::format("{}:nWrite", name))
+    , nRowHit(fmt::format("{}:nRowHit", name))
+    , nRowMiss(fmt::format("{}:nRowMiss", name))
+    , nWriteDrain(fmt::format("{}:nWriteDrain", name))
+    , avgReadQueue(fmt::format("{}_avgReadQueue", name)) {
+  read_timing(section);
+  read_mapping(section);
+
+  xor_bank     = Config::has_entry(section, "xor_bank") && Config::get_bool(section, "xor_bank");
+  refresh      = !Config::has_entry(section, "refresh") || Config::get_bool(section, "refresh");
+  rq_size      = get_opt(section, "rq_size", 32, 1, 1024);
+  wq_size      = get_opt(section, "wq_size", 32, 1, 1024);
+  wq_high      = get_opt(section, "wq_high", wq_size * 3 / 4, 1, wq_size);
+  wq_low       = get_opt(section, "wq_low", wq_size / 4, 0, wq_high - 1);
+  max_row_hits = get_opt(section, "max_row_hits", 16, 1, 1024);
+
+  if (banks_per_channel() > 64) {
+    Config::add_error(fmt::format("memory controller {} has {} banks per channel, the maximum is 64", section, banks_per_channel()));
+  }
+
+  channels.resize(n_channels);
+  ranks.resize(n_channels * n_ranks);
+  bgs.resize(n_channels * n_ranks * n_bgs);
+  banks.resize(n_channels * banks_per_channel());
+
+  // stagger the refresh across ranks
+  for (size_t i = 0; i < ranks.size(); ++i) {
+    ranks[i].refresh_due = tREFI + (tREFI * i) / ranks.size();
+  }
+
+  slots.resize(n_channels * (rq_size + wq_size));
+  for (size_t i = 0; i < slots.size(); ++i) {
+    slots[i].next = i + 1 < slots.size() ? i + 1 : no_slot;
+  }
+  free_slot = 0;
+  n_queued  = 0;
+}
+
+void Dram::read_timing(const std::string& section) {
+  auto std_name = Config::get_string(section, "standard", {"ddr4", "ddr5", "hbm"});
+
+  const Dram_preset* p = &presets[0];
+  for (const auto& e : presets) {
+    if (std_name == e.name) {
+      p = &e;
+    }
+  }
+
+  tCK = get_opt(section, "clock_ratio", p->clock_ratio, 1, 64);
+
+  auto t = [&](const char* n, uint32_t def) -> TimeDelta_t { return tCK * get_opt(section, n, def, 1, 1 << 20); };
+
+  tCL    = t("tCL", p->tCL);
+  tCWL   = t("tCWL", p->tCWL);
+  tRCD   = t("tRCD", p->tRCD);
+  tRP    = t("tRP", p->tRP);
+  tRAS   = t("tRAS", p->tRAS);
+  tRTP   = t("tRTP", p->tRTP);
+  tWR    = t("tWR", p->tWR);
+  tBL    = t("tBL", p->tBL);
+  tCCD_S = t("tCCD_S", p->tCCD_S);
+  tCCD_L = t("tCCD_L", p->tCCD_L);
+  tRRD_S = t("tRRD_S", p->tRRD_S);
+  tRRD_L = t("tRRD_L", p->tRRD_L);
+  tFAW   = t("tFAW", p->tFAW);
+  tWTR_S = t("tWTR_S", p->tWTR_S);
+  tWTR_L = t("tWTR_L", p->tWTR_L);
+  tRTRS  = t("tRTRS", p->tRTRS);
+  tREFI  = t("tREFI", p->tREFI);
+  tRFC   = t("tRFC", p->tRFC);
+
+  line_size  = get_opt_power2(section, "line_size", 64, 8, 4096);
+  n_channels = get_opt_power2(section, "channels", p->channels, 1, 64);
+  n_ranks    = get_opt_power2(section, "ranks", p->ranks, 1, 16);
+  n_bgs      = get_opt_power2(section, "bank_groups", p->bank_groups, 1, 16);
+  n_banks    = get_opt_power2(section, "banks", p->banks, 1, 64);
+  n_rows     = get_opt_power2(section, "rows", p->rows, 1, 1 << 24);
+
+  auto row_size = get_opt_power2(section, "row_size", p->row_size, line_size, 1 << 16);
+  n_cols        = row_size / line_size;
+  line_bits     = log2i(line_size);
+  bg_shift      = log2i(n_banks);
+  rank_shift    = bg_shift + log2i(n_bgs);
+}
+
+void Dram::read_mapping(const std::string& section) {
+  // Fields from the most to the least significant address bits, above the line offset
+  std::string mapping("ro_ra_bg_ba_co_ch");
+  if (Config::has_entry(section, "mapping")) {
+    mapping = Config::get_string(section, "mapping");
+  }
+
+  static const std::array<const char*, f_last> tokens = {"ch", "ra", "bg", "ba", "ro", "co"};
+  const std::array<uint32_t, f_last>           sizes  = {n_channels, n_ranks, n_bgs, n_banks, n_rows, n_cols};
+
+  std::vector<Field> order;
+  size_t             start = 0;
+  while (start <= mapping.size()) {
+    auto end = mapping.find('_', start);
+    if (end == std::string::npos) {
+      end = mapping.size();
+    }
+    auto tok = mapping.substr(start, end - start);
+    auto it  = std::find_if(tokens.begin(), tokens.end(), [&tok](const char* e) { return tok == e; });
+    if (it == tokens.end()) {
+      Config::add_error(fmt::format("memory controller {} mapping:{} has unknown field '{}'", section, mapping, tok));
+      return;
+    }
+    order.push_back(static_cast<Field>(it - tokens.begin()));
+    start = end + 1;
+  }
+
+  auto sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  if (sorted.size() != f_last || std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+    Config::add_error(fmt::format("memory controller {} mapping:{} must use each of ch ra bg ba ro co once", section, mapping));
+    return;
+  }
+
+  uint32_t shift = line_bits;
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    field_shift[*it] = shift;
+    field_bits[*it]  = log2i(sizes[*it]);
+    shift += field_bits[*it];
+  }
+}
+
+Dram::Location Dram::map(Addr_t addr) const {
+  std::array<uint32_t, f_last> v;
+  for (int f = 0; f < f_last; ++f) {
+    v[f] = (addr >> field_shift[f]) & ((1ULL << field_bits[f]) - 1);
+  }
+
+  Location loc{v[f_channel], v[f_rank], v[f_bg], v[f_bank], v[f_row], v[f_col]};
+  if (xor_bank) {
+    // permutation interleaving, rows that conflict in a bank spread across banks
+    loc.bank ^= loc.row & (n_banks - 1);
+    loc.bg ^= (loc.row >> field_bits[f_bank]) & (n_bgs - 1);
+  }
+  return loc;
+}
+
+bool Dram::can_accept(Addr_t addr, bool write) const {
+  const auto& ch = channels[map(addr).channel];
+  return ch.n_q[write] < (write ? wq_size : rq_size);
+}
+
+uint32_t Dram::enqueue(Addr_t addr, bool write, Time_t now, bool stats) {
+  I(can_accept(addr, write));
+  I(free_slot != no_slot);
+
+  auto loc = map(addr);
+  auto& ch = channels[loc.channel];
+
+  if (ch.n_q[0] + ch.n_q[1] == 0) {
+    catch_up_refresh(loc.channel, now);
+  }
+
+  uint32_t id = free_slot;
+  auto&    s  = slots[id];
+  free_slot   = s.next;
+
+  s.arrival = now;
+  s.row     = loc.row;
+  s.next    = no_slot;
+  s.stats   = stats;
+
+  uint32_t local = (loc.rank * n_bgs + loc.bg) * n_banks + loc.bank;
+  auto&    b     = banks[loc.channel * banks_per_channel() + local];
+  if (b.tail[write] == no_slot) {
+    b.head[write] = id;
+  } else {
+    slots[b.tail[write]].next = id;
+  }
+  b.tail[write] = id;
+  b.n_q[write]++;
+  if (b.open_row == loc.row) {
+    b.hits[write]++;
+  }
+
+  ch.n_q[write]++;
+  ch.pending |= 1ULL << local;
+  ch.idle_until = 0;
+  ++n_queued;
+
+  if (!write) {
+    avgReadQueue.sample(ch.n_q[0], stats);
+  }
+
+  return id;
+}
+
+Time_t Dram::act_ready(const Rank& r, const Bank_group& g, const Bank& b) const {
+  return std::max({b.next_act, r.next_act, g.next_act, r.faw[r.faw_pos], r.busy_until});
+}
+
+Time_t Dram::col_ready(const Channel& ch, uint32_t rank_id, const Rank& r, const Bank_group& g, const Bank& b, bool write) const {
+  // the data burst has to find the bus free, plus a turnaround when the rank changes
+  Time_t bus = ch.data_free + (ch.last_rank == rank_id ? 0 : tRTRS);
+  Time_t lat = write ? tCWL : tCL;
+  bus        = bus > lat ? bus - lat : 0;
+
+  if (write) {
+    return std::max({b.next_wr, g.next_wr, r.next_wr, ch.next_wr, bus});
+  }
+  return std::max({b.next_rd, g.next_rd, r.next_rd, ch.next_rd, bus});
+}
+
+void Dram::catch_up_refresh(uint32_t ch_id, Time_t now) {
+  // The channel was idle: the refreshes that fell in the idle time are
+  // assumed done, and they left every bank precharged.
+  if (!refresh) {
+    return;
+  }
+  for (uint32_t r = 0; r < n_ranks; ++r) {
+    uint32_t rank_id = ch_id * n_ranks + r;
+    auto&    rk      = ranks[rank_id];
+    if (now < rk.refresh_due) {
+      continue;
+    }
+    Time_t last = rk.refresh_due + ((now - rk.refresh_due) / tREFI) * tREFI;
+    rk.busy_until  = std::max(rk.busy_until, last + tRFC);
+    rk.refresh_due = last + tREFI;
+    rk.n_open      = 0;
+
+    auto* b = &banks[rank_id * banks_per_rank()];
+    for (uint32_t i = 0; i < banks_per_rank(); ++i) {
+      b[i].open_row = no_row;
+      b[i].hits     = {0, 0};
+    }
+  }
+}
+
+bool Dram::do_refresh(uint32_t rank_id, Time_t now, Time_t& wake) {
+  // Close every bank of the rank, then issue REF. Returns true if a command was issued.
+  auto& rk = ranks[rank_id];
+  if (rk.n_open == 0) {
+    Time_t ready = std::max(rk.ref_ready, rk.busy_until);
+    if (ready > now) {
+      wake = std::min(wake, ready);
+      return false;
+    }
+    rk.busy_until = now + tRFC;
+    rk.refresh_due += tREFI;
+    nRefresh.inc();
+    return true;
+  }
+
+  uint32_t first = rank_id * banks_per_rank();
+  for (uint32_t i = 0; i < banks_per_rank(); ++i) {
+    auto& b = banks[first + i];
+    if (b.open_row == no_row) {
+      continue;
+    }
+    if (b.next_pre <= now) {
+      issue_pre(rank_id, first + i, now);
+      return true;
+    }
+    wake = std::min(wake, b.next_pre);
+  }
+  return false;
+}
+
+void Dram::issue_act(uint32_t rank_id, uint32_t bg_id, uint32_t bank_id, bool write, Time_t now) {
+  auto& rk = ranks[rank_id];
+  auto& g  = bgs[bg_id];
+  auto& b  = banks[bank_id];
+
+  I(b.open_row == no_row);
+  I(b.head[write] != no_slot);
+
+  b.open_row  = slots[b.head[write]].row;
+  b.row_hits  = 0;
+  b.next_rd   = now + tRCD;
+  b.next_wr   = now + tRCD;
+  b.next_pre  = now + tRAS;
+  b.next_act  = now + tRAS + tRP;
+  g.next_act  = std::max(g.next_act, now + tRRD_L);
+  rk.next_act = std::max(rk.next_act, now + tRRD_S);
+
+  rk.faw[rk.faw_pos] = now + tFAW;
+  rk.faw_pos         = (rk.faw_pos + 1) & 3;
+  rk.n_open++;
+
+  for (int q = 0; q < 2; ++q) {
+    b.hits[q] = 0;
+    for (auto s = b.head[q]; s != no_slot; s = slots[s].next) {
+      b.hits[q] += slots[s].row == b.open_row;
+    }
+  }
+
+  nActivate.inc();
+}
+
+void Dram::issue_pre(uint32_t rank_id, uint32_t bank_id, Time_t now) {
+  auto& rk = ranks[rank_id];
+  auto& b  = banks[bank_id];
+
+  I(b.open_row != no_row);
+  I(rk.n_open);
+
+  b.open_row   = no_row;
+  b.hits       = {0, 0};
+  b.next_act   = std::max(b.next_act, now + tRP);
+  rk.ref_ready = std::max(rk.ref_ready, now + tRP);
+  rk.n_open--;
+
+  nPrecharge.inc();
+}
+
+void Dram::issue_col(uint32_t ch_id, uint32_t rank_id, uint32_t bg_id, uint32_t bank_id, bool write, Time_t now,
+                     std::vector<Done>& done) {
+  auto& ch = channels[ch_id];
+  auto& rk = ranks[rank_id];
+  auto& g  = bgs[bg_id];
+  auto& b  = banks[bank_id];
+
+  // oldest request to the open row
+  uint32_t prev = no_slot;
+  uint32_t id   = b.head[write];
+  while (slots[id].row != b.open_row) {
+    prev = id;
+    id   = slots[id].next;
+    I(id != no_slot);
+  }
+
+  auto& s = slots[id];
+  if (prev == no_slot) {
+    b.head[write] = s.next;
+  } else {
+    slots[prev].next = s.next;
+  }
+  if (b.tail[write] == id) {
+    b.tail[write] = prev;
+  }
+
+  if (b.row_hits == 0) {
+    nRowMiss.inc(s.stats);
+  } else {
+    nRowHit.inc(s.stats);
+  }
+  b.row_hits++;
+  b.n_q[write]--;
+  b.hits[write]--;
+  ch.n_q[write]--;
+  --n_queued;
+  if (b.n_q[0] + b.n_q[1] == 0) {
+    ch.pending &= ~(1ULL << (bank_id - ch_id * banks_per_channel()));
+  }
+
+  Time_t data_end = now + (write ? tCWL : tCL) + tBL;
+
+  g.next_rd    = std::max(g.next_rd, now + tCCD_L);
+  g.next_wr    = std::max(g.next_wr, now + tCCD_L);
+  rk.next_rd   = std::max(rk.next_rd, now + tCCD_S);
+  rk.next_wr   = std::max(rk.next_wr, now + tCCD_S);
+  ch.data_free = data_end;
+  ch.last_rank = rank_id;
+
+  if (write) {
+    b.next_pre = std::max(b.next_pre, data_end + tWR);
+    g.next_rd  = std::max(g.next_rd, data_end + tWTR_L);
+    rk.next_rd = std::max(rk.next_rd, data_end + tWTR_S);
+    nWrite.inc(s.stats);
+  } else {
+    b.next_pre = std::max(b.next_pre, now + tRTP);
+    Time_t rtw = data_end + tRTRS;  // read to write turnaround
+    ch.next_wr = std::max(ch.next_wr, rtw - std::min<Time_t>(tCWL, rtw));
+    nRead.inc(s.stats);
+  }
+
+  done.push_back({id, data_end});
+
+  s.next    = free_slot;
+  free_slot = id;
+}
+
+Time_t Dram::tick_channel(uint32_t ch_id, Time_t now, std::vector<Done>& done) {
+  auto& ch = channels[ch_id];
+  if (ch.next_cmd > now) {
+    return ch.next_cmd;
+  }
+  if (ch.idle_until > now) {
+    return ch.idle_until;  // nothing changed since the last scan
+  }
+
+  // write drain with hysteresis
+  bool drain = ch.n_q[1] >= wq_high || (ch.n_q[0] == 0 && ch.n_q[1] > 0);
+  if (!ch.write_mode && drain) {
+    ch.write_mode = true;
+    nWriteDrain.inc(ch.n_q[1] >= wq_high);
+  } else if (ch.write_mode && (ch.n_q[1] == 0 || (ch.n_q[1] <= wq_low && ch.n_q[0] > 0))) {
+    ch.write_mode = false;
+  }
+  bool write = ch.write_mode;
+
+  Time_t wake = no_time;
+
+  // refresh first, it blocks the whole rank
+  uint32_t refreshing = 0;  // ranks bitmask
+  if (refresh) {
+    for (uint32_t r = 0; r < n_ranks; ++r) {
+      uint32_t rank_id = ch_id * n_ranks + r;
+      if (ranks[rank_id].refresh_due > now) {
+        wake = std::min(wake, ranks[rank_id].refresh_due);
+        continue;
+      }
+      refreshing |= 1U << r;
+      if (do_refresh(rank_id, now, wake)) {
+        ch.next_cmd = now + tCK;
+        return ch.next_cmd;
+      }
+    }
+  }
+
+  // FR-FCFS: the oldest ready row hit, else the oldest ready activate/precharge
+  enum Cmd : uint8_t { c_none, c_act, c_pre, c_col };
+  Cmd      best_cmd = c_none;
+  bool     best_hit = false;
+  Time_t   best_age = no_time;
+  uint32_t best     = 0;
+
+  // all the sizes are powers of two, the bank id also gives its bank group and rank
+  const uint32_t first = ch_id * banks_per_channel();
+  for (uint64_t mask = ch.pending; mask; mask &= mask - 1) {
+    uint32_t bank_id = first + __builtin_ctzll(mask);
+    uint32_t rank_id = bank_id >> rank_shift;
+    uint32_t bg_id   = bank_id >> bg_shift;
+    auto&    b       = banks[bank_id];
+
+    if (b.n_q[write] == 0 || (refreshing >> (rank_id - ch_id * n_ranks)) & 1) {
+      continue;
+    }
+
+    Time_t age = slots[b.head[write]].arrival;
+    bool   hit = false;
+    Cmd    cmd;
+    Time_t ready;
+    if (b.open_row == no_row) {
+      cmd   = c_act;
+      ready = act_ready(ranks[rank_id], bgs[bg_id], b);
+    } else if (b.hits[write] && (b.row_hits < max_row_hits || b.hits[write] == b.n_q[write])) {
+      cmd   = c_col;
+      hit   = true;
+      ready = col_ready(ch, rank_id, ranks[rank_id], bgs[bg_id], b, write);
+    } else {
+      cmd   = c_pre;
+      ready = b.next_pre;
+    }
+
+    if (ready > now) {
+      wake = std::min(wake, ready);
+      continue;
+    }
+    if (best_cmd == c_none || (hit && !best_hit) || (hit == best_hit && age < best_age)) {
+      best_cmd = cmd;
+      best_hit = hit;
+      best_age = age;
+      best     = bank_id;
+    }
+  }
+
+  if (best_cmd == c_none) {
+    ch.idle_until = wake;
+    return wake;
+  }
+
+  uint32_t rank_id = best >> rank_shift;
+  uint32_t bg_id   = best >> bg_shift;
+  switch (best_cmd) {
+    case c_act: issue_act(rank_id, bg_id, best, write, now); break;
+    case c_pre: issue_pre(rank_id, best, now); break;
+    case c_col: issue_col(ch_id, rank_id, bg_id, best, write, now, done); break;
+    default: I(0);
+  }
+
+  ch.next_cmd = now + tCK;
+  return ch.next_cmd;
+}
+
+Time_t Dram::tick(Time_t now, std::vector<Done>& done) {
+  Time_t wake = no_time;
+  for (uint32_t c = 0; c < n_channels; ++c) {
+    if (channels[c].n_q[0] + channels[c].n_q[1] == 0) {
+      continue;
+    }
+    wake = std::min(wake, tick_channel(c, now, done));
+  }
+  return wake;
+}
@@ -0,0 +1,201 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "opcode.hpp"
+#include "snippets.hpp"
+#include "stats.hpp"
+
+// Cycle accurate DRAM timing model with DDR4, DDR5 and HBM presets.
+//
+// Each channel has rank, bank group and bank state machines that track
+// the earliest time every command can issue (tRCD, tRP, tRAS, tRTP, tWR,
+// tCCD_S/L, tRRD_S/L, tFAW, tWTR_S/L, read/write turnaround and the data
+// bus). The FR-FCFS scheduler only looks at banks with queued requests,
+// and each bank keeps its own read and write FIFO plus the number of
+// queued hits to the open row, so a tick does not scan the request buffer.
+//
+// The model knows nothing about MemRequest: enqueue returns a slot, and
+// tick reports finished slots with the cycle their data burst ends. All
+// the times are core cycles (DRAM clocks times clock_ratio).
+class Dram {
+public:
+  static constexpr uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+  static constexpr Time_t   no_time = std::numeric_limits<Time_t>::max();
+
+  struct Done {
+    uint32_t slot;
+    Time_t   when;
+  };
+
+  struct Location {
+    uint32_t channel;
+    uint32_t rank;
+    uint32_t bg;
+    uint32_t bank;
+    uint32_t row;
+    uint32_t col;
+  };
+
+  Dram(const std::string& section, const std::string& name);
+
+  [[nodiscard]] Location map(Addr_t addr) const;
+
+  [[nodiscard]] bool can_accept(Addr_t addr, bool write) const;
+
+  // Caller must check can_accept first
+  uint32_t enqueue(Addr_t addr, bool write, Time_t now, bool stats = true);
+
+  // Issue at most one command per channel. Finished requests are appended
+  // to done. Returns when the next command may be ready (no_time if idle).
+  Time_t tick(Time_t now, std::vector<Done>& done);
+
+  [[nodiscard]] size_t      n_slots() const { return slots.size(); }
+  [[nodiscard]] size_t      n_pending() const { return n_queued; }
+  [[nodiscard]] TimeDelta_t get_idle_latency() const { return tRCD + tCL + tBL; }
+  [[nodiscard]] uint32_t    get_line_size() const { return line_size; }
+
+private:
+  static constexpr uint32_t no_row = std::numeric_limits<uint32_t>::max();
+
+  enum Field : uint8_t { f_channel = 0, f_rank, f_bg, f_bank, f_row, f_col, f_last };
+
+  // timing, already scaled to core cycles
+  TimeDelta_t tCK;
+  TimeDelta_t tCL;
+  TimeDelta_t tCWL;
+  TimeDelta_t tRCD;
+  TimeDelta_t tRP;
+  TimeDelta_t tRAS;
+  TimeDelta_t tRTP;
+  TimeDelta_t tWR;
+  TimeDelta_t tBL;
+  TimeDelta_t tCCD_S;
+  TimeDelta_t tCCD_L;
+  TimeDelta_t tRRD_S;
+  TimeDelta_t tRRD_L;
+  TimeDelta_t tFAW;
+  TimeDelta_t tWTR_S;
+  TimeDelta_t tWTR_L;
+  TimeDelta_t tRTRS;
+  TimeDelta_t tREFI;
+  TimeDelta_t tRFC;
+
+  uint32_t line_size;
+  uint32_t line_bits;
+  uint32_t n_channels;
+  uint32_t n_ranks;
+  uint32_t n_bgs;
+  uint32_t n_banks;  // per bank group
+  uint32_t n_rows;
+  uint32_t n_cols;  // lines per row
+  uint32_t bg_shift;
+  uint32_t rank_shift;
+
+  std::array<uint8_t, f_last> field_shift;
+  std::array<uint8_t, f_last> field_bits;
+
+  bool     xor_bank;
+  bool     refresh;
+  uint32_t rq_size;
+  uint32_t wq_size;
+  uint32_t wq_high;
+  uint32_t wq_low;
+  uint32_t max_row_hits;
+
+  struct Slot {
+    Time_t   arrival;
+    uint32_t row;
+    uint32_t next;
+    bool     stats;
+  };
+
+  struct Bank {
+    Time_t   next_act = 0;
+    Time_t   next_pre = 0;
+    Time_t   next_rd  = 0;
+    Time_t   next_wr  = 0;
+    uint32_t open_row = no_row;
+    uint32_t row_hits = 0;  // column commands since the activate
+
+    // per bank FIFO, [0] reads and [1] writes
+    std::array<uint32_t, 2> head = {no_slot, no_slot};
+    std::array<uint32_t, 2> tail = {no_slot, no_slot};
+    std::array<uint32_t, 2> n_q  = {0, 0};
+    std::array<uint32_t, 2> hits = {0, 0};  // queued requests for open_row
+  };
+
+  struct Bank_group {
+    Time_t next_act = 0;
+    Time_t next_rd  = 0;
+    Time_t next_wr  = 0;
+  };
+
+  struct Rank {
+    Time_t                next_act    = 0;
+    Time_t                next_rd     = 0;
+    Time_t                next_wr     = 0;
+    Time_t                busy_until  = 0;  // refresh in progress
+    Time_t                refresh_due = 0;
+    Time_t                ref_ready   = 0;  // last precharge done
+    std::array<Time_t, 4> faw         = {0, 0, 0, 0};
+    uint32_t              faw_pos     = 0;
+    uint32_t              n_open      = 0;
+  };
+
+  struct Channel {
+    Time_t                  next_cmd   = 0;
+    Time_t                  idle_until = 0;  // no command ready before
+    Time_t                  data_free  = 0;
+    Time_t                  next_rd    = 0;
+    Time_t                  next_wr    = 0;
+    uint32_t                last_rank  = 0;
+    bool                    write_mode = false;
+    std::array<uint32_t, 2> n_q        = {0, 0};
+    uint64_t                pending    = 0;  // banks with queued requests
+  };
+
+  std::vector<Slot>       slots;
+  uint32_t                free_slot;
+  size_t                  n_queued;
+  std::vector<Channel>    channels;
+  std::vector<Rank>       ranks;
+  std::vector<Bank_group> bgs;
+  std::vector<Bank>       banks;
+
+  Stats_cntr nActivate;
+  Stats_cntr nPrecharge;
+  Stats_cntr nRefresh;
+  Stats_cntr nRead;
+  Stats_cntr nWrite;
+  Stats_cntr nRowHit;
+  Stats_cntr nRowMiss;
+  Stats_cntr nWriteDrain;
+  Stats_avg  avgReadQueue;
+
+  void read_timing(const std::string& section);
+  void read_mapping(const std::string& section);
+
+  [[nodiscard]] uint32_t banks_per_channel() const { return n_ranks * n_bgs * n_banks; }
+  [[nodiscard]] uint32_t banks_per_rank() const { return n_bgs * n_banks; }
+
+  [[nodiscard]] Time_t act_ready(const Rank& r, const Bank_group& g, const Bank& b) const;
+  [[nodiscard]] Time_t col_ready(const Channel& ch, uint32_t rank_id, const Rank& r, const Bank_group& g, const Bank& b,
+                                 bool write) const;
+
+  void catch_up_refresh(uint32_t ch_id, Time_t now);
+  bool do_refresh(uint32_t rank_id, Time_t now, Time_t& wake);
+
+  void issue_act(uint32_t rank_id, uint32_t bg_id, uint32_t bank_id, bool write, Time_t now);
+  void issue_pre(uint32_t rank_id, uint32_t bank_id, Time_t now);
+  void issue_col(uint32_t ch_id, uint32_t rank_id, uint32_t bg_id, uint32_t bank_id, bool write, Time_t now,
+                 std::vector<Done>& done);
+
+  Time_t tick_channel(uint32_t ch_id, Time_t now, std::vector<Done>& done);
+};
@@ -0,0 +1,211 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "dram.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+
+class Dram_test : public ::testing::Test {
+protected:
+  // DDR4 preset, one core cycle per DRAM clock: tRCD=tCL=tRP=22, tRAS=52, tBL=4
+  static constexpr Time_t idle_lat = 22 + 22 + 4;
+
+  void setup(const std::string& extra, bool refresh = false) {
+    std::ofstream file("dram_test.toml");
+    file << "[mem]\n";
+    file << "standard = \"ddr4\"\n";
+    file << "clock_ratio = 1\n";
+    file << "refresh = " << (refresh ? "true" : "false") << "\n";
+    file << extra;
+    file.close();
+
+    Config::init("dram_test.toml");
+  }
+
+  // Address of line col in row/bank/bg for the default ro_ra_bg_ba_co_ch mapping (1 channel, 1 rank)
+  static Addr_t addr(uint32_t row, uint32_t bg, uint32_t bank, uint32_t col) {
+    return ((((static_cast<Addr_t>(row) * 4 + bg) * 4 + bank) * 128 + col) << 6);
+  }
+
+  // Feeds one Dram and keeps the completion time per request (slots are reused)
+  class Driver {
+  public:
+    explicit Driver(Dram& _d) : d(_d) {}
+
+    Time_t              now = 0;
+    std::vector<Time_t> when;
+
+    size_t add(Addr_t a, bool write = false) {
+      auto s = d.enqueue(a, write, now);
+      owner.resize(d.n_slots());
+      owner[s] = when.size();
+      when.push_back(0);
+      return when.size() - 1;
+    }
+
+    Time_t step() {
+      done.clear();
+      auto wake = d.tick(now, done);
+      for (const auto& e : done) {
+        when[owner[e.slot]] = e.when;
+      }
+      return wake;
+    }
+
+    void advance(Time_t end) {
+      for (; now < end; ++now) {
+        step();
+      }
+    }
+
+    void drain() {
+      while (d.n_pending()) {
+        auto wake = step();
+        now       = wake > now && wake != Dram::no_time ? wake : now + 1;
+      }
+    }
+
+  private:
+    Dram&                   d;
+    std::vector<size_t>     owner;
+    std::vector<Dram::Done> done;
+  };
+};
+
+TEST_F(Dram_test, idle_read_latency) {
+  setup("");
+  Dram d("mem", "dram0");
+  EXPECT_FALSE(Config::has_errors());
+  EXPECT_EQ(d.get_idle_latency(), idle_lat);
+
+  Driver t(d);
+  auto   a = t.add(addr(5, 1, 2, 3));
+  t.drain();
+  EXPECT_EQ(t.when[a], idle_lat);
+}
+
+TEST_F(Dram_test, row_hit_beats_row_conflict) {
+  setup("");
+  Dram d("mem", "dram0");
+
+  Driver t(d);
+  auto   a = t.add(addr(5, 0, 0, 0));
+  auto   b = t.add(addr(5, 0, 0, 1));
+  t.drain();
+  EXPECT_EQ(t.when[a], idle_lat);
+  EXPECT_EQ(t.when[b], idle_lat + 8);  // tCCD_L
+
+  auto start = t.now;
+  auto c     = t.add(addr(9, 0, 0, 0));
+  t.drain();
+  EXPECT_GE(t.when[c] - start, 22 + idle_lat);  // precharge first
+}
+
+TEST_F(Dram_test, fr_fcfs_serves_row_hits_first) {
+  setup("");
+  Dram d("mem", "dram0");
+
+  Driver t(d);
+  auto   a = t.add(addr(1, 0, 0, 0));
+  auto   b = t.add(addr(2, 0, 0, 0));  // conflict, older
+  auto   c = t.add(addr(1, 0, 0, 5));  // hit, younger
+  t.drain();
+  EXPECT_LT(t.when[a], t.when[c]);
+  EXPECT_LT(t.when[c], t.when[b]);
+}
+
+TEST_F(Dram_test, four_activate_window) {
+  setup("");
+  Dram d("mem", "dram0");
+
+  // five banks in different bank groups or banks, tRRD_S=4 tRRD_L=8 tFAW=34
+  Driver t(d);
+  for (uint32_t i = 0; i < 5; ++i) {
+    t.add(addr(1, i & 3, i >> 2, 0));
+  }
+  t.drain();
+
+  std::sort(t.when.begin(), t.when.end());
+  EXPECT_EQ(t.when[0], idle_lat);
+  EXPECT_LT(t.when[3], 34 + idle_lat);
+  EXPECT_GE(t.when[4], 34 + idle_lat);
+}
+
+TEST_F(Dram_test, writes_drain_in_bursts) {
+  setup("wq_size = 8\nwq_high = 6\nwq_low = 2\n");
+  Dram d("mem", "dram0");
+
+  Driver              t(d);
+  std::vector<size_t> w;
+  for (uint32_t i = 0; i < 4; ++i) {
+    w.push_back(t.add(addr(3, 1, 1, i), true));
+  }
+  std::vector<size_t> r;
+  for (uint32_t i = 0; i < 8; ++i) {
+    r.push_back(t.add(addr(4, 2, 2, i)));
+  }
+  t.drain();
+
+  // below the high watermark the reads go first
+  for (auto ws : w) {
+    for (auto rs : r) {
+      EXPECT_GT(t.when[ws], t.when[rs]);
+    }
+  }
+
+  // at the high watermark the writes go in a burst ahead of the new reads
+  w.clear();
+  r.clear();
+  for (uint32_t i = 0; i < 6; ++i) {
+    w.push_back(t.add(addr(3, 1, 1, i), true));
+  }
+  r.push_back(t.add(addr(4, 2, 2, 0)));
+  t.drain();
+  EXPECT_LT(t.when[w[0]], t.when[r[0]]);
+}
+
+TEST_F(Dram_test, refresh_blocks_rank) {
+  setup("tREFI = 1000\ntRFC = 300\n", true);
+  Dram d("mem", "dram0");
+
+  // lands right when the first refresh is due, the rank is busy for tRFC
+  Driver t(d);
+  t.now  = 1000;
+  auto a = t.add(addr(1, 0, 0, 0));
+  t.drain();
+  EXPECT_EQ(t.when[a], 1000 + 300 + idle_lat);
+
+  // a busy channel refreshes on its own at 2000
+  t.advance(1500);
+  std::vector<size_t> r;
+  for (uint32_t i = 0; i < 24; ++i) {
+    r.push_back(t.add(addr(1 + (i & 7), i & 3, 0, i)));
+    t.advance(t.now + 40);
+  }
+  t.drain();
+  EXPECT_LT(t.when[r[0]], 2000);
+  EXPECT_GE(t.when[r[13]], 2000 + 300);  // arrived at 2020
+}
+
+TEST_F(Dram_test, address_mapping) {
+  setup("channels = 2\n");
+  Dram d("mem", "dram0");
+  EXPECT_FALSE(Config::has_errors());
+
+  // consecutive lines interleave channels, then walk the row
+  auto l0 = d.map(0);
+  auto l1 = d.map(64);
+  auto l2 = d.map(128);
+  EXPECT_EQ(l0.channel, 0U);
+  EXPECT_EQ(l1.channel, 1U);
+  EXPECT_EQ(l2.channel, 0U);
+  EXPECT_EQ(l2.col, 1U);
+  EXPECT_EQ(l2.row, l0.row);
+
+  setup("mapping = \"ro_ra_bg_ba_co\"\n");
+  Dram bad("mem", "dram1");
+  EXPECT_TRUE(Config::has_errors());
+}
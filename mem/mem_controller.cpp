@@ -2,10 +2,7 @@
 
 #include "mem_controller.hpp"
 
-#include <cmath>
-#include <iostream>
-#include <queue>
-#include <vector>
+#include <algorithm>
 
 #include "config.hpp"
 #include "memory_system.hpp"
@@ -14,46 +11,16 @@ MemController::MemController(Memory_system* current, const std::string& sec, con
     /* constructor {{{1 */
     : MemObj(sec, n)
     , delay(Config::get_integer(sec, "delay", 1, 1024))
-    , PreChargeLatency(Config::get_integer(sec, "PreChargeLatency", 1, 1024))
-    , RowAccessLatency(Config::get_integer(sec, "RowAccessLatency", 1, 1024))
-    , ColumnAccessLatency(Config::get_integer(sec, "ColumnAccessLatency", 4, 1024))
-    , nPrecharge(fmt::format("{}:nPrecharge", n))
-    , nColumnAccess(fmt::format("{}:nColumnAccess", n))
-    , nRowAccess(fmt::format("{}:nRowAccess", n))
-    , avgMemLat(fmt::format("{}_avgMemLat", n))
+    , dram(sec, n)
     , readHit(fmt::format("{}:readHit", n))
-    , memRequestBufferSize(Config::get_integer(sec, "memRequestBufferSize", 1, 1024)) {
-  MemObj* lower_level = NULL;
-
-  NumUnits_t num = Config::get_integer(section, "port_num");
-
-  cmdPort = PortGeneric::create(name + "_cmd", num);
-
-  numBanks                = Config::get_power2(section, "NumBanks");
-  unsigned int numRows    = Config::get_power2(section, "NumRows");
-  unsigned int ColumnSize = Config::get_power2(section, "ColumnSize");
-  unsigned int numColumns = Config::get_power2(section, "NumColumns");
-
-  columnOffset = log2(ColumnSize);
-  columnMask   = numColumns - 1;
-  columnMask   = columnMask << columnOffset;  // FIXME: Use Addr_t
-
-  rowOffset = columnOffset + log2(numColumns);
-  rowMask   = numRows - 1;
-  rowMask   = rowMask << rowOffset;  // FIXME: use Addr_t
-
-  bankOffset = rowOffset + log2(numRows);
-  bankMask   = numBanks - 1;
-  bankMask   = bankMask << bankOffset;
+    , writeHit(fmt::format("{}:writeHit", n))
+    , nOverflow(fmt::format("{}:nOverflow", n))
+    , avgMemLat(fmt::format("{}_avgMemLat", n))
+    , wake_at(Dram::no_time) {
+  slot_req.resize(dram.n_slots());
 
-  bankState.resize(numBanks);
-  for (uint32_t curBank = 0; curBank < numBanks; curBank++) {
-    bankState[curBank].activeRow = 0;
-    bankState[curBank].state     = INIT;  // Changed from ACTIVE (LNB)
-    bankState[curBank].bankTime  = 0;     // added (LNB)
-  }
   I(current);
-  lower_level = current->declareMemoryObj(section, "lower_level");
+  MemObj* lower_level = current->declareMemoryObj(section, "lower_level");
   if (lower_level) {
     addLowerLevel(lower_level);
   }
@@ -64,13 +31,19 @@ void MemController::doReq(MemRequest* mreq)
 /* request reaches the memory controller {{{1 */
 {
   readHit.inc(mreq->has_stats());
-  addMemRequest(mreq);
+  addMemRequest(mreq, globalClock);
 }
 /* }}} */
 
 void MemController::doReqAck([[maybe_unused]] MemRequest* mreq) { I(0); }
 
-void MemController::doDisp(MemRequest* mreq) { addMemRequest(mreq); }
+void MemController::doDisp(MemRequest* mreq)
+/* write back reaches the memory controller {{{1 */
+{
+  writeHit.inc(mreq->has_stats());
+  addMemRequest(mreq, globalClock);
+}
+/* }}} */
 
 void MemController::doSetState([[maybe_unused]] MemRequest* mreq) { I(0); }
 
@@ -95,182 +68,129 @@ void MemController::tryPrefetch(Addr_t addr, bool doStats, int degree, Addr_t pr
 
 TimeDelta_t MemController::ffread(Addr_t addr) {
   (void)addr;
-  return delay + RowAccessLatency;
+  return delay + dram.get_idle_latency();
 }
 
 TimeDelta_t MemController::ffwrite(Addr_t addr) {
   (void)addr;
-  return delay + RowAccessLatency;
+  return delay + dram.get_idle_latency();
 }
 
-void MemController::addMemRequest(MemRequest* mreq) {
-  I(0);  // really, a new?? FIXME:
-  FCFSField* newEntry = new FCFSField;
+void MemController::addMemRequest(MemRequest* mreq, Time_t start)
+/* queue in the dram, or in the overflow if its queue is full {{{1 */
+{
+  bool write = mreq->isDisp();
 
-  newEntry->Bank        = getBank(mreq);
-  newEntry->Row         = getRow(mreq);
-  newEntry->Column      = getColumn(mreq);
-  newEntry->mreq        = mreq;
-  newEntry->TimeEntered = globalClock;
+  if (!overflow.empty() || !dram.can_accept(mreq->getAddr(), write)) {
+    nOverflow.inc(mreq->has_stats());
+    overflow.push_back({mreq, start});
+    update_occupancy();
+    return;
+  }
 
-  OverflowMemoryRequests.push(newEntry);
+  auto slot      = dram.enqueue(mreq->getAddr(), write, globalClock, mreq->has_stats());
+  slot_req[slot] = {mreq, start};
 
-  manageRam();
+  run();
 }
+/* }}} */
 
-// This function implements the FR-FCFS memory scheduling algorithm
-void MemController::manageRam(void) {
-  // First, we need to determine if any actions (precharging, activating, or accessing) have been completed
-  for (uint32_t curBank = 0; curBank < numBanks; curBank++) {
-    if ((bankState[curBank].state == PRECHARGE) && (globalClock - bankState[curBank].bankTime >= PreChargeLatency)) {
-      bankState[curBank].state = IDLE;
-
-    } else if ((bankState[curBank].state == ACTIVATING) && (globalClock - bankState[curBank].bankTime >= RowAccessLatency)) {
-      bankState[curBank].state = ACTIVE;
+void MemController::finishMemRequest(const Pending& p, Time_t when)
+/* data burst done, ack the request {{{1 */
+{
+  MemRequest* mreq = p.mreq;
+  I(mreq);
 
-    } else if ((bankState[curBank].state == ACCESSING) && (globalClock - bankState[curBank].bankTime >= ColumnAccessLatency)) {
-      bankState[curBank].state = ACTIVE;
+  when += delay;
+  avgMemLat.sample(when - p.start, mreq->has_stats());
 
-      for (FCFSList::iterator it = curMemRequests.begin(); it != curMemRequests.end(); it++) {
-        FCFSField* tempMem = *it;
+  if (mreq->isDisp() || mreq->isHomeNode()) {
+    mreq->ackAbs(when);
+    return;
+  }
 
-        // If current memory request has completed, finish processing the request by sending the proper ACK
-        if ((curBank == tempMem->Bank) && (bankState[curBank].activeRow == tempMem->Row)) {
-          I(tempMem->mreq);
+  I(mreq->isReq());
+  if (mreq->getAction() == ma_setValid || mreq->getAction() == ma_setExclusive) {
+    mreq->convert2ReqAck(ma_setExclusive);
+  } else {
+    mreq->convert2ReqAck(ma_setDirty);
+  }
+  router->scheduleReqAckAbs(mreq, when);
+}
+/* }}} */
 
-          if (tempMem->mreq->isDisp()) {
-            tempMem->mreq->ack();  // Fixed doDisp Acknowledge -- LNB 5/28/2014
-          } else {
-            MemRequest* mreq = tempMem->mreq;
-            I(mreq->isReq());
+void MemController::manageRam(void)
+/* scheduled wake up {{{1 */
+{
+  if (globalClock != wake_at) {
+    return;  // superseded by an earlier wake up
+  }
+  wake_at = Dram::no_time;
 
-            if (mreq->getAction() == ma_setValid || mreq->getAction() == ma_setExclusive) {
-              mreq->convert2ReqAck(ma_setExclusive);
-            } else {
-              mreq->convert2ReqAck(ma_setDirty);
-            }
+  run();
+}
+/* }}} */
 
-            Time_t delta = globalClock - tempMem->TimeEntered;
+void MemController::run(void)
+/* issue the ready DRAM commands, and wake up when the next one can go {{{1 */
+{
+  done.clear();
+  Time_t next = dram.tick(globalClock, done);
 
-            router->scheduleReqAck(mreq, 1);  //  Fixed doReq acknowledge -- LNB 5/28/2014
-            avgMemLat.sample(delta, mreq->has_stats());
-          }
+  for (const auto& d : done) {
+    // copy, the slot may be reused by the overflow transfer
+    Pending p = slot_req[d.slot];
 #ifndef NDEBUG
-          tempMem->mreq = 0;
+    slot_req[d.slot].mreq = nullptr;
 #endif
+    finishMemRequest(p, d.when);
+  }
 
-          curMemRequests.erase(it);
+  if (!done.empty() && !overflow.empty()) {
+    transferOverflowMemory();
+    next = globalClock + 1;
+  }
 
-          break;
-        }
-      }
-    }
+  if (next != Dram::no_time) {
+    wake(next);
   }
 
-  // Call function to replace any deleted address with a new one from queue
-  transferOverflowMemory();
-  // Call function to determine what the next action should begin
-  scheduleNextAction();
+  update_occupancy();
 }
+/* }}} */
 
-// This function adds any pending references in the queue to the buffer if there is space available
-void MemController::transferOverflowMemory(void) {
-  while ((curMemRequests.size() <= memRequestBufferSize) && (!OverflowMemoryRequests.empty())) {
-    curMemRequests.push_back(OverflowMemoryRequests.front());
-    OverflowMemoryRequests.pop();
-  }
+void MemController::update_occupancy()
+/* queued requests (the overflow counts as full queues) {{{1 */
+{
+  auto n = dram.n_pending() + overflow.size();
+  occupancy.store(std::min<size_t>(100, n * 100 / dram.n_slots()), std::memory_order_relaxed);
 }
+/* }}} */
 
-// This function determines what action can be performed next and schedules a callback for when that action completes
-void MemController::scheduleNextAction(void) {
-  uint32_t oldestReadyColsBank = numBanks + 1;
-  uint32_t oldestReadyRowsBank = numBanks + 1;
-  uint32_t oldestReadyRow      = 0;
-  uint32_t oldestbank          = 0;
-
-  bool oldestColumnFound = false;
-  bool oldestRowFound    = false;
-  bool oldestBankFound   = false;
-
-  // Go through memory references in buffer to determine what actions are ready to begin
-  for (uint32_t curReference = 0; curReference < curMemRequests.size(); curReference++) {
-    auto curBank = curMemRequests[curReference]->Bank;
-    auto curRow  = curMemRequests[curReference]->Row;
-    if (!oldestColumnFound) {
-      if ((bankState[curBank].state == ACTIVE) && (bankState[curBank].activeRow == curRow)) {
-        bankState[curBank].cpend = true;
-        oldestColumnFound        = true;
-        //   if(bankState[oldestReadyColsBank].bankTime > bankState[curBank].bankTime){
-        oldestReadyColsBank = curBank;
-        //   }
-      }
-    }
-    if ((bankState[curBank].state == ACTIVE) && (bankState[curBank].activeRow != curRow)) {
-      bankState[curBank].bpend = true;
-    }
-    if (!oldestRowFound) {
-      if (bankState[curBank].state == IDLE) {
-        oldestRowFound = true;
-        //    if(bankState[oldestReadyRowsBank].bankTime > bankState[curBank].bankTime){
-        oldestReadyRow      = curMemRequests[curReference]->Row;
-        oldestReadyRowsBank = curBank;
-        //    }
-      }
-    }
-    if (bankState[curBank].state == INIT) {
-      oldestBankFound = true;
-      oldestbank      = curBank;
-    }
+void MemController::wake(Time_t when)
+/* keep a single pending manageRam, the earliest one {{{1 */
+{
+  when = std::max(when, globalClock + 1);
+  if (when >= wake_at) {
+    return;
   }
+  wake_at = when;
+  ManageRamCB::scheduleAbs(when, this);
+}
+/* }}} */
 
-  //... and determine if a bank has no pending column references
-  for (uint32_t curBank = 0; curBank < numBanks; curBank++) {
-    if ((bankState[curBank].bpend) && (!bankState[curBank].cpend)) {
-      oldestBankFound = true;
-      if (bankState[oldestbank].bankTime > bankState[curBank].bankTime) {
-        oldestbank = curBank;
-      }
+void MemController::transferOverflowMemory(void)
+/* move the oldest waiting requests to the dram, in order {{{1 */
+{
+  while (!overflow.empty()) {
+    auto& p     = overflow.front();
+    bool  write = p.mreq->isDisp();
+    if (!dram.can_accept(p.mreq->getAddr(), write)) {
+      break;
     }
-    bankState[curBank].bpend = false;
-    bankState[curBank].cpend = false;
-  }
-
-  // Now determine which of the ready actions should be start and when the callback should occur
-  if (oldestBankFound) {
-    bankState[oldestbank].state    = PRECHARGE;
-    bankState[oldestbank].bankTime = globalClock;
-
-    nPrecharge.inc();
-
-    ManageRamCB::schedule(PreChargeLatency, this);
-  } else if (oldestColumnFound) {
-    bankState[oldestReadyColsBank].state    = ACCESSING;
-    bankState[oldestReadyColsBank].bankTime = globalClock;
-
-    nColumnAccess.inc();
-
-    ManageRamCB::schedule(ColumnAccessLatency, this);
-  } else if (oldestRowFound) {
-    bankState[oldestReadyRowsBank].state     = ACTIVATING;
-    bankState[oldestReadyRowsBank].bankTime  = globalClock;
-    bankState[oldestReadyRowsBank].activeRow = oldestReadyRow;
-
-    nRowAccess.inc();
-
-    ManageRamCB::schedule(RowAccessLatency, this);
+    auto slot      = dram.enqueue(p.mreq->getAddr(), write, globalClock, p.mreq->has_stats());
+    slot_req[slot] = p;
+    overflow.pop_front();
   }
 }
-
-uint32_t MemController::getBank(MemRequest* mreq) const {
-  uint32_t bank = (mreq->getAddr() & bankMask) >> bankOffset;
-  return bank;
-}
-uint32_t MemController::getRow(MemRequest* mreq) const {
-  uint32_t row = (mreq->getAddr() & rowMask) >> rowOffset;
-  return row;
-}
-
-uint32_t MemController::getColumn(MemRequest* mreq) const {
-  uint32_t column = (mreq->getAddr() & columnMask) >> columnOffset;
-  return column;
-}
+/* }}} */
@@ -2,73 +2,44 @@
 
 #pragma once
 
-#include <queue>
+#include <atomic>
+#include <deque>
 #include <vector>
 
-#include "cachecore.hpp"
 #include "callback.hpp"
 #include "config.hpp"
+#include "dram.hpp"
 #include "memory_system.hpp"
 #include "memrequest.hpp"
-#include "port.hpp"
 #include "snippets.hpp"
 #include "stats.hpp"
 
+// Main memory: queues the requests in a cycle accurate Dram model and
+// acks them when their data burst is done. Only one manageRam callback is
+// in flight, scheduled for the next cycle the Dram can issue a command.
 class MemController : public MemObj {
 protected:
-  class FCFSField {
-  public:
-    uint32_t    Bank;
-    uint32_t    Row;
-    uint32_t    Column;
-    Time_t      TimeEntered;
-    MemRequest* mreq;
-  };
-  TimeDelta_t delay;
-  TimeDelta_t PreChargeLatency;
-  TimeDelta_t RowAccessLatency;
-  TimeDelta_t ColumnAccessLatency;
-
-  Stats_cntr nPrecharge;
-  Stats_cntr nColumnAccess;
-  Stats_cntr nRowAccess;
-  Stats_avg  avgMemLat;
+  TimeDelta_t delay;  // controller and PHY, added to every access
+
+  Dram dram;
+
   Stats_cntr readHit;
+  Stats_cntr writeHit;
+  Stats_cntr nOverflow;
+  Stats_avg  avgMemLat;
 
-  enum STATE {
-    IDLE = 0,
-    ACTIVATING,
-    PRECHARGE,
-    ACTIVE,
-    ACCESSING,
-    INIT  // Added LNB 5/31/2014
-  };
-  std::shared_ptr<PortGeneric> cmdPort;
-
-  uint32_t rowMask;
-  uint32_t columnMask;
-  uint32_t bankMask;
-  uint32_t rowOffset;
-  uint32_t columnOffset;
-  uint32_t bankOffset;
-  uint32_t numBanks;
-  uint32_t memRequestBufferSize;
-
-  class BankStatus {
+  // requests that do not fit in the Dram queues yet
+  class Pending {
   public:
-    int      state;
-    uint32_t activeRow;
-    bool     bpend;
-    bool     cpend;
-    Time_t   bankTime;
+    MemRequest* mreq;
+    Time_t      start;
   };
+  std::deque<Pending>     overflow;  // in order, the head blocks the rest
+  std::vector<Pending>    slot_req;
+  std::vector<Dram::Done> done;
+  Time_t                  wake_at;
 
-  std::vector<BankStatus> bankState;
-
-  using FCFSList = std::vector<FCFSField*>;
-  FCFSList curMemRequests;
-  using FCFSQueue = std::queue<FCFSField*>;
-  FCFSQueue OverflowMemoryRequests;
+  std::atomic<uint32_t> occupancy{0};  // percent of the Dram slots, read by the cache prefetchers
 
 public:
   MemController(Memory_system* current, const std::string& device_descr_section, const std::string& device_name = "");
@@ -95,22 +66,18 @@ public:
 
   [[nodiscard]] bool isBusy(Addr_t addr) const;
 
-  [[nodiscard]] uint16_t getLineSize() const;
+  [[nodiscard]] uint32_t get_occupancy() const override { return occupancy.load(std::memory_order_relaxed); }
 
   void manageRam(void);
 
   using ManageRamCB = CallbackMember0<MemController, &MemController::manageRam>;
-  // typedef CallbackMember0<MemController, &MemController::manageRam>   ManageRamCB;  // Added by LNB 5/27/2014
 
-  // TimeDelta_t ffread(Addr_t addr, DataType data);
-  // TimeDelta_t ffwrite(Addr_t addr, DataType data);
-  // void        ffinvalidate(Addr_t addr, int32_t lineSize);
 private:
-  uint32_t getBank(MemRequest* mreq) const;
-  uint32_t getRow(MemRequest* mreq) const;
-  uint32_t getColumn(MemRequest* mreq) const;
-  void     addMemRequest(MemRequest* mreq);
+  void addMemRequest(MemRequest* mreq, Time_t start);
+  void finishMemRequest(const Pending& p, Time_t when);
 
+  void run(void);
+  void wake(Time_t when);
   void transferOverflowMemory(void);
-  void scheduleNextAction(void);
+  void update_occupancy();
 };
@@ -8,6 +8,7 @@
 #include "bus.hpp"
 #include "ccache.hpp"
 #include "config.hpp"
+#include "directory.hpp"
 #include "drawarch.hpp"
 #include "mem_controller.hpp"
 #include "memxbar.hpp"
@@ -42,6 +43,9 @@ MemObj* Memory_system::buildMemoryObj(const std::string& device_type, const std:
   } else if (device_type == "memcontroller") {
     mdev    = new MemController(this, dev_section, dev_name);
     devtype = 5;
+  } else if (device_type == "directory") {
+    mdev    = new Directory(this, dev_section, dev_name);
+    devtype = 6;
   } else {
     Config::add_error(fmt::format("unknown memory type:{} from section:{}", device_type, dev_section));
     return nullptr;
@@ -67,6 +71,9 @@ MemObj* Memory_system::buildMemoryObj(const std::string& device_type, const std:
     case 5:  // void
       mystr += "\"[shape=record,sides=5,peripheries=1,color=skyblue,style=filled]";
       break;
+    case 6:  // directory
+      mystr += "\"[shape=record,sides=5,peripheries=1,color=khaki,style=filled]";
+      break;
     default: mystr += "\"[shape=record,sides=5,peripheries=3,color=white,style=filled]"; break;
   }
   arch.addObj(mystr);
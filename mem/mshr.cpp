@@ -3,6 +3,7 @@
 #include "mshr.hpp"
 
 #include "config.hpp"
+#include "debug_log.hpp"
 #include "fmt/format.h"
 #include "memory_system.hpp"
 #include "memrequest.hpp"
@@ -75,6 +76,7 @@ void MSHR::addEntry(Addr_t addr, CallbackBase* c, MemRequest* mreq) {
   avgSubUse.sample(entry[pos].nUse, mreq->has_stats());
 
   nStallConflict.inc();
+  DLOG(mshr, "{} conflict addr={:x} nUse={} free={}", name, addr, entry[pos].nUse, nFreeEntries);
 
 #ifdef DEBUG_TRANSIENTS
   I(!entry[pos].pending_mreq.empty());
@@ -95,6 +97,7 @@ void MSHR::blockEntry(Addr_t addr, MemRequest* mreq) {
   I(entry[pos].nUse == 0);
   entry[pos].nUse++;
   avgSubUse.sample(entry[pos].nUse, mreq->has_stats());
+  DLOG(mshr, "{} alloc addr={:x} free={}", name, addr, nFreeEntries);
 
 #ifdef DEBUG_TRANSIENTS
   I(entry[pos].pending_mreq.empty());
@@ -135,6 +138,7 @@ bool MSHR::retire(Addr_t addr, MemRequest* mreq) {
   I(nFreeEntries >= 0);
 
   GI(entry[pos].nUse == 0, entry[pos].cc.empty());
+  DLOG(mshr, "{} retire addr={:x} nUse={} free={}", name, addr, entry[pos].nUse, nFreeEntries);
 
   if (!entry[pos].cc.empty()) {
     entry[pos].cc.callNext();
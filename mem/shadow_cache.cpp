@@ -0,0 +1,144 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "shadow_cache.hpp"
+
+#include <algorithm>
+
+#include "config.hpp"
+#include "fmt/format.h"
+#include "snippets.hpp"
+
+void Shadow_cache::Config_stats::inc(bool hit, bool write, bool en) const {
+  if (write) {
+    (hit ? writeHit : writeMiss)->inc(en);
+  } else {
+    (hit ? readHit : readMiss)->inc(en);
+  }
+}
+
+Shadow_cache::Shadow_cache(const std::string& section, const std::string& name) {
+  auto n = Config::get_array_size(section, "shadow");
+  configs.reserve(n);
+
+  for (auto i = 0u; i < n; ++i) {
+    auto sec = Config::get_string(section, "shadow", i);
+
+    int32_t size  = Config::get_power2(sec, "size");
+    int32_t assoc = Config::get_integer(sec, "assoc", 1, 1024);
+    int32_t bsize = Config::get_power2(sec, "line_size", 1, 1024);
+
+    // No UAR, it needs the tracker stats of a full cache
+    std::vector<std::string> allowed = {std::string(k_RANDOM),
+                                        std::string(k_LRU),
+                                        std::string(k_SHIP),
+                                        std::string(k_LRUp),
+                                        std::string(k_HAWKEYE),
+                                        std::string(k_PAR)};
+    auto                     policy  = Config::get_string(sec, "repl_policy", allowed);
+
+    bool xr = Config::has_entry(sec, "xor") && Config::get_bool(sec, "xor");
+    bool sk = Config::has_entry(sec, "skew") && Config::get_bool(sec, "skew");
+
+    uint32_t shct_size = 0;
+    if (policy == k_SHIP) {
+      shct_size = Config::get_integer(sec, "ship_sign_bits");
+    }
+
+    if (size / bsize < assoc) {
+      Config::add_error(fmt::format("shadow {} for {} has size {} smaller than assoc {} lines", sec, section, size, assoc));
+    }
+    if (Config::has_errors()) {
+      continue;
+    }
+
+    Config_stats cs;
+    cs.section   = sec;
+    cs.assoc     = assoc;
+    cs.readHit   = std::make_unique<Stats_cntr>(fmt::format("{}:{}_readHit", name, sec));
+    cs.readMiss  = std::make_unique<Stats_cntr>(fmt::format("{}:{}_readMiss", name, sec));
+    cs.writeHit  = std::make_unique<Stats_cntr>(fmt::format("{}:{}_writeHit", name, sec));
+    cs.writeMiss = std::make_unique<Stats_cntr>(fmt::format("{}:{}_writeMiss", name, sec));
+    configs.emplace_back(std::move(cs));
+
+    // Same set mapping as CacheAssoc/CacheDM without xor
+    if (policy == k_LRU && !xr && !sk) {
+      uint32_t sets = roundUpPower2(size / bsize) / roundUpPower2(assoc);
+      add_stack(configs.size() - 1, log2i(bsize), sets);
+    } else {
+      auto* cache = CacheType::create(size, assoc, bsize, 1, policy, sk, xr, shct_size);
+      if (cache) {
+        generics.push_back({cache, configs.size() - 1});
+      }
+    }
+  }
+}
+
+Shadow_cache::~Shadow_cache() {
+  for (auto& g : generics) {
+    g.cache->destroy();
+  }
+}
+
+void Shadow_cache::add_stack(size_t config, uint32_t log2_line, uint32_t sets) {
+  auto assoc = configs[config].assoc;
+
+  for (auto& g : groups) {
+    if (g.log2_line == log2_line && g.mask_sets == sets - 1) {
+      g.members.push_back(config);
+      g.depth = std::max(g.depth, assoc);
+      g.stack.resize(static_cast<size_t>(sets) * g.depth);
+      return;
+    }
+  }
+
+  Stack_group g;
+  g.log2_line = log2_line;
+  g.mask_sets = sets - 1;
+  g.depth     = assoc;
+  g.stack.resize(static_cast<size_t>(sets) * assoc);
+  g.n_valid.resize(sets, 0);
+  g.members.push_back(config);
+  groups.emplace_back(std::move(g));
+}
+
+void Shadow_cache::access_stack(Stack_group& g, Addr_t addr, bool write, bool en) {
+  Addr_t tag = addr >> g.log2_line;
+  auto   set = static_cast<uint32_t>(tag & g.mask_sets);
+
+  Addr_t* s = &g.stack[static_cast<size_t>(set) * g.depth];
+  auto&   n = g.n_valid[set];
+
+  uint32_t dist = 0;
+  while (dist < n && s[dist] != tag) {
+    ++dist;
+  }
+
+  bool found = dist < n;
+  for (auto c : g.members) {
+    configs[c].inc(found && dist < configs[c].assoc, write, en);
+  }
+
+  // Move to MRU, a miss drops the LRU entry when the stack is full
+  if (!found) {
+    if (n < g.depth) {
+      ++n;
+    }
+    dist = n - 1;
+  }
+  std::copy_backward(s, s + dist, s + dist + 1);
+  s[0] = tag;
+}
+
+void Shadow_cache::access(Addr_t addr, bool write, bool en) {
+  for (auto& g : groups) {
+    access_stack(g, addr, write, en);
+  }
+
+  for (auto& g : generics) {
+    bool hit = g.cache->readLine(addr, addr, 0) != nullptr;
+    if (!hit) {
+      g.cache->fillLine(addr, addr, 0);
+    }
+    configs[g.config].inc(hit, write, en);
+  }
+}
@@ -0,0 +1,80 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cachecore.hpp"
+#include "opcode.hpp"
+#include "stats.hpp"
+
+// Tag only arrays that see the same demand stream as a CCache, for design
+// sweeps. Each entry of the cache `shadow` list is a section with the usual
+// size/assoc/line_size/repl_policy keys, and gets its own hit/miss counters.
+// Shadows do not change the timing, they are never filled by prefetches or
+// invalidated by coherence.
+//
+// LRU configs that share the line size and the number of sets are simulated
+// together with one Mattson stack per set: a hit at stack depth d is a hit for
+// every config with assoc > d. Other policies (and xor/skew indexing) use a
+// CacheGeneric instance each.
+class Shadow_cache {
+private:
+  class Shadow_state : public StateGeneric<Addr_t> {
+  public:
+    explicit Shadow_state(int32_t lineSize) { (void)lineSize; }
+  };
+  using CacheType = CacheGeneric<Shadow_state, Addr_t>;
+
+  struct Config_stats {
+    std::string section;
+    uint32_t    assoc;
+
+    std::unique_ptr<Stats_cntr> readHit;
+    std::unique_ptr<Stats_cntr> readMiss;
+    std::unique_ptr<Stats_cntr> writeHit;
+    std::unique_ptr<Stats_cntr> writeMiss;
+
+    void inc(bool hit, bool write, bool en) const;
+  };
+  std::vector<Config_stats> configs;
+
+  struct Stack_group {
+    uint32_t log2_line;
+    uint32_t mask_sets;
+    uint32_t depth;  // max assoc in the group
+
+    std::vector<Addr_t>   stack;    // sets * depth, MRU first
+    std::vector<uint32_t> n_valid;  // per set
+    std::vector<size_t>   members;  // configs index
+  };
+  std::vector<Stack_group> groups;
+
+  struct Generic_shadow {
+    CacheType* cache;
+    size_t     config;
+  };
+  std::vector<Generic_shadow> generics;
+
+  void add_stack(size_t config, uint32_t log2_line, uint32_t sets);
+  void access_stack(Stack_group& g, Addr_t addr, bool write, bool en);
+
+public:
+  // Configs from the `shadow` array of section, stats named "<name>:<shadow section>_readHit"...
+  Shadow_cache(const std::string& section, const std::string& name);
+  ~Shadow_cache();
+
+  Shadow_cache(const Shadow_cache&)            = delete;
+  Shadow_cache& operator=(const Shadow_cache&) = delete;
+
+  void access(Addr_t addr, bool write, bool en);
+
+  [[nodiscard]] size_t get_n_configs() const { return configs.size(); }
+  [[nodiscard]] size_t get_n_stack_groups() const { return groups.size(); }
+  [[nodiscard]] double get_hits(size_t i) const { return configs[i].readHit->getDouble() + configs[i].writeHit->getDouble(); }
+  [[nodiscard]] double get_misses(size_t i) const {
+    return configs[i].readMiss->getDouble() + configs[i].writeMiss->getDouble();
+  }
+};
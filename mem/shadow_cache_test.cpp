@@ -0,0 +1,85 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "shadow_cache.hpp"
+
+#include <fstream>
+#include <random>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+
+class Shadow_cache_test : public ::testing::Test {
+protected:
+  class Ref_state : public StateGeneric<Addr_t> {
+  public:
+    explicit Ref_state(int32_t lineSize) { (void)lineSize; }
+  };
+  using Ref_cache = CacheGeneric<Ref_state, Addr_t>;
+
+  void SetUp() override {
+    std::ofstream file("shadow_cache_test.toml");
+    file << "[dl1]\n";
+    file << "shadow = [\"s4k_2w\", \"s4k_4w\", \"s8k_4w\", \"s4k_fa\", \"s4k_rnd\"]\n";
+    file << "\n[s4k_2w]\nsize = 4096\nassoc = 2\nline_size = 64\nrepl_policy = \"lru\"\n";
+    file << "\n[s4k_4w]\nsize = 4096\nassoc = 4\nline_size = 64\nrepl_policy = \"lru\"\n";
+    file << "\n[s8k_4w]\nsize = 8192\nassoc = 4\nline_size = 64\nrepl_policy = \"lru\"\n";
+    file << "\n[s4k_fa]\nsize = 4096\nassoc = 64\nline_size = 64\nrepl_policy = \"lru\"\n";
+    file << "\n[s4k_rnd]\nsize = 4096\nassoc = 4\nline_size = 64\nrepl_policy = \"random\"\n";
+    file.close();
+
+    Config::init("shadow_cache_test.toml");
+  }
+};
+
+TEST_F(Shadow_cache_test, stack_matches_lru_caches) {
+  Shadow_cache shadow("dl1", "DL1");
+  ASSERT_EQ(shadow.get_n_configs(), 5U);
+  EXPECT_EQ(shadow.get_n_stack_groups(), 3U);  // 32 sets (4k 2w, 8k 4w), 16 sets (4k 4w), 1 set (fa)
+
+  std::vector<Ref_cache*> ref = {
+      Ref_cache::create(4096, 2, 64, 1, "lru", false, false),
+      Ref_cache::create(4096, 4, 64, 1, "lru", false, false),
+      Ref_cache::create(8192, 4, 64, 1, "lru", false, false),
+      Ref_cache::create(4096, 64, 64, 1, "lru", false, false),
+  };
+  std::vector<uint64_t> ref_hits(ref.size(), 0);
+
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < 20000; ++i) {
+    // Mix of a hot 6KB region and a cold 1MB one, tag 0 is an invalid line
+    Addr_t addr = 0x10000 + ((rng() & 3) ? (rng() % 6144) : (rng() % (1 << 20)));
+    shadow.access(addr, rng() & 1, true);
+
+    for (auto j = 0u; j < ref.size(); ++j) {
+      if (ref[j]->readLine(addr, addr, 0)) {
+        ref_hits[j]++;
+      } else {
+        ref[j]->fillLine(addr, addr, 0);
+      }
+    }
+  }
+
+  for (auto j = 0u; j < ref.size(); ++j) {
+    EXPECT_EQ(shadow.get_hits(j), static_cast<double>(ref_hits[j])) << "config " << j;
+    EXPECT_EQ(shadow.get_hits(j) + shadow.get_misses(j), 20000.0);
+    ref[j]->destroy();
+  }
+
+  // Inclusion property: more ways with the same sets never hurts LRU
+  EXPECT_GT(shadow.get_hits(2), shadow.get_hits(0));
+
+  // Non stack policies still count every access
+  EXPECT_EQ(shadow.get_hits(4) + shadow.get_misses(4), 20000.0);
+  EXPECT_GT(shadow.get_hits(4), 0.0);
+}
+
+TEST_F(Shadow_cache_test, disabled_stats) {
+  Shadow_cache shadow("dl1", "DL1b");
+
+  shadow.access(0x10000, false, false);  // warmup, not counted
+  shadow.access(0x10000, true, true);
+  shadow.access(0x20000, false, true);
+
+  EXPECT_EQ(shadow.get_hits(0), 1.0);
+  EXPECT_EQ(shadow.get_misses(0), 1.0);
+}
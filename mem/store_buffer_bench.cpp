@@ -0,0 +1,95 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include <fstream>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "callback.hpp"
+#include "config.hpp"
+#include "dinst.hpp"
+#include "store_buffer.hpp"
+
+static void setup_config(int scb_size) {
+  std::ofstream file("store_buffer_bench.toml");
+
+  // No dl1, so ownership is granted one cycle after the store
+  file << "[soc]\n"
+          "core = [\"c0\"]\n"
+          "[c0]\n"
+          "caches        = false\n"
+          "scb_size      = "
+       << scb_size
+       << "\n"
+          "il1           = \"il1_cache IL1\"\n"
+          "[il1_cache]\n"
+          "line_size  = 64\n";
+  file.close();
+
+  Config::init("store_buffer_bench.toml");
+}
+
+// Per cycle work of the store pipeline: two stores (can_accept_st, add_st),
+// four load forward checks, clean count, and a transient flush every 64
+// cycles. Args: scb_size, lines touched
+static void BM_store_buffer(benchmark::State& state) {
+  const int scb_size = state.range(0);
+  const int n_lines  = state.range(1);
+
+  setup_config(scb_size);
+  Store_buffer sb(0, nullptr);
+
+  std::vector<Dinst*> insts(1 << 12);
+  uint64_t            x = 0x9E3779B97F4A7C15ULL;
+  for (size_t i = 0; i < insts.size(); ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    insts[i] = Dinst::create(
+        Instruction(Opcode::iSALU_ST, RegType::LREG_R1, RegType::LREG_R2, RegType::LREG_R3, RegType::LREG_R4),
+        0x1000,
+        0x80000 + 64 * (x % n_lines) + 4 * ((x >> 20) % 16),
+        0,
+        true);
+    if ((x >> 40) % 8 == 0) {
+      insts[i]->setTransient();
+    }
+  }
+
+  int64_t n   = 0;
+  int64_t clk = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < insts.size(); i += 2) {
+      for (size_t j = i; j < i + 2; ++j) {
+        if (sb.can_accept_st(insts[j]->getAddr())) {
+          sb.add_st(insts[j]);
+        }
+      }
+      for (size_t j = 0; j < 4; ++j) {
+        benchmark::DoNotOptimize(sb.is_ld_forward(insts[(i + 97 * j) % insts.size()]->getAddr()));
+      }
+      benchmark::DoNotOptimize(sb.get_clean_num());
+      if ((++clk & 63) == 0) {
+        sb.flush_transient();
+      }
+      EventScheduler::advanceClock();
+    }
+    n += insts.size() / 2;
+  }
+
+  state.counters["cycles"] = benchmark::Counter(n, benchmark::Counter::kIsRate);
+
+  // drain the ownership callbacks before sb goes away
+  for (int i = 0; i < 4; ++i) {
+    EventScheduler::advanceClock();
+  }
+  for (auto* d : insts) {
+    d->scrap();
+  }
+}
+
+BENCHMARK(BM_store_buffer)->ArgsProduct({{16, 32, 64}, {16, 256}});
+
+int main(int argc, char* argv[]) {
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -138,4 +138,71 @@ TEST_F(Store_buffer_test, store_buf_is_load_forward) {
   // is_ld_forward true, because st_inst has been added to sb
   EXPECT_EQ(sb->is_ld_forward(this->createStInst()->getAddr()), true);
   sb->ownership_done(st_inst->getAddr());
-}
\ No newline at end of file
+}
+/* Lines go clean on ownership, dropped by remove_clean, and transient lines
+by flush_transient. A clean line that gets a new store waits for ownership again */
+TEST_F(Store_buffer_test, store_buf_clean_and_transient) {
+  this->setupStoreBuffer();
+
+  std::vector<Dinst*> insts;
+  for (int i = 0; i < 8; ++i) {
+    Addr_t addr = 0x1000 + 64 * i + 4 * i;
+    insts.push_back(
+        Dinst::create(Instruction(Opcode::iSALU_ST, RegType::LREG_R1, RegType::LREG_R2, RegType::LREG_R3, RegType::LREG_R4),
+                      0xdeaddead,
+                      addr,
+                      0,
+                      true));
+    if (i >= 6) {
+      insts.back()->setTransient();
+    }
+    ASSERT_TRUE(sb->can_accept_st(addr));
+    sb->add_st(insts.back());
+  }
+  EXPECT_EQ(sb->size(), 8);
+  EXPECT_EQ(sb->get_clean_num(), 0);
+
+  auto line = sb->get_line(insts[3]->getAddr());
+  EXPECT_TRUE(line.is_waiting_wb());
+  EXPECT_EQ(line.line_addr, this->sb_calc_line(insts[3]->getAddr()));
+  EXPECT_EQ(line.word_present, uint64_t{1} << 3);
+  EXPECT_TRUE(sb->get_line(insts[7]->getAddr()).is_transient());
+
+  for (int i = 0; i < 4; ++i) {
+    sb->ownership_done(insts[i]->getAddr());
+  }
+  EXPECT_EQ(sb->get_clean_num(), 4);
+  EXPECT_TRUE(sb->is_clean_disp(insts[0]));
+
+  // new store to a clean line
+  sb->add_st(insts[0]);
+  EXPECT_FALSE(sb->is_clean_disp(insts[0]));
+  EXPECT_EQ(sb->get_clean_num(), 3);
+
+  sb->remove_clean();
+  EXPECT_EQ(sb->size(), 5);
+  EXPECT_TRUE(sb->find(insts[0]));
+  EXPECT_FALSE(sb->find(insts[1]));
+  EXPECT_FALSE(sb->is_ld_forward(insts[2]->getAddr()));
+
+  sb->flush_transient();
+  EXPECT_EQ(sb->size(), 3);
+  EXPECT_FALSE(sb->find(insts[6]));
+  EXPECT_FALSE(sb->find(insts[7]));
+  EXPECT_TRUE(sb->is_ld_forward(insts[5]->getAddr()));
+
+  sb->remove_spec_load(insts[5]);
+  EXPECT_EQ(sb->size(), 2);
+  EXPECT_EQ(sb->get_line(insts[5]->getAddr()).state, Store_buffer_line::State::Invalid);
+
+  // freed slots are reused
+  for (int i = 1; i < 8; ++i) {
+    if (!sb->find(insts[i])) {
+      sb->add_st(insts[i]);
+    }
+  }
+  EXPECT_EQ(sb->size(), 8);
+  for (auto* d : insts) {
+    EXPECT_TRUE(sb->is_ld_forward(d->getAddr()));
+  }
+}
@@ -18,6 +18,18 @@ BimodalStride::BimodalStride(int _size, size_t _width) : size(_size), max_conf(1
   table.resize(size);
 }
 
+void BimodalStride::snapshot(Snapshot_io& ar, const std::string& name) {
+#ifdef UNLIMITED_BIMODAL
+  (void)ar;
+  (void)name;  // the hash map restarts cold
+#else
+  if (!ar.section(name, (static_cast<uint64_t>(size) << 16) | max_conf)) {
+    return;
+  }
+  ar.io(table);
+#endif
+}
+
 void BimodalLastEntry::update(int ndelta, uint16_t max_conf) {
   // No need to waste space for delta 0
   if (delta == ndelta) {
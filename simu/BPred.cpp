@@ -87,6 +87,14 @@ void BPRas::tryPrefetch(MemObj* il1, bool doStats, int degree) {
   }
 }
 
+void BPRas::snapshot(Snapshot_io& ar) {
+  if (!ar.section(full_name, RasSize)) {
+    return;
+  }
+  ar.io(stack);
+  ar.io(index);
+}
+
 Outcome BPRas::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   // printf("\n\nBPred.cpp::BPRas::predict::Entering predict::dinstID %llu at clock cycle %llu\n", dinst->getID(), globalClock);
   (void)doStats;
@@ -307,6 +315,12 @@ std::tuple<Addr_t, Addr_t> BPBTB::compute_index_tag(Dinst* dinst, bool do_tag_of
   return {boundary_key, tag_key};  // & tag_mask};
 }
 
+void BPBTB::snapshot(Snapshot_io& ar, const std::string& prefix) {
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i]->snapshot(ar, fmt::format("{}:{}{}", prefix, btb_name, i));
+  }
+}
+
 Outcome BPBTB::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   // I(dinst->isTaken());  // BTB should be called only when the branch is taken (predict taken & taken -> call BTB)
   ++btb_tag_counter;
@@ -547,6 +561,11 @@ void BP2bitL0::fetchBoundaryEnd() {
   pc = 0;
 }
 
+void BP2bitL0::snapshot(Snapshot_io& ar) {
+  btb.snapshot(ar, full_name);
+  table.snapshot(ar, fmt::format("{}:table", full_name));
+}
+
 Outcome BP2bitL0::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   // NOTE: 2 bit is simple, no predecode of instruction type (isJump() special code)
 
@@ -603,6 +622,11 @@ void BP2bit::fetchBoundaryEnd() {
   pc = 0;
 }
 
+void BP2bit::snapshot(Snapshot_io& ar) {
+  btb.snapshot(ar, full_name);
+  table.snapshot(ar, fmt::format("{}:table", full_name));
+}
+
 Outcome BP2bit::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   // NOTE: 2 bit is simple, no predecode of instruction type (isJump() special code)
 
@@ -997,6 +1021,11 @@ void BPIMLI::fetchBoundaryEnd() {
   taken_counter = -1;
 }
 
+void BPIMLI::snapshot(Snapshot_io& ar) {
+  btb.snapshot(ar, full_name);
+  imli->snapshot(ar, fmt::format("{}:imli", full_name));
+}
+
 Outcome BPIMLI::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   if (!FetchPredict) {
     boundaryPC = dinst->getPC();
@@ -1321,6 +1350,14 @@ BP2level::BP2level(int32_t i, const std::string& section, const std::string& sna
 
 BP2level::~BP2level() { delete historyTable; }
 
+void BP2level::snapshot(Snapshot_io& ar) {
+  btb.snapshot(ar, full_name);
+  globalTable.snapshot(ar, fmt::format("{}:global", full_name));
+  if (ar.section(fmt::format("{}:lhr", full_name), (static_cast<uint64_t>(l1Size) << 32) | maxCores)) {
+    ar.io_bytes(historyTable, sizeof(HistoryType) * l1Size * maxCores);
+  }
+}
+
 Outcome BP2level::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   if (!dinst->getInst()->isBranch()) {
     if (useDolc) {
@@ -1394,6 +1431,16 @@ BPHybrid::BPHybrid(int32_t i, const std::string& section, const std::string& sna
 
 BPHybrid::~BPHybrid() {}
 
+void BPHybrid::snapshot(Snapshot_io& ar) {
+  btb.snapshot(ar, full_name);
+  globalTable.snapshot(ar, fmt::format("{}:global", full_name));
+  localTable.snapshot(ar, fmt::format("{}:local", full_name));
+  metaTable.snapshot(ar, fmt::format("{}:meta", full_name));
+  if (ar.section(fmt::format("{}:ghr", full_name), historySize)) {
+    ar.io(ghr);
+  }
+}
+
 Outcome BPHybrid::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   if (!dinst->getInst()->isBranch()) {
     return btb.predict(dinst, doUpdate, doStats);
@@ -1477,6 +1524,17 @@ BP2BcgSkew::~BP2BcgSkew() {
   // Nothing?
 }
 
+void BP2BcgSkew::snapshot(Snapshot_io& ar) {
+  btb.snapshot(ar, full_name);
+  BIM.snapshot(ar, fmt::format("{}:bim", full_name));
+  G0.snapshot(ar, fmt::format("{}:g0", full_name));
+  G1.snapshot(ar, fmt::format("{}:g1", full_name));
+  metaTable.snapshot(ar, fmt::format("{}:meta", full_name));
+  if (ar.section(fmt::format("{}:ghr", full_name), 0)) {
+    ar.io(history);
+  }
+}
+
 Outcome BP2BcgSkew::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   if (!dinst->getInst()->isBranch()) {
     return btb.predict(dinst, doUpdate, doStats);
@@ -1602,6 +1660,18 @@ BPyags::BPyags(int32_t i, const std::string& section, const std::string& sname)
 
 BPyags::~BPyags() {}
 
+void BPyags::snapshot(Snapshot_io& ar) {
+  btb.snapshot(ar, full_name);
+  table.snapshot(ar, fmt::format("{}:meta", full_name));
+  ctableTaken.snapshot(ar, fmt::format("{}:ctaken", full_name));
+  ctableNotTaken.snapshot(ar, fmt::format("{}:cnottaken", full_name));
+  if (ar.section(fmt::format("{}:caches", full_name), (static_cast<uint64_t>(CacheTakenMask) << 32) | CacheNotTakenMask)) {
+    ar.io(ghr);
+    ar.io_bytes(CacheTaken, CacheTakenMask + 1);
+    ar.io_bytes(CacheNotTaken, CacheNotTakenMask + 1);
+  }
+}
+
 Outcome BPyags::predict(Dinst* dinst, bool doUpdate, bool doStats) {
   if (!dinst->getInst()->isBranch()) {
     return btb.predict(dinst, doUpdate, doStats);
@@ -2161,6 +2231,33 @@ void BPredictor::fetchBoundaryEnd() {
   }
 }
 
+void BPredictor::warmup(Dinst* dinst) {
+  // Functional warmup: train the RAS and every level, no delays, stats, or prefetches
+  I(dinst->getInst()->isControl());
+  I(!dinst->has_stats());
+
+  ras->doPredict(dinst);
+  pred1->doPredict(dinst);
+  if (pred2) {
+    pred2->doPredict(dinst);
+  }
+  if (pred3) {
+    pred3->doPredict(dinst);
+  }
+}
+
+void BPredictor::snapshot(Snapshot_io& ar) {
+  // SMT copies share pred1/2/3, their sections are written once
+  ras->snapshot(ar);
+  pred1->snapshot(ar);
+  if (pred2) {
+    pred2->snapshot(ar);
+  }
+  if (pred3) {
+    pred3->snapshot(ar);
+  }
+}
+
 Outcome BPredictor::predict1(Dinst* dinst) {
   // printf("\n\nBPred.cpp::Bpredictor::predict1::Entering predict1::dinstID %llu at clock cycle %llu\n", dinst->getID(), globalClock);
   I(dinst->getInst()->isControl());
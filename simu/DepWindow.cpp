@@ -55,7 +55,7 @@ void DepWindow::select(Dinst* dinst) {
   schedPort->schedule(dinst->has_stats(),
                       dinst->getID(),
                       dinst->isTransient(),
-                      [this, dinst](Time_t allocated_time) { do_schedule(allocated_time, dinst); });
+                      do_schedulePR::create(this, dinst));
 }
 
 void DepWindow::do_schedule(Time_t when, Dinst* dinst) {
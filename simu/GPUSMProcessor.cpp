@@ -134,7 +134,7 @@ StallCause GPUSMProcessor::add_inst(Dinst* dinst) {
 
   nInst[inst->getOpcode()]->inc(dinst->has_stats());
 
-  ROB.push(dinst);
+  push_rob(dinst);
 
   if (!dinst->isSrc2Ready()) {
     // It already has a src2 dep. It means that it is solved at
@@ -185,7 +185,7 @@ void GPUSMProcessor::retire() { /*{{{*/
     rROB.push(dinst);
     ROB.pop();
 
-    nCommitted.inc(dinst->has_stats());
+    count_commit(dinst, dinst->has_stats());
   }
 
   robUsed.sample(ROB.size(), stats);
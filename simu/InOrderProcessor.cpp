@@ -95,7 +95,7 @@ StallCause InOrderProcessor::add_inst(Dinst* dinst) {
 
   nInst[inst->getOpcode()]->inc(dinst->has_stats());  // FIXME: move to cluster
 
-  ROB.push(dinst);
+  push_rob(dinst);
 
   if (!dinst->isSrc2Ready()) {
     // It already has a src2 dep. It means that it is solved at
@@ -149,7 +149,7 @@ void InOrderProcessor::retire() { /*{{{*/
     rROB.push(dinst);
     ROB.pop();
 
-    nCommitted.inc(dinst->has_stats());
+    count_commit(dinst, dinst->has_stats());
   }
 
   robUsed.sample(ROB.size(), stats);
@@ -98,6 +98,170 @@ void LSQFull::remove(Dinst* dinst)
 }
 /* }}} */
 
+LSQAddr::LSQAddr(Hartid_t hid, int32_t size)
+    /* constructor {{{1 */
+    : LSQ(size), stldForwarding(fmt::format("P({}):stldForwarding", hid)) {
+  uint32_t n = roundUpPower2(2 * static_cast<uint32_t>(size > 8 ? size : 8));
+  table.resize(n);
+  mask = n - 1;
+}
+/* }}} */
+
+int32_t LSQAddr::find(Addr_t word) const {
+  for (uint32_t pos = home(word);; pos = (pos + 1) & mask) {
+    const auto& s = table[pos];
+    if (s.q.empty()) {
+      return -1;
+    }
+    if (s.word == word) {
+      return pos;
+    }
+  }
+}
+
+void LSQAddr::grow() {
+  // More words in flight than expected (entries are freed before remove)
+  std::vector<Slot> old;
+  old.swap(table);
+  table.resize(2 * old.size());
+  mask = table.size() - 1;
+
+  for (auto& s : old) {
+    if (s.q.empty()) {
+      continue;
+    }
+    uint32_t pos = home(s.word);
+    while (!table[pos].q.empty()) {
+      pos = (pos + 1) & mask;
+    }
+    table[pos] = std::move(s);
+  }
+}
+
+void LSQAddr::release(uint32_t pos) {
+  // Backward shift deletion, no tombstones so find() stops at the first free slot
+  I(table[pos].q.empty());
+  n_used--;
+
+  uint32_t j = pos;
+  while (true) {
+    j = (j + 1) & mask;
+    if (table[j].q.empty()) {
+      return;
+    }
+    uint32_t k = home(table[j].word);
+    bool     move;
+    if (j > pos) {
+      move = k <= pos || k > j;
+    } else {
+      move = k <= pos && k > j;
+    }
+    if (move) {
+      std::swap(table[pos], table[j]);  // the free slot keeps an allocated vector
+      pos = j;
+    }
+  }
+}
+
+bool LSQAddr::insert(Dinst* dinst)
+/* Insert dinst in LSQ (in-order) {{{1 */
+{
+  I(dinst->getAddr());
+  Addr_t word = calcWord(dinst);
+
+  auto pos = find(word);
+  if (pos < 0) {
+    if (2 * (n_used + 1) > table.size()) {
+      grow();
+    }
+    pos = home(word);
+    while (!table[pos].q.empty()) {
+      pos = (pos + 1) & mask;
+    }
+    table[pos].word = word;
+    n_used++;
+  }
+
+  auto& q  = table[pos].q;
+  auto  it = q.end();
+  while (it != q.begin() && (*(it - 1))->getID() > dinst->getID()) {  // almost always at the end
+    --it;
+  }
+  q.insert(it, dinst);
+
+  return true;
+}
+/* }}} */
+
+Dinst* LSQAddr::executing(Dinst* dinst)
+/* dinst got executed (out-of-order), same checks as LSQFull {{{1 */
+{
+  I(dinst->getAddr());
+
+  const Instruction* inst = dinst->getInst();
+  Dinst*             faulty = 0;
+
+  auto pos = find(calcWord(dinst));
+  if (pos >= 0) {
+    const auto& q = table[pos].q;
+
+    // Youngest younger load already executed with a different PC
+    size_t i = q.size();
+    while (i > 0 && q[i - 1]->getID() > dinst->getID()) {
+      --i;
+      Dinst* qdinst = q[i];
+      if (inst->isStore() && qdinst->getInst()->isLoad() && qdinst->isExecuted() && qdinst->getPC() != dinst->getPC()) {
+        faulty = qdinst;
+        break;
+      }
+    }
+    while (i > 0 && q[i - 1]->getID() > dinst->getID()) {
+      --i;
+    }
+
+    // Any older store already executed
+    if (!dinst->isLoadForwarded() && inst->isLoad()) {
+      while (i > 0) {
+        --i;
+        Dinst* qdinst = q[i];
+        if (qdinst != dinst && qdinst->getInst()->isStore() && qdinst->isExecuted()) {
+          dinst->setLoadForwarded();
+          stldForwarding.inc(dinst->has_stats());
+          break;
+        }
+      }
+    }
+  }
+
+  unresolved--;
+  I(!dinst->isExecuted());  // first clear, then mark executed
+  return faulty;
+}
+/* }}} */
+
+void LSQAddr::remove(Dinst* dinst)
+/* Remove from the LSQ {{{1 (in-order) */
+{
+  I(dinst->getAddr());
+
+  auto pos = find(calcWord(dinst));
+  if (pos < 0) {
+    return;
+  }
+
+  auto& q = table[pos].q;
+  for (auto it = q.begin(); it != q.end(); ++it) {  // usually the oldest
+    if (*it == dinst) {
+      q.erase(it);
+      if (q.empty()) {
+        release(pos);
+      }
+      return;
+    }
+  }
+}
+/* }}} */
+
 LSQNone::LSQNone(Hartid_t hid, int32_t size)
     /* constructor {{{1 */
     : LSQ(size) {
@@ -35,6 +35,8 @@
 
 #include "mrouter.hpp"
 
+#include <algorithm>
+
 #include "drawarch.hpp"
 #include "memrequest.hpp"
 extern DrawArch arch;
@@ -118,6 +120,24 @@ void MRouter::fillRouteTables()
 }
 // }}}
 
+void MRouter::propagate_uncore_domain(bool below_shared)
+/* anonymous objects below a shared one also run in the uncore domain {{{1 */
+{
+  auto* uncore = Clock_domain::get_uncore();
+  if (uncore == nullptr) {
+    return;
+  }
+
+  below_shared = below_shared || self_mobj->get_domain() == uncore;
+  for (auto* dn : down_node) {
+    if (below_shared) {
+      dn->set_domain(uncore);
+    }
+    dn->getRouter()->propagate_uncore_domain(below_shared);
+  }
+}
+/* }}} */
+
 void MRouter::updateRouteTables(MemObj* upmobj, MemObj* const top_node)
 /* regenerate the routing tables {{{1 */
 {
@@ -228,8 +248,7 @@ void MRouter::scheduleReqAckAbs(MemRequest* mreq, Time_t w)
     I(it != up_map.end());
     obj = it->second;
   }
-  obj->blockFill(mreq);
-  mreq->startReqAckAbs(obj, w);
+  mreq->startFillReqAckAbs(obj, w);
 }
 /* }}} */
 
@@ -337,11 +356,9 @@ int32_t MRouter::sendSetStateOthers(MemRequest* mreq, MsgAction ma, TimeDelta_t
 /* }}} */
 
 int32_t MRouter::sendSetStateOthersPos(uint32_t pos, MemRequest* mreq, MsgAction ma, TimeDelta_t lat)
-/* send setState to specific pos, return how many {{{1 */
+/* send setState to specific pos, even if it is the only up node, return how many {{{1 */
 {
-  if (up_node.size() <= 1) {
-    return 0;  // if single node, for sure it does not get one
-  }
+  I(pos < up_node.size());
 
   bool   doStats = mreq->has_stats();
   Addr_t addr    = mreq->getAddr();
@@ -379,10 +396,23 @@ int32_t MRouter::sendSetStateAll(MemRequest* mreq, MsgAction ma, TimeDelta_t lat
 }
 /* }}} */
 
+using tryPrefetchCB = CallbackMember6<MemObj, Addr_t, bool, int, Addr_t, Addr_t, CallbackBase*, &MemObj::tryPrefetch>;
+
+static void propagate_prefetch(MemObj* obj, Addr_t addr, bool doStats, int degree, Addr_t pref_sign, Addr_t pc,
+                               CallbackBase* cb) {
+  if (unlikely(Clock_domain::is_parallel() && obj->get_domain() != Clock_domain::get_current())) {
+    // tryPrefetch schedules events, so it must run in the thread that owns obj
+    obj->get_domain()->post(globalClock + Clock_domain::hop_latency(0),
+                            tryPrefetchCB::create(obj, addr, doStats, degree, pref_sign, pc, cb));
+    return;
+  }
+  obj->tryPrefetch(addr, doStats, degree, pref_sign, pc, cb);
+}
+
 void MRouter::tryPrefetch(Addr_t addr, bool doStats, int degree, Addr_t pref_sign, Addr_t pc, CallbackBase* cb)
 /* propagate the prefetch to the lower level {{{1 */
 {
-  down_node[0]->tryPrefetch(addr, doStats, degree, pref_sign, pc, cb);
+  propagate_prefetch(down_node[0], addr, doStats, degree, pref_sign, pc, cb);
 }
 /* }}} */
 
@@ -390,13 +420,14 @@ void MRouter::tryPrefetchPos(uint32_t pos, Addr_t addr, int degree, bool doStats
 /* propagate the prefetch to the lower level {{{1 */
 {
   I(pos < down_node.size());
-  down_node[pos]->tryPrefetch(addr, doStats, degree, pref_sign, pc, cb);
+  propagate_prefetch(down_node[pos], addr, doStats, degree, pref_sign, pc, cb);
 }
 /* }}} */
 
 TimeDelta_t MRouter::ffread(Addr_t addr)
 /* propagate the read to the lower level {{{1 */
 {
+  Clock_domain::Sync_guard guard(down_node[0]->get_domain());
   return down_node[0]->ffread(addr);
 }
 /* }}} */
@@ -404,6 +435,7 @@ TimeDelta_t MRouter::ffread(Addr_t addr)
 TimeDelta_t MRouter::ffwrite(Addr_t addr)
 /* propagate the read to the lower level {{{1 */
 {
+  Clock_domain::Sync_guard guard(down_node[0]->get_domain());
   return down_node[0]->ffwrite(addr);
 }
 /* }}} */
@@ -412,6 +444,7 @@ TimeDelta_t MRouter::ffreadPos(uint32_t pos, Addr_t addr)
 /* propagate the read to the lower level {{{1 */
 {
   I(pos < down_node.size());
+  Clock_domain::Sync_guard guard(down_node[pos]->get_domain());
   return down_node[pos]->ffread(addr);
 }
 /* }}} */
@@ -420,6 +453,7 @@ TimeDelta_t MRouter::ffwritePos(uint32_t pos, Addr_t addr)
 /* propagate the read to the lower level {{{1 */
 {
   I(pos < down_node.size());
+  Clock_domain::Sync_guard guard(down_node[pos]->get_domain());
   return down_node[pos]->ffwrite(addr);
 }
 /* }}} */
@@ -428,6 +462,18 @@ bool MRouter::isBusyPos(uint32_t pos, Addr_t addr) const
 /* propagate the isBusy {{{1 */
 {
   I(pos < down_node.size());
+  Clock_domain::Sync_guard guard(down_node[pos]->get_domain());
   return down_node[pos]->isBusy(addr);
 }
 /* }}} */
+
+uint32_t MRouter::getDownOccupancy() const
+/* highest queue occupancy of the lower levels {{{1 */
+{
+  uint32_t occ = 0;
+  for (const auto* obj : down_node) {
+    occ = std::max(occ, obj->get_occupancy());  // no Sync_guard, the controllers publish it atomically
+  }
+  return occ;
+}
+/* }}} */
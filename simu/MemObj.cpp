@@ -191,6 +191,10 @@ void MemObj::setNeedsCoherence() {
 }
 void MemObj::clearNeedsCoherence() {}
 
+void MemObj::snapshot(Snapshot_io& ar) { (void)ar; }
+
+uint32_t MemObj::get_occupancy() const { return router->getDownOccupancy(); }
+
 bool MemObj::Invalid(Addr_t addr) const {
   (void)addr;
   I(0);
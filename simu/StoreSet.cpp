@@ -81,6 +81,13 @@ void StoreSet::merge_sets(Dinst* m_dinst, Dinst* d_dinst)
 }
 /* }}} */
 #endif
+void StoreSet::snapshot(Snapshot_io& ar, const std::string& name) {
+  if (!ar.section(name, StoreSetSize)) {
+    return;
+  }
+  ar.io(SSIT);
+}
+
 void StoreSet::clear_SSIT()
 /* Clear all the SSIT entries {{{1 */
 {
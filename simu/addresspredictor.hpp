@@ -5,6 +5,7 @@
 #include "dinst.hpp"
 #include "estl.hpp"
 #include "iassert.hpp"
+#include "snapshot.hpp"
 #include "stats.hpp"
 
 // #define DEBUG_STRIDESO2 1
@@ -47,6 +48,12 @@ public:
   virtual bool       try_chain_predict(MemObj* dl1, Addr_t pc, int distance) = 0;
   virtual Conf_level exe_update(Addr_t pc, Addr_t addr, Data_t data = 0)     = 0;
   virtual Conf_level ret_update(Addr_t pc, Addr_t addr, Data_t data = 0)     = 0;
+
+  // Predictors without snapshot support restart cold after a restore
+  virtual void snapshot(Snapshot_io& ar, const std::string& name) {
+    (void)ar;
+    (void)name;
+  }
 };
 
 /**********************
@@ -118,6 +125,8 @@ public:
   int get_delta(Addr_t pc) const { return table[get_index(pc)].delta; };
 
   Addr_t get_addr(Addr_t pc) const { return table[get_index(pc)].addr; };
+
+  void snapshot(Snapshot_io& ar, const std::string& name);
 };
 
 class Stride_address_predictor : public AddressPredictor {
@@ -132,6 +141,7 @@ public:
   bool       try_chain_predict(MemObj* dl1, Addr_t pc, int distance);
   Conf_level exe_update(Addr_t pc, Addr_t addr, Data_t data);
   Conf_level ret_update(Addr_t pc, Addr_t addr, Data_t data);
+  void       snapshot(Snapshot_io& ar, const std::string& name) override { bimodal.snapshot(ar, name); }
 };
 
 /*****************************
@@ -334,4 +344,5 @@ public:
   bool       try_chain_predict(MemObj* dl1, Addr_t pc, int distance);
   Conf_level exe_update(Addr_t pc, Addr_t addr, Data_t data);
   Conf_level ret_update(Addr_t pc, Addr_t addr, Data_t data);
+  void       snapshot(Snapshot_io& ar, const std::string& name) override { bimodal.snapshot(ar, name); }
 };
@@ -133,6 +133,9 @@ public:
   virtual void fetchBoundaryBegin(Dinst* dinst);  // If the branch predictor support fetch boundary model, do it
   virtual void fetchBoundaryEnd();                // If the branch predictor support fetch boundary model, do it
 
+  // Predictors without snapshot support restart cold after a restore
+  virtual void snapshot(Snapshot_io& ar) { (void)ar; }
+
   Outcome doPredict(Dinst* dinst, bool doStats = true) {
         I(taken_counter >= 0);
 
@@ -180,6 +183,7 @@ public:
   BPRas(int32_t i, const std::string& section, const std::string& sname);
   ~BPRas();
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
+  void    snapshot(Snapshot_io& ar) override;
 
   void tryPrefetch(MemObj* il1, bool doStats, int degree);
 };
@@ -213,6 +217,11 @@ private:
 
     Addr_t targetPC;
 
+    void io(Snapshot_io& ar) {
+      StateGeneric<Addr_t>::io(ar);
+      ar.io(targetPC);
+    }
+
     // bool operator==(BTBState s) const { return targetPC == s.targetPC; }
   };
 
@@ -235,6 +244,7 @@ public:
   void    fetchBoundaryEnd();
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
   void    updateOnly(Dinst* dinst);
+  void    snapshot(Snapshot_io& ar, const std::string& prefix);
 };
 
 class BPOracle : public BPred {
@@ -349,6 +359,7 @@ public:
   void    fetchBoundaryBegin(Dinst* dinst);
   void    fetchBoundaryEnd();
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
+  void    snapshot(Snapshot_io& ar) override;
 };
 
 // Similar to BP2bit but try to learn only for taken, and bias to non-taken unless confident
@@ -368,6 +379,7 @@ public:
   void    fetchBoundaryBegin(Dinst* dinst);
   void    fetchBoundaryEnd();
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
+  void    snapshot(Snapshot_io& ar) override;
 };
 class IMLIBest;
 
@@ -389,6 +401,7 @@ public:
   void    fetchBoundaryBegin(Dinst* dinst);
   void    fetchBoundaryEnd();
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
+  void    snapshot(Snapshot_io& ar) override;
 };
 
 // FIXME: convert to just class Tahead;
@@ -501,6 +514,7 @@ public:
     BPred::fetchBoundaryEnd();
   }
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
+  void    snapshot(Snapshot_io& ar) override;
 };
 
 class BPHybrid : public BPred {
@@ -531,6 +545,7 @@ public:
     BPred::fetchBoundaryEnd();
   }
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
+  void    snapshot(Snapshot_io& ar) override;
 };
 
 class BP2BcgSkew : public BPred {
@@ -567,6 +582,7 @@ public:
     BPred::fetchBoundaryEnd();
   }
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
+  void    snapshot(Snapshot_io& ar) override;
 };
 
 class BPyags : public BPred {
@@ -604,6 +620,7 @@ public:
     BPred::fetchBoundaryEnd();
   }
   Outcome predict(Dinst* dinst, bool doUpdate, bool doStats);
+  void    snapshot(Snapshot_io& ar) override;
 };
 
 class BPOgehl : public BPred {
@@ -885,6 +902,8 @@ public:
   void        fetchBoundaryBegin(Dinst* dinst);
   void        fetchBoundaryEnd();
   TimeDelta_t predict(Dinst* dinst, bool* fastfix);
+  void        warmup(Dinst* dinst);
+  void        snapshot(Snapshot_io& ar);
   bool        Miss_Prediction(Dinst* dinst);
   void        dump(const std::string& str) const;
 };
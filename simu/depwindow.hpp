@@ -22,6 +22,7 @@ private:
   std::shared_ptr<PortGeneric> schedPort;
 
   void do_schedule(Time_t when, Dinst* dinst);
+  using do_schedulePR = PortRequestMember1<DepWindow, Dinst*, &DepWindow::do_schedule>;
 
 protected:
   void preSelect(Dinst* dinst);
@@ -25,7 +25,6 @@ extern bool MIMDmode;
 
 // #define IDEAL_FETCHBOUNDARY_ENTRY 1
 
-// #define ENABLE_FAST_WARMUP 1
 // #define FETCH_TRACE 1
 
 // SBPT: Do not track RAT, just use last predictable LD
@@ -212,6 +211,50 @@ void FetchEngine::chainPrefDone(Addr_t pc, int distance, Addr_t addr) {
 
 void FetchEngine::chainLoadDone(Dinst* dinst) { (void)dinst; }
 
+void FetchEngine::functional_warmup(std::shared_ptr<Emul_base> eint, Hartid_t fid) {
+  // No timing: instructions go straight from the emulator to the IL1/DL1
+  // (ffread/ffwrite) and the branch predictor, then get dropped.
+  Addr_t last_line  = 0;
+  bool   begin_next = true;
+
+  while (eint->is_warmup(fid)) {
+    Dinst* dinst = eint->peek(fid);
+    if (dinst == nullptr) {
+      break;
+    }
+
+    Addr_t line = dinst->getPC() >> il1_line_bits;
+    if (il1_enable && line != last_line) {
+      (void)gms->getIL1()->ffread(dinst->getPC());
+      last_line = line;
+    }
+
+    const Instruction* inst = dinst->getInst();
+    if (inst->isLoad()) {
+      (void)gms->getDL1()->ffread(dinst->getAddr());
+    } else if (inst->isStore()) {
+      (void)gms->getDL1()->ffwrite(dinst->getAddr());
+    } else if (inst->isControl()) {
+      if (begin_next) {
+        bpred->fetchBoundaryBegin(dinst);
+        begin_next = false;
+      }
+      bpred->warmup(dinst);
+      if (dinst->isTaken()) {
+        bpred->fetchBoundaryEnd();
+        begin_next = true;
+      }
+    }
+
+    eint->execute(fid);
+    dinst->scrap();
+  }
+
+  if (!begin_next) {
+    bpred->fetchBoundaryEnd();
+  }
+}
+
 void FetchEngine::realfetch(IBucket* bucket, std::shared_ptr<Emul_base> eint, Hartid_t fid, int32_t n2Fetch, GProcessor* gproc) {
   //printf("FetchEngine::::Entering realfetch !!!\n");
   Addr_t  lastpc     = 0;
@@ -224,34 +267,15 @@ void FetchEngine::realfetch(IBucket* bucket, std::shared_ptr<Emul_base> eint, Ha
 #endif
 
   do {
+    if (unlikely(eint->is_warmup(fid))) {  // run start or a new sampling interval, before peek consumes it
+      functional_warmup(eint, fid);
+    }
     Dinst* dinst = eint->peek(fid);
     if (dinst == nullptr) {  // end of trace
       TaskHandler::simu_pause(fid);
       break;
     }
 
-#ifdef ENABLE_FAST_WARMUP
-    if (dinst->getPC() == 0) {  // FIXME: W mode, counter, not this
-      do {
-        EventScheduler::advanceClock();
-      } while (gms->getDL1()->isBusy(dinst->getAddr()));
-
-      if (dinst->getInst()->isLoad()) {
-        MemRequest::sendReqReadWarmup(gms->getDL1(), dinst->getAddr());
-        dinst->scrap(eint);
-        dinst = 0;
-      } else if (dinst->getInst()->isStore()) {
-        MemRequest::sendReqWriteWarmup(gms->getDL1(), dinst->getAddr());
-        dinst->scrap(eint);
-        dinst = 0;
-      } else {
-        I(0);
-        dinst->scrap(eint);
-        dinst = 0;
-      }
-      continue;
-    }
-#endif
     dinst->setBB(max_bb_cycle - maxBB);
     if (lastpc == 0) {
       bpred->fetchBoundaryBegin(dinst);
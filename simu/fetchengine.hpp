@@ -50,6 +50,7 @@ private:
   bool il1_enable;
 
   bool processBranch(Dinst* dinst);
+  void functional_warmup(std::shared_ptr<Emul_base> eint, Hartid_t fid);
 
   // ******************* Statistics section
   Stats_avg  avgEntryFetchLost;
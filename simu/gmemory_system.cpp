@@ -6,6 +6,7 @@
 #include <string>
 
 #include "absl/strings/str_split.h"
+#include "clock_domain.hpp"
 #include "config.hpp"
 #include "drawarch.hpp"
 #include "memobj.hpp"
@@ -50,6 +51,12 @@ MemObj* MemoryObjContainer::searchMemoryObj(const std::string& device_name) cons
   return intlMemoryObjContainer.find(device_name)->second;
 }
 
+void MemoryObjContainer::snapshot(Snapshot_io& ar) {
+  for (auto& [name, obj] : intlMemoryObjContainer) {
+    obj->snapshot(ar);
+  }
+}
+
 void MemoryObjContainer::clear() { intlMemoryObjContainer.clear(); }
 
 //////////////////////////////////////////////
@@ -105,6 +112,9 @@ void Gmemory_system::build_memory_system() {
   } else if (DL1->get_type() == "prefetcher") {
     DL1->getRouter()->getDownNode()->setCoreDL1(coreId);
   }
+
+  IL1->getRouter()->propagate_uncore_domain();
+  DL1->getRouter()->propagate_uncore_domain();
 }
 
 std::string Gmemory_system::buildUniqueName(const std::string& device_type) {
@@ -133,6 +143,11 @@ MemObj* Gmemory_system::searchMemoryObj(bool shared, const std::string& name) co
   return getMemoryObjContainer(shared)->searchMemoryObj(name);
 }
 
+void Gmemory_system::snapshot(Snapshot_io& ar) {
+  localMemoryObjContainer->snapshot(ar);
+  sharedMemoryObjContainer.snapshot(ar);
+}
+
 MemObj* Gmemory_system::declareMemoryObj_uniqueName(const std::string& name, const std::string& device_descr_section) {
   return finishDeclareMemoryObj({device_descr_section, name, "shared"});
 }
@@ -223,6 +238,8 @@ MemObj* Gmemory_system::finishDeclareMemoryObj(const std::vector<std::string>& v
   MemObj* newMem = buildMemoryObj(device_type, device_descr_section, device_name);
   if (newMem) {  // Would be 0 in known-error mode
     getMemoryObjContainer(shared)->addMemoryObj(device_name, newMem);
+    // Private objects run with their core, shared ones in the uncore domain
+    newMem->set_domain(shared ? Clock_domain::get_uncore() : Clock_domain::get_current());
   }
 
   return newMem;
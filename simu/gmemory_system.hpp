@@ -13,6 +13,7 @@
 #include "opcode.hpp"
 
 class MemObj;
+class Snapshot_io;
 
 class MemoryObjContainer {
 private:
@@ -25,6 +26,8 @@ public:
   MemObj* searchMemoryObj(const std::string& section, const std::string& name) const;
   MemObj* searchMemoryObj(const std::string& name) const;
 
+  void snapshot(Snapshot_io& ar);
+
   void clear();
 };
 
@@ -78,6 +81,9 @@ public:
   MemObj* declareMemoryObj(const std::string& block, const std::string& field);
   MemObj* finishDeclareMemoryObj(const std::vector<std::string>& vPars, const std::string& name_suffix = "");
 
+  // Local objects and the shared ones (shared sections are written once)
+  void snapshot(Snapshot_io& ar);
+
   uint32_t getCoreId() const { return coreId; };
   MemObj*  getDL1() const { return DL1; };
   MemObj*  getIL1() const { return IL1; };
@@ -7,6 +7,7 @@
 #include <string>
 
 #include "addresspredictor.hpp"
+#include "debug_log.hpp"
 #include "fetchengine.hpp"
 #include "fmt/format.h"
 #include "gmemory_system.hpp"
@@ -72,11 +73,22 @@ GProcessor::GProcessor(std::shared_ptr<Gmemory_system> gm, Hartid_t i)
 
   flushing_last_transientid = 0;
   last_transientid =0;
+  transient_ckpt   = no_transient_ckpt;
   busy = false;
+  last_stall = NoStall;
 }
 
 GProcessor::~GProcessor() {}
 
+void GProcessor::snapshot(Snapshot_io& ar) {
+  for (auto& f : smt_fetch.fe) {
+    f->ref_bpred()->snapshot(ar);
+  }
+  storeset->snapshot(ar, fmt::format("P({})_storeset", hid));
+  prefetcher->snapshot(ar, fmt::format("P({})_prefetcher", hid));
+  memorySystem->snapshot(ar);
+}
+
 void GProcessor::buildInstStats(const std::string& txt) {
   for (const auto t : Opcodes) {
     nInst[t] = std::make_unique<Stats_cntr>(fmt::format("P({})_{}_{}:n", hid, txt, t));
@@ -112,30 +124,30 @@ std::shared_ptr<FetchEngine> SMT_fetch::fetch_next() {
 }
 
 void GProcessor::fetch() {
-  //printf("gprocessor::fetch:: Entering at @clockcycle %lu\n", globalClock);
+  DLOG(fetch, "gprocessor::fetch:: Entering");
   I(eint);
   I(is_power_up());
   
   auto ifid = smt_fetch.fetch_next();
  //unblock fetch starts here!!!
  if (!ifid->isBlocked() && do_random_transients) {
-   //printf("gprocessor::fetch:: After Fetch is done after Br inst+ flush old transients at @clockcycle %lu\n", globalClock);
+   DLOG(transient, "gprocessor::fetch:: After Fetch is done after Br inst+ flush old transients");
    flush_transient_inst_on_fetch_ready();
  }
 
   if (spaceInInstQueue < FetchWidth) {
-    //printf("gprocessor::fetch:: spaceInInstQueue < FetchWidth) ::RETURN FALSE at @clockcycle %lu\n", globalClock);
+    DLOG(fetch, "gprocessor::fetch:: spaceInInstQueue < FetchWidth) ::RETURN FALSE");
     return;
   }
 
   //auto ifid = smt_fetch.fetch_next();
   if (ifid->isBlocked() && !do_random_transients) {
-    //printf("gprocessor::fetch::ifid->isBlocked() && !do_random_transients ::RETURN FALSE at @clockcycle %lu\n", globalClock);
+    DLOG(transient, "gprocessor::fetch::ifid->isBlocked() && !do_random_transients ::RETURN FALSE");
     return;
   }
  //unblock fetch starts here!!!
  /*if (!ifid->isBlocked() && do_random_transients) {
-   //printf("gprocessor::fetch:: After Fetch is done after Br inst+ flush old transients at @clockcycle %lu\n", globalClock);
+   DLOG(transient, "gprocessor::fetch:: After Fetch is done after Br inst+ flush old transients");
    flush_transient_inst_on_fetch_ready();
  }*/
 
@@ -144,9 +156,7 @@ void GProcessor::fetch() {
   auto smt_hid = hid;  // FIXME: do SMT fetch
   if (bucket) {
     if (ifid->isBlocked()) {
-      //printf("gprocessor::fetch:: Fetch is blocked and add_transient() is added + bucket size is %zu at @clockcycle %llu\n",
-             // bucket->size(),
-             // globalClock);
+      DLOG(transient, "gprocessor::fetch:: Fetch is blocked and add_transient() is added + bucket size is {}", bucket->size());
       //I(do_random_transients);
       //if (ifid->is_ifid_control()){
       Addr_t pc = ifid->getMissDinst()->getAddr() + 4;  // FIXME: it should be last random pc+4
@@ -154,13 +164,12 @@ void GProcessor::fetch() {
       //ifid->reset_ifid_control();
       //}
     } else {
-      // //printf("gprocessor::fetch::!ISBlocked() Sending fetch to fetchEngine at @clockcycle %llu\n", globalClock);
+      DLOG(fetch, "gprocessor::fetch::!ISBlocked() Sending fetch to fetchEngine");
       ifid->fetch(bucket, eint, smt_hid, this);
       /*if (do_random_transients) {
-        ////printf(
-            // "gprocessor::fetch:: After Fetch is done after Br inst+ flush old transients+ bucket size is %zu at @clockcycle %lu\n",
-             //bucket->size(),
-             //globalClock);
+        DLOG(transient,
+             "gprocessor::fetch:: After Fetch is done after Br inst+ flush old transients+ bucket size is {}",
+             bucket->size());
         flush_transient_inst_on_fetch_ready();
       } */
       if (!bucket->empty()) {
@@ -169,9 +178,9 @@ void GProcessor::fetch() {
       }
     }
   } else {
-     //printf("gprocessor::fetch:: No FETCH !!! No Bucket-->pipeQ.pipeLine.newItem() at @clockcycle %lu\n", globalClock);
+    DLOG(fetch, "gprocessor::fetch:: No FETCH !!! No Bucket-->pipeQ.pipeLine.newItem()");
   }
-     //printf("gprocessor::fetch:: Leaving FETCH true at @clockcycle %lu\n", globalClock);
+  DLOG(fetch, "gprocessor::fetch:: Leaving FETCH true");
 }
 
 void GProcessor::flush_transient_inst_on_fetch_ready() {
@@ -193,7 +202,7 @@ void GProcessor::flush_transient_inst_on_fetch_ready() {
 }
 
 void GProcessor::flush_transient_from_scb() {
-  //printf("gprocessor::flush_transient_scb on before new fetch!!!\n");
+  DLOG(scb, "gprocessor::flush_transient_scb on before new fetch!!!");
   scb->flush_transient();
 }
 
@@ -221,9 +230,13 @@ void GProcessor::dump_rob()
 }
 
 void GProcessor::flush_transient_from_rob() {
-  // try the for loop scan
-  //printf("gprocessor::flush_transient_rob on before new fetch!!!\n");
-  while (!ROB.empty()) {
+  // Only the entries renamed since the checkpoint are walked, so a squash
+  // costs the transients of this miss and not the whole window. Transients
+  // left in the ROB by an older flush are destroyed by retire.
+  auto n_squash  = ROB.size_since(transient_ckpt);
+  transient_ckpt = no_transient_ckpt;
+  DLOG(transient, "gprocessor::flush_transient_rob on before new fetch!!! squashing {} of {}", n_squash, ROB.size());
+  for (; n_squash > 0; --n_squash) {
     auto* dinst = ROB.end_data();
     // makes sure isExecuted in preretire()
 
@@ -334,23 +347,19 @@ void GProcessor::flush_transient_from_rob() {
 }
 
 void GProcessor::flush_remaining_transient_inst_from_inst_queue() {
-  //printf("gprocessor::flush_transient_remaining_inst_queue Entering before new Transient_add_inst!!!\n");
+  DLOG(transient, "gprocessor::flush_transient_remaining_inst_queue Entering before new Transient_add_inst!!!");
   while (!pipeQ.instQueue.empty()) {
     auto* bucket = pipeQ.instQueue.end_data();
     if (bucket) {
       while (!bucket->empty() && bucket->is_transient()) {
         auto* dinst = bucket->end_data();
         if (dinst->isTransient()) {
-          //printf("gprocessor::flush_transient_inst_remain_queue destroying inst %lu at @clockcycle %lu\n",
-                  //dinst->getID(),
-                  //globalClock);
+          DLOG(transient, "gprocessor::flush_transient_inst_remain_queue destroying inst {}", dinst->getID());
           dinst->destroyTransientInst();
           bucket->pop_from_back();
           ++spaceInInstQueue;
         } else {
-          //printf("gprocessor::flush_transient_inst_remain_queue NO Transient inst!! %lu at @clockcycle %lu\n",
-                 //dinst->getID(),
-                 //globalClock);
+          DLOG(transient, "gprocessor::flush_transient_inst_remain_queue NO Transient inst!! {}", dinst->getID());
           return;
         }
       }
@@ -364,14 +373,14 @@ void GProcessor::flush_remaining_transient_inst_from_inst_queue() {
 }
 
 void GProcessor::flush_transient_inst_from_inst_queue() {
-  //printf("gprocessor::flush_transient_inst_queue Entering before new fetch!!!\n");
+  DLOG(transient, "gprocessor::flush_transient_inst_queue Entering before new fetch!!!");
   while (!pipeQ.instQueue.empty()) {
     auto* bucket = pipeQ.instQueue.end_data();
     if (bucket) {
       while (!bucket->empty()) {
         auto* dinst = bucket->end_data();
         if (dinst->isTransient()) {
-          //printf("gprocessor::flush_transient_inst_queue destroying inst %lu at @clockcycle %lu\n", dinst->getID(), globalClock);
+          DLOG(transient, "gprocessor::flush_transient_inst_queue destroying inst {}", dinst->getID());
           dinst->destroyTransientInst();
           bucket->pop_from_back();
           ++spaceInInstQueue;
@@ -433,9 +442,7 @@ void GProcessor::add_inst_transient_on_branch_miss(IBucket* bucket, Addr_t pc) {
       alu_dinst = Dinst::create(Instruction(Opcode::iCALU_FPALU, src1, src2, dst1, dst2), pc, 0, 0, true);
     } else if (rand() & 1) {
       alu_dinst = Dinst::create(Instruction(Opcode::iBALU_LBRANCH, src1, src2, dst1, dst2), pc, 0, 0, true);
-      //printf("gprocessor::add_transient_inst creating BRANCH_TRANSIENT  %lu at @clockcycle %lu\n",
-             //alu_dinst->getID(),
-             //globalClock);
+      DLOG(transient, "gprocessor::add_transient_inst creating BRANCH_TRANSIENT {}", alu_dinst->getID());
 
     } else {
       alu_dinst = Dinst::create(
@@ -450,7 +457,7 @@ void GProcessor::add_inst_transient_on_branch_miss(IBucket* bucket, Addr_t pc) {
     alu_dinst->set_spec();
     last_transientid = alu_dinst->getID();
     if (bucket) {
-      //printf("gprocessor::add_transient_inst pushing in pipeline  %lu at @clockcycle %lu\n", alu_dinst->getID(), globalClock);
+      DLOG(transient, "gprocessor::add_transient_inst pushing in pipeline {}", alu_dinst->getID());
       alu_dinst->setFetchTime();
       bucket->push(alu_dinst);
       // flush_remaining_transient_inst_from_inst_queue();
@@ -463,18 +470,20 @@ void GProcessor::add_inst_transient_on_branch_miss(IBucket* bucket, Addr_t pc) {
 }
 
 int32_t GProcessor::issue() {
-  // //printf("gprocessor::issue Entering Issue \n");
+  DLOG(fetch, "gprocessor::issue Entering Issue");
   int32_t i = 0;  // Instructions executed counter
 
   I(!pipeQ.instQueue.empty());
   // flush_remaining_transient_inst_from_inst_queue();
 
+  last_stall = NoStall;
+
   do {
     IBucket* bucket = pipeQ.instQueue.top();
     do {
       I(!bucket->empty());
       if (i >= IssueWidth) {
-        //printf("gprocessor::issue i<Issuewidth!!! return!!! \n");
+        DLOG(fetch, "gprocessor::issue i<Issuewidth!!! return!!!");
         return i;
       }
 
@@ -484,11 +493,14 @@ int32_t GProcessor::issue() {
       dinst->setGProc(this);
 
       StallCause c = add_inst(dinst);
-      //printf("gprocessor::issue inst  %llu at @clockcycle %llu\n", dinst->getID(), globalClock);
+      DLOG(fetch, "gprocessor::issue inst {}", dinst->getID());
       if (c != NoStall) {
         if (i < RealisticWidth) {
           nStall[c]->add(RealisticWidth - i, dinst->has_stats());
         }
+        if (i == 0) {
+          last_stall = c;
+        }
         return i;
       }
       i++;
@@ -501,10 +513,62 @@ int32_t GProcessor::issue() {
     pipeQ.instQueue.pop();
   } while (!pipeQ.instQueue.empty());
 
-  //printf("gprocessor::issue Exit inst\n");
+  DLOG(fetch, "gprocessor::issue Exit inst");
   return i;
 }
 
+bool GProcessor::is_frontend_quiescent() const
+/* fetch, decode and issue are stalled until a callback fires {{{1 */
+{
+  if (do_random_transients || !busy || smt_size > 1 || !can_skip_clock()) {
+    return false;
+  }
+
+  // unblocked by the branch (executed callback), the free buckets and the
+  // instQueue space come back on a callback or on a retire/issue
+  bool no_fetch = spaceInInstQueue < FetchWidth || !pipeQ.pipeLine.hasFreeItem() || smt_fetch.fe[0]->isBlocked();
+  if (!no_fetch) {
+    return false;
+  }
+
+  // the buckets leave the pipeline after a fixed delay, not on a callback
+  if (spaceInInstQueue >= FetchWidth && pipeQ.pipeLine.size()) {
+    return false;
+  }
+
+  if (pipeQ.instQueue.empty()) {
+    return true;
+  }
+
+  switch (last_stall) {
+    case SmallWinStall:
+    case SmallROBStall:
+    case SmallREGStall:
+    case OutsLoadsStall:
+    case OutsStoresStall:
+    case OutsBranchesStall: return true;  // freed by an executed callback or a retire
+    default: return false;                // issued, or a replay/syscall stall that depends on the clock
+  }
+}
+/* }}} */
+
+void GProcessor::skip_frontend_clock(Time_t n)
+/* the stats of n cycles like the last one {{{1 */
+{
+  skip_ticks(n, use_stats);
+
+  if (spaceInInstQueue >= FetchWidth) {
+    noFetch2.add(n, use_stats);
+  } else {
+    noFetch.add(n, use_stats);
+  }
+
+  if (!pipeQ.instQueue.empty() && RealisticWidth > 0) {
+    nStall[last_stall]->add(RealisticWidth * n, pipeQ.instQueue.top()->top()->has_stats());
+  }
+}
+/* }}} */
+
 bool GProcessor::decode_stage() {
   if (!ROB.empty()) {
     use_stats = ROB.top()->has_stats();
@@ -512,14 +576,14 @@ bool GProcessor::decode_stage() {
 
   bool new_clock = adjust_clock(use_stats);
   if (!new_clock) {
-    //printf("gprocessor::decode !newclock @clockcycle %llu\n", globalClock);
+    DLOG(fetch, "gprocessor::decode !newclock");
     return true;
   }
 
   // pipeQ.pipeLine.flush_transient_inst_from_received_bucket();
   //  ID Stage (insert to instQueue)
   if (spaceInInstQueue >= FetchWidth) {
-    //printf("gprocessor::decode  pipeline_nextitem at @clockcycle %llu\n", globalClock);
+    DLOG(fetch, "gprocessor::decode pipeline_nextitem");
     IBucket* bucket = pipeQ.pipeLine.nextItem();
 
     // IBucket* temp = bucket;
@@ -532,16 +596,16 @@ bool GProcessor::decode_stage() {
       spaceInInstQueue -= bucket->size();
       }*/
       pipeQ.instQueue.push(bucket);
-      //printf("gprocessor::decode  pushing from pipelineQ --> InstQ at @clockcycle %llu\n", globalClock);
+      DLOG(fetch, "gprocessor::decode pushing from pipelineQ --> InstQ");
 
     } else {
       noFetch2.inc(use_stats);
     }
   } else {
-    //printf("gprocessor::decode !spaceInInstQueue >= FetchWidth) at @clockcycle %llu\n", globalClock);
+    DLOG(fetch, "gprocessor::decode !spaceInInstQueue >= FetchWidth)");
     noFetch.inc(use_stats);
   }
 
-  //printf("gprocessor::decode Return False!!! at @clockcycle %llu\n", globalClock);
+  DLOG(fetch, "gprocessor::decode Return False!!!");
   return false;
 }
@@ -76,6 +76,38 @@ protected:
   FastQueue<Dinst*> rROB;  // ready/retiring/executed ROB
   FastQueue<Dinst*> ROB;
 
+  // ROB tail when the first transient of the current miss was renamed. The
+  // transient flush only walks the entries pushed after it
+  static constexpr uint64_t no_transient_ckpt = UINT64_MAX;
+  uint64_t                  transient_ckpt;
+
+  void checkpoint_transient() {
+    if (transient_ckpt == no_transient_ckpt) {
+      transient_ckpt = ROB.checkpoint();
+    }
+  }
+
+  // Rename into the ROB. Every core pushes through here, so the first
+  // transient of a miss always takes the checkpoint
+  void push_rob(Dinst* dinst) {
+    if (dinst->isTransient()) {
+      checkpoint_transient();
+    }
+    ROB.push(dinst);
+  }
+
+  // Count a retired instruction. Sampling intervals start and end here, so
+  // they cover what retired in them, not what was fetched
+  void count_commit(Dinst* dinst, bool en) {
+    if (unlikely(dinst->is_sample_begin())) {
+      Stats_sampler::mark();
+    }
+    nCommitted.inc(en);
+    if (unlikely(dinst->is_sample_end())) {
+      Stats_sampler::sample(eint->pop_sample_weight());
+    }
+  }
+
   uint32_t smt;  // 1...
   bool     busy;
 
@@ -107,6 +139,11 @@ protected:
   int32_t issue();
   void    fetch();
 
+  StallCause last_stall;  // why the last issue() did not issue anything (NoStall if it did)
+
+  [[nodiscard]] bool is_frontend_quiescent() const;
+  void               skip_frontend_clock(Time_t n);
+
   virtual StallCause add_inst(Dinst* dinst)  = 0;
   virtual void       try_flush(Dinst* dinst) = 0;
 
@@ -163,6 +200,8 @@ public:
   void dump_rob();
   void report(const std::string& str);
 
+  void snapshot(Snapshot_io& ar) override;
+
   // Addr_t   random_addr_gen();
   uint64_t random_reg_gen(bool reg);
 
@@ -0,0 +1,93 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "gprocessor.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+#include "inorderprocessor.hpp"
+#include "memory_system.hpp"
+#include "report.hpp"
+
+// Opens the protected rename/flush path of an in-order core
+class Inorder_probe : public InOrderProcessor {
+public:
+  Inorder_probe(std::shared_ptr<Gmemory_system> gm, CPU_t i) : InOrderProcessor(gm, i) {}
+
+  StallCause rename(Dinst* dinst) {
+    dinst->setGProc(this);
+    return add_inst(dinst);
+  }
+
+  [[nodiscard]] size_t n_transient_in_rob() const {
+    size_t n = 0;
+    for (uint32_t i = 0; i < ROB.size(); ++i) {
+      if (ROB.getData(ROB.getIDFromTop(i))->isTransient()) {
+        ++n;
+      }
+    }
+    return n;
+  }
+};
+
+class GProcessor_test : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    // The default configuration with an in-order c0
+    std::ifstream     in("conf/desesc.toml");
+    std::stringstream conf;
+    conf << in.rdbuf();
+
+    auto        str = conf.str();
+    std::string ooo = "type  = \"ooo\"  # ooo or inorder or accel";
+    auto        pos = str.find(ooo);
+    ASSERT_NE(pos, std::string::npos);
+    str.replace(pos, ooo.size(), "type  = \"inorder\"\nretire_delay = 0");
+
+    std::ofstream file("gprocessor_test.toml");
+    file << str;
+    file.close();
+
+    Report::init();
+    Config::init("gprocessor_test.toml");
+
+    gm   = std::make_shared<Memory_system>(0);
+    proc = std::make_shared<Inorder_probe>(gm, 0);
+    ASSERT_FALSE(Config::has_errors());
+  }
+
+  static Dinst* make(Opcode op, RegType dst, bool transient) {
+    auto* dinst = Dinst::create(Instruction(op, RegType::LREG_R1, RegType::LREG_R2, dst, RegType::LREG_InvalidOutput),
+                                0x1000,
+                                0,
+                                0,
+                                true);
+    if (transient) {
+      dinst->setTransient();
+    }
+    return dinst;
+  }
+
+  static inline std::shared_ptr<Gmemory_system> gm;
+  static inline std::shared_ptr<Inorder_probe>  proc;
+};
+
+// The in-order core renames through the same ROB push as the OoO one, so
+// the transient checkpoint is taken and the flush finds its transients
+TEST_F(GProcessor_test, inorder_flush_transient_from_rob) {
+  ASSERT_EQ(proc->rename(make(Opcode::iAALU, RegType::LREG_R3, false)), NoStall);
+  ASSERT_EQ(proc->rename(make(Opcode::iAALU, RegType::LREG_R4, true)), NoStall);
+  ASSERT_EQ(proc->rename(make(Opcode::iAALU, RegType::LREG_R5, true)), NoStall);
+  EXPECT_EQ(proc->n_transient_in_rob(), 2);
+
+  for (int i = 0; i < 32; ++i) {
+    EventScheduler::advanceClock();  // execute, not retire
+  }
+
+  proc->flush_transient_from_rob();
+  EXPECT_EQ(proc->n_transient_in_rob(), 0);
+  EXPECT_EQ(proc->getROBSizeOnly(), 1);
+}
@@ -66,6 +66,7 @@
 
 #include "dinst.hpp"  // Addr_t and Opcode
 #include "dolc.hpp"
+#include "snapshot.hpp"
 
 #define MEDIUM_TAGE 1
 // #define IMLI_150K 1
@@ -375,6 +376,8 @@ public:
 
   void dump() { printf(" loff=%d ctr=%d", pos_p, pred[pos_p]); }
 
+  void io(Snapshot_io& ar) { ar.io(pred); }
+
   bool predict() const { return pred[pos_p] >= 0; }
   bool highconf() const { return (abs(2 * pred[pos_p] + 1) >= (1 << bwidth) - 1); }
 
@@ -1933,4 +1936,45 @@ public:
         .state                = {},
     });
   }
+
+  // Learned tables and the histories that index them (not the in-flight deferred ops)
+  void snapshot(Snapshot_io& ar, const std::string& name) {
+    uint64_t key = (static_cast<uint64_t>(nhist) << 32) | (log2_tage_entries << 24) | (log2_tage_nsub << 16)
+                   | (log2_bimodal_entries << 8) | (log2_bimodal_nsub << 4) | bwidth;
+    if (!ar.section(name, key)) {
+      return;
+    }
+
+    bimodal.io(ar);
+    for (auto& t : gtable) {
+      ar.io(t);
+    }
+    ar.io(ch_i);
+    ar.io(ch_t[0]);
+    ar.io(ch_t[1]);
+    ar.io(ghist);
+    ar.io(ptghist);
+    ar.io(GHIST);
+    ar.io(phist);
+    ar.io(IMLIcount);
+    ar.io(TICK);
+#ifndef POSTPREDICT
+    ar.io(use_alt_on_na);
+#endif
+    ar.io(Bias);
+    ar.io(BiasSK);
+    ar.io(PGEHL);
+    ar.io(LGEHL);
+    ar.io(GGEHL);
+#ifdef IMLIOH
+    ar.io(FGEHL);
+    ar.io(IGEHL);
+#endif
+    ar.io(L_shist);
+    ar.io(Pupdatethreshold);
+#ifdef LOOPPREDICTOR
+    ar.io(ltable);
+    ar.io(WITHLOOP);
+#endif
+  }
 };
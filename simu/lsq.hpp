@@ -56,6 +56,38 @@ public:
   void   remove(Dinst* dinst);
 };
 
+// Same model as LSQFull, indexed by word. Each word in flight has a slot in
+// an open addressed table (linear probing, at most half full) holding its
+// loads and stores sorted by age, so executing() only looks at that word and
+// stops at the first match instead of walking every entry.
+class LSQAddr : public LSQ {
+private:
+  struct Slot {
+    Addr_t              word{0};
+    std::vector<Dinst*> q;  // by ID, empty when the slot is free
+  };
+
+  Stats_cntr        stldForwarding;
+  std::vector<Slot> table;
+  uint32_t          mask;
+  uint32_t          n_used{0};
+
+  static Addr_t calcWord(const Dinst* dinst) { return (dinst->getAddr()) >> 3; }
+
+  uint32_t home(Addr_t word) const { return (word * 0x9E3779B97F4A7C15ULL) >> 40 & mask; }
+  int32_t  find(Addr_t word) const;
+  void     release(uint32_t pos);
+  void     grow();
+
+public:
+  LSQAddr(Hartid_t hid, int32_t size);
+  ~LSQAddr() {}
+
+  bool   insert(Dinst* dinst);
+  Dinst* executing(Dinst* dinst);
+  void   remove(Dinst* dinst);
+};
+
 class LSQNone : public LSQ {
 private:
   std::array<Dinst*, 128> addrTable;
@@ -0,0 +1,65 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lsq.hpp"
+
+// Memory operations per second through insert, out-of-order executing and
+// in-order remove. Args: window (instructions in flight), words touched
+template <typename Q>
+static void BM_lsq(benchmark::State& state) {
+  const int window = state.range(0);
+  const int words  = state.range(1);
+
+  Q q(0, window);
+
+  // Created once, so the loop only measures the LSQ
+  std::vector<Dinst*> insts(1 << 14);
+  uint64_t            x = 0x9E3779B97F4A7C15ULL;
+  for (size_t i = 0; i < insts.size(); ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    auto op  = (x & 3) == 0 ? Opcode::iSALU_ST : Opcode::iLALU_LD;
+    insts[i] = Dinst::create(Instruction(op, RegType::LREG_R1, RegType::LREG_R2, RegType::LREG_R3, RegType::LREG_R4),
+                             0x1000 + 4 * (x % 64),
+                             0x80000 + 8 * ((x >> 8) % words),
+                             0,
+                             false);
+  }
+
+  globalClock = 1;
+  int64_t n   = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < insts.size(); ++i) {
+      q.insert(insts[i]);
+      if (i >= static_cast<size_t>(window / 2)) {
+        // executes half a window behind, younger entries already there
+        auto* d = insts[i - window / 2];
+        benchmark::DoNotOptimize(q.executing(d));
+      }
+      if (i >= static_cast<size_t>(window)) {
+        q.remove(insts[i - window]);
+      }
+    }
+    for (size_t i = insts.size() - window; i < insts.size(); ++i) {
+      q.remove(insts[i]);
+    }
+    n += insts.size();
+  }
+
+  state.counters["ops"] = benchmark::Counter(n, benchmark::Counter::kIsRate);
+
+  for (auto* d : insts) {
+    d->scrap();
+  }
+}
+
+BENCHMARK(BM_lsq<LSQFull>)->ArgsProduct({{32, 128}, {16, 1024}});
+BENCHMARK(BM_lsq<LSQAddr>)->ArgsProduct({{32, 128}, {16, 1024}});
+
+int main(int argc, char* argv[]) {
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+}
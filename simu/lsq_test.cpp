@@ -1,80 +1,107 @@
-/*
-   ESESC: Super ESCalar simulator
-   Copyright (C) 2009 University of California, Santa Cruz.
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
 
-   Contributed by Jose Renau
-                  Basilio Fraguela
-                  Milos Prvulovic
-                  Smruti Sarangi
-
-This file is part of ESESC.
-
-ESESC is free software; you can redistribute it and/or modify it under the terms
-of the GNU General Public License as published by the Free Software Foundation;
-either version 2, or (at your option) any later version.
-
-ESESC is distributed in the  hope that it will be useful, but WITHOUT ANY
-WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
-PARTICULAR PURPOSE. See the GNU General Public License for more details.
-
-You should have received a copy of the GNU General Public License along with
-ESESC; see the file COPYING. If not, write to the Free Software Foundation, 59
-Temple Place - Suite 330, Boston, MA 02111-1307, USA.
-*/
-
-/*
- * This launches the ESESC simulator environment with an ideal memory
- */
-
-#include <signal.h>
-#include <sys/time.h>
-#include <sys/types.h>
-
-#include "Instruction.h"
-#include "dinst.hpp"
-#include "nanassert.h"
-
-//*********** BEGIN CREATE FAKE PROCESSOR CLASS
-uint64_t nReplays = 0;
-#define GPROCESSOR_H 1
-class GProcessor {
-public:
-  void replay(Dinst* dinst) { nReplays++; }
-};
-//*********** END CREATE FAKE PROCESSOR CLASS
-#include "config.hpp"
 #include "lsq.hpp"
 
-long long instTotal = 0;
-
-LSQ* lsq;
+#include <random>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "gtest/gtest.h"
+
+class Lsq_test : public ::testing::TestWithParam<int> {
+protected:
+  // The same instruction for each LSQ, created in the same order
+  struct Op {
+    Dinst* full;
+    Dinst* addr;
+    bool   executed;
+  };
+
+  static Dinst* make(bool store, Addr_t pc, Addr_t addr) {
+    auto op = store ? Opcode::iSALU_ST : Opcode::iLALU_LD;
+    return Dinst::create(Instruction(op, RegType::LREG_R1, RegType::LREG_R2, RegType::LREG_R3, RegType::LREG_R4),
+                         pc,
+                         addr,
+                         0,
+                         true);
+  }
+};
 
-void doTest() {
+// Random in-order insert/remove and out-of-order execution, LSQAddr finds
+// the same violations and forwards the same loads as LSQFull
+TEST_P(Lsq_test, addr_matches_full) {
+  int window = GetParam();
+
+  LSQFull full(0, window);
+  LSQAddr addr(0, window / 8);  // more words in flight than sized for, so the table grows
+
+  std::mt19937_64                     rng(window);
+  std::vector<Op>                     inflight;
+  absl::flat_hash_map<Dinst*, Dinst*> full2addr;
+  int                                 n_faulty    = 0;
+  int                                 n_forwarded = 0;
+
+  globalClock = 1;
+  for (int step = 0; step < 200000; ++step) {
+    ++globalClock;
+    auto r = rng() % 16;
+
+    if (r < 6 && static_cast<int>(inflight.size()) < window) {
+      bool   store = rng() & 1;
+      Addr_t pc    = 0x1000 + 4 * (rng() % 8);
+      Addr_t a     = 0x80000 + 8 * (rng() % 48) + (rng() & 7);  // few words, so many conflicts
+      Op     op{make(store, pc, a), make(store, pc, a), false};
+      ASSERT_TRUE(full.insert(op.full));
+      ASSERT_TRUE(addr.insert(op.addr));
+      full2addr[op.full] = op.addr;
+      inflight.push_back(op);
+    } else if (r < 12 && !inflight.empty()) {
+      auto& op = inflight[rng() % inflight.size()];
+      if (op.executed) {
+        continue;
+      }
+      auto* ff = full.executing(op.full);
+      auto* fa = addr.executing(op.addr);
+      ASSERT_EQ(ff == nullptr, fa == nullptr) << "step " << step;
+      if (ff) {
+        EXPECT_EQ(full2addr[ff], fa) << "step " << step;
+        n_faulty++;
+      }
+      ASSERT_EQ(op.full->isLoadForwarded(), op.addr->isLoadForwarded()) << "step " << step;
+      n_forwarded += op.full->isLoadForwarded();
+
+      op.full->markExecuted();
+      op.addr->markExecuted();
+      op.executed = true;
+    } else if (!inflight.empty()) {
+      // Retire the oldest, or flush a random one (removed twice, like a
+      // try_flush followed by the retire)
+      size_t i     = (r == 15) ? rng() % inflight.size() : 0;
+      auto   op    = inflight[i];
+      bool   flush = r == 15;
+      inflight.erase(inflight.begin() + i);
+
+      full.remove(op.full);
+      addr.remove(op.addr);
+      if (flush) {
+        full.remove(op.full);
+        addr.remove(op.addr);
+      }
+      full2addr.erase(op.full);
+      op.full->scrap();
+      op.addr->scrap();
+    }
+  }
+
+  EXPECT_GT(n_faulty, 20);
+  EXPECT_GT(n_forwarded, 200);
+
+  for (auto& op : inflight) {
+    full.remove(op.full);
+    addr.remove(op.addr);
+    op.full->scrap();
+    op.addr->scrap();
+  }
 }
 
-// FIXME: this is a broken test/benchmark, but it would be good to have one for the LSQ
-
-int main(int argc, const char** argv) {
-  Config::init();
-
-  GProcessor gproc;
-  // lsq = new LSQFull(&gproc,0);
-  lsq = new LSQFull(0);
-
-  timeval startTime;
-  gettimeofday(&startTime, 0);
-
-  doTest();
-
-  timeval endTime;
-  gettimeofday(&endTime, 0);
-  double msecs = (endTime.tv_sec - startTime.tv_sec) * 1000 + (endTime.tv_usec - startTime.tv_usec) / 1000;
-
-  long double res = instTotal / 1000;
-  res /= msecs;
-  MSG("------------------");
-  MSG("LSQ MIPS = %g secs = %g insts = %lld", (double)res, msecs / 1000, (long long)instTotal);
-  MSG("------------------");
-
-  return 0;
-}
+INSTANTIATE_TEST_SUITE_P(Windows, Lsq_test, ::testing::Values(4, 32, 128));
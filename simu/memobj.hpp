@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "callback.hpp"
+#include "clock_domain.hpp"
 #include "dinst.hpp"
 #include "iassert.hpp"
 #include "mrouter.hpp"
@@ -14,6 +15,7 @@
 #include "store_buffer.hpp"
 
 class MemRequest;
+class Snapshot_io;
 
 #define PSIGN_NONE       0
 #define PSIGN_RAS        1
@@ -23,6 +25,8 @@ class MemRequest;
 #define PSIGN_INDIRECT   5
 #define PSIGN_CHASE      6
 #define PSIGN_MEGA       7
+#define PSIGN_CACHE      8  // Cache_prefetcher of the cache
+#define PSIGN_CACHE_UP   9  // Cache_prefetcher of an upper level, filled on the way up
 #define LDBUFF_SIZE      512
 #define CIR_QUEUE_WINDOW 512  // FIXME: need to change this to a conf variable
 
@@ -52,6 +56,7 @@ protected:
   bool            firstLevelIL1;
   bool            firstLevelDL1;
   bool            isLLC;
+  Clock_domain*   domain{nullptr};  // nullptr unless the parallel engine is on
   void            addLowerLevel(MemObj* obj);
   void            addUpperLevel(MemObj* obj);
 
@@ -81,6 +86,9 @@ public:
 
   MRouter* getRouter() { return router; }
 
+  Clock_domain* get_domain() const { return domain; }
+  void          set_domain(Clock_domain* d) { domain = d; }
+
   virtual void tryPrefetch(Addr_t addr, bool doStats, int degree, Addr_t pref_sign, Addr_t pc, CallbackBase* cb = 0) = 0;
 
   // Interface for fast-forward (no BW, just warmup caches)
@@ -120,6 +128,13 @@ public:
   virtual void clearNeedsCoherence();
 
   virtual bool Invalid(Addr_t addr) const;
+
+  // Percent of the memory controller queues in use below this object (the
+  // highest one). Read from any domain, it must not touch timing state.
+  virtual uint32_t get_occupancy() const;
+
+  // Timing state checkpoint (no-op for objects without long lived state)
+  virtual void snapshot(Snapshot_io& ar);
 };
 
 class DummyMemObj : public MemObj {
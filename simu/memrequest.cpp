@@ -11,13 +11,13 @@
 #include "pipeline.hpp"
 #include "resource.hpp"
 
-pool<MemRequest> MemRequest::actPool(2048, "MemRequest");
-
 bool forcemsgdump = true;
 
 MemRequest::MemRequest()
 /* constructor  */
-{}
+{
+  next_hop = Hop::redo_req;
+}
 
 MemRequest::~MemRequest()
 // destructor
@@ -26,6 +26,38 @@ MemRequest::~MemRequest()
 }
 //
 
+void MemRequest::run_hop(Hop h) {
+  switch (h) {
+    case Hop::redo_req: redoReq(); break;
+    case Hop::redo_req_ack: redoReqAck(); break;
+    case Hop::redo_set_state: redoSetState(); break;
+    case Hop::redo_set_state_ack: redoSetStateAck(); break;
+    case Hop::redo_disp: redoDisp(); break;
+    case Hop::start_req: startReq(); break;
+    case Hop::start_req_ack: startReqAck(); break;
+    case Hop::start_set_state: startSetState(); break;
+    case Hop::start_set_state_ack: startSetStateAck(); break;
+    case Hop::start_disp: startDisp(); break;
+  }
+}
+
+EventScheduler* MemRequest::create_hop_cb(Hop h) {
+  switch (h) {
+    case Hop::redo_req: return redoReqCB::create(this, getPriority());
+    case Hop::redo_req_ack: return redoReqAckCB::create(this, getPriority());
+    case Hop::redo_set_state: return redoSetStateCB::create(this, getPriority());
+    case Hop::redo_set_state_ack: return redoSetStateAckCB::create(this, getPriority());
+    case Hop::redo_disp: return redoDispCB::create(this, getPriority());
+    case Hop::start_req: return startReqCB::create(this, getPriority());
+    case Hop::start_req_ack: return startReqAckCB::create(this, getPriority());
+    case Hop::start_set_state: return startSetStateCB::create(this, getPriority());
+    case Hop::start_set_state_ack: return startSetStateAckCB::create(this, getPriority());
+    case Hop::start_disp: return startDispCB::create(this, getPriority());
+  }
+  I(0);
+  return nullptr;
+}
+
 void MemRequest::redoReq() {
   upce();
   currMemObj->doReq(this);
@@ -75,6 +107,28 @@ void MemRequest::startDisp() {
   currMemObj->disp(this);
 }
 
+void MemRequest::startFillReqAckAbs(MemObj* m, Time_t when) {
+  setNextHop(m);
+  if (unlikely(crosses_domain())) {
+    // The fill must block the upper level ports in its own thread
+    fill_when = when;
+    post_hop(fillReqAckCB::create(this, getPriority()), 0);
+    return;
+  }
+
+  m->blockFill(this);
+  hop_abs(Hop::start_req_ack, when);
+}
+
+void MemRequest::fillReqAck() {
+  currMemObj->blockFill(this);
+  if (fill_when > globalClock) {
+    hop_abs(Hop::start_req_ack, fill_when);
+  } else {
+    startReqAck();
+  }
+}
+
 void MemRequest::addPendingSetStateAck(MemRequest* mreq) {
   I(mreq->id < id);
   I(mreq->mt == mt_setState || mreq->mt == mt_req || mreq->mt == mt_reqAck);
@@ -98,9 +152,9 @@ void MemRequest::setStateAckDone(TimeDelta_t lat) {
   orig->pendingSetStateAck--;
   if (orig->pendingSetStateAck <= 0) {
     if (orig->mt == mt_req) {
-      redoReqCB::schedule(lat, orig, orig->getPriority());
+      orig->redoReq(lat);
     } else if (orig->mt == mt_reqAck) {
-      redoReqAckCB::schedule(lat, orig, orig->getPriority());
+      orig->redoReqAck(lat);
     } else if (orig->mt == mt_setState) {
       // I(orig->setStateAckOrig==0);
       // orig->ack();
@@ -119,7 +173,7 @@ void MemRequest::setStateAckDone(TimeDelta_t lat) {
 MemRequest* MemRequest::create(MemObj* mobj, Addr_t addr, bool keep_stats, CallbackBase* cb) {
   I(mobj);
 
-  MemRequest* r = actPool.out();
+  MemRequest* r = ref_pool().out();
 
   r->addr                    = addr;
   r->homeMemObj              = mobj;
@@ -127,7 +181,7 @@ MemRequest* MemRequest::create(MemObj* mobj, Addr_t addr, bool keep_stats, Callb
   r->currMemObj              = mobj;
   r->firstCache              = 0;
   r->topCoherentNode         = 0;
-  static uint64_t current_id = 0;
+  static thread_local uint64_t current_id = 0;
   r->id                      = current_id++;
 #ifdef DEBUG_CALLPATH
   r->prevMemObj = 0;
@@ -156,11 +210,7 @@ MemRequest* MemRequest::create(MemObj* mobj, Addr_t addr, bool keep_stats, Callb
 
 #ifdef DEBUG_CALLPATH
 void MemRequest::dump_all() {
-  MemRequest* mreq = actPool.firstInUse();
-  while (mreq) {
-    mreq->dump_calledge(0, true);
-    mreq = actPool.nextInUse(mreq);
-  }
+  ref_pool().for_each_in_use([](MemRequest* mreq) { mreq->dump_calledge(0, true); });
 }
 
 void MemRequest::dump_calledge(TimeDelta_t lat, bool interesting) {
@@ -286,6 +336,7 @@ void MemRequest::setNextHop(MemObj* newMemObj) {
 void MemRequest::destroy()
 /* destroy/recycle current and parent_req messages  */
 {
-  actPool.in(this);
+  I(!isInQueue());  // destroyed with a hop pending
+  ref_pool().in(this);
 }
 /*  */
@@ -10,7 +10,11 @@
 // #define DEBUG_CALLPATH 1
 #endif
 
-class MemRequest {
+// A request is its own event: a hop sets next_hop and queues the request,
+// so the usual path (port slot, tag check, hit) allocates no callback. A
+// request that is already queued, or goes to another Clock_domain, still
+// takes a CallbackMember from its pool.
+class MemRequest : public EventScheduler {
 private:
   void setNextHop(MemObj* m);
   void startReq();
@@ -22,9 +26,54 @@ private:
   uint64_t id;
 
   // memRequest pool {{{1
-  static pool<MemRequest> actPool;
-  friend class pool<MemRequest>;
+  static pool_home<MemRequest>& ref_pool() {
+    static thread_local auto* p = new pool_home<MemRequest>(2048, "MemRequest");  // never deleted, see pool_home
+    return *p;
+  }
+  friend class pool_home<MemRequest>;
   // }}}
+
+  enum class Hop : uint8_t {
+    redo_req,
+    redo_req_ack,
+    redo_set_state,
+    redo_set_state_ack,
+    redo_disp,
+    start_req,
+    start_req_ack,
+    start_set_state,
+    start_set_state_ack,
+    start_disp
+  };
+  Hop next_hop;
+
+  void            call() override { run_hop(next_hop); }
+  void            run_hop(Hop h);
+  EventScheduler* create_hop_cb(Hop h);
+  void            hop(Hop h, TimeDelta_t lat) {
+    if (lat == 0) {
+      run_hop(h);
+    } else if (isInQueue()) {
+      EventScheduler::schedule(lat, create_hop_cb(h));
+    } else {
+      next_hop = h;
+      resetPriority();
+      initPriority(getPriority());
+      EventScheduler::schedule(lat, this);
+    }
+  }
+  void hop_abs(Hop h, Time_t when) {
+    if (when == globalClock) {
+      run_hop(h);
+    } else if (isInQueue()) {
+      EventScheduler::scheduleAbs(when, create_hop_cb(h));
+    } else {
+      next_hop = h;
+      resetPriority();
+      initPriority(getPriority());
+      EventScheduler::scheduleAbs(when, this);
+    }
+  }
   /* MsgType declarations {{{1 */
   enum MsgType { mt_req, mt_reqAck, mt_setState, mt_setStateAck, mt_disp };
 
@@ -65,6 +114,7 @@ private:
   MemRequest* setStateAckOrig;
 
   Time_t startClock;
+  Time_t fill_when;  // reqAck time of a fill posted to another Clock_domain
 
   bool prefetch;  // This means that can be dropped at will
   bool spec;
@@ -97,7 +147,7 @@ private:
   /* }}} */
 
   MemRequest();
-  virtual ~MemRequest();
+  ~MemRequest() override;
 
   void memReq();     // E.g: L1 -> L2
   void memReqAck();  // E.gL L2 -> L1 ack
@@ -108,31 +158,62 @@ private:
   void memDisp();  // E.g: L1 -> L2
 
   friend class MRouter;  // only mrouter can call the req directly
-  void redoReq(TimeDelta_t lat) { redoReqCB::schedule(lat, this, getPriority()); }
-  void redoReqAck(TimeDelta_t lat) { redoReqAckCB::schedule(lat, this, getPriority()); }
-  void redoSetState(TimeDelta_t lat) { redoSetStateCB::schedule(lat, this, getPriority()); }
-  void redoSetStateAck(TimeDelta_t lat) { redoSetStateAckCB::schedule(lat, this, getPriority()); }
-  void redoDisp(TimeDelta_t lat) { redoDispCB::schedule(lat, this, getPriority()); }
+  void redoReq(TimeDelta_t lat) { hop(Hop::redo_req, lat); }
+  void redoReqAck(TimeDelta_t lat) { hop(Hop::redo_req_ack, lat); }
+  void redoSetState(TimeDelta_t lat) { hop(Hop::redo_set_state, lat); }
+  void redoSetStateAck(TimeDelta_t lat) { hop(Hop::redo_set_state_ack, lat); }
+  void redoDisp(TimeDelta_t lat) { hop(Hop::redo_disp, lat); }
 
   void startReq(MemObj* m, TimeDelta_t lat) {
     setNextHop(m);
-    startReqCB::schedule(lat, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startReqCB::create(this, getPriority()), lat);
+      return;
+    }
+    hop(Hop::start_req, lat);
   }
   void startReqAck(MemObj* m, TimeDelta_t lat) {
     setNextHop(m);
-    startReqAckCB::schedule(lat, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startReqAckCB::create(this, getPriority()), lat);
+      return;
+    }
+    hop(Hop::start_req_ack, lat);
   }
   void startSetState(MemObj* m, TimeDelta_t lat) {
     setNextHop(m);
-    startSetStateCB::schedule(lat, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startSetStateCB::create(this, getPriority()), lat);
+      return;
+    }
+    hop(Hop::start_set_state, lat);
   }
   void startSetStateAck(MemObj* m, TimeDelta_t lat) {
     setNextHop(m);
-    startSetStateAckCB::schedule(lat, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startSetStateAckCB::create(this, getPriority()), lat);
+      return;
+    }
+    hop(Hop::start_set_state_ack, lat);
   }
   void startDisp(MemObj* m, TimeDelta_t lat) {
     setNextHop(m);
-    startDispCB::schedule(lat, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startDispCB::create(this, getPriority()), lat);
+      return;
+    }
+    hop(Hop::start_disp, lat);
+  }
+
+  void startFillReqAckAbs(MemObj* m, Time_t when);
+  void fillReqAck();
+
+  // Parallel engine: a hop into another Clock_domain goes through its mailbox
+  [[nodiscard]] bool crosses_domain() const {
+    return Clock_domain::is_parallel() && currMemObj->get_domain() != Clock_domain::get_current();
+  }
+  void post_hop(EventScheduler* ev, Time_t lat) {
+    currMemObj->get_domain()->post(globalClock + Clock_domain::hop_latency(lat), ev);
   }
 
   void setStateAckDone(TimeDelta_t lat);
@@ -175,38 +256,59 @@ public:
   using startSetStateCB    = CallbackMember0<MemRequest, &MemRequest::startSetState>;
   using startSetStateAckCB = CallbackMember0<MemRequest, &MemRequest::startSetStateAck>;
   using startDispCB        = CallbackMember0<MemRequest, &MemRequest::startDisp>;
+  using fillReqAckCB       = CallbackMember0<MemRequest, &MemRequest::fillReqAck>;
 
-  void redoReqAbs(Time_t when) { redoReqCB::scheduleAbs(when, this, getPriority()); }
+  void redoReqAbs(Time_t when) { hop_abs(Hop::redo_req, when); }
   void startReqAbs(MemObj* m, Time_t when) {
     setNextHop(m);
-    startReqCB::scheduleAbs(when, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startReqCB::create(this, getPriority()), when - globalClock);
+      return;
+    }
+    hop_abs(Hop::start_req, when);
   }
   void restartReq() { startReq(); }
 
-  void redoReqAckAbs(Time_t when) { redoReqAckCB::scheduleAbs(when, this, getPriority()); }
+  void redoReqAckAbs(Time_t when) { hop_abs(Hop::redo_req_ack, when); }
   void startReqAckAbs(MemObj* m, Time_t when) {
     setNextHop(m);
-    startReqAckCB::scheduleAbs(when, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startReqAckCB::create(this, getPriority()), when - globalClock);
+      return;
+    }
+    hop_abs(Hop::start_req_ack, when);
   }
   void restartReqAck() { startReqAck(); }
-  void restartReqAckAbs(Time_t when) { startReqAckCB::scheduleAbs(when, this, getPriority()); }
+  void restartReqAckAbs(Time_t when) { hop_abs(Hop::start_req_ack, when); }
 
-  void redoSetStateAbs(Time_t when) { redoSetStateCB::scheduleAbs(when, this, getPriority()); }
+  void redoSetStateAbs(Time_t when) { hop_abs(Hop::redo_set_state, when); }
   void startSetStateAbs(MemObj* m, Time_t when) {
     setNextHop(m);
-    startSetStateCB::scheduleAbs(when, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startSetStateCB::create(this, getPriority()), when - globalClock);
+      return;
+    }
+    hop_abs(Hop::start_set_state, when);
   }
 
-  void redoSetStateAckAbs(Time_t when) { redoSetStateAckCB::scheduleAbs(when, this, getPriority()); }
+  void redoSetStateAckAbs(Time_t when) { hop_abs(Hop::redo_set_state_ack, when); }
   void startSetStateAckAbs(MemObj* m, Time_t when) {
     setNextHop(m);
-    startSetStateAckCB::scheduleAbs(when, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startSetStateAckCB::create(this, getPriority()), when - globalClock);
+      return;
+    }
+    hop_abs(Hop::start_set_state_ack, when);
   }
 
-  void redoDispAbs(Time_t when) { redoDispCB::scheduleAbs(when, this, getPriority()); }
+  void redoDispAbs(Time_t when) { hop_abs(Hop::redo_disp, when); }
   void startDispAbs(MemObj* m, Time_t when) {
     setNextHop(m);
-    startDispCB::scheduleAbs(when, this, getPriority());
+    if (unlikely(crosses_domain())) {
+      post_hop(startDispCB::create(this, getPriority()), when - globalClock);
+      return;
+    }
+    hop_abs(Hop::start_disp, when);
   }
 
   static void sendReqVPCWriteUpdate(MemObj* m, bool keep_stats, Addr_t addr) {
@@ -458,7 +560,7 @@ public:
     I(creator);
     mreq->creatorObj      = creator;
     mreq->topCoherentNode = creator;
-    m->disp(mreq);
+    mreq->dispatch_disp();
   }
   static void sendCleanDisp(MemObj* m, MemObj* creator, Addr_t addr, bool prefetch, bool keep_stats) {
     MemRequest* mreq = create(m, addr, keep_stats, nullptr);
@@ -469,7 +571,14 @@ public:
     I(creator);
     mreq->creatorObj      = creator;
     mreq->topCoherentNode = creator;
-    m->disp(mreq);
+    mreq->dispatch_disp();
+  }
+  void dispatch_disp() {
+    if (unlikely(crosses_domain())) {
+      post_hop(startDispCB::create(this, getPriority()), 0);
+      return;
+    }
+    currMemObj->disp(this);
   }
 
   static MemRequest* createSetState(MemObj* m, MemObj* creator, MsgAction ma, Addr_t naddr, bool keep_stats) {
@@ -61,6 +61,7 @@ public:
   int16_t getCreatorPort(const MemRequest* mreq) const;
 
   void fillRouteTables();
+  void propagate_uncore_domain(bool below_shared = false);
   void addUpNode(MemObj* upm);
   void addDownNode(MemObj* upm);
 
@@ -94,7 +95,10 @@ public:
 
   bool isBusyPos(uint32_t pos, Addr_t addr) const;
 
-  bool isTopLevel() const { return up_node.empty(); }
+  uint32_t getDownOccupancy() const;
+
+  bool   isTopLevel() const { return up_node.empty(); }
+  size_t getNumUpNodes() const { return up_node.size(); }
 
   MemObj* getDownNode(int pos = 0) const {
     I(down_node.size() > pos);
@@ -11,6 +11,7 @@
 #include <numeric>
 
 #include "config.hpp"
+#include "debug_log.hpp"
 #include "fastqueue.hpp"
 #include "fetchengine.hpp"
 #include "fmt/format.h"
@@ -59,6 +60,7 @@ OoOProcessor::OoOProcessor(std::shared_ptr<Gmemory_system> gm, CPU_t i)
   flushing         = false;
   replayRecovering = false;
   replayID         = 0;
+  retire_idle      = false;
 
   last_state.dinst_ID = 0xdeadbeef;
 
@@ -82,15 +84,14 @@ OoOProcessor::~OoOProcessor()
 /* }}} */
 
 bool OoOProcessor::advance_clock_drain() {
-  // printf("OOOProc::advance_clock_drain ::decode_stage() is called\n");
-  // printf("OOOProc::advance_clock_drain ::decode_stage()::dump_rat is called\n");
+  DLOG(fetch, "OOOProc::advance_clock_drain ::decode_stage() is called");
 
   // dump_rat();
-  //printf("OOOProc::advance_clock_drain ::decode_stage()::Entering\n");
+  DLOG(fetch, "OOOProc::advance_clock_drain ::decode_stage()::Entering");
   bool abort = decode_stage();
 
   if (abort || !busy) {
-    //printf("OOOProc::advance_clock_drain :: abort|!busy::return busy at @Clockcyle %lu\n", globalClock);
+    DLOG(fetch, "OOOProc::advance_clock_drain :: abort|!busy::return busy");
     return busy;
   }
 
@@ -121,55 +122,89 @@ bool OoOProcessor::advance_clock_drain() {
     } else {
       nStall[ReplaysStall]->add(RealisticWidth, use_stats);
       retire();
-      //printf("OOOProc::advance_clock_drain :: ::ROB !empty():recovering:: return true at @Clockcyle %lu\n", globalClock);
+      DLOG(fetch, "OOOProc::advance_clock_drain :: ::ROB !empty():recovering:: return true");
       return true;
     }
   }
 
   if (!pipeQ.instQueue.empty()) {
     auto n = issue();
-    //printf("OOOprocessor::advance_clock_drain ::Sending issue spaceInInstQueue Before issue is %d !!!\n", spaceInInstQueue);
+    DLOG(fetch, "OOOprocessor::advance_clock_drain ::Sending issue spaceInInstQueue Before issue is {} !!!", spaceInInstQueue);
     spaceInInstQueue += n;
-    //printf("OOOprocessor:: spaceInInstQueue after issue is %d !!!\n", spaceInInstQueue);
+    DLOG(fetch, "OOOprocessor:: spaceInInstQueue after issue is {} !!!", spaceInInstQueue);
   } else if (ROB.empty() && rROB.empty() && !pipeQ.pipeLine.hasOutstandingItems()) {
-    //printf("OOOProc::advance_clock_drain :: !issue_stage()::return false\n");
+    DLOG(fetch, "OOOProc::advance_clock_drain :: !issue_stage()::return false");
     return false;
   }
 
+  auto rob_size   = ROB.size();
+  bool rrob_empty = rROB.empty();
   retire();
+  retire_idle = rrob_empty && rROB.empty() && ROB.size() == rob_size;
 
-  //printf("OOOProc::advance_clock_drain :: Leaving::return true at @Clockcyle %lu\n", globalClock);
+  DLOG(fetch, "OOOProc::advance_clock_drain :: Leaving::return true");
   return true;
 }
 
 bool OoOProcessor::advance_clock() {
-  //printf("OOOProc::advance_clock :: Entering at @Clockcyle %lu\n", globalClock);
+  DLOG(fetch, "OOOProc::advance_clock :: Entering");
   if (!TaskHandler::is_active(hid)) {
-    //printf("OOOProc::advance_clock :: !TaskHandler::is_active()::return false at @Clockcyle %lu\n", globalClock);
+    DLOG(fetch, "OOOProc::advance_clock :: !TaskHandler::is_active()::return false");
     return false;
   }
 
   Tracer::advance_clock();
-  //printf("OOOProc::advance_clock::Tracer::advanceclock():: Entering at @Clockcyle %lu\n", globalClock);
+  DLOG(fetch, "OOOProc::advance_clock::Tracer::advanceclock():: Entering");
 
   // sending--->GProcessor::fetch()
-  //printf("OOOProc::advance_clock :: sending to GPROCCESOR::Fetch:: fetch() at @Clockcyle %lu\n", globalClock);
+  DLOG(fetch, "OOOProc::advance_clock :: sending to GPROCCESOR::Fetch:: fetch()");
   fetch();
 
   return advance_clock_drain();
 }
 
+bool OoOProcessor::is_quiescent() const
+/* all the stages wait for a callback (a miss), the cycles can be skipped {{{1 */
+{
+  if (!TaskHandler::is_active(hid)) {
+    return true;  // advance_clock does nothing
+  }
+#ifdef TRACK_TIMELEAK
+  return false;  // per cycle ROB walk
+#else
+  if (replayRecovering || flushing || !retire_idle) {
+    return false;
+  }
+  return is_frontend_quiescent();
+#endif
+}
+/* }}} */
+
+void OoOProcessor::skip_clock(Time_t n)
+/* same stats as n idle advance_clock {{{1 */
+{
+  if (!TaskHandler::is_active(hid)) {
+    return;
+  }
+
+  skip_frontend_clock(n);
+
+  if (!ROB.empty() && ROB.top()->has_stats()) {
+    robUsed.sample(ROB.size(), true, n);
+  }
+}
+/* }}} */
+
 void OoOProcessor::executing(Dinst* dinst)
 // {{{1 Called when the instruction starts to execute
 {
   if (dinst->isTransient()) {
-    // printf("OOOProc::executing  Transient starts to dinstID %ld\n", dinst->getID());
+    DLOG(transient, "OOOProc::executing Transient starts to dinstID {}", dinst->getID());
     dinst->markExecutingTransient();
   } else {
     dinst->markExecuting();
   }
 
-  // printf("OOOProc::Executing::dump_rat is called\n");
   // dump_rat();
 
   Tracer::stage(dinst, "EX");
@@ -224,12 +259,11 @@ void OoOProcessor::executing(Dinst* dinst)
 // 1}}}
 //
 void OoOProcessor::executed([[maybe_unused]] Dinst* dinst) {
-  // printf("OOOProc::Executed::dump_rat is called\n");
   // dump_rat();
   // if (dinst->isTransient()) {
-  //   printf("OOOProc::executed Transientinst starts to executed\n");
+  DLOG(transient, "OOOProc::executed Transientinst starts to executed");
   // } else {
-  //   printf("OOOProc::executed  starts to dinstID %ld\n", dinst->getID());
+  DLOG(fetch, "OOOProc::executed starts to dinstID {}", dinst->getID());
   // }
 
 #ifdef TRACK_FORWARDING
@@ -245,24 +279,24 @@ void OoOProcessor::flushed(Dinst* dinst)
 
 StallCause OoOProcessor::add_inst(Dinst* dinst) {
   // if (dinst->isTransient()) {
-  //   printf("OOOProc::add_inst_Transient Entering for  dinstID %ld\n", dinst->getID());
+  DLOG(transient, "OOOProc::add_inst_Transient Entering for dinstID {}", dinst->getID());
   // }
 
   if (dinst->getInst()->isLoad()) {
-    //printf("OOOProc::add_inst Load_add_inst for  dinstID %lu\n", dinst->getID());
+    DLOG(rename, "OOOProc::add_inst Load_add_inst for dinstID {}", dinst->getID());
   }
-  //printf("OOOProc::add_inst Entering for  dinstID %lu\n", dinst->getID());
+  DLOG(rename, "OOOProc::add_inst Entering for dinstID {}", dinst->getID());
   if (replayRecovering && dinst->getID() > replayID) {
-    //printf("OOOProc::add_inst::Replay stalls for  dinstID %lu\n", dinst->getID());
+    DLOG(rename, "OOOProc::add_inst::Replay stalls for dinstID {}", dinst->getID());
     Tracer::stage(dinst, "Wrep");
     return ReplaysStall;
   }
 
-  //printf("OOOProc::add_inst::ROBSIZE for  dinstID %lu is %zu\n", dinst->getID(), (ROB.size() + rROB.size()));
+  DLOG(rename, "OOOProc::add_inst::ROBSIZE for dinstID {} is {}", dinst->getID(), (ROB.size() + rROB.size()));
   if ((ROB.size() + rROB.size()) >= (MaxROBSize - 1)) {
     Tracer::stage(dinst, "Wrob");
-    //printf("OOOProc::add_inst::smallrobstall for  dinstID %lu\n", dinst->getID());
-    //printf("OOOProc::add_inst::ROBSIZE for  dinstID %lu is %zu\n", dinst->getID(), ROB.size() + rROB.size());
+    DLOG(rename, "OOOProc::add_inst::smallrobstall for dinstID {}", dinst->getID());
+    DLOG(rename, "OOOProc::add_inst::ROBSIZE for dinstID {} is {}", dinst->getID(), ROB.size() + rROB.size());
     return SmallROBStall;
   }
 
@@ -270,7 +304,7 @@ StallCause OoOProcessor::add_inst(Dinst* dinst) {
 
   if (nTotalRegs <= 0) {
     Tracer::stage(dinst, "Wreg");
-    //printf("OOOProc::add_inst::smallregstall for  dinstID %lu\n", dinst->getID());
+    DLOG(rename, "OOOProc::add_inst::smallregstall for dinstID {}", dinst->getID());
     return SmallREGStall;
   }
 
@@ -283,9 +317,9 @@ StallCause OoOProcessor::add_inst(Dinst* dinst) {
 
   StallCause sc = cluster->canIssue(dinst);
   if (sc != NoStall) {
-    // printf("OOOP::add_inst !cluster->canissue wcls dinstID %ld\n", dinst->getID());
+    DLOG(rename, "OOOP::add_inst !cluster->canissue wcls dinstID {}", dinst->getID());
     Tracer::stage(dinst, "Wcls");
-    //printf("OOOProc::add_inst::small Wcls stall for  dinstID %lu\n", dinst->getID());
+    DLOG(rename, "OOOProc::add_inst::small Wcls stall for dinstID {}", dinst->getID());
     return sc;
   }
 
@@ -301,7 +335,7 @@ StallCause OoOProcessor::add_inst(Dinst* dinst) {
 #endif
 
   if (!scooreMemory) {  // no dynamic serialization for tradcore
-    // printf("ooop::add_inst !scooreMemory dinstID %ld\n", dinst->getID());
+    DLOG(rename, "ooop::add_inst !scooreMemory dinstID {}", dinst->getID());
     if (serialize_for > 0 && !replayRecovering) {
       serialize_for--;
       if (inst->isMemory() && dinst->isSrc3Ready()) {
@@ -362,7 +396,7 @@ StallCause OoOProcessor::add_inst(Dinst* dinst) {
             dinst->setSerializeEntry(&serializeRAT[last_serializeLogical]);
             serializeRAT[last_serializeLogical] = dinst;
           } else {
-            // printf("ooop::add_inst serializeRAT  dinstID %ld\n", dinst->getID());
+            DLOG(rename, "ooop::add_inst serializeRAT dinstID {}", dinst->getID());
             serializeRAT[inst->getDst1()] = nullptr;
             serializeRAT[inst->getDst2()] = nullptr;
           }
@@ -373,67 +407,67 @@ StallCause OoOProcessor::add_inst(Dinst* dinst) {
 
   nInst[inst->getOpcode()]->inc(dinst->has_stats());  // FIXME: move to cluster
 
-  ROB.push(dinst);
+  push_rob(dinst);
   if (is_load_spec(dinst)) {
     dinst->set_spec();
   }
   dinst->set_present_in_rob();
   I(dinst->getCluster() != 0);  // Resource::schedule must set the resource field
 
-  // printf("OOOProc::add_inst and dumprat before adding in RAT%ld\n", dinst->getID());
+  DLOG(rename, "OOOProc::add_inst and dumprat before adding in RAT{}", dinst->getID());
   // dump_rat();
   int n = 0;
   if (!dinst->isSrc2Ready()) {
     // It already has a src2 dep. It means that it is solved at
     // retirement (Memory consistency. coherence issues)
 
-    //printf("OOOProc::add_inst !dinst->isSrc2Ready(): :: src2 RAW dep for Inst %lu \n", dinst->getID());
+    DLOG(rename, "OOOProc::add_inst !dinst->isSrc2Ready(): :: src2 RAW dep for Inst {}", dinst->getID());
 
     if (TRAT[inst->getSrc1()] && dinst->isTransient()) {
       TRAT[inst->getSrc1()]->addSrc1(dinst);
-      //printf("OOOProc::add_inst TRAT[] addSrc1 %lu\n", dinst->getID());
+      DLOG(rename, "OOOProc::add_inst TRAT[] addSrc1 {}", dinst->getID());
       n++;
       // MSG("addDep0 %8ld->%8lld %lld",RAT[inst->getSrc1()]->getID(), dinst->getID(), globalClock);
     } else {
       if (RAT[inst->getSrc1()] && !dinst->isTransient()) {
         RAT[inst->getSrc1()]->addSrc1(dinst);
-        //printf("OOOProc::add_inst RAT[] addSrc1 %lu\n", dinst->getID());
+        DLOG(rename, "OOOProc::add_inst RAT[] addSrc1 {}", dinst->getID());
         n++;
         // MSG("addDep0 %8ld->%8lld %lld",RAT[inst->getSrc1()]->getID(), dinst->getID(), globalClock);
       }
     }
   } else {  //(dinst->isSrc2Ready())
-    //printf("OOOProc::add_inst has dinst->isSrc2Ready():: no src2 dep:: for Inst  %lu \n", dinst->getID());
+    DLOG(rename, "OOOProc::add_inst has dinst->isSrc2Ready():: no src2 dep:: for Inst {}", dinst->getID());
 
     if (TRAT[inst->getSrc1()] && dinst->isTransient()) {
       TRAT[inst->getSrc1()]->addSrc1(dinst);
-      //printf("OOOProc::add_inst addSrc1 TART[] %lu\n", dinst->getID());
+      DLOG(rename, "OOOProc::add_inst addSrc1 TART[] {}", dinst->getID());
       n++;
       // MSG("addDep0 %8ld->%8lld %lld",RAT[inst->getSrc1()]->getID(), dinst->getID(), globalClock);
     } else {
       if (RAT[inst->getSrc1()] && !dinst->isTransient()) {
-        //printf("OOOProc::add_inst addSrc1 RAT[] %lu\n", dinst->getID());
+        DLOG(rename, "OOOProc::add_inst addSrc1 RAT[] {}", dinst->getID());
         RAT[inst->getSrc1()]->addSrc1(dinst);
         n++;
         // MSG("addDep1 %8ld->%8lld %lld",RAT[inst->getSrc1()]->getID(), dinst->getID(), globalClock);
       } else {
-        //printf("OOOProc::add_inst dinst->isSrc2Ready():: no RAT Src1 entry for %lu \n", dinst->getID());
+        DLOG(rename, "OOOProc::add_inst dinst->isSrc2Ready():: no RAT Src1 entry for {}", dinst->getID());
       }
     }
 
     if (TRAT[inst->getSrc2()] && dinst->isTransient()) {
       TRAT[inst->getSrc2()]->addSrc2(dinst);
-      //printf("OOOProc::add_inst TRAT[] addSrc2 %lu\n", dinst->getID());
+      DLOG(rename, "OOOProc::add_inst TRAT[] addSrc2 {}", dinst->getID());
       n++;
       // MSG("addDep0 %8ld->%8lld %lld",RAT[inst->getSrc1()]->getID(), dinst->getID(), globalClock);
     } else {
       if (RAT[inst->getSrc2()] && !dinst->isTransient()) {
-        //printf("OOOProc::add_inst addSrc2 RAT[] %lu\n", dinst->getID());
+        DLOG(rename, "OOOProc::add_inst addSrc2 RAT[] {}", dinst->getID());
         RAT[inst->getSrc2()]->addSrc2(dinst);
         n++;
         // MSG("addDep2 %8ld->%8lld %lld",RAT[inst->getSrc2()]->getID(), dinst->getID(), globalClock);
       } else {
-        //printf("OOOProc::add_inst dinst->isSrc2Ready():: no RAT Src2 entry for %lu \n", dinst->getID());
+        DLOG(rename, "OOOProc::add_inst dinst->isSrc2Ready():: no RAT Src2 entry for {}", dinst->getID());
       }
     }
   }  // end (!dinst->isSrc2Ready())
@@ -444,7 +478,7 @@ StallCause OoOProcessor::add_inst(Dinst* dinst) {
   (void)n;
 #endif
 
-  // printf("OOOPROCCESOR::add_inst : RAT entry instID %ld\n", dinst->getID());
+  DLOG(rename, "OOOPROCCESOR::add_inst : RAT entry instID {}", dinst->getID());
 
   if (dinst->isTransient()) {
     dinst->setRAT1Entry(&TRAT[inst->getDst1()]);
@@ -472,9 +506,9 @@ StallCause OoOProcessor::add_inst(Dinst* dinst) {
 
   dinst->markRenamed();
   Tracer::stage(dinst, "RN");
-  // printf("OOOPROCCESOR::add_inst :  done rename instID %ld\n", dinst->getID());
+  DLOG(rename, "OOOPROCCESOR::add_inst : done rename instID {}", dinst->getID());
 
-  // printf("OOOProc::add_inst and dumprat after adding in RAT%ld\n", dinst->getID());
+  DLOG(rename, "OOOProc::add_inst and dumprat after adding in RAT{}", dinst->getID());
   // dump_rat();
 
 #ifdef WAVESNAP_EN
@@ -494,7 +528,7 @@ StallCause OoOProcessor::add_inst(Dinst* dinst) {
   // dinst->getCluster()->add_inst_retry(dinst);
   // lima}
 
-  // printf("OOOProc::add_inst %ld Exiting add_inst with NoStall \n", dinst->getID());
+  DLOG(rename, "OOOProc::add_inst {} Exiting add_inst with NoStall", dinst->getID());
   return NoStall;
 }
 /* }}} */
@@ -525,7 +559,7 @@ void OoOProcessor::retire_lock_check()
 /* }}} */
 
 void OoOProcessor::try_flush(Dinst* dinst) {
-  // printf("OOOProcessor::try_flush for Inst %ld\n", dinst->getID());
+  DLOG(rob, "OOOProcessor::try_flush for Inst {}", dinst->getID());
   if (dinst->getInst()->hasDstRegister()) {
     nTotalRegs++;
   }
@@ -572,9 +606,10 @@ void OoOProcessor::retire() {
         nTotalRegs++;
       }
       Tracer::event(dinst, "PNR");
-      //printf("OOOProcessor::retire::Transient poping from rob Inst %lu and ROB size is %zu\n",
-             //dinst->getID(),
-             //(ROB.size() + rROB.size()));
+      DLOG(transient,
+           "OOOProcessor::retire::Transient poping from rob Inst {} and ROB size is {}",
+           dinst->getID(),
+           (ROB.size() + rROB.size()));
       dinst->destroyTransientInst();
       ROB.pop();
       continue;
@@ -611,13 +646,15 @@ void OoOProcessor::retire() {
       Tracer::event(dinst, "PNR");
       rROB.push(dinst);
       ROB.pop();
-      //printf("OOOProcessor::retire::poping from ROB Inst %lu and ROB size is %zu and rROB size is %zu\n",
-             //dinst->getID(),
-             //ROB.size(),
-             //rROB.size());
-      //printf("OOOProcessor::retire::After poping from ROB Inst %lu and TOTAL_ROB size is %zu\n ",
-             //dinst->getID(),
-             //ROB.size() + rROB.size());
+      DLOG(rob,
+           "OOOProcessor::retire::poping from ROB Inst {} and ROB size is {} and rROB size is {}",
+           dinst->getID(),
+           ROB.size(),
+           rROB.size());
+      DLOG(rob,
+           "OOOProcessor::retire::After poping from ROB Inst {} and TOTAL_ROB size is {}",
+           dinst->getID(),
+           ROB.size() + rROB.size());
     }
   }  //! ROB.empty()_loop_end
 
@@ -694,10 +731,7 @@ void OoOProcessor::retire() {
   for (uint16_t i = 0; i < RetireWidth && !rROB.empty(); i++) {
     Dinst* dinst = rROB.top();
     dinst->mark_rrob();
-    //printf("OOOProcessor::retire::rROB Inst %lu and ROB size is %zu and rROB size is %zu\n",
-           //dinst->getID(),
-           //ROB.size(),
-           //rROB.size());
+    DLOG(rob, "OOOProcessor::retire::rROB Inst {} and ROB size is {} and rROB size is {}", dinst->getID(), ROB.size(), rROB.size());
     // dumpROB();
     /*if (dinst->is_load_destroyed()) {
       break;
@@ -718,23 +752,24 @@ void OoOProcessor::retire() {
 #ifdef SUPERDUMP
       if (rROB.size() > 8) {
         dinst->getInst()->dump("not ret");
-        //printf("----------------------\n");
+        DLOG(rob, "----------------------");
         dumpROB();
       }
 #endif
       break;
     }
 
-    //printf("OOOProcessor::retire:: cluster assigned  Inst %lu\n ", dinst->getID());
+    DLOG(rob, "OOOProcessor::retire:: cluster assigned Inst {}", dinst->getID());
     if (!dinst->is_spec()) {
       I(dinst->getCluster());
     }
 
     bool done = dinst->getCluster()->retire(dinst, flushing);
     if (!done) {
-      //printf("OOOProcessor::retire::!done cluster->retire() for ROB Inst %lu and TOTAL_ROB size is %zu\n ",
-             //dinst->getID(),
-             //ROB.size() + rROB.size());
+      DLOG(rob,
+           "OOOProcessor::retire::!done cluster->retire() for ROB Inst {} and TOTAL_ROB size is {}",
+           dinst->getID(),
+           ROB.size() + rROB.size());
       break;
     }
 
@@ -744,7 +779,7 @@ void OoOProcessor::retire() {
       flushing_fid = smt_hid;  // It can be different from hid due to SMT
     }
 
-    nCommitted.inc(!flushing && dinst->has_stats());
+    count_commit(dinst, !flushing && dinst->has_stats());
 
 #ifdef ESESC_BRANCHPROFILE
     if (dinst->getInst()->isBranch() && dinst->has_stats()) {
@@ -813,30 +848,31 @@ void OoOProcessor::retire() {
       I(dinst->isPerformed());
     }
 
-    //printf("OOOProcessor::retire::Marked Retire Inst %lu and TOTAL_ROB size is %zu\n ", dinst->getID(), ROB.size() + rROB.size());
+    DLOG(rob, "OOOProcessor::retire::Marked Retire Inst {} and TOTAL_ROB size is {}", dinst->getID(), ROB.size() + rROB.size());
     dinst->mark_retired();
     Tracer::commit(dinst);
     if (dinst->isPerformed() && !dinst->getInst()->isLoad()) {  // Stores can perform after retirement
-      //printf("OOOProcessor::retire::Destroying  Inst %lu and TOTAL_ROB size is %zu\n ", dinst->getID(), ROB.size() + rROB.size());
+      DLOG(rob, "OOOProcessor::retire::Destroying Inst {} and TOTAL_ROB size is {}", dinst->getID(), ROB.size() + rROB.size());
       dinst->destroy();
     }
     if (dinst->isPerformed() && dinst->is_load_scb_all()) {  // Stores can perform after retirement
-      //printf("OOOProcessor::retire::Destroying  Inst %lu and TOTAL_ROB size is %zu\n ", dinst->getID(), ROB.size() + rROB.size());
+      DLOG(rob, "OOOProcessor::retire::Destroying Inst {} and TOTAL_ROB size is {}", dinst->getID(), ROB.size() + rROB.size());
       dinst->destroy();
     }
 
     if (dinst->is_load_destroyed_retired_spec() && dinst->is_load_destroyed_retired_safe_write()) {
       /*both the FULoad::performed_spec and FULoad::performed_safe_write need to be execute before destroy in retire*/
-      //printf("OOOProcessor::retire::Destroying LOADdestroying Inst %lu and TOTAL_ROB size is %zu\n ",
-             //dinst->getID(),
-             //ROB.size() + rROB.size());
+      DLOG(rob,
+           "OOOProcessor::retire::Destroying LOADdestroying Inst {} and TOTAL_ROB size is {}",
+           dinst->getID(),
+           ROB.size() + rROB.size());
       dinst->destroy();
     }
 
-    //printf("OOOProcessor::retire::Before rROB.pop rROB size is %ld and rROB size is %ld\n", ROB.size(), rROB.size());
+    DLOG(rob, "OOOProcessor::retire::Before rROB.pop rROB size is {} and rROB size is {}", ROB.size(), rROB.size());
     // dumpROB();
     rROB.pop();
-    //printf("OOOProcessor::retire::After rROB.pop  rROB size is %ld and rROB size is %ld\n", ROB.size(), rROB.size());
+    DLOG(rob, "OOOProcessor::retire::After rROB.pop rROB size is {} and rROB size is {}", ROB.size(), rROB.size());
     // dumpROB();
   }  // !rROB.empty()_loop_ends
 }
@@ -44,7 +44,7 @@ private:
   const bool    MemoryReplay;
   const int32_t RetireDelay;
 
-  LSQFull lsq;
+  LSQAddr lsq;
 
   uint32_t serialize_level;
   uint32_t serialize;
@@ -64,6 +64,7 @@ private:
   bool   replayRecovering;
   Time_t replayID;
   bool   flushing;
+  bool   retire_idle;  // the last retire() did not move the ROB
 
   Hartid_t flushing_fid;
 
@@ -105,6 +106,9 @@ public:
   bool   isReplayRecovering() override final { return replayRecovering; }
   Time_t getReplayID() override final { return replayID; }
 
+  bool is_quiescent() const override final;
+  void skip_clock(Time_t n) override final;
+
   void dump_rat() {
     // auto rat_max= static_cast <int> ( RegType::LREG_MAX);
 
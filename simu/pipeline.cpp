@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "config.hpp"
+#include "debug_log.hpp"
 #include "gprocessor.hpp"
 
 IBucket::IBucket(size_t size, Pipeline* p, bool clean) : FastQueue<Dinst*>(size), cleanItem(clean), pipeLine(p) {}
@@ -19,9 +20,9 @@ void IBucket::markFetched() {
     //    if (top()->getFlowId())
   }
 
-  //printf("Pipeline::markFetched:: Came from FetchEngine:: Memrequest at @Clockcyle %lu\n", globalClock);
-  //printf("Pipeline::markfetched::bucket->PipelineID is %lu at @Clockcyle %lu \n", this->getPipelineId(), globalClock);
-  //printf("Pipeline::markFetched::Now send to pipeline::readyitem at @clock %lu\n", globalClock);
+  DLOG(fetch, "Pipeline::markFetched:: Came from FetchEngine:: Memrequest");
+  DLOG(fetch, "Pipeline::markfetched::bucket->PipelineID is {}", this->getPipelineId());
+  DLOG(fetch, "Pipeline::markFetched::Now send to pipeline::readyitem");
   pipeLine->readyItem(this);
 }
 
@@ -42,7 +43,7 @@ Pipeline::Pipeline(size_t s, size_t fetch, int32_t maxReqs)
 
   bucketPool.reserve(bucketPoolMaxSize);
   I(bucketPool.empty());
-  //printf("Pipeline::Pipeline:: bucketPoolMaxSize is %ld\n", bucketPoolMaxSize);
+  DLOG(fetch, "Pipeline::Pipeline:: bucketPoolMaxSize is {}", bucketPoolMaxSize);
 
   for (size_t i = 0; i < bucketPoolMaxSize; i++) {
     IBucket* ib = new IBucket(fetch + 1, this);  // +1 instructions
@@ -71,7 +72,7 @@ Pipeline::~Pipeline() {
 // push fetched Inst(IF->PipelineQ) into PipelineQ
 // Buffer is the biggest one: buckets resides inside buffer
 void Pipeline::readyItem(IBucket* b) {
-  // printf("Pipeline::readyitem::Entering readyitem \n");
+  DLOG(fetch, "Pipeline::readyitem::Entering readyitem");
   b->setClock();
   b->reset_transient();
   nIRequests++;
@@ -83,18 +84,18 @@ void Pipeline::readyItem(IBucket* b) {
       I(dinst);
       I(!dinst->is_present_in_rob());
       if (dinst->isTransient()) {
-        //printf("Pipeline::itemready  transient destroy instID %lu\n", dinst->getID());
+        DLOG(transient, "Pipeline::itemready transient destroy instID {}", dinst->getID());
         dinst->destroyTransientInst();
         b->pop_from_back();
       } else {
-        // printf("Pipeline::itemready NOT TRansient anymore instID %lu\n", dinst->getID());
+        DLOG(fetch, "Pipeline::itemready NOT TRansient anymore instID {}", dinst->getID());
         break;
       }
     }
   }*/
       
       /*else {
-        // printf("Pipeline::flush_transient_int_from_Pipelinebuffer No inst in PipeLineBuffer \n");
+        DLOG(transient, "Pipeline::flush_transient_int_from_Pipelinebuffer No inst in PipeLineBuffer");
         if (bucket->empty()) {
           doneItem(bucket);
         }
@@ -106,14 +107,11 @@ void Pipeline::readyItem(IBucket* b) {
 
   // out-of-order pipelineId are kept separately in recieved; latter works on them
   if (b->getPipelineId() != minItemCntr) {
-    // printf(
-        // "Pipeline::readyitem-->recieved.push(b) PipelineID != minItemCntr !!!\nbucket->PipelineID is %llu and minItemCntr is %llu "
-        // "\n",
-        // b->getPipelineId(),
-        // minItemCntr);
-    // printf("Pipeline::readyitem::recived.push(bucket)::not actual !buffer.push() inst  %llu at @clockcycle %llu\n",
-           // b->top()->getID(),
-           // globalClock);
+    DLOG(fetch,
+         "Pipeline::readyitem-->recieved.push(b) PipelineID != minItemCntr !!! bucket->PipelineID is {} and minItemCntr is {}",
+         b->getPipelineId(),
+         minItemCntr);
+    DLOG(fetch, "Pipeline::readyitem::recived.push(bucket)::not actual !buffer.push() inst {}", b->top()->getID());
     received.push(b);
     return;
   }
@@ -121,29 +119,31 @@ void Pipeline::readyItem(IBucket* b) {
   // If the message is received in-order. Do not use the sorting
   // receive structure (remember that a cache can respond
   // out-of-order the memory requests)
-  // printf("Pipeline::readyitem-->PipelineID == minItemCntr !!!\nbucket->PipelineID is %llu and minItemCntr is %llu \n",
-         // b->getPipelineId(),
-         // minItemCntr);
+  DLOG(fetch,
+       "Pipeline::readyitem-->PipelineID == minItemCntr !!! bucket->PipelineID is {} and minItemCntr is {}",
+       b->getPipelineId(),
+       minItemCntr);
   minItemCntr++;
-  // printf("Pipeline::readyitem:: minItemCntr++ bucket->PipelineID is %llu and minItemCntr is %llu \n",
-         // b->getPipelineId(),
-         // minItemCntr);
+  DLOG(fetch,
+       "Pipeline::readyitem:: minItemCntr++ bucket->PipelineID is {} and minItemCntr is {}",
+       b->getPipelineId(),
+       minItemCntr);
 
   if (b->empty()) {
-    //printf("Pipeline::readyitem::bufferEmpty buffer size is %lu\n", buffer.size());
+    DLOG(fetch, "Pipeline::readyitem::bufferEmpty buffer size is {}", buffer.size());
     doneItem(b);
   } else {
     buffer.push(b);
-    //printf("Pipeline::readyitem::buffersize is %lu\n", buffer.size());
-    //printf("Pipeline::ReadyItem::pushing bucket--into-->buffer:: inst %lu at @clockcycle %lu\n", b->top()->getID(), globalClock);
+    DLOG(fetch, "Pipeline::readyitem::buffersize is {}", buffer.size());
+    DLOG(fetch, "Pipeline::ReadyItem::pushing bucket--into-->buffer:: inst {}", b->top()->getID());
   }
   // clear received
   clearItems();
 }
 
 void Pipeline::clearItems() {
-  // printf("Pipeline::clearitem::Entering clearitem \n");
-  // printf("Pipeline::clearitem::minItemCntr :: Before minItemCntr is %llu \n", minItemCntr);
+  DLOG(fetch, "Pipeline::clearitem::Entering clearitem");
+  DLOG(fetch, "Pipeline::clearitem::minItemCntr :: Before minItemCntr is {}", minItemCntr);
   
   // Check if minItemCntr was already freed during transient flush
   //flushedPipelineIDs={4,5,10}
@@ -153,8 +153,7 @@ void Pipeline::clearItems() {
       // Check if minItemCntr was already freed during transient flush
     auto it = std::find(flushedPipelineIDs.begin(), flushedPipelineIDs.end(), minItemCntr);
     if (it != flushedPipelineIDs.end()) {
-      //printf("Pipeline::clearitem::skipping flushed pipelineId %ld minItemCntr now %ld\n",
-               //minItemCntr, minItemCntr + 1);
+      DLOG(fetch, "Pipeline::clearitem::skipping flushed pipelineId {} minItemCntr now {}", minItemCntr, minItemCntr + 1);
       flushedPipelineIDs.erase(it);
       minItemCntr++;
       continue;  // keep looping — next ID might also be in flushedPipelineIDs
@@ -170,7 +169,7 @@ void Pipeline::clearItems() {
     //if(b->getPipelineId() == minItemCntr) starts herei!!!
     received.pop();
     minItemCntr++;
-    //printf("Pipeline::clearitem::minItemCntr++ now %ld\n", minItemCntr);
+    DLOG(fetch, "Pipeline::clearitem::minItemCntr++ now {}", minItemCntr);
       
     if (b->empty()) {
       doneItem(b);
@@ -185,8 +184,8 @@ void Pipeline::clearItems() {
 
 
 /*void Pipeline::clearItems() {
-  // printf("Pipeline::clearitem::Entering clearitem \n");
-  // printf("Pipeline::clearitem::minItemCntr :: Before minItemCntr is %llu \n", minItemCntr);
+  DLOG(fetch, "Pipeline::clearitem::Entering clearitem");
+  DLOG(fetch, "Pipeline::clearitem::minItemCntr :: Before minItemCntr is {}", minItemCntr);
   while (!received.empty()) {
     IBucket* b = received.top();
 
@@ -196,10 +195,10 @@ void Pipeline::clearItems() {
 
     received.pop();
 
-    // printf("Pipeline::clearitem::minItemCntr :: Before minItemCntr is %llu \n", minItemCntr);
+    DLOG(fetch, "Pipeline::clearitem::minItemCntr :: Before minItemCntr is {}", minItemCntr);
     // should be minItemCnt--
     minItemCntr++;
-    // printf("Pipeline::clearitem::minItemCntr++ ::AFter  minItemCntr is %llu \n", minItemCntr);
+    DLOG(fetch, "Pipeline::clearitem::minItemCntr++ ::AFter minItemCntr is {}", minItemCntr);
 
     if (b->empty()) {
       doneItem(b);
@@ -216,14 +215,18 @@ void Pipeline::doneItem(IBucket* b) {
   I(b->empty());
   b->clock = 0;
   b->reset_transient();
-  //printf("Pipeline::doneItem::bucket.empty()-->bucketpool.push() \n");
-  // printf("Pipeline::flush_buffer::bucket.empty()-->bucketpool.push() \n");
+  DLOG(fetch, "Pipeline::doneItem::bucket.empty()-->bucketpool.push()");
+  DLOG(fetch, "Pipeline::flush_buffer::bucket.empty()-->bucketpool.push()");
 
-  //printf("Pipeline::doneItem:: Before bucketPool Size is %ld and bucketPoolMaxSize is %ld\n", bucketPool.size(), bucketPoolMaxSize);
+  DLOG(fetch,
+       "Pipeline::doneItem:: Before bucketPool Size is {} and bucketPoolMaxSize is {}",
+       bucketPool.size(),
+       bucketPoolMaxSize);
   bucketPool.push_back(b);
-  //printf("Pipeline::doneItem:: After stocked bucketPool++ Size is %ld and bucketPoolMaxSize is %ld\n",
-         //bucketPool.size(),
-         //bucketPoolMaxSize);
+  DLOG(fetch,
+       "Pipeline::doneItem:: After stocked bucketPool++ Size is {} and bucketPoolMaxSize is {}",
+       bucketPool.size(),
+       bucketPoolMaxSize);
 }
 
 bool Pipeline::transient_buffer_empty() { return transient_buffer.empty(); }
@@ -231,7 +234,7 @@ bool Pipeline::transient_buffer_empty() { return transient_buffer.empty(); }
 IBucket* Pipeline::flush_transient_inst_from_bucket(IBucket* b) { return b; }
 
 void Pipeline::flush_transient_inst_from_buffer() {
-  // printf("Pipeline::flush_transient_int_from_Pipelinebuffer Entering before new fetch!!!\n");
+  DLOG(transient, "Pipeline::flush_transient_int_from_Pipelinebuffer Entering before new fetch!!!");
   while (!buffer.empty()) {
     auto* bucket = buffer.end_data();
     I(bucket);
@@ -242,11 +245,11 @@ void Pipeline::flush_transient_inst_from_buffer() {
       I(dinst);
       I(!dinst->is_present_in_rob());
       if (dinst->isTransient()) {
-        // printf("Pipeline::flush_transient_int_from_Pipelinebuffer destroy instID %llu\n", dinst->getID());
+        DLOG(transient, "Pipeline::flush_transient_int_from_Pipelinebuffer destroy instID {}", dinst->getID());
         dinst->destroyTransientInst();
         bucket->pop_from_back();
       } else {
-        // printf("Pipeline::flush_transient_int_from_Pipelinebuffer No inst in PipeLineBuffer \n");
+        DLOG(transient, "Pipeline::flush_transient_int_from_Pipelinebuffer No inst in PipeLineBuffer");
         if (bucket->empty()) {
           doneItem(bucket);
         }
@@ -254,47 +257,48 @@ void Pipeline::flush_transient_inst_from_buffer() {
       }
     }  // while_!bucket_empty buffer.pop();
     if (bucket->empty()) {
-      // printf("Pipeline::flush_buffer::bucket.empty()-->bucketpool.push() \n");
+      DLOG(transient, "Pipeline::flush_buffer::bucket.empty()-->bucketpool.push()");
       I(bucket->empty());
       doneItem(bucket);
       buffer.pop_from_back();
     } else {
       buffer.pop_from_back();
-      // printf("Pipeline::flush_buffer::!bucket.empty()-->!bucketpool.push() \n");
+      DLOG(transient, "Pipeline::flush_buffer::!bucket.empty()-->!bucketpool.push()");
     }
     // limamustbuffer.pop_from_back();
   }
 }
 
 void Pipeline::flush_transient_inst_from_received_bucket() {
-  //printf("Pipeline::flush_transient_int_from_received_bucket Entering !!!\n");
-  //printf("Pipeline::flush_transient_int_from_received_bucket Stocked bucketPool.Size is %ld\n", bucketPool.size());
+  DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket Entering !!!");
+  DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket Stocked bucketPool.Size is {}", bucketPool.size());
   std::vector<IBucket*> to_return;  // non-empty buckets go back into received
 
   if(received.empty()) {
-    //printf("Pipeline::flush_transient_int_from_Received_bucket OH!!! Received empty return!!!\n");
+    DLOG(transient, "Pipeline::flush_transient_int_from_Received_bucket OH!!! Received empty return!!!");
     return;
   }
 
   while (!received.empty()) {
     IBucket* bucket = received.top();
     received.pop();
-     //printf("Pipeline::flush_transient_int_from_Received_bucket New Bucket Started!!! \n");
+    DLOG(transient, "Pipeline::flush_transient_int_from_Received_bucket New Bucket Started!!!");
 
     if (bucket) {
       while (!bucket->empty()) {
-       //printf("Pipeline::flush_transient_int_from_Received_bucket Bucket:: bucket->PipelineID is %lu and minItemCntr is %lu \n",
-               //bucket->getPipelineId(),
-               //minItemCntr);
+        DLOG(transient,
+             "Pipeline::flush_transient_int_from_Received_bucket Bucket:: bucket->PipelineID is {} and minItemCntr is {}",
+             bucket->getPipelineId(),
+             minItemCntr);
         auto* dinst = bucket->end_data();
         I(dinst);
         I(!dinst->is_present_in_rob());
         if (dinst->isTransient()) {
-          //printf("Pipeline::flush_transient_int_from_received_bucket destroy instID %lu\n", dinst->getID());
+          DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket destroy instID {}", dinst->getID());
           dinst->destroyTransientInst();
           bucket->pop_from_back();
         } else {
-          //printf("Pipeline::flush_transient_int_from_received_bucket Not Transient so BREAK!!!instID %lu\n", dinst->getID());
+          DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket Not Transient so BREAK!!!instID {}", dinst->getID());
           break;// stop at first non-transient
         }
       }  // bucket_empty_while_loop_end
@@ -309,14 +313,14 @@ void Pipeline::flush_transient_inst_from_received_bucket() {
         bucket->clock = 0;
         bucket->reset_transient();
         bucketPool.push_back(bucket);
-        //printf("Pipeline::flush_transient_int_from_Received_bucket Yahoo!!! bucket==empty!!! \n");
-        //printf("Pipeline::flush_received freed pipelineId %ld to pushing to bucketpool\n", bucket->getPipelineId());
-        //printf("Pipeline::flush_transient_int_from_received_bucket Stocked bucketPool.Size is %ld\n", bucketPool.size());
+        DLOG(transient, "Pipeline::flush_transient_int_from_Received_bucket Yahoo!!! bucket==empty!!!");
+        DLOG(transient, "Pipeline::flush_received freed pipelineId {} to pushing to bucketpool", bucket->getPipelineId());
+        DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket Stocked bucketPool.Size is {}", bucketPool.size());
       } else {
         // Still has non-transient instructions — put back
         to_return.push_back(bucket);
-        //printf("Pipeline::flush_transient_int_from_Received_bucket Yahoo!!! bucket!=empty!!! \n");
-        //printf("Pipeline::flush_received freed pipelineId %ld has Non Transient Inst :to_return\n", bucket->getPipelineId());
+        DLOG(transient, "Pipeline::flush_transient_int_from_Received_bucket Yahoo!!! bucket!=empty!!!");
+        DLOG(transient, "Pipeline::flush_received freed pipelineId {} has Non Transient Inst :to_return", bucket->getPipelineId());
       }
     
     
@@ -325,7 +329,7 @@ void Pipeline::flush_transient_inst_from_received_bucket() {
     for (auto* b : to_return) {
       received.push(b);
     }
-  //printf("Pipeline::flush_transient_int_from_received_bucket Leaving !!!\n");
+  DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket Leaving !!!");
 }
       
       
@@ -337,27 +341,27 @@ void Pipeline::flush_transient_inst_from_received_bucket() {
       
       
       if (bucket->getPipelineId() == minItemCntr) {
-        // printf(
-            // "Pipeline::flush_transient_int_from_Received_bucket Bucket minItemcntr++ ::PipelineID == minItemCntr "
-            // "!!!\nbucket->PipelineID is %llu and minItemCntr is %llu \n",
-            // bucket->getPipelineId(),
-            // minItemCntr);
+        DLOG(transient,
+             "Pipeline::flush_transient_int_from_Received_bucket Bucket minItemcntr++ ::PipelineID == minItemCntr !!!"
+             " bucket->PipelineID is {} and minItemCntr is {}",
+             bucket->getPipelineId(),
+             minItemCntr);
         minItemCntr++;
       }
 
       if (bucket->getPipelineId() != minItemCntr) {
-        // printf(
-            // "Pipeline::flush_transient_int_from_Received_bucket Bucket ended BREAK PipelineID != minItemCntr "
-            // "!!!\nbucket->PipelineID is %llu and minItemCntr is %llu \n",
-            // bucket->getPipelineId(),
-            // minItemCntr);
+        DLOG(transient,
+             "Pipeline::flush_transient_int_from_Received_bucket Bucket ended BREAK PipelineID != minItemCntr !!!"
+             " bucket->PipelineID is {} and minItemCntr is {}",
+             bucket->getPipelineId(),
+             minItemCntr);
 
         bucket->set_transient();
         break;
       }
       if (bucket->empty()) {
         bucket->clock = 0;
-        printf("Pipeline::flush_transient_int_from_Received_bucket BucketEmpty-->Push to BucketPOOL!!! \n");
+        DLOG(transient, "Pipeline::flush_transient_int_from_Received_bucket BucketEmpty-->Push to BucketPOOL!!!");
         doneItem(bucket);
       }
       received.pop();
@@ -367,17 +371,17 @@ void Pipeline::flush_transient_inst_from_received_bucket() {
 */
 
 /*void Pipeline::flush_transient_inst_from_received_bucket() {
-   printf("Pipeline::flush_transient_int_from_received_bucket Entering before new fetch!!!\n");
-   printf("Pipeline::flush_transient_int_from_received_bucket Stocked bucketPool.Size is %ld\n", bucketPool.size());
+  DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket Entering before new fetch!!!");
+  DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket Stocked bucketPool.Size is {}", bucketPool.size());
   while (!received.empty()) {
     IBucket* bucket = received.top();
-    // printf("Pipeline::flush_transient_int_from_Received_bucket New Bucket Started!!! \n");
+    DLOG(transient, "Pipeline::flush_transient_int_from_Received_bucket New Bucket Started!!!");
     if (bucket->getPipelineId() != minItemCntr) {
-      // printf(
-          // "Pipeline::flush_transient_int_from_Received_bucket Bucket ended BREAK PipelineID != minItemCntr !!!\nbucket->PipelineID "
-          // "is %llu and minItemCntr is %llu \n",
-          // bucket->getPipelineId(),
-          // minItemCntr);
+      DLOG(transient,
+           "Pipeline::flush_transient_int_from_Received_bucket Bucket ended BREAK PipelineID != minItemCntr !!!"
+           " bucket->PipelineID is {} and minItemCntr is {}",
+           bucket->getPipelineId(),
+           minItemCntr);
 
       bucket->set_transient();
       break;
@@ -385,44 +389,45 @@ void Pipeline::flush_transient_inst_from_received_bucket() {
 
     if (bucket) {
       while (!bucket->empty()) {
-        // printf("Pipeline::flush_transient_int_from_Received_bucket Bucket:: bucket->PipelineID is %llu and minItemCntr is %llu \n",
-               // bucket->getPipelineId(),
-               // minItemCntr);
+        DLOG(transient,
+             "Pipeline::flush_transient_int_from_Received_bucket Bucket:: bucket->PipelineID is {} and minItemCntr is {}",
+             bucket->getPipelineId(),
+             minItemCntr);
         auto* dinst = bucket->end_data();
         I(dinst);
         I(!dinst->is_present_in_rob());
         if (dinst->isTransient()) {
-          // printf("Pipeline::flush_transient_int_from_received_bucket destroy instID %llu\n", dinst->getID());
+          DLOG(transient, "Pipeline::flush_transient_int_from_received_bucket destroy instID {}", dinst->getID());
           dinst->destroyTransientInst();
           bucket->pop_from_back();
         } else {
           return;  // Nothing else to do
         }
       }  // bucket_empty_while
-      // printf("Pipeline::flush_transient_int_from_Received_bucket Yahoo!!! 1 Bucket ended:: bucket==empty!!! \n");
+      DLOG(transient, "Pipeline::flush_transient_int_from_Received_bucket Yahoo!!! 1 Bucket ended:: bucket==empty!!!");
 
       if (bucket->getPipelineId() == minItemCntr) {
-        // printf(
-            // "Pipeline::flush_transient_int_from_Received_bucket Bucket minItemcntr++ ::PipelineID == minItemCntr "
-            // "!!!\nbucket->PipelineID is %llu and minItemCntr is %llu \n",
-            // bucket->getPipelineId(),
-            // minItemCntr);
+        DLOG(transient,
+             "Pipeline::flush_transient_int_from_Received_bucket Bucket minItemcntr++ ::PipelineID == minItemCntr !!!"
+             " bucket->PipelineID is {} and minItemCntr is {}",
+             bucket->getPipelineId(),
+             minItemCntr);
         minItemCntr++;
       }
 
       if (bucket->getPipelineId() != minItemCntr) {
-        // printf(
-            // "Pipeline::flush_transient_int_from_Received_bucket Bucket ended BREAK PipelineID != minItemCntr "
-            // "!!!\nbucket->PipelineID is %llu and minItemCntr is %llu \n",
-            // bucket->getPipelineId(),
-            // minItemCntr);
+        DLOG(transient,
+             "Pipeline::flush_transient_int_from_Received_bucket Bucket ended BREAK PipelineID != minItemCntr !!!"
+             " bucket->PipelineID is {} and minItemCntr is {}",
+             bucket->getPipelineId(),
+             minItemCntr);
 
         bucket->set_transient();
         break;
       }
       if (bucket->empty()) {
         bucket->clock = 0;
-        printf("Pipeline::flush_transient_int_from_Received_bucket BucketEmpty-->Push to BucketPOOL!!! \n");
+        DLOG(transient, "Pipeline::flush_transient_int_from_Received_bucket BucketEmpty-->Push to BucketPOOL!!!");
         doneItem(bucket);
       }
       received.pop();
@@ -431,12 +436,12 @@ void Pipeline::flush_transient_inst_from_received_bucket() {
 }
 */
 IBucket* Pipeline::nextItem() {
-  // printf("Pipeline::nextitem::Entering nextitem \n");
+  DLOG(fetch, "Pipeline::nextitem::Entering nextitem");
   while (1) {
     if (buffer.empty()) {
 #ifndef NDEBUG
       // It should not be possible to propagate more buckets
-      // printf("Pipeline::nextitem::Bufferempty+ so return NULL!!!\n");
+      DLOG(fetch, "Pipeline::nextitem::Bufferempty+ so return NULL!!!");
       clearItems();
       I(buffer.empty());
 #endif
@@ -454,10 +459,7 @@ IBucket* Pipeline::nextItem() {
     I(!b->empty());
     I(b->top() != nullptr);
 
-    if (b) {
-      // Dinst* dinst = b->top();
-      // printf("Pipeline::nextitem inst  %llu at @clockcycle %llu\n", dinst->getID(), globalClock);
-    }
+    DLOG(fetch, "Pipeline::nextitem inst {}", b->top()->getID());
     return b;
   }
 }
@@ -474,28 +476,30 @@ PipeQueue::~PipeQueue() {
 
 IBucket* Pipeline::newItem() {
   if (nIRequests == 0) {
-    //printf("Pipeline::Newitem:: No new item:: nIRequests==0 return FALSE::at @clockcycle %lu\n", globalClock);
+    DLOG(fetch, "Pipeline::Newitem:: No new item:: nIRequests==0 return FALSE");
     return 0;
   }
   if (bucketPool.empty()) {
-    //printf("Pipeline::Newitem:: No new item ::bucketPool.empty())::return FALSE::at @clockcycle %lu\n", globalClock);
+    DLOG(fetch, "Pipeline::Newitem:: No new item ::bucketPool.empty())::return FALSE");
     return 0;
   }
 
   nIRequests--;
 
   IBucket* b = bucketPool.back();
-  //printf("Pipeline::NewItem():: Before bucketPool Size is %ld and bucketPoolMaxSize is %ld\n",
-          //bucketPool.size(),
-         //bucketPoolMaxSize);
+  DLOG(fetch,
+       "Pipeline::NewItem():: Before bucketPool Size is {} and bucketPoolMaxSize is {}",
+       bucketPool.size(),
+       bucketPoolMaxSize);
   bucketPool.pop_back();
-  //printf("Pipeline::doneItem:: After bucketPool-- Size is %ld and bucketPoolMaxSize is %ld\n",
-         //bucketPool.size(),
-         //bucketPoolMaxSize);
+  DLOG(fetch,
+       "Pipeline::doneItem:: After bucketPool-- Size is {} and bucketPoolMaxSize is {}",
+       bucketPool.size(),
+       bucketPoolMaxSize);
 
   b->setPipelineId(maxItemCntr);
 
-  //printf("Pipeline::Newitem:: new item ::at bucket->PipelineId is %lu at @clockcycle %lu\n", maxItemCntr, globalClock);
+  DLOG(fetch, "Pipeline::Newitem:: new item ::at bucket->PipelineId is {}", maxItemCntr);
   maxItemCntr++;
 
 #ifndef NDEBUG
@@ -54,6 +54,7 @@ public:
   // FastQueue<Dinst *>   transient_buffer;
   [[nodiscard]] IBucket* newItem();
   [[nodiscard]] bool     hasOutstandingItems() const;
+  [[nodiscard]] bool     hasFreeItem() const { return nIRequests > 0 && !bucketPool.empty(); }
   void                   readyItem(IBucket* b);
   void                   doneItem(IBucket* b);
   void                   flush_transient_inst_from_buffer();
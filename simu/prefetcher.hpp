@@ -47,4 +47,10 @@ public:
 
   void exe(Dinst* dinst);
   void ret(Dinst* dinst);
+
+  void snapshot(Snapshot_io& ar, const std::string& name) {
+    if (apred) {
+      apred->snapshot(ar, name);
+    }
+  }
 };
@@ -291,7 +291,7 @@ void FULoad::executing(Dinst* dinst) {
   gen->schedule(dinst->has_stats(),
                 dinst->getID(),
                 dinst->isTransient(),
-                [this, dinst](Time_t allocated_time) { do_load_execution(allocated_time, dinst); });
+                do_load_executionPR::create(this, dinst));
 }
 
 /* }}} */
@@ -744,7 +744,7 @@ void FUStore::executing(Dinst* dinst) {
   gen->schedule(dinst->has_stats(),
                 dinst->getID(),
                 dinst->isTransient(),
-                [this, dinst](Time_t allocated_time) { do_store_execution(allocated_time, dinst); });
+                do_store_executionPR::create(this, dinst));
 }
 /* }}} */
 
@@ -928,7 +928,7 @@ void FUGeneric::executing(Dinst* dinst) {
   gen->schedule(dinst->has_stats(),
                 dinst->getID(),
                 dinst->isTransient(),
-                [this, dinst](Time_t allocated_time) { do_generic_execution(allocated_time, dinst); });
+                do_generic_executionPR::create(this, dinst));
 }
 /* }}} */
 
@@ -1021,7 +1021,7 @@ void FUBranch::executing(Dinst* dinst) {
   gen->schedule(dinst->has_stats(),
                 dinst->getID(),
                 dinst->isTransient(),
-                [this, dinst](Time_t allocated_time) { do_branch_execution(allocated_time, dinst); });
+                do_branch_executionPR::create(this, dinst));
 }
 /* }}} */
 
@@ -1146,7 +1146,7 @@ void FURALU::executing(Dinst* dinst) {
   gen->schedule(dinst->has_stats(),
                 dinst->getID(),
                 dinst->isTransient(),
-                [this, dinst](Time_t allocated_time) { do_ralu_execution(allocated_time, dinst); });
+                do_ralu_executionPR::create(this, dinst));
 }
 /* }}} */
 
@@ -155,6 +155,7 @@ private:
 
 
   void do_load_execution(Time_t when, Dinst* dinst);
+  using do_load_executionPR = PortRequestMember1<FULoad, Dinst*, &FULoad::do_load_execution>;
 
 protected:
   void cacheDispatched(Dinst* dinst);
@@ -184,6 +185,7 @@ private:
 
 
   void do_store_execution(Time_t when, Dinst* dinst);
+  using do_store_executionPR = PortRequestMember1<FUStore, Dinst*, &FUStore::do_store_execution>;
 
 public:
   FUStore(Opcode type, std::shared_ptr<Cluster> cls, std::shared_ptr<PortGeneric> aGen, LSQ* lsq, std::shared_ptr<StoreSet> ss,
@@ -206,6 +208,7 @@ class FUGeneric : public Resource {
 private:
 
   void do_generic_execution(Time_t when, Dinst* dinst);
+  using do_generic_executionPR = PortRequestMember1<FUGeneric, Dinst*, &FUGeneric::do_generic_execution>;
 
 protected:
 public:
@@ -231,6 +234,7 @@ private:
 
 
   void do_branch_execution(Time_t when, Dinst* dinst);
+  using do_branch_executionPR = PortRequestMember1<FUBranch, Dinst*, &FUBranch::do_branch_execution>;
 
 protected:
 public:
@@ -257,6 +261,7 @@ private:
 
 
   void do_ralu_execution(Time_t when, Dinst* dinst);
+  using do_ralu_executionPR = PortRequestMember1<FURALU, Dinst*, &FURALU::do_ralu_execution>;
 
 protected:
 public:
@@ -2,6 +2,8 @@
 
 #include "simu_base.hpp"
 
+#include <algorithm>
+
 #include "config.hpp"
 #include "fmt/format.h"
 
@@ -62,3 +64,16 @@ bool Simu_base::adjust_clock(bool en) {
 
   return true;
 }
+
+void Simu_base::skip_ticks(Time_t n, bool en) {
+  // same as n adjust_clock calls over globalClock+1 .. globalClock+n
+  clockTicks.add(n, en);
+
+  Time_t last = globalClock + n;
+  Time_t from = std::max(lastWallClock, globalClock);
+  if (en && last > from) {
+    wallclock.add(last - from, true);
+    lastWallClock = last;
+  }
+  activeclock_end = last;
+}
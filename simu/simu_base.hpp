@@ -35,6 +35,10 @@ protected:
   std::shared_ptr<Gmemory_system> memorySystem;
 
   bool adjust_clock(bool en);
+  void skip_ticks(Time_t n, bool en);
+
+  // Fractional clocks would have to replay the clock_counter
+  [[nodiscard]] bool can_skip_clock() const { return clock_ratio >= 1; }
 
   Simu_base(std::shared_ptr<Gmemory_system> gm, Hartid_t i);
 
@@ -63,4 +67,12 @@ public:
   virtual std::string get_type() const      = 0;
 
   virtual size_t get_smt_size() const { return 1; }
+
+  // Idle-cycle skip. A quiescent core does nothing but stall until a callback
+  // fires, and skip_clock accounts for n of those cycles at once
+  virtual bool is_quiescent() const { return false; }
+  virtual void skip_clock(Time_t n) { skip_ticks(n, true); }
+
+  // Long lived timing state (caches, predictors) for checkpoint/restore
+  virtual void snapshot(Snapshot_io& ar) { memorySystem->snapshot(ar); }
 };
@@ -2,11 +2,15 @@
 
 #include "store_buffer.hpp"
 
-#include "absl/container/flat_hash_map.h"
+#include <bit>
+
 #include "absl/strings/str_split.h"
 #include "config.hpp"
+#include "debug_log.hpp"
+#include "fmt/format.h"
 #include "memrequest.hpp"
 #include "resource.hpp"
+#include "tag_match.hpp"
 
 using ownership_doneCB = CallbackMember1<Store_buffer, Addr_t, &Store_buffer::ownership_done>;
 
@@ -30,203 +34,257 @@ Store_buffer::Store_buffer(Hartid_t hid, std::shared_ptr<Gmemory_system> ms) {
   scb_size        = Config::get_integer("soc", "core", hid, "scb_size", 1, 2048);
   scb_clean_lines = scb_size;
   // scb_lines_num       = 0;
+
+  if (line_size > 256) {
+    Config::add_error(fmt::format("store buffer tracks up to 64 words per line, {} line_size is {}", l1_sec, line_size));
+  }
+
+  // add_st only drops clean lines once over scb_size, so a couple more slots
+  n_lines = 0;
+  resize(scb_size + 2);
+}
+
+void Store_buffer::resize(size_t n_slots) {
+  auto old = tags.size();
+  I(n_slots > old);
+
+  tags.resize(n_slots, no_line);
+  words.resize(n_slots, 0);
+  states.resize(n_slots, Store_buffer_line::State::Invalid);
+  clean_bits.resize((n_slots + 63) / 64, 0);
+  transient_bits.resize((n_slots + 63) / 64, 0);
+
+  // lowest slots handed out first
+  for (auto i = n_slots; i > old; --i) {
+    free_slots.push_back(static_cast<uint32_t>(i - 1));
+  }
+}
+
+uint32_t Store_buffer::alloc_slot(Addr_t line) {
+  if (free_slots.empty()) {
+    // only when add_st is called without can_accept_st
+    resize(2 * tags.size());
+  }
+  auto slot = free_slots.back();
+  free_slots.pop_back();
+  I(tags[slot] == no_line);
+
+  tags[slot]  = line;
+  words[slot] = 0;
+  set_state(slot, Store_buffer_line::State::Uncoherent);
+  set_bit(transient_bits, slot, false);
+  ++n_lines;
+
+  return slot;
+}
+
+void Store_buffer::release_slot(uint32_t slot) {
+  I(tags[slot] != no_line);
+  tags[slot]   = no_line;
+  states[slot] = Store_buffer_line::State::Invalid;
+  set_bit(clean_bits, slot, false);
+  set_bit(transient_bits, slot, false);
+  free_slots.push_back(slot);
+  --n_lines;
+}
+
+template <typename F>
+size_t Store_buffer::release_if(const std::vector<uint64_t>& bits, F&& on_release) {
+  size_t num = 0;
+  for (size_t w = 0; w < bits.size(); ++w) {
+    // copy, release_slot clears the bits being walked
+    for (uint64_t b = bits[w]; b; b &= b - 1) {
+      auto slot = static_cast<uint32_t>(w * 64 + std::countr_zero(b));
+      on_release(tags[slot]);
+      release_slot(slot);
+      ++num;
+    }
+  }
+  return num;
+}
+
+int32_t Store_buffer::find_slot(Addr_t line) const {
+  return tag_match_first(tags.data(), static_cast<uint32_t>(tags.size()), line);
+}
+
+Store_buffer_line Store_buffer::get_line(Addr_t addr) const {
+  Store_buffer_line line;
+
+  auto slot = find_slot(calc_line(addr));
+  if (slot < 0) {
+    return line;
+  }
+  line.state        = states[slot];
+  line.transient    = get_bit(transient_bits, slot);
+  line.word_present = words[slot];
+  line.line_addr    = tags[slot];
+  return line;
 }
 
 bool Store_buffer::can_accept_st(Addr_t st_addr) const {
   /* scb_clean_lines can be wrtiteback to L1cache and new entry can be accepted*/
   /* scb_clean_lines can be wrtiteback to L1cache; so  new space can be created by deleting clean lines; 34-5<32*/
-  // if ((static_cast<int>(scb_lines_map.size()) - scb_clean_lines) < scb_size) {
+  // if ((static_cast<int>(n_lines) - scb_clean_lines) < scb_size) {
   int scb_clean = this->get_clean_num();
-  if ((static_cast<int>(scb_lines_map.size()) - scb_clean) < scb_size) {
-    // printf("Store_buffer::can_accept_st::TRUE return can accept::  addr %llu and scb.size() %zu and scb_clean%d\n",
-           // st_addr,
-           // scb_lines_map.size(),
-           // scb_clean);
+  if ((static_cast<int>(n_lines) - scb_clean) < scb_size) {
+    DLOG(scb,
+         "Store_buffer::can_accept_st::TRUE return can accept:: addr {} and scb.size() {} and scb_clean{}",
+         st_addr,
+         n_lines,
+         scb_clean);
     return true;
   } else {
-    // printf(
-        // "Store_buffer::can_accept_st:: SCB full: size>scb_size::return can  not accept::addr %llu and scb.size() %zu and scb_clean "
-        // "%d\n",
-        // st_addr,
-        // scb_lines_map.size(),
-        // scb_clean);
+    DLOG(scb,
+         "Store_buffer::can_accept_st:: SCB full: size>scb_size::return can not accept::addr {} and scb.size() {} and scb_clean {}",
+         st_addr,
+         n_lines,
+         scb_clean);
   }
 
-  auto it = scb_lines_map.find(calc_line(st_addr));
-  if (it != scb_lines_map.end()) {
-    // printf("Store_buffer:can_accept_st::RETURN TRUE addr already in scb  %llu and line_addr %llu\n", st_addr, calc_line(st_addr));
+  if (find_slot(calc_line(st_addr)) >= 0) {
+    DLOG(scb, "Store_buffer:can_accept_st::RETURN TRUE addr already in scb {} and line_addr {}", st_addr, calc_line(st_addr));
     return true;
   } else {
-    // printf(
-        // "Store_buffer:can_accept_st::return:: RETURN FALSE :: addr NOT  in scb + SCBFull:size >scb_size::%llu and line_addr %llu\n",
-        // st_addr,
-        // calc_line(st_addr));
+    DLOG(scb,
+         "Store_buffer:can_accept_st::return:: RETURN FALSE :: addr NOT in scb + SCBFull:size >scb_size::{} and line_addr {}",
+         st_addr,
+         calc_line(st_addr));
     return false;
   }
-  return it != scb_lines_map.end();
 }
 
 int Store_buffer::get_clean_num() const {
-  // printf("Store_buffer::get_clean():: Entering in scb\n");
+  DLOG(scb, "Store_buffer::get_clean():: Entering in scb");
   int num = 0;
-  for (auto it = scb_lines_map.begin(); it != scb_lines_map.end(); ++it) {
-    if (it->second.is_clean()) {
-      num++;
-    }
+  for (auto b : clean_bits) {
+    num += std::popcount(b);
   }
-  // printf("Store_buffer::get_clean:: After scbclean num is  %d \n", num);
+  DLOG(scb, "Store_buffer::get_clean:: After scbclean num is {}", num);
   return num;
 }
 
 void Store_buffer::remove_clean() {
   // I(scb_clean_lines);
 
-  // printf("Store_buffer::remove_clean():: Entering in scb\n");
+  DLOG(scb, "Store_buffer::remove_clean():: Entering in scb");
   // int scb_clean = this->get_clean_num();
-  // printf("Store_buffer::remove_clean:: Before scb.size() %ld and scb_clean%d\n", scb_lines_map.size(), scb_clean);
-  // printf("Store_buffer::remove_clean:: Before scb_clean is  %d \n", scb_clean);
-  size_t num = 0;
-
-  absl::erase_if(scb_lines_map, [&num](std::pair<const Addr_t, Store_buffer_line> p) {
+  DLOG(scb, "Store_buffer::remove_clean:: Before scb.size() {} and scb_clean{}", n_lines, get_clean_num());
+  DLOG(scb, "Store_buffer::remove_clean:: Before scb_clean is {}", get_clean_num());
+  auto num = release_if(clean_bits, [](Addr_t line) {
     // if (p.second.is_safe()) { stores safe only can be write back to L1cache from scb_spec
-    if (p.second.is_clean()) {
-      // printf("Store_buffer::remove_clean():: Removing  st_addr_line %llu from scb\n", p.first);
-      ++num;
-      return true;
-    }
-    // printf("Store_buffer::remove_clean():: NOT Removing  st_addr_line %llu \n", p.first);
-    return false;
+    DLOG(scb, "Store_buffer::remove_clean():: Removing st_addr_line {} from scb", line);
   });
 
-  // printf("Store_buffer::remove_clean:: After scb.size() %ld and scb_clean%d\n", scb_lines_map.size(), scb_clean);
-  // printf("Store_buffer::remove_clean:: After scb_clean is  %d \n", scb_clean);
-  // printf("Store_buffer::remove_clean():: Leaving from scb\n");
+  DLOG(scb, "Store_buffer::remove_clean:: After scb.size() {} and removed {}", n_lines, num);
+  DLOG(scb, "Store_buffer::remove_clean:: After scb_clean is {}", get_clean_num());
+  DLOG(scb, "Store_buffer::remove_clean():: Leaving from scb");
 }
 
 void Store_buffer::flush_transient() {
   // I(scb_clean_lines);
 
-  // printf("Store_buffer::remove_clean():: Entering in scb\n");
-  size_t num       = 0;
-  // int    scb_clean = this->get_clean_num();
-  // printf("Store_buffer::flush transinet:: Before scb.size() %ld and scb_clean%d\n", scb_lines_map.size(), scb_clean);
+  DLOG(scb, "Store_buffer::remove_clean():: Entering in scb");
+  DLOG(scb, "Store_buffer::flush transinet:: Before scb.size() {} and scb_clean{}", n_lines, get_clean_num());
 
-  absl::erase_if(scb_lines_map, [&num](std::pair<const Addr_t, Store_buffer_line> p) {
-    // if (p.second.is_safe()) { stores safe only can be write back to L1cache from scb_spec
-    if (p.second.is_transient()) {
-      // printf("Store_buffer::flushtransient:: Removing  st_addr_line %llu from scb\n", p.first);
-      ++num;
-      return true;
-    }
-    return false;
+  auto num = release_if(transient_bits, [](Addr_t line) {
+    DLOG(scb, "Store_buffer::flushtransient:: Removing st_addr_line {} from scb", line);
   });
 
-  // printf("Store_buffer::flush transinet:: After scb.size() %ld and flushed trunsients num is %ld\n", scb_lines_map.size(), num);
-  // printf("Store_buffer::flush_transient: Leaving from scb\n");
+  DLOG(scb, "Store_buffer::flush transinet:: After scb.size() {} and flushed trunsients num is {}", n_lines, num);
+  DLOG(scb, "Store_buffer::flush_transient: Leaving from scb");
 }
 
 void Store_buffer::remove_spec_load(Dinst* dinst) {
   /*spec_load removed from scb*/
 
-  // printf("Store_buffer::remove_spec_load:: Entering for specLoad to scb inst  %llu\n", dinst->getID());
+  DLOG(scb, "Store_buffer::remove_spec_load:: Entering for specLoad to scb inst {}", dinst->getID());
   // I(scb_lines_num);
   Addr_t addr      = dinst->getAddr();
   Addr_t addr_line = calc_line(addr);
 
   // remove_clean();
   // int scb_clean = this->get_clean_num();
-  // printf("Store_buffer::remove::spec load addr %llu and addr_line %llu\n", addr, addr_line);
-  // printf("Store_buffer::remove(): before scb.size() %ld and scb_clean%d\n", scb_lines_map.size(), scb_clean);
-
-  // Removes the element from the hashmap named 'scb_map' with key erase(key)
-  // The erase() method typically returns the number of elements removed (0 or 1 when erasing by key)
-  // or an iterator i to the element following the erased one (when erasing by iterator).
-  auto it = scb_lines_map.find(addr_line);
-  // if (!(it == scb_lines_map.end()) && !it->second.is_waiting_wb()) {
-  if (!(it == scb_lines_map.end())) {
-    // printf("Store_buffer::removei_spec_load::Found spec load addr %llu and addr_line %llu\n", addr, addr_line);
-    scb_lines_map.erase(addr_line);
-    // printf("Store_buffer::remove::Removing spec load addr %llu and addr_line %llu\n", addr, addr_line);
-    // printf("Store_buffer::remove(): After scb.size() %ld\n", scb_lines_map.size());
+  DLOG(scb, "Store_buffer::remove::spec load addr {} and addr_line {}", addr, addr_line);
+  DLOG(scb, "Store_buffer::remove(): before scb.size() {} and scb_clean{}", n_lines, get_clean_num());
+
+  auto slot = find_slot(addr_line);
+  // if (slot >= 0 && !is_waiting_wb) {
+  if (slot >= 0) {
+    DLOG(scb, "Store_buffer::removei_spec_load::Found spec load addr {} and addr_line {}", addr, addr_line);
+    release_slot(slot);
+    DLOG(scb, "Store_buffer::remove::Removing spec load addr {} and addr_line {}", addr, addr_line);
+    DLOG(scb, "Store_buffer::remove(): After scb.size() {}", n_lines);
   } else {
-    // printf("Store_buffer::remove::Found NOT spec load addr %llu and addr_line %llu scb\n", addr, addr_line);
-    // printf("Store_buffer::remove(): After scb.size() %ld\n", scb_lines_map.size());
+    DLOG(scb, "Store_buffer::remove::Found NOT spec load addr {} and addr_line {} scb", addr, addr_line);
+    DLOG(scb, "Store_buffer::remove(): After scb.size() {}", n_lines);
   }
 }
 bool Store_buffer::is_clean_disp(Dinst* dinst) {
   /*spec_load removed from scb*/
 
-  // printf("Store_buffer::::is_clean_disp:: Entering inst  %llu\n", dinst->getID());
+  DLOG(scb, "Store_buffer::::is_clean_disp:: Entering inst {}", dinst->getID());
   // I(scb_lines_num);
   Addr_t addr      = dinst->getAddr();
   Addr_t addr_line = calc_line(addr);
-  auto   it        = scb_lines_map.find(addr_line);
-  if (!(it == scb_lines_map.end()) && it->second.is_clean()) {
-    return true;
-  } else {
-    return false;
-  }
+  auto   slot      = find_slot(addr_line);
+  return slot >= 0 && states[slot] == Store_buffer_line::State::Clean;
 }
 
 void Store_buffer::set_clean_scb(Dinst* dinst) {
   /*spec_load removed from scb*/
 
-  // printf("Store_buffer:set_clean_scb:: inst  %llu\n", dinst->getID());
+  DLOG(scb, "Store_buffer:set_clean_scb:: inst {}", dinst->getID());
   // int scb_clean = this->get_clean_num();
-  // printf("Store_buffer::set_clean_scb::: Before scb.size() %ld and scb_clean%d\n", scb_lines_map.size(), scb_clean);
-  // printf("Store_buffer::set_clean_scb:: Before scb_clean is  %d \n", scb_clean);
+  DLOG(scb, "Store_buffer::set_clean_scb::: Before scb.size() {} and scb_clean{}", n_lines, get_clean_num());
+  DLOG(scb, "Store_buffer::set_clean_scb:: Before scb_clean is {}", get_clean_num());
   // I(scb_lines_num);
   Addr_t addr      = dinst->getAddr();
   Addr_t addr_line = calc_line(addr);
-  auto   it        = scb_lines_map.find(addr_line);
-  if ((it == scb_lines_map.end())) {
+  auto   slot      = find_slot(addr_line);
+  if (slot < 0) {
     // not found in scb
-    // printf("Store_buffer::set_clean_scb::NOT found dinst  %llu\n", dinst->getID());
-    // printf("Store_buffer::set_clean::addr %llu and addr_line %llu\n", addr, addr_line);
+    DLOG(scb, "Store_buffer::set_clean_scb::NOT found dinst {}", dinst->getID());
+    DLOG(scb, "Store_buffer::set_clean::addr {} and addr_line {}", addr, addr_line);
   } else {
-    // printf("Store_buffer::set_clean::dinst  found  %llu\n", dinst->getID());
-    // printf("Store_buffer::set_clean::addr %llu and addr_line %llu\n", addr, addr_line);
-    it->second.set_clean();
+    DLOG(scb, "Store_buffer::set_clean::dinst found {}", dinst->getID());
+    DLOG(scb, "Store_buffer::set_clean::addr {} and addr_line {}", addr, addr_line);
+    set_state(slot, Store_buffer_line::State::Clean);
   }
   // int scb_clean_after = this->get_clean_num();
-  // printf("Store_buffer::set_clean_scb::: AFter scb.size() %ld and scb_clean%d\n", scb_lines_map.size(), scb_clean_after);
-  // printf("Store_buffer::set_clean_scb:: After scb_clean is  %d \n", scb_clean);
+  DLOG(scb, "Store_buffer::set_clean_scb::: AFter scb.size() {} and scb_clean{}", n_lines, get_clean_num());
+  DLOG(scb, "Store_buffer::set_clean_scb:: After scb_clean is {}", get_clean_num());
 }
 
 void Store_buffer::add_st(Dinst* dinst) {
   auto st_addr = dinst->getAddr();
   // I(can_accept_st(st_addr));
-  // printf("Store_buffer::add_st::Entering store add_st in scb for dinst  %llu\n", dinst->getID());
+  DLOG(scb, "Store_buffer::add_st::Entering store add_st in scb for dinst {}", dinst->getID());
 
   auto st_addr_line = calc_line(st_addr);
-  // printf("Store_buffer::add_st::add_st in scb for st_addr %llu and st_addr_line  %llu\n", st_addr, st_addr_line);
-  auto it = scb_lines_map.find(st_addr_line);
-  // scb does not has the addr : new entry in map 'scb_map'
-  if (it == scb_lines_map.end()) {
-    // printf("Store_buffer::add_st::In scb No entry found for store st_addr %llu and st_addr_line %llu\n", st_addr, st_addr_line);
-    // if ((static_cast<int>(scb_lines_map.size()) +  >= scb_size) {
+  DLOG(scb, "Store_buffer::add_st::add_st in scb for st_addr {} and st_addr_line {}", st_addr, st_addr_line);
+  auto slot = find_slot(st_addr_line);
+  // scb does not has the addr : new entry
+  if (slot < 0) {
+    DLOG(scb, "Store_buffer::add_st::In scb No entry found for store st_addr {} and st_addr_line {}", st_addr, st_addr_line);
+    // if ((static_cast<int>(n_lines) +  >= scb_size) {
     // int scb_clean = this->get_clean_num();
-    // printf("Store_buffer::add_st:: Before remove_clean() st_addr %llu and scb.size() %zu and scb_clean  %d\n",
-           // st_addr,
-           // scb_lines_map.size(),
-           // scb_clean);
-    if (static_cast<int>(scb_lines_map.size()) > scb_size) {
-      // printf("Store_buffer::add_st:: remove_clean st_addr %llu and st_addr_line %llu\n", st_addr, st_addr_line);
+    DLOG(scb,
+         "Store_buffer::add_st:: Before remove_clean() st_addr {} and scb.size() {} and scb_clean {}",
+         st_addr,
+         n_lines,
+         get_clean_num());
+    if (static_cast<int>(n_lines) > scb_size) {
+      DLOG(scb, "Store_buffer::add_st:: remove_clean st_addr {} and st_addr_line {}", st_addr, st_addr_line);
       remove_clean();
     }
 
-    Store_buffer_line line;
-
-    line.init(line_size, st_addr_line);
-    line.add_st(calc_offset(st_addr));
-    I(line.state == Store_buffer_line::State::Uncoherent);
-
-    // printf("Store_buffer::add_st::Inserting new entry for store st_addr  %llu\n", st_addr_line);
-    scb_lines_map.insert({st_addr_line, line});
-    line.set_waiting_wb();
+    DLOG(scb, "Store_buffer::add_st::Inserting new entry for store st_addr {}", st_addr_line);
+    slot = alloc_slot(st_addr_line);
+    words[slot] |= Store_buffer_line::word_bit(calc_offset(st_addr));
+    I(states[slot] == Store_buffer_line::State::Uncoherent);
 
     if (dinst->isTransient()) {
-      it->second.set_transient();
+      set_bit(transient_bits, slot, true);
     }
 
     CallbackBase* cb = ownership_doneCB::create(this, st_addr);
@@ -235,11 +293,10 @@ void Store_buffer::add_st(Dinst* dinst) {
     // if (dl1 && !dinst->is_spec()) {
     // CallbackBase* cb = ownership_doneCB::create(this, st_addr);
     if (dl1) {
-      // printf(
-          // "Store_buffer::add_st::SCB new entry for the store addr +Sending the store to cache for st_addr %llu and st_addr_line  "
-          // "%llu\n",
-          // st_addr,
-          // st_addr_line);
+      DLOG(scb,
+           "Store_buffer::add_st::SCB new entry for the store addr +Sending the store to cache for st_addr {} and st_addr_line {}",
+           st_addr,
+           st_addr_line);
       MemRequest::sendReqWrite(dl1, dinst->has_stats(), st_addr, dinst->getPC(), cb);
     } else {
       // dinst->set_write_scb_r();
@@ -253,35 +310,29 @@ void Store_buffer::add_st(Dinst* dinst) {
     return;
   }
   // scb already have the address beforehand in map 'scb_map': duplicate entry
-  // printf("Store_buffer::add_st::SCB already have this addr for store st_addr %llu and st_addr_line %llu\n",
-         // st_addr,
-         // calc_line(st_addr));
-  it->second.add_st(calc_offset(st_addr));
-  if (it->second.is_waiting_wb()) {
-    // printf(
-        // "Store_buffer::add_st::WaitingPending for writeback to SCB from cache + already have this addr for store st_addr %llu and "
-        // "st_addr_line %llu\n",
-        // st_addr,
-        // calc_line(st_addr));
+  DLOG(scb,
+       "Store_buffer::add_st::SCB already have this addr for store st_addr {} and st_addr_line {}",
+       st_addr,
+       calc_line(st_addr));
+  words[slot] |= Store_buffer_line::word_bit(calc_offset(st_addr));
+  if (states[slot] == Store_buffer_line::State::Uncoherent) {
+    DLOG(scb,
+         "Store_buffer::add_st::WaitingPending for writeback to SCB from cache + already have this addr for store st_addr {} and"
+         " st_addr_line {}",
+         st_addr,
+         calc_line(st_addr));
     // fmt::print("scb::add_st {} with pending WB for addr 0x{}\n", dinst->getID(), st_addr);
     return;  // DONE
   }
-  // FIX
-  auto it_found = scb_lines_map.find(st_addr_line);
-  if (it_found != scb_lines_map.end()) {
-    // FIXEND
-
-    it->second.set_waiting_wb();
-  }
+  set_state(slot, Store_buffer_line::State::Uncoherent);
   // if (dl1 && !dinst->is_spec()) {
   CallbackBase* cb = ownership_doneCB::create(this, st_addr);
   // auto *cb = ownership_doneCB::create(this, st_addr);
   if (dl1) {
-    // printf(
-        // "Store_buffer::add_st::SCB already have this addr+Sending the store to cache for store st_addr %llu and st_addr_line "
-        // "%llu\n",
-        // st_addr,
-        // calc_line(st_addr));
+    DLOG(scb,
+         "Store_buffer::add_st::SCB already have this addr+Sending the store to cache for store st_addr {} and st_addr_line {}",
+         st_addr,
+         calc_line(st_addr));
     MemRequest::sendReqWrite(dl1, dinst->has_stats(), st_addr, dinst->getPC(), cb);
     // MemRequest::sendReqWrite(dl1, dinst->has_stats(), st_addr, dinst->getPC(), cb);
   } else {
@@ -295,31 +346,26 @@ void Store_buffer::add_st(Dinst* dinst) {
 void Store_buffer::ownership_done(Addr_t st_addr) {
   auto st_addr_line = calc_line(st_addr);
 
-  // printf("Store_buffer::ownership_done:: Entering in scb for st_addr  %llu and st_addr_line %llu\n", st_addr, st_addr_line);
-  auto it = scb_lines_map.find(st_addr_line);
-  if (it != scb_lines_map.end()) {
-    // I(it->second.is_waiting_wb());
-    it->second.set_clean();
-    // printf("Store_buffer::ownership_done:: Leaving from scb for st_addr  %llu\n", st_addr);
+  DLOG(scb, "Store_buffer::ownership_done:: Entering in scb for st_addr {} and st_addr_line {}", st_addr, st_addr_line);
+  auto slot = find_slot(st_addr_line);
+  if (slot >= 0) {
+    // I(states[slot] == Store_buffer_line::State::Uncoherent);
+    set_state(slot, Store_buffer_line::State::Clean);
+    DLOG(scb, "Store_buffer::ownership_done:: Leaving from scb for st_addr {}", st_addr);
   }
 }
 
 bool Store_buffer::is_ld_forward(Addr_t addr) const {
-  const auto it = scb_lines_map.find(calc_line(addr));
-  if (it == scb_lines_map.end()) {
+  auto slot = find_slot(calc_line(addr));
+  if (slot < 0) {
     return false;
   }
 
-  return it->second.is_ld_forward(calc_offset(addr));
+  return words[slot] & Store_buffer_line::word_bit(calc_offset(addr));
 }
 
 bool Store_buffer::find(Dinst* dinst) {
   auto st_addr      = dinst->getAddr();
   auto st_addr_line = calc_line(st_addr);
-  auto it           = scb_lines_map.find(st_addr_line);
-  // end is the iterator position: found if(it!=end position)
-  if (it == scb_lines_map.end()) {
-    return false;
-  }
-  return true;
+  return find_slot(st_addr_line) >= 0;
 }
@@ -5,7 +5,6 @@
 #include <cstdint>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "callback.hpp"
 #include "dinst.hpp"
 #include "gmemory_system.hpp"
@@ -16,32 +15,36 @@ class MemObj;  // To break circular dependencies
 class FUStore;
 class Store_buffer_line {
 public:
-  // NOTE: Invalid not used because when invalid it is removed from the map
-  enum class State { Uncoherent, Modified, Invalid, Clean };  // UMIC
+  // NOTE: Invalid not used because when invalid it is removed from the buffer
+  enum class State : uint8_t { Uncoherent, Modified, Invalid, Clean };  // UMIC
 
-  State             state;
-  bool              transient;
-  std::vector<bool> word_present;  // FIXME: dinst does byte info
+  State    state;
+  bool     transient;
+  uint64_t word_present;  // one bit per 4 byte word, lines up to 256 bytes. FIXME: dinst does byte info
 
   Addr_t line_addr;
 
   Store_buffer_line() { state = State::Invalid; }
 
+  static uint64_t word_bit(Addr_t addr_off) {
+    I((addr_off >> 2) < 64);  // pass only the line offset
+    return uint64_t{1} << (addr_off >> 2);
+  }
+
   void init(size_t line_size, Addr_t addr) {
     I(state == State::Invalid);
-    word_present.assign(line_size >> 2, false);
-    state     = State::Uncoherent;
-    line_addr = addr;
-    transient = false;
+    I(line_size <= 256);
+    (void)line_size;
+    word_present = 0;
+    state        = State::Uncoherent;
+    line_addr    = addr;
+    transient    = false;
   }
   void set_waiting_wb() { state = State::Uncoherent; }
 
-  void add_st(Addr_t addr_off) {
-    I((addr_off >> 2) < word_present.size());  // pass only the line offset
-    word_present[addr_off >> 2] = true;
-  }
+  void add_st(Addr_t addr_off) { word_present |= word_bit(addr_off); }
 
-  bool is_ld_forward(Addr_t addr_off) const { return word_present[addr_off >> 2]; }
+  bool is_ld_forward(Addr_t addr_off) const { return word_present & word_bit(addr_off); }
 
   void set_clean() { state = State::Clean; }
   bool is_clean() const { return state == State::Clean; }
@@ -54,8 +57,18 @@ class Store_buffer {
 protected:
   MemObj* dl1;
 
-  // FA structure, so a map is fine
-  absl::flat_hash_map<Addr_t, Store_buffer_line> scb_lines_map;
+  // Small FA structure kept as arrays indexed by slot. Free slots have the
+  // no_line tag, so a lookup is a compare over one array. Clean and transient
+  // lines are bitmaps, so counting or dropping them is a few words of work.
+  static constexpr Addr_t no_line = ~Addr_t{0};
+
+  std::vector<Addr_t>                   tags;
+  std::vector<uint64_t>                 words;  // Store_buffer_line::word_present
+  std::vector<Store_buffer_line::State> states;
+  std::vector<uint64_t>                 clean_bits;
+  std::vector<uint64_t>                 transient_bits;
+  std::vector<uint32_t>                 free_slots;
+  size_t                                n_lines;
 
   /*scb_size=32*/
   // int    scb_size;
@@ -68,7 +81,22 @@ protected:
   Addr_t calc_line(Addr_t addr) const { return addr >> line_size_addr_bits; }
   Addr_t calc_offset(Addr_t addr) const { return addr & line_size_mask; }
 
-  // void remove_clean();
+  int32_t find_slot(Addr_t line) const;
+  static bool get_bit(const std::vector<uint64_t>& bits, uint32_t slot) { return (bits[slot >> 6] >> (slot & 63)) & 1; }
+  static void set_bit(std::vector<uint64_t>& bits, uint32_t slot, bool v) {
+    auto m = uint64_t{1} << (slot & 63);
+    bits[slot >> 6] = v ? (bits[slot >> 6] | m) : (bits[slot >> 6] & ~m);
+  }
+
+  void     resize(size_t n_slots);
+  uint32_t alloc_slot(Addr_t line);
+  void     release_slot(uint32_t slot);
+  void     set_state(uint32_t slot, Store_buffer_line::State st) {
+    states[slot] = st;
+    set_bit(clean_bits, slot, st == Store_buffer_line::State::Clean);
+  }
+  template <typename F>
+  size_t release_if(const std::vector<uint64_t>& bits, F&& on_release);
 
 public:
   int  scb_size;
@@ -87,5 +115,9 @@ public:
   void set_clean_scb(Dinst* dinst);
   void flush_transient();
 
-  bool is_ld_forward(Addr_t ld_addr) const;
+  bool   is_ld_forward(Addr_t ld_addr) const;
+  size_t size() const { return n_lines; }
+
+  // The line holding addr gathered from the arrays, state Invalid if not present
+  Store_buffer_line get_line(Addr_t addr) const;
 };
@@ -7,6 +7,7 @@
 #include "callback.hpp"
 #include "dinst.hpp"
 #include "estl.hpp"
+#include "snapshot.hpp"
 
 #define STORESET_MERGING  1
 #define STORESET_CLEARING 1
@@ -66,6 +67,9 @@ public:
 
   SSID_t mergeset(SSID_t id1, SSID_t id2);
 
+  // Only the SSIT, the LFST points to in-flight instructions
+  void snapshot(Snapshot_io& ar, const std::string& name);
+
 #ifdef STORESET_MERGING
   // move violating load to qdinst load's store set, stores will migrate as violations occur.
   void merge_sets(Dinst* m_dinst, Dinst* d_dinst);
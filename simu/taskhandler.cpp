@@ -4,12 +4,18 @@
 
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
+#include <barrier>
 #include <iostream>
+#include <thread>
 
 #include "cluster.hpp"
 #include "config.hpp"
+#include "debug_log.hpp"
 #include "emul_base.hpp"
 #include "report.hpp"
+#include "stats.hpp"
 #include "tracer.hpp"
 
 void TaskHandler::report() {
@@ -51,6 +57,7 @@ void TaskHandler::simu_create(std::shared_ptr<Simu_base> simu) {
     map.active       = simu->is_power_up();
     map.simu         = simu;
     map.deactivating = false;
+    map.domain       = Clock_domain::get_current();
 
     allmaps.push_back(map);
   }
@@ -135,28 +142,215 @@ void TaskHandler::boot() {
     }
   }
 
+  if (Config::has_entry("stats", "interval")) {
+    auto n_cycles = Config::get_integer("stats", "interval", 1);
+    Stats_interval::open(fmt::format("stats_interval.{}.bin", Report::get_extension()), n_cycles);
+  }
+
+  if (Config::has_entry("debug", "channels")) {
+    auto n_channels = Config::get_array_size("debug", "channels");
+    for (auto i = 0u; i < n_channels; ++i) {
+      auto name = Config::get_array_string("debug", "channels", i);
+      if (!Debug_log::enable(name)) {
+        Config::add_error(fmt::format("unknown debug channel {}", name));
+      }
+    }
+  }
+  if (Debug_log::requested()) {
+    if (Debug_log::compiled) {
+      Debug_log::open(fmt::format("debug_log.{}.bin", Report::get_extension()));
+    } else {
+      fmt::print("WARNING: debug channels ignored, build with -c dbg or --config=dlog\n");
+    }
+  }
+
+  if (Config::has_entry("soc", "idle_skip")) {
+    idle_skip = Config::get_bool("soc", "idle_skip");
+  }
+
   EventScheduler::advanceClock();
 
+  if (Clock_domain::is_parallel()) {
+    boot_parallel();
+  } else {
+    boot_sequential();
+  }
+}
+
+bool TaskHandler::advance_hart(Hartid_t hid) {
+  // returns false once a deactivating hart has drained
+  if (likely(!allmaps[hid].deactivating)) {
+    allmaps[hid].simu->advance_clock();
+    return true;
+  }
+  auto work_done = allmaps[hid].simu->advance_clock_drain();
+  if (!work_done) {
+    allmaps[hid].active       = false;
+    allmaps[hid].deactivating = false;  // already deactivated
+    allmaps[hid].simu->set_power_down();
+    return false;
+  }
+  return true;
+}
+
+void TaskHandler::skip_idle_clock()
+/* all the harts wait for a callback, jump to the next one {{{1 */
+{
+  for (auto hid : running) {
+    if (allmaps[hid].deactivating || !allmaps[hid].simu->is_quiescent()) {
+      return;
+    }
+  }
+
+  // stop at the interval snapshot so the skipped cycles land in their interval
+  Time_t next = std::min<Time_t>(EventScheduler::nextEventTime(), Stats_interval::get_next());
+  if (next >= MaxTime || next <= globalClock + 1) {
+    return;  // nothing scheduled means a lock, let the cycles run
+  }
+
+  Time_t n = next - globalClock - 1;
+  for (auto hid : running) {
+    allmaps[hid].simu->skip_clock(n);
+  }
+  EventScheduler::skipClock(next);
+}
+/* }}} */
+
+void TaskHandler::boot_sequential() {
   while (!running.empty()) {
     // advance cores & check for deactivate
     for (auto hid : running) {
-      if (likely(!allmaps[hid].deactivating)) {
-        allmaps[hid].simu->advance_clock();
-        continue;
-      }
-      auto work_done = allmaps[hid].simu->advance_clock_drain();
-      if (!work_done) {
-        allmaps[hid].active       = false;
-        allmaps[hid].deactivating = false;  // already deactivated
-        allmaps[hid].simu->set_power_down();
-
+      if (!advance_hart(hid)) {
         running.erase(hid);
         break;  // core_pause can break the iterator
       }
     }
 
+    if (idle_skip) {
+      skip_idle_clock();
+    }
     EventScheduler::advanceClock();
+    Stats_interval::tick(globalClock);
+
+    if (unlikely(snapshot_pending)) {
+      snapshot_save();
+    }
+  }
+}
+
+void TaskHandler::boot_parallel() {
+  /* one thread per core Clock_domain, the uncore runs in this thread {{{1 */
+  std::vector<Clock_domain*>         domains;
+  std::vector<std::vector<Hartid_t>> harts;  // per domain
+  for (auto hid : running) {
+    auto* d = allmaps[hid].domain;
+    I(d && d != Clock_domain::get_uncore());
+    auto it = std::find(domains.begin(), domains.end(), d);
+    if (it == domains.end()) {
+      domains.push_back(d);
+      harts.emplace_back();
+      it = domains.end() - 1;
+    }
+    harts[it - domains.begin()].push_back(hid);
+  }
+
+  std::vector<uint8_t> alive(allmaps.size(), 0);  // each entry only written by its domain thread
+  for (auto hid : running) {
+    alive[hid] = 1;
+  }
+
+  const auto        quantum = Clock_domain::get_quantum();
+  std::atomic<bool> stop{false};
+  std::barrier      sync(static_cast<std::ptrdiff_t>(domains.size() + 1));
+
+  const Time_t start = globalClock;  // workers start with a 0 thread_local clock
+
+  std::vector<std::jthread> workers;
+  for (size_t i = 0; i < domains.size(); ++i) {
+    workers.emplace_back([&, i]() {
+      Clock_domain::set_current(domains[i]);
+      globalClock = start;  // same start cycle as the uncore
+      while (true) {
+        sync.arrive_and_wait();  // quantum start
+        if (stop.load()) {
+          break;
+        }
+        domains[i]->deliver();
+        for (Time_t q = 0; q < quantum; ++q) {
+          for (auto hid : harts[i]) {
+            if (alive[hid]) {
+              alive[hid] = advance_hart(hid);
+            }
+          }
+          EventScheduler::advanceClock();
+        }
+        sync.arrive_and_wait();  // quantum end
+      }
+      Clock_domain::set_current(nullptr);
+    });
+  }
+
+  auto* uncore = Clock_domain::get_uncore();
+  Clock_domain::set_current(uncore);
+  while (true) {
+    sync.arrive_and_wait();
+    uncore->deliver();
+    for (Time_t q = 0; q < quantum; ++q) {
+      std::lock_guard<std::recursive_mutex> lock(uncore->ref_sync_mutex());
+      EventScheduler::advanceClock();
+    }
+    sync.arrive_and_wait();
+
+    // Workers are parked in the barrier, the hart sets can be updated safely
+    Stats_interval::tick(globalClock);  // quantum granularity
+    if (unlikely(snapshot_pending)) {
+      snapshot_save();
+    }
+    for (auto it = running.begin(); it != running.end();) {
+      auto cur = it++;
+      if (!alive[*cur]) {
+        running.erase(cur);
+      }
+    }
+    if (running.empty()) {
+      stop.store(true);
+      sync.arrive_and_wait();  // release the workers so they see stop
+      break;
+    }
+  }
+  workers.clear();  // join
+  Clock_domain::set_current(nullptr);
+}
+/* }}} */
+
+void TaskHandler::snapshot_restore(const std::string& file_name) {
+  auto ar = Snapshot_io::open(file_name);
+  if (!ar) {
+    return;
+  }
+
+  for (auto& simu : simus) {
+    simu->snapshot(*ar);
   }
+
+  fmt::print("snapshot {} restored {} sections ({} skipped)\n", file_name, ar->get_n_restored(), ar->get_n_skipped());
+}
+
+void TaskHandler::snapshot_save() {
+  // Saved once, the first cycle that all the harts are past the functional warmup
+  for (auto hid : running) {
+    if (allmaps[hid].emul->is_warmup(hid)) {
+      return;
+    }
+  }
+
+  for (auto& simu : simus) {
+    simu->snapshot(*snapshot_pending);
+  }
+  if (snapshot_pending->close()) {
+    fmt::print("snapshot saved at cycle {}\n", globalClock);
+  }
+  snapshot_pending = nullptr;
 }
 
 void TaskHandler::unboot()
@@ -213,6 +407,18 @@ void TaskHandler::plugEnd()
     cpuid = cpuid + 1;
   }
 
+  if (Config::has_entry("soc", "snapshot_load")) {
+    snapshot_restore(Config::get_string("soc", "snapshot_load"));
+  }
+  if (Config::has_entry("soc", "snapshot_save")) {
+    snapshot_pending = Snapshot_io::create(Config::get_string("soc", "snapshot_save"));
+  }
+
+  // Only reported when the emulator samples (samples/simpoints)
+  for (size_t i = 0; i < simus.size(); i++) {
+    Stats_sampler::add_ratio(fmt::format("P({}):cpi", i), fmt::format("P({}):clockTicks", i), fmt::format("P({}):nCommitted", i));
+  }
+
   plugging = false;
 }
 /* }}} */
@@ -233,10 +439,25 @@ void TaskHandler::unplug()
     }
   }
 #endif
+  if (snapshot_pending) {
+    // The run ended before the warmup did, keep what was trained
+    for (auto& simu : simus) {
+      simu->snapshot(*snapshot_pending);
+    }
+    snapshot_pending->close();
+    snapshot_pending = nullptr;
+  }
+
   allmaps.clear();
   emuls.clear();
   simus.clear();
 
+  Stats_sampler::reset();
+
+  Tracer::close();
+  Stats_interval::close();
+  Debug_log::close();
+
   Cluster::unplug();
 }
 /* }}} */
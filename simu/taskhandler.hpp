@@ -5,9 +5,11 @@
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "clock_domain.hpp"
 #include "emul_base.hpp"
 #include "iassert.hpp"
 #include "simu_base.hpp"
+#include "snapshot.hpp"
 
 class TaskHandler {
 private:
@@ -18,6 +20,7 @@ private:
     bool                       deactivating;
     std::shared_ptr<Emul_base> emul;
     std::shared_ptr<Simu_base> simu;
+    Clock_domain*              domain;  // nullptr without [soc] parallel
   };
 
   static inline bool terminate_all{false};
@@ -30,6 +33,17 @@ private:
   static inline std::vector<std::shared_ptr<Simu_base> > simus;  // All the simus in the system
 
   static inline bool plugging{false};
+  static inline bool idle_skip{true};  // [soc] idle_skip
+
+  static inline std::unique_ptr<Snapshot_io> snapshot_pending;  // [soc] snapshot_save not written yet
+
+  static void snapshot_restore(const std::string& file_name);
+  static void snapshot_save();
+
+  static bool advance_hart(Hartid_t hid);
+  static void skip_idle_clock();
+  static void boot_sequential();
+  static void boot_parallel();
 
 public:
   static void simu_create(std::shared_ptr<Simu_base> simu);
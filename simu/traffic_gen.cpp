@@ -0,0 +1,320 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "traffic_gen.hpp"
+
+#include <limits>
+#include <numeric>
+
+#include "config.hpp"
+#include "emul_dromajo.hpp"
+#include "fmt/format.h"
+#include "memobj.hpp"
+#include "memrequest.hpp"
+#include "taskhandler.hpp"
+
+Traffic_stream::Traffic_stream(const std::string& section, uint32_t _line_size)
+    /* constructor {{{1 */
+    : line_size(_line_size), n_sent(0), done(false), offset(0) {
+  auto p  = Config::get_string(section, "pattern", {"stride", "random", "chase", "hot", "replay"});
+  pattern = Pattern::stride;
+  if (p == "random") {
+    pattern = Pattern::random;
+  } else if (p == "chase") {
+    pattern = Pattern::chase;
+  } else if (p == "hot") {
+    pattern = Pattern::hot;
+  } else if (p == "replay") {
+    pattern = Pattern::replay;
+  }
+
+  auto get_opt = [&section](const std::string& key, int def, int from, int to) {
+    if (Config::has_entry(section, key)) {
+      return Config::get_integer(section, key, from, to);
+    }
+    return def;
+  };
+
+  base            = get_opt("base", 0, 0, std::numeric_limits<int>::max());
+  auto size       = get_opt("size", 1 << 20, line_size, std::numeric_limits<int>::max());
+  n_lines         = size / line_size;
+  stride          = get_opt("stride", line_size, 1, size);
+  n_hot_lines     = get_opt("hot_size", line_size, line_size, size) / line_size;
+  hot_pct         = get_opt("hot_pct", 90, 0, 100);
+  write_pct       = get_opt("write_pct", 0, 0, 100);
+  n_requests      = get_opt("n_requests", 0, 0, std::numeric_limits<int>::max());
+  max_outstanding = get_opt("max_outstanding", 16, 1, 4096);
+  burst           = get_opt("burst", 1, 1, 1 << 20);
+  gap             = get_opt("gap", 0, 0, 1 << 20);
+  rnd.seed(get_opt("seed", 1, 0, std::numeric_limits<int>::max()));
+
+  base -= base % line_size;
+
+  if (pattern == Pattern::chase) {
+    max_outstanding = 1;
+    if (n_lines > (1 << 26)) {
+      Config::add_error(fmt::format("{} chase footprint of {} lines is too large", section, n_lines));
+      n_lines = 1;
+    }
+    // Sattolo's shuffle, a single cycle that visits every line of the footprint
+    std::vector<uint32_t> order(n_lines);
+    std::iota(order.begin(), order.end(), 0);
+    for (auto i = order.size() - 1; i > 0; --i) {
+      auto j = rnd() % i;
+      std::swap(order[i], order[j]);
+    }
+    chase.resize(n_lines);
+    for (size_t i = 0; i < order.size(); ++i) {
+      chase[order[i]] = order[(i + 1) % order.size()];
+    }
+  }
+
+  if (pattern == Pattern::replay) {
+    replay = Trace_reader::open(Config::get_string(section, "trace"));
+    if (!replay) {
+      done = true;
+    }
+  } else if (n_requests == 0) {
+    Config::add_error(fmt::format("{} needs n_requests, only replay can run until the trace ends", section));
+    done = true;
+  }
+}
+/* }}} */
+
+bool Traffic_stream::next_replay(Addr_t& addr, bool& write)
+/* next load or store of the recorded trace {{{1 */
+{
+  Trace_record rec;
+  while (replay->next(rec)) {
+    auto inst = Emul_dromajo::decode(rec.insn);
+    if (inst.isLoad() || inst.isStore()) {
+      addr  = rec.addr;
+      write = inst.isStore();
+      return true;
+    }
+  }
+  return false;
+}
+/* }}} */
+
+bool Traffic_stream::next(Addr_t& addr, bool& write)
+/* generate the next request {{{1 */
+{
+  if (done) {
+    return false;
+  }
+
+  write = write_pct && (rnd() % 100) < write_pct;
+
+  switch (pattern) {
+    case Pattern::stride:
+      addr   = base + offset;
+      offset = (offset + stride) % (n_lines * line_size);
+      break;
+    case Pattern::random: addr = base + (rnd() % n_lines) * line_size; break;
+    case Pattern::hot:
+      if ((rnd() % 100) < hot_pct) {
+        addr = base + (rnd() % n_hot_lines) * line_size;
+      } else {
+        addr = base + (rnd() % n_lines) * line_size;
+      }
+      break;
+    case Pattern::chase:
+      addr   = base + offset * line_size;
+      offset = chase[offset];
+      break;
+    case Pattern::replay:
+      if (!next_replay(addr, write)) {
+        done = true;
+        return false;
+      }
+      break;
+  }
+
+  ++n_sent;
+  if (n_requests && n_sent >= n_requests) {
+    done = true;
+  }
+  return true;
+}
+/* }}} */
+
+Traffic_gen::Traffic_gen(std::shared_ptr<Gmemory_system> gm, Hartid_t i)
+    /* constructor {{{1 */
+    : Simu_base(gm, i)
+    , target(gm->getDL1())
+    , outstanding(0)
+    , done_bytes(0)
+    , finished(false)
+    , nRead(fmt::format("P({})_tg_reads", i))
+    , nWrite(fmt::format("P({})_tg_writes", i))
+    , nBytes(fmt::format("P({})_tg_bytes", i))
+    , avgReadLat(fmt::format("P({})_tg_avgReadLat", i))
+    , avgWriteLat(fmt::format("P({})_tg_avgWriteLat", i))
+    , readLat(fmt::format("P({})_tg_readLat", i), 1024)
+    , writeLat(fmt::format("P({})_tg_writeLat", i), 1024)
+    , avgBandwidth(fmt::format("P({})_tg_avgBandwidth", i))
+    , avgOutstanding(fmt::format("P({})_tg_avgOutstanding", i)) {
+  auto section = Config::get_string("soc", "core", i);
+
+  line_size = 64;
+  if (Config::has_entry(section, "line_size")) {
+    line_size = Config::get_power2(section, "line_size", 4, 4096);
+  }
+
+  if (Config::has_entry(section, "target")) {
+    auto name = Config::get_string(section, "target");
+    target    = gm->searchMemoryObj(false, name);
+    if (target == nullptr) {
+      target = gm->searchMemoryObj(true, name);
+    }
+    if (target == nullptr) {
+      Config::add_error(fmt::format("{} target {} is not a memory object", section, name));
+    }
+  } else if (target == nullptr) {
+    Config::add_error(fmt::format("{} traffic generator without a DL1 or a target", section));
+  }
+
+  auto n = Config::get_array_size(section, "streams", 64);
+  if (n == 0) {
+    Config::add_error(fmt::format("{} traffic generator without streams", section));
+  }
+  for (auto s = 0u; s < n; ++s) {
+    streams.emplace_back(std::make_unique<Traffic_stream>(Config::get_array_string(section, "streams", s), line_size));
+  }
+  state.resize(streams.size());
+}
+/* }}} */
+
+Traffic_gen::~Traffic_gen()
+/* destructor {{{1 */
+{
+  // Nothing to do
+}
+/* }}} */
+
+void Traffic_gen::read_performed(uint32_t sid, Time_t startTime)
+// {{{1 callback for completed reads
+{
+  I(outstanding && state[sid].outstanding);
+  outstanding--;
+  state[sid].outstanding--;
+  done_bytes += line_size;
+
+  nRead.inc(true);
+  avgReadLat.sample(globalClock - startTime, true);
+  readLat.sample(globalClock - startTime, true);
+}
+/* }}} */
+
+void Traffic_gen::write_performed(uint32_t sid, Time_t startTime)
+// {{{1 callback for completed writes
+{
+  I(outstanding && state[sid].outstanding);
+  outstanding--;
+  state[sid].outstanding--;
+  done_bytes += line_size;
+
+  nWrite.inc(true);
+  avgWriteLat.sample(globalClock - startTime, true);
+  writeLat.sample(globalClock - startTime, true);
+}
+/* }}} */
+
+void Traffic_gen::issue(uint32_t sid)
+/* at most one request per stream and cycle {{{1 */
+{
+  auto& s  = *streams[sid];
+  auto& st = state[sid];
+
+  if (s.is_done() || st.outstanding >= s.get_max_outstanding()) {
+    return;
+  }
+  if (st.burst_left == 0) {
+    if (globalClock < st.next_burst) {
+      return;
+    }
+    st.burst_left = s.get_burst();
+  }
+
+  Addr_t addr;
+  bool   write;
+  if (!s.next(addr, write)) {
+    return;
+  }
+
+  st.outstanding++;
+  outstanding++;
+  if (--st.burst_left == 0) {
+    st.next_burst = globalClock + 1 + s.get_gap();
+  }
+
+  if (write) {
+    MemRequest::sendReqWrite(target, true, addr, 0, write_performedCB::create(this, sid, globalClock));
+  } else {
+    MemRequest::sendReqRead(target, true, addr, 0, read_performedCB::create(this, sid, globalClock));
+  }
+}
+/* }}} */
+
+bool Traffic_gen::advance_clock_drain() {
+  if (is_power_down()) {
+    return false;
+  }
+
+  adjust_clock(true);
+
+  nBytes.add(done_bytes, true);
+  avgBandwidth.sample(done_bytes, true);
+  avgOutstanding.sample(outstanding, true);
+  done_bytes = 0;
+
+  return outstanding != 0;
+}
+
+bool Traffic_gen::advance_clock() {
+  if (target == nullptr) {
+    return false;
+  }
+
+  bool all_done = true;
+  for (auto sid = 0u; sid < streams.size(); ++sid) {
+    issue(sid);
+    all_done = all_done && streams[sid]->is_done();
+  }
+
+  bool busy = advance_clock_drain();
+
+  if (all_done && !finished) {
+    finished = true;
+    TaskHandler::simu_pause(hid);  // drains the outstanding requests, then powers down
+  }
+
+  return busy;
+}
+
+bool Traffic_gen::is_quiescent() const
+/* every stream waits for a completion {{{1 */
+{
+  if (!can_skip_clock() || done_bytes) {
+    return false;
+  }
+  for (auto sid = 0u; sid < streams.size(); ++sid) {
+    if (!streams[sid]->is_done() && state[sid].outstanding < streams[sid]->get_max_outstanding()) {
+      return false;
+    }
+  }
+  return true;
+}
+/* }}} */
+
+void Traffic_gen::skip_clock(Time_t n)
+/* n cycles without completions {{{1 */
+{
+  if (is_power_down()) {
+    return;  // same as advance_clock_drain, no samples once drained
+  }
+  skip_ticks(n, true);
+  avgBandwidth.sample(0, true, n);
+  avgOutstanding.sample(outstanding, true, n);
+}
+/* }}} */
@@ -0,0 +1,119 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#pragma once
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "callback.hpp"
+#include "gmemory_system.hpp"
+#include "simu_base.hpp"
+#include "stats.hpp"
+#include "trace_file.hpp"
+
+// One address stream of the traffic generator, configured in its own section:
+//
+//   pattern          stride, random, chase (pointer chase), hot (hot set) or replay
+//   base, size       footprint in bytes, the addresses wrap inside it
+//   stride           stride pattern step in bytes
+//   hot_size         hot pattern: hot_pct percent of the accesses go to the first hot_size bytes
+//   write_pct        percent of writes (replay uses the recorded loads and stores)
+//   n_requests       requests to send, 0 is until the replay trace ends
+//   max_outstanding  requests in flight (chase is always 1, each load needs the previous one)
+//   burst, gap       burst requests back to back (one per cycle), then gap idle cycles
+//   trace            replay: a trace recorded with [drom_emu] record
+//   seed
+//
+// The stream only generates addresses, Traffic_gen sends them.
+class Traffic_stream {
+public:
+  enum class Pattern : uint8_t { stride, random, chase, hot, replay };
+
+  Traffic_stream(const std::string& section, uint32_t line_size);
+
+  // False when there are no more requests
+  bool next(Addr_t& addr, bool& write);
+
+  [[nodiscard]] bool     is_done() const { return done; }
+  [[nodiscard]] Pattern  get_pattern() const { return pattern; }
+  [[nodiscard]] uint32_t get_max_outstanding() const { return max_outstanding; }
+  [[nodiscard]] uint32_t get_burst() const { return burst; }
+  [[nodiscard]] uint32_t get_gap() const { return gap; }
+  [[nodiscard]] uint64_t get_n_sent() const { return n_sent; }
+
+private:
+  Pattern  pattern;
+  uint32_t line_size;
+  Addr_t   base;
+  Addr_t   n_lines;
+  Addr_t   stride;
+  Addr_t   n_hot_lines;
+  uint32_t hot_pct;
+  uint32_t write_pct;
+  uint64_t n_requests;
+  uint32_t max_outstanding;
+  uint32_t burst;
+  uint32_t gap;
+
+  uint64_t n_sent;
+  bool     done;
+  Addr_t   offset;  // stride position in bytes, or current chase line
+
+  std::vector<uint32_t>         chase;  // next line, one single cycle over the footprint
+  std::unique_ptr<Trace_reader> replay;
+  std::mt19937_64               rnd;
+
+  bool next_replay(Addr_t& addr, bool& write);
+};
+
+// Synthetic traffic generator core (type = "traffic"). It sends the requests
+// of its streams to the DL1 (or to the memory object named by target) and
+// reports the latency histograms and the achieved bandwidth. It needs no
+// emulator (emul type "none"), and it pauses once every stream is done.
+class Traffic_gen : public Simu_base {
+protected:
+  std::vector<std::unique_ptr<Traffic_stream>> streams;
+
+  struct Stream_state {
+    uint32_t outstanding = 0;
+    uint32_t burst_left  = 0;
+    Time_t   next_burst  = 0;
+  };
+  std::vector<Stream_state> state;
+
+  MemObj*  target;
+  uint32_t line_size;
+  uint64_t outstanding;
+  uint64_t done_bytes;  // completed since the last cycle
+  bool     finished;
+
+  Stats_cntr nRead;
+  Stats_cntr nWrite;
+  Stats_cntr nBytes;
+  Stats_avg  avgReadLat;
+  Stats_avg  avgWriteLat;
+  Stats_hist readLat;
+  Stats_hist writeLat;
+  Stats_avg  avgBandwidth;  // bytes per cycle
+  Stats_avg  avgOutstanding;
+
+  void read_performed(uint32_t sid, Time_t startTime);
+  void write_performed(uint32_t sid, Time_t startTime);
+  typedef CallbackMember2<Traffic_gen, uint32_t, Time_t, &Traffic_gen::read_performed>  read_performedCB;
+  typedef CallbackMember2<Traffic_gen, uint32_t, Time_t, &Traffic_gen::write_performed> write_performedCB;
+
+  void issue(uint32_t sid);
+
+public:
+  Traffic_gen(std::shared_ptr<Gmemory_system> gm, Hartid_t i);
+  virtual ~Traffic_gen();
+
+  bool        advance_clock_drain() override final;
+  bool        advance_clock() override final;
+  std::string get_type() const override final { return "traffic"; }
+
+  bool is_quiescent() const override final;
+  void skip_clock(Time_t n) override final;
+};
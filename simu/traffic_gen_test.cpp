@@ -0,0 +1,214 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "traffic_gen.hpp"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <set>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+#include "memory_system.hpp"
+#include "report.hpp"
+#include "taskhandler.hpp"
+#include "trace_file.hpp"
+
+// Opens the stats of a generator
+class Traffic_probe : public Traffic_gen {
+public:
+  Traffic_probe(std::shared_ptr<Gmemory_system> gm, Hartid_t i) : Traffic_gen(gm, i) {}
+
+  [[nodiscard]] const Stats_cntr& get_nRead() const { return nRead; }
+  [[nodiscard]] const Stats_cntr& get_nBytes() const { return nBytes; }
+  [[nodiscard]] const Stats_avg&  get_avgReadLat() const { return avgReadLat; }
+  [[nodiscard]] const Stats_hist& get_readLat() const { return readLat; }
+  [[nodiscard]] const Stats_avg&  get_avgBandwidth() const { return avgBandwidth; }
+  [[nodiscard]] const Stats_avg&  get_avgOutstanding() const { return avgOutstanding; }
+};
+
+// Two generators, each with its own DL1, over a shared L2 and memory
+class Traffic_gen_hier_test : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    std::ofstream file("traffic_gen_hier_test.toml");
+    file << "[soc]\ncore = [\"tg0\",\"tg1\"]\n";
+    for (const auto* sec : {"tg0", "tg1"}) {
+      file << "[" << sec << "]\ntype = \"traffic\"\nfrequency_mhz = 1000\ncaches = true\n"
+           << "dl1 = \"dl1_cache DL1\"\nil1 = \"dl1_cache IL1\"\nstreams = [\"st_" << sec << "\"]\n";
+    }
+    // tg0 reads 64 lines twice, one at a time; tg1 keeps 8 misses in flight
+    file << "[st_tg0]\npattern = \"stride\"\nbase = 4096\nsize = 4096\nn_requests = 128\nmax_outstanding = 1\n";
+    file << "[st_tg1]\npattern = \"stride\"\nbase = 1048576\nsize = 1048576\nn_requests = 256\nmax_outstanding = 8\n";
+    for (const auto* sec : {"dl1_cache", "l2_cache"}) {
+      bool l1 = sec[0] == 'd';
+      file << "[" << sec << "]\n"
+           << "type = \"cache\"\ncold_misses = true\nline_size = 64\nassoc = 4\nrepl_policy = \"lru\"\n"
+           << "size = " << (l1 ? 32768 : 1048576) << "\ndelay = " << (l1 ? 5 : 13) << "\nmiss_delay = 2\n"
+           << "port_occ = 1\nport_num = 1\nport_banks = 32\nsend_port_occ = 1\nsend_port_num = 1\n"
+           << "max_requests = 32\nallocate_miss = true\nvictim = false\ncoherent = true\ninclusive = true\n"
+           << "directory = false\nnlp_distance = 2\nnlp_degree = 0\nnlp_stride = 1\ndrop_prefetch = false\n"
+           << "prefetch_degree = 0\nmega_lines1K = 0\n"
+           << "lower_level = \"" << (l1 ? "l2_cache L2 shared" : "mem mem shared") << "\"\n";
+    }
+    file << "[mem]\ntype = \"nice\"\nline_size = 64\ndelay = 31\ncold_misses = true\nlower_level = \"\"\n";
+    file.close();
+
+    Report::init();
+    Config::init("traffic_gen_hier_test.toml");
+    TaskHandler::plugBegin();
+    for (Hartid_t i = 0; i < 2; ++i) {
+      gen[i] = std::make_shared<Traffic_probe>(std::make_shared<Memory_system>(i), i);
+      TaskHandler::simu_create(gen[i]);
+    }
+    TaskHandler::plugEnd();
+    ASSERT_FALSE(Config::has_errors());
+    EventScheduler::advanceClock();
+  }
+
+  // Until every stream is done and the last request is back
+  static void run(Traffic_probe& g) {
+    bool busy = true;
+    while (TaskHandler::is_active(g.get_hid()) || busy) {
+      busy = g.advance_clock();
+      EventScheduler::advanceClock();
+    }
+  }
+
+  static inline std::shared_ptr<Traffic_probe> gen[2];
+};
+
+TEST_F(Traffic_gen_hier_test, latency_of_misses_and_hits) {
+  auto& g = *gen[0];
+  run(g);
+
+  EXPECT_EQ(g.get_nRead().getDouble(), 128);
+  EXPECT_EQ(g.get_readLat().get_samples(), 128);
+  EXPECT_EQ(g.get_readLat().get_count(37), 64);  // first pass, cold misses to memory
+  EXPECT_EQ(g.get_readLat().get_count(5), 64);   // second pass, DL1 hits
+  EXPECT_EQ(g.get_avgReadLat().get_mean(), (37 + 5) / 2.0);
+
+  // one request at a time, and every completed byte is sampled once
+  auto& bw = g.get_avgBandwidth();
+  EXPECT_EQ(bw.get_mean() * bw.get_samples(), 128 * 64);
+  EXPECT_EQ(g.get_nBytes().getDouble(), 128 * 64);
+  EXPECT_EQ(g.get_avgOutstanding().get_samples(), bw.get_samples());
+  EXPECT_LE(g.get_avgOutstanding().get_mean(), 1);
+  EXPECT_GT(g.get_avgOutstanding().get_mean(), 0.9);
+}
+
+TEST_F(Traffic_gen_hier_test, outstanding_and_bandwidth) {
+  auto& g = *gen[1];
+  run(g);
+
+  EXPECT_EQ(g.get_nRead().getDouble(), 256);
+  EXPECT_EQ(g.get_readLat().get_count(5), 0);  // all misses
+
+  auto& bw = g.get_avgBandwidth();
+  EXPECT_EQ(bw.get_mean() * bw.get_samples(), 256 * 64);
+  EXPECT_GT(g.get_avgOutstanding().get_mean(), 4);  // misses overlap
+  EXPECT_LE(g.get_avgOutstanding().get_mean(), 8);
+  EXPECT_GT(bw.get_mean(), 64.0 / (5 + 31));  // more than one miss per latency
+}
+
+class Traffic_gen_test : public ::testing::Test {
+protected:
+  void setup(const std::string& stream) {
+    std::ofstream file("traffic_gen_test.toml");
+    file << "[st]\n";
+    file << stream;
+    file.close();
+
+    Config::init("traffic_gen_test.toml");
+  }
+
+  static std::vector<Addr_t> run(Traffic_stream& s, size_t max = 1 << 20) {
+    std::vector<Addr_t> v;
+    Addr_t              addr;
+    bool                write;
+    while (v.size() < max && s.next(addr, write)) {
+      v.push_back(addr);
+    }
+    return v;
+  }
+};
+
+TEST_F(Traffic_gen_test, stride_wraps_in_the_footprint) {
+  setup("pattern = \"stride\"\nbase = 4096\nsize = 1024\nstride = 128\nn_requests = 10\n");
+  Traffic_stream s("st", 64);
+  EXPECT_FALSE(Config::has_errors());
+
+  auto v = run(s);
+  ASSERT_EQ(v.size(), 10U);
+  EXPECT_EQ(v[0], 4096U);
+  EXPECT_EQ(v[1], 4096U + 128);
+  EXPECT_EQ(v[8], 4096U);  // 8 steps of 128 cover 1024
+  EXPECT_TRUE(s.is_done());
+}
+
+TEST_F(Traffic_gen_test, chase_visits_every_line_once) {
+  setup("pattern = \"chase\"\nsize = 65536\nn_requests = 1024\nmax_outstanding = 8\n");
+  Traffic_stream s("st", 64);
+  EXPECT_EQ(s.get_max_outstanding(), 1U);  // dependent loads
+
+  auto             v = run(s);
+  std::set<Addr_t> lines(v.begin(), v.end());
+  EXPECT_EQ(v.size(), 1024U);
+  EXPECT_EQ(lines.size(), 1024U);
+  EXPECT_LT(*lines.rbegin(), 65536U);
+}
+
+TEST_F(Traffic_gen_test, hot_set_and_write_mix) {
+  setup("pattern = \"hot\"\nsize = 1048576\nhot_size = 4096\nhot_pct = 80\nwrite_pct = 25\nn_requests = 20000\n");
+  Traffic_stream s("st", 64);
+
+  size_t hot    = 0;
+  size_t writes = 0;
+  Addr_t addr;
+  bool   write;
+  while (s.next(addr, write)) {
+    EXPECT_EQ(addr % 64, 0U);
+    hot += addr < 4096;
+    writes += write;
+  }
+  EXPECT_EQ(s.get_n_sent(), 20000U);
+  EXPECT_NEAR(hot / 20000.0, 0.80, 0.03);  // plus the random ones that land in the hot set
+  EXPECT_NEAR(writes / 20000.0, 0.25, 0.02);
+}
+
+TEST_F(Traffic_gen_test, replay_sends_the_loads_and_stores) {
+  auto name = fmt::format("traffic_gen_test_{}.trace", getpid());
+  {
+    Trace_writer wr(name);
+    wr.append({0x80000000, 0x80000002, 0, 0x0505});                  // c.addi a0, 1
+    wr.append({0x80000002, 0x80000006, 0x80001000, 0x0005b503});     // ld a0, 0(a1)
+    wr.append({0x80000006, 0x8000000a, 0x80001000, 0xfe050de3});     // beq
+    wr.append({0x8000000a, 0x8000000e, 0x80002000, 0x00a5b023});     // sd a0, 0(a1)
+    wr.append({0x8000000e, 0x80000012, 0x80000ff8, 0x0005b503});     // ld a0, 0(a1)
+  }
+  setup(fmt::format("pattern = \"replay\"\ntrace = \"{}\"\n", name));  // runs until the trace ends
+  Traffic_stream s("st", 64);
+  EXPECT_FALSE(Config::has_errors());
+
+  std::vector<std::pair<Addr_t, bool>> v;
+  Addr_t                               addr;
+  bool                                 write;
+  while (s.next(addr, write)) {
+    v.emplace_back(addr, write);
+  }
+  unlink(name.c_str());
+
+  EXPECT_EQ(v, (std::vector<std::pair<Addr_t, bool>>{{0x80001000, false}, {0x80002000, true}, {0x80000ff8, false}}));
+  EXPECT_TRUE(s.is_done());
+}
+
+TEST_F(Traffic_gen_test, config_errors) {
+  setup("pattern = \"random\"\n");  // no n_requests
+  Traffic_stream s("st", 64);
+  EXPECT_TRUE(Config::has_errors());
+  EXPECT_TRUE(s.is_done());
+
+  setup("pattern = \"chase\"\nsize = 4096\n");  // chase needs it too
+  Traffic_stream c("st", 64);
+  EXPECT_TRUE(c.is_done());
+}
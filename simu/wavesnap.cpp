@@ -12,6 +12,8 @@ Wavesnap::Wavesnap() {
   this->first_window_completed = false;
   this->signature_count        = 0;
   this->current_encoding       = "";
+
+  Dinst::keep_cold(true);  // stage times for every instruction, not only stats
 #ifdef RECORD_ONCE
   for (uint64_t i = 0; i < HASH_SIZE; i++) {
     this->signature_hit.push_back(false);